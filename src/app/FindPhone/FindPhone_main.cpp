@@ -100,6 +100,7 @@ void bluetooth_FindPhone_tile_setup(void)
     lv_obj_align(header, bluetooth_FindPhone_tile, LV_ALIGN_IN_TOP_RIGHT, -10, 10);
 
     gadgetbridge_register_cb( GADGETBRIDGE_JSON_MSG, bluetooth_FindPhone_event_cb, "bluetooth_FindPhone");
+    gadgetbridge_register_json_filter( "find", "n" );
 }
 
 void FindPhone_main_setup( uint32_t tile_num ) {
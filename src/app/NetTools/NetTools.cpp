@@ -62,7 +62,7 @@ void NetTools_load_config( void);
 /*
  * automatic register the app setup function with explicit call in main.cpp
  */
-static int registed = app_autocall_function( &NetTools_setup, 18 );           /** @brief app autocall function */
+static int registed = app_autocall_deferred( "Net\nTools", &NetTools_64px, &NetTools_setup, 18 );           /** @brief app autocall function */
 
 /*
  * setup routine for example app
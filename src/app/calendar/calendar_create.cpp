@@ -71,7 +71,7 @@ lv_style_t calendar_create_date_select_style;       /** @brief calendar select s
 /**
  * internal variables
  */
-static int calendar_create_edit_rowid = -1;
+static int64_t calendar_create_edit_rowid = -1;
 static int calendar_create_year = 0;                /** @brief current year in calendar overview */
 static int calendar_create_month = 0;               /** @brief current month in calendar overview */
 static int calendar_create_day = 0;                 /** @brief current day in calendar overview */
@@ -81,8 +81,6 @@ static int calendar_create_min = 0;                 /** @brief current day in ca
  * internal function declaration
  */
 void calendar_create_build_ui( void );
-static int calendar_create_get_content_callback( void *data, int argc, char **argv, char **azColName );
-static int calendar_create_dummy_callback( void *data, int argc, char **argv, char **azColName );
 static void calendar_create_date_selected_event_cb( lv_obj_t * obj, lv_event_t event );
 static void calendar_create_date_select_event_cb( lv_obj_t * obj, lv_event_t event );
 static void calendar_create_exit_event_cb( lv_obj_t * obj, lv_event_t event );
@@ -289,41 +287,17 @@ void calendar_create_set_content( void ) {
     lv_textarea_set_text( claendar_create_textfield, "" );
     calendar_create_edit_rowid = -1;
     /**
-     * build sql query string
+     * get entry at the selected date and time
      */
-#ifdef NATIVE_64BIT
-    char sql[512]="";
-    snprintf( sql, sizeof( sql ),   "SELECT rowid, content FROM calendar WHERE year == %d AND month == %d AND day == %d AND hour == %d AND min == %d;",
-                                    calendar_create_year,
-                                    calendar_create_month,
-                                    calendar_create_day,
-                                    calendar_create_hour,
-                                    calendar_create_min );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_get_content_callback, sql ) ) {
-        if ( calendar_create_edit_rowid != -1 ) {
-            CALENDAR_DAY_DEBUG_LOG("entry exist, set content from rowid %d", calendar_create_edit_rowid );
-        }
-        else {
-            CALENDAR_DAY_DEBUG_LOG("new entry");
-        }
+    char content[ CALENDAR_DB_CONTENT_SIZE ] = "";
+    calendar_create_edit_rowid = calendar_db_get_entry( calendar_create_year, calendar_create_month, calendar_create_day, calendar_create_hour, calendar_create_min, content, sizeof( content ) );
+    if ( calendar_create_edit_rowid != -1 ) {
+        CALENDAR_DAY_DEBUG_LOG("entry exist, set content from rowid %lld", (long long)calendar_create_edit_rowid );
+        lv_textarea_set_text( claendar_create_textfield, content );
     }
-#else
-    String sql = (String) "SELECT rowid, content FROM calendar WHERE year == " + calendar_create_year + " AND month == " + calendar_create_month + " AND day == " + calendar_create_day + " AND hour == " + calendar_create_hour + " AND min == " + calendar_create_min + ";";
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_get_content_callback, sql.c_str() ) ) {
-        if ( calendar_create_edit_rowid != -1 ) {
-            CALENDAR_DAY_DEBUG_LOG("entry exist, set content from rowid %d", calendar_create_edit_rowid );
-        }
-        else {
-            CALENDAR_DAY_DEBUG_LOG("new entry");
-        }
+    else {
+        CALENDAR_DAY_DEBUG_LOG("new entry");
     }
-#endif
 }
 
 void calendar_create_clear_content( void ) {
@@ -334,162 +308,33 @@ void calendar_create_clear_content( void ) {
     calendar_create_edit_rowid = -1;
 }
 
-static int calendar_create_get_content_callback( void *data, int argc, char **argv, char **azColName ) {
-    String Result = "";
-    /**
-     * count all key/values pairs
-     */
-    for ( int i = 0; i < argc ; i++ ) {
-       /**
-         * build an result string for one line presentation
-         */
-        Result += i != 0 ? "," : "";
-        Result += azColName[i];
-        Result += "=";
-        Result += argv[i] ? argv[i] : "NULL";
-        if( !strcmp( azColName[i], "content" ) ) {
-            lv_textarea_set_text( claendar_create_textfield, argv[i] );
-        }
-        if( !strcmp( azColName[i], "rowid" ) ) {
-            calendar_create_edit_rowid = atoi( argv[i] );
-        }
-    }
-    CALENDAR_DAY_DEBUG_LOG("Result = %s", Result.c_str() );
-    return( 0 );
-}
-
-static int calendar_create_dummy_callback( void *data, int argc, char **argv, char **azColName ) {
-    String Result = "";
-    /**
-     * count all key/values pairs
-     */
-    for ( int i = 0; i < argc ; i++ ) {
-       /**
-         * build an result string for one line presentation
-         */
-        Result += i != 0 ? "," : "";
-        Result += azColName[i];
-        Result += "=";
-        Result += argv[i] ? argv[i] : "NULL";
-    }
-    CALENDAR_DAY_DEBUG_LOG("Result = %s", Result.c_str() );
-    return( 0 );
-}
-
 void calendar_create_update_date( void ) {
-    /**
-     * build sql query string
-     */
-    char date[30]="";
-    snprintf( date, sizeof( date ),"%04d%02d%02d%02d%02d", calendar_create_year, calendar_create_month, calendar_create_day, lv_dropdown_get_selected( calendar_create_hour_list ), lv_dropdown_get_selected( calendar_create_min_list ) * 15 );
-#ifdef NATIVE_64BIT
-    char sql[512]="";
-    snprintf( sql, sizeof( sql ), "UPDATE calendar SET date=%s,year=%d,month=%d,day=%d,hour=%d,min=%d,content='%s' WHERE rowid == %d;",
-                            date,
-                            calendar_create_year,
-                            calendar_create_month,
-                            calendar_create_day,
-                            lv_dropdown_get_selected( calendar_create_hour_list ),
-                            lv_dropdown_get_selected( calendar_create_min_list ) * 15,
-                            lv_textarea_get_text( claendar_create_textfield ),
-                            calendar_create_edit_rowid );
-
-    CALENDAR_DAY_DEBUG_LOG("UPDATE query: %s", sql );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_dummy_callback, sql ) ) {
-        CALENDAR_DAY_DEBUG_LOG("sql query ok");
-    }
-#else
-    String sql = (String)   "UPDATE calendar SET " + 
-                            "date=" + date + "," +
-                            "year=" + calendar_create_year + "," +
-                            "month=" + calendar_create_month + "," +
-                            "day=" + calendar_create_day + "," +
-                            "hour=" + lv_dropdown_get_selected( calendar_create_hour_list ) + "," +
-                            "min=" + lv_dropdown_get_selected( calendar_create_min_list ) * 15 + "," +
-                            "content='" + lv_textarea_get_text( claendar_create_textfield ) + "' " +
-                            "WHERE rowid == " + calendar_create_edit_rowid + ";";
-    CALENDAR_DAY_DEBUG_LOG("UPDATE query: %s", sql.c_str() );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_dummy_callback, sql.c_str() ) ) {
-        CALENDAR_DAY_DEBUG_LOG("sql query ok");
+    if ( calendar_db_update( calendar_create_edit_rowid,
+                             calendar_create_year,
+                             calendar_create_month,
+                             calendar_create_day,
+                             lv_dropdown_get_selected( calendar_create_hour_list ),
+                             lv_dropdown_get_selected( calendar_create_min_list ) * 15,
+                             lv_textarea_get_text( claendar_create_textfield ) ) ) {
+        CALENDAR_DAY_DEBUG_LOG("update rowid %lld ok", (long long)calendar_create_edit_rowid );
     }
-#endif
 }
 
 void calendar_create_insert_date( void ) {
-    /**
-     * build sql query string
-     */
-    char date[30]="";
-    snprintf( date, sizeof( date ),"%04d%02d%02d%02d%02d", calendar_create_year, calendar_create_month, calendar_create_day, lv_dropdown_get_selected( calendar_create_hour_list ), lv_dropdown_get_selected( calendar_create_min_list ) * 15 );
-#ifdef NATIVE_64BIT
-    char sql[512]="";
-    snprintf( sql, sizeof( sql ),   "INSERT INTO calendar VALUES ( %s, %d, %d, %d, %d, %d, '%s');" ,
-                                    date,
-                                    calendar_create_year, 
-                                    calendar_create_month,
-                                    calendar_create_day,
-                                    lv_dropdown_get_selected( calendar_create_hour_list ),
-                                    lv_dropdown_get_selected( calendar_create_min_list ) * 15,
-                                    lv_textarea_get_text( claendar_create_textfield ) );
-
-    CALENDAR_DAY_DEBUG_LOG("UPDATE query: %s", sql );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_dummy_callback, sql ) ) {
-        CALENDAR_DAY_DEBUG_LOG("sql query ok");
+    if ( calendar_db_insert( calendar_create_year,
+                             calendar_create_month,
+                             calendar_create_day,
+                             lv_dropdown_get_selected( calendar_create_hour_list ),
+                             lv_dropdown_get_selected( calendar_create_min_list ) * 15,
+                             lv_textarea_get_text( claendar_create_textfield ) ) ) {
+        CALENDAR_DAY_DEBUG_LOG("insert ok");
     }
-#else
-    String sql = (String)   "INSERT INTO calendar VALUES ( " +
-                            date + "," +
-                            calendar_create_year + "," +
-                            calendar_create_month + "," +
-                            calendar_create_day + "," +
-                            lv_dropdown_get_selected( calendar_create_hour_list ) + "," +
-                            lv_dropdown_get_selected( calendar_create_min_list ) * 15 + "," +
-                            "'" + lv_textarea_get_text( claendar_create_textfield ) + "'" +
-                            ");";
-
-    CALENDAR_DAY_DEBUG_LOG("UPDATE query: %s", sql.c_str() );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_dummy_callback, sql.c_str() ) ) {
-        CALENDAR_DAY_DEBUG_LOG("sql query ok");
-    }
-#endif
 }
 
 void calendar_create_delete_date( void ) {
-    /**
-     * build sql query string
-     */
-#ifdef NATIVE_64BIT
-    char sql[512] = "";
-    snprintf( sql, sizeof( sql ), "DELETE FROM calendar WHERE rowid == %d;", calendar_create_edit_rowid );
-    CALENDAR_DAY_DEBUG_LOG("UPDATE query: %s", sql );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_dummy_callback, sql ) ) {
-        CALENDAR_DAY_DEBUG_LOG("sql query ok");
-    }
-#else
-    String sql = (String)   "DELETE FROM calendar WHERE rowid == " + calendar_create_edit_rowid + ";";
-    CALENDAR_DAY_DEBUG_LOG("UPDATE query: %s", sql.c_str() );
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_create_dummy_callback, sql.c_str() ) ) {
-        CALENDAR_DAY_DEBUG_LOG("sql query ok");
+    if ( calendar_db_delete( calendar_create_edit_rowid ) ) {
+        CALENDAR_DAY_DEBUG_LOG("delete rowid %lld ok", (long long)calendar_create_edit_rowid );
     }
-#endif
 }
 
 void calendar_create_activate_cb( void ) {
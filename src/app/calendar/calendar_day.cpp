@@ -73,7 +73,7 @@ static int calendar_day_day = 0;                /** @brief current day in calend
 /**
  * internal function declaration
  */
-static int calendar_day_overview_callback( void *data, int argc, char **argv, char **azColName );
+static bool calendar_day_overview_callback( calendar_db_entry_t *entry, void *data );
 void calendar_day_build_ui( void );
 static void calendar_day_exit_event_cb( lv_obj_t * obj, lv_event_t event );
 static void calendar_day_create_event_cb( lv_obj_t * obj, lv_event_t event );
@@ -203,32 +203,17 @@ void calendar_day_hibernate_cb( void ) {
     calendar_db_close();
 }
 
-static int calendar_day_overview_callback( void *data, int argc, char **argv, char **azColName ) {
-    String Result = "";
-    char hour[8] = "";
-    char min[8] = "";
-    /**
-     * count all key/values pairs
-     */
-    for ( int i = 0; i < argc ; i++ ) {
-       /**
-         * build an result string for one line presentation
-         */
-        Result += i != 0 ? "," : "";
-        Result += azColName[i];
-        Result += "=";
-        Result += argv[i] ? argv[i] : "NULL";
-    }
-    CALENDAR_DAY_DEBUG_LOG("Result = %s", Result.c_str() );
-    snprintf( hour, sizeof( hour ), "%02d", atoi( argv[ 0 ] ) );
-    snprintf( min, sizeof( min ), "%02d", atoi( argv[ 1 ] ) );
+static bool calendar_day_overview_callback( calendar_db_entry_t *entry, void *data ) {
+    char date[ CALENDAR_DB_CONTENT_SIZE + 16 ] = "";
+
+    CALENDAR_DAY_DEBUG_LOG("rowid = %lld, %02d:%02d %s", (long long)entry->rowid, entry->hour, entry->min, entry->content );
     /**
-     * add list entry   
+     * add list entry
      */
-    String Date = (String) hour + ":" + min + " - " + argv[2];
-    lv_obj_t *list_btn = lv_list_add_btn( calendar_day_list, NULL, Date.c_str() );
+    snprintf( date, sizeof( date ), "%02d:%02d - %s", entry->hour, entry->min, entry->content );
+    lv_obj_t *list_btn = lv_list_add_btn( calendar_day_list, NULL, date );
     lv_obj_set_event_cb( list_btn, calendar_day_edit_event_cb );
-    return( 0 );
+    return( true );
 }
 
 uint32_t calendar_day_get_tile( void ) {
@@ -242,27 +227,9 @@ void calendar_day_overview_refresh( int year, int month, int day ) {
 
     while ( lv_list_remove( calendar_day_list, 0 ) );
     /**
-     * build sql query string
-     */
-#ifdef NATIVE_64BIT
-    char sql[512]="";
-    snprintf( sql, sizeof( sql ),    "SELECT hour, min, content FROM calendar WHERE year == %d AND month == %d AND day == %d ORDER BY hour, min;",
-                                    year,
-                                    month,
-                                    day );
-    /**
-     * exec sql query
+     * query all dates of the day
      */
-    if ( calendar_db_exec( calendar_day_overview_callback, sql ) ) {
+    if ( calendar_db_get_day( year, month, day, calendar_day_overview_callback, NULL ) ) {
         CALENDAR_DAY_DEBUG_LOG("list created");
     }
-#else
-    String sql = (String) "SELECT hour, min, content FROM calendar WHERE year == " + year + " AND month == " + month + " AND day == " + day + " ORDER BY hour, min;";
-    /**
-     * exec sql query
-     */
-    if ( calendar_db_exec( calendar_day_overview_callback, sql.c_str() ) ) {
-        CALENDAR_DAY_DEBUG_LOG("list created");
-    }
-#endif
-}
\ No newline at end of file
+}
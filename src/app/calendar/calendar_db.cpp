@@ -1,6 +1,8 @@
 #include "config.h"
 #include "utils/sqlite3/sqlite3.h"
+#include "utils/sqlite3/esp32.h"
 #include "utils/filepath_convert.h"
+#include "hardware/powermgm.h"
 #include "calendar_db.h"
 
 #ifdef NATIVE_64BIT
@@ -20,18 +22,59 @@
     #include <time.h>
     #include <Arduino.h>
 #endif
+/**
+ * prepared statements, prepared on first use and kept until the database is closed on standby
+ */
+typedef enum {
+    CALENDAR_DB_STMT_MONTH = 0,
+    CALENDAR_DB_STMT_DAY,
+    CALENDAR_DB_STMT_ENTRY,
+    CALENDAR_DB_STMT_INSERT,
+    CALENDAR_DB_STMT_UPDATE,
+    CALENDAR_DB_STMT_DELETE,
+    CALENDAR_DB_STMT_BEGIN,
+    CALENDAR_DB_STMT_COMMIT,
+    CALENDAR_DB_STMT_NUM
+} calendar_db_stmt_t;
+
+static const char *calendar_db_stmt_sql[ CALENDAR_DB_STMT_NUM ] = {
+    "SELECT DISTINCT day FROM calendar WHERE year == ?1 AND month == ?2;",
+    "SELECT rowid, hour, min, content FROM calendar WHERE year == ?1 AND month == ?2 AND day == ?3 ORDER BY hour, min;",
+    "SELECT rowid, content FROM calendar WHERE year == ?1 AND month == ?2 AND day == ?3 AND hour == ?4 AND min == ?5 LIMIT 1;",
+    "INSERT INTO calendar VALUES ( ?1, ?2, ?3, ?4, ?5, ?6, ?7 );",
+    "UPDATE calendar SET date = ?2, year = ?3, month = ?4, day = ?5, hour = ?6, min = ?7, content = ?8 WHERE rowid == ?1;",
+    "DELETE FROM calendar WHERE rowid == ?1;",
+    "BEGIN;",
+    "COMMIT;"
+};
 /**
  * internal variables
  */
 sqlite3 *calendar_db = NULL;
 static uint32_t calendar_db_version = 0;
+static sqlite3_stmt *calendar_db_stmt[ CALENDAR_DB_STMT_NUM ];
+static int calendar_db_pending = 0;                 /** @brief writes inside the open transaction, 0 means no open transaction */
 /**
  * internal function declaration
  */
 static int calendar_db_version_callback( void *data, int argc, char **argv, char **azColName );
 static int calendar_db_exec_callback( void *data, int argc, char **argv, char **azColName );
+static bool calendar_db_powermgm_event_cb( EventBits_t event, void *arg );
+static sqlite3_stmt *calendar_db_get_stmt( calendar_db_stmt_t stmt );
+static bool calendar_db_step( calendar_db_stmt_t stmt );
+static bool calendar_db_write( calendar_db_stmt_t stmt );
+static bool calendar_db_commit( void );
+static void calendar_db_shutdown( void );
+static void calendar_db_upgrade( void );
+#ifdef CALENDAR_DB_BENCHMARK
+    static void calendar_db_benchmark( void );
+#endif // CALENDAR_DB_BENCHMARK
 
 void calendar_db_setup( void ) {
+    /**
+     * init sqlite3 once, the database is opened and closed on demand
+     */
+    sqlite3_initialize();
     /**
      * check if database exist and set create_table flag if not exist
      */
@@ -52,12 +95,12 @@ void calendar_db_setup( void ) {
         CALENDAR_DB_DEBUG_LOG("database exist");
         fclose( dbfile );
         /**
-         * get calendar_db_version
+         * get calendar_db_version and upgrade if needed
          */
         if ( calendar_db_open() ) {
             calendar_db_exec( calendar_db_version_callback, "SELECT version FROM calendar_db_version;");
+            calendar_db_upgrade();
         }
-        calendar_db_close();
     }
     else {
         CALENDAR_DB_ERROR_LOG("databsae not exist, create database and tables");
@@ -73,6 +116,8 @@ void calendar_db_setup( void ) {
             calendar_db_exec( calendar_db_exec_callback, "CREATE TABLE calendar ( date INTEGER, year INTEGER, month INTEGER, day INTEGER, hour INTEGER, min INTEGER, content );");
             calendar_db_exec( calendar_db_exec_callback, "CREATE TABLE calendar_db_version ( version INTEGER );");
             calendar_db_exec( calendar_db_exec_callback, "INSERT INTO calendar_db_version VALUES ( 1 );");
+            calendar_db_version = 1;
+            calendar_db_upgrade();
             #ifdef CALENDAR_DB_CREATE_TEST_DATA
                 CALENDAR_DB_INFO_LOG("create test dataset");
                 /**
@@ -82,40 +127,45 @@ void calendar_db_setup( void ) {
                 struct tm time_tm;
                 time( &now );
                 localtime_r( &now, &time_tm );
-                char date[30]="";
-                snprintf( date, sizeof( date ),"%04d%02d%02d%02d%02d", ( time_tm.tm_year + 1900 ), ( time_tm.tm_mon + 1 ), time_tm.tm_mday, time_tm.tm_hour, time_tm.tm_min );
-#ifdef NATIVE_64BIT
-                char sql[ 512 ] = "";
-                snprintf( sql, sizeof( sql ), "INSERT INTO calendar VALUES (%s,%d,%d,%d,%d,%d, 'first date');",
-                                        date,
-                                        ( time_tm.tm_year + 1900 ),
-                                        ( time_tm.tm_mon + 1 ), 
-                                        time_tm.tm_mday, 
-                                        time_tm.tm_hour, 
-                                        time_tm.tm_min ); 
-                calendar_db_exec( calendar_db_exec_callback, sql );
-#else
-                String sql = (String)   "INSERT INTO calendar VALUES (" +
-                                        date + "," +
-                                        ( time_tm.tm_year + 1900 ) + "," + 
-                                        ( time_tm.tm_mon + 1 ) + "," + 
-                                        time_tm.tm_mday + "," + 
-                                        time_tm.tm_hour + "," + 
-                                        time_tm.tm_min + "," + 
-                                        "'first date');";
-                calendar_db_exec( calendar_db_exec_callback, sql.c_str() );
-#endif
-                calendar_db_exec( calendar_db_version_callback, "SELECT version FROM calendar_db_version;");
+                calendar_db_insert( time_tm.tm_year + 1900, time_tm.tm_mon + 1, time_tm.tm_mday, time_tm.tm_hour, time_tm.tm_min, "first date" );
             #endif // CALENDAR_DB_CREATE_TEST_DATA
-            /**
-             * close and shutdown sqlite3
-             */
-            calendar_db_close();
         }
         else {
             CALENDAR_DB_ERROR_LOG("Can't open database: %s", sqlite3_errmsg( calendar_db ) );
         }
     }
+    #ifdef CALENDAR_DB_BENCHMARK
+        calendar_db_benchmark();
+    #endif // CALENDAR_DB_BENCHMARK
+    /**
+     * close database until the app needs it
+     */
+    calendar_db_shutdown();
+    powermgm_register_cb( POWERMGM_STANDBY, calendar_db_powermgm_event_cb, "calendar db powermgm" );
+}
+
+static bool calendar_db_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case( POWERMGM_STANDBY ):
+            calendar_db_shutdown();
+            break;
+    }
+    return( true );
+}
+
+static void calendar_db_upgrade( void ) {
+    char sql[64] = "";
+
+    if ( calendar_db_version >= CALENDAR_DB_VERSION )
+        return;
+    /**
+     * version 2: index for month and day queries
+     */
+    CALENDAR_DB_INFO_LOG("upgrade calendar db from version %d to %d", calendar_db_version, CALENDAR_DB_VERSION );
+    calendar_db_exec( calendar_db_exec_callback, "CREATE INDEX IF NOT EXISTS calendar_ymd ON calendar ( year, month, day, hour, min );");
+    snprintf( sql, sizeof( sql ), "UPDATE calendar_db_version SET version = %d;", CALENDAR_DB_VERSION );
+    calendar_db_exec( calendar_db_exec_callback, sql );
+    calendar_db_version = CALENDAR_DB_VERSION;
 }
 
 bool calendar_db_open( void ) {
@@ -124,13 +174,8 @@ bool calendar_db_open( void ) {
      * check if calendar_db already open
      */
     if ( calendar_db ) {
-        CALENDAR_DB_INFO_LOG("calendar_db already open");
         return( true );
     }
-    /**
-     * init sqlite3
-     */
-    sqlite3_initialize();
     /**
      * create calendar db filename
      */
@@ -142,14 +187,8 @@ bool calendar_db_open( void ) {
     int error = sqlite3_open( filename, &calendar_db );
     if ( error ) {
         CALENDAR_DB_ERROR_LOG("can't open calendar database: %s", sqlite3_errmsg( calendar_db ) );
-        calendar_db = NULL;
-        /**
-         * shutdown sqlite3
-         */
-        sqlite3_db_cacheflush( calendar_db );
         sqlite3_close( calendar_db );
-        sqlite3_db_release_memory( calendar_db );
-        sqlite3_shutdown();
+        calendar_db = NULL;
     }
     else {
         CALENDAR_DB_DEBUG_LOG("calendar database open");
@@ -159,19 +198,244 @@ bool calendar_db_open( void ) {
 }
 
 void calendar_db_close( void ) {
+    /**
+     * only commit pending writes, the database and the prepared
+     * statements are kept until standby
+     */
+    calendar_db_commit();
+}
+
+static void calendar_db_shutdown( void ) {
     if ( calendar_db ) {
         /**
-         * shutdown sqlite3
+         * a commit that still fails here is rolled back, the open
+         * transaction must not outlive the connection
+         */
+        if ( !calendar_db_commit() ) {
+            calendar_db_exec( calendar_db_exec_callback, "ROLLBACK;");
+            calendar_db_pending = 0;
+        }
+        /**
+         * finalize prepared statements
+         */
+        for ( int i = 0 ; i < CALENDAR_DB_STMT_NUM ; i++ ) {
+            if ( calendar_db_stmt[ i ] ) {
+                sqlite3_finalize( calendar_db_stmt[ i ] );
+                calendar_db_stmt[ i ] = NULL;
+            }
+        }
+        /**
+         * close database
          */
-        sqlite3_db_cacheflush( calendar_db );
         sqlite3_close( calendar_db );
-        sqlite3_db_release_memory( calendar_db );
-        sqlite3_shutdown();
         CALENDAR_DB_DEBUG_LOG("calendar database closed");
     }
     calendar_db = NULL;
 }
 
+static sqlite3_stmt *calendar_db_get_stmt( calendar_db_stmt_t stmt ) {
+    if ( !calendar_db_open() ) {
+        return( NULL );
+    }
+    /**
+     * prepare statement on first use
+     */
+    if ( !calendar_db_stmt[ stmt ] ) {
+        if ( sqlite3_prepare_v3( calendar_db, calendar_db_stmt_sql[ stmt ], -1, SQLITE_PREPARE_PERSISTENT, &calendar_db_stmt[ stmt ], NULL ) != SQLITE_OK ) {
+            CALENDAR_DB_ERROR_LOG("prepare failed: %s", sqlite3_errmsg( calendar_db ) );
+            calendar_db_stmt[ stmt ] = NULL;
+            return( NULL );
+        }
+    }
+    return( calendar_db_stmt[ stmt ] );
+}
+
+static bool calendar_db_step( calendar_db_stmt_t stmt ) {
+    bool retval = false;
+    sqlite3_stmt *s = calendar_db_stmt[ stmt ];
+
+    if ( !s ) {
+        return( retval );
+    }
+
+    if ( sqlite3_step( s ) == SQLITE_DONE ) {
+        retval = true;
+    }
+    else {
+        CALENDAR_DB_ERROR_LOG("SQL error: %s", sqlite3_errmsg( calendar_db ) );
+    }
+    sqlite3_reset( s );
+    sqlite3_clear_bindings( s );
+    return( retval );
+}
+
+static bool calendar_db_write( calendar_db_stmt_t stmt ) {
+    /**
+     * group writes into one transaction, one journal write per batch instead of per entry
+     */
+    if ( !calendar_db_pending ) {
+        if ( !calendar_db_get_stmt( CALENDAR_DB_STMT_BEGIN ) || !calendar_db_step( CALENDAR_DB_STMT_BEGIN ) ) {
+            sqlite3_reset( calendar_db_stmt[ stmt ] );
+            sqlite3_clear_bindings( calendar_db_stmt[ stmt ] );
+            return( false );
+        }
+    }
+    calendar_db_pending++;
+    bool retval = calendar_db_step( stmt );
+
+    if ( calendar_db_pending >= CALENDAR_DB_BATCH ) {
+        calendar_db_commit();
+    }
+    return( retval );
+}
+
+static bool calendar_db_commit( void ) {
+    if ( !calendar_db_pending ) {
+        return( true );
+    }
+    if ( calendar_db_get_stmt( CALENDAR_DB_STMT_COMMIT ) && calendar_db_step( CALENDAR_DB_STMT_COMMIT ) ) {
+        CALENDAR_DB_DEBUG_LOG("commit %d writes", calendar_db_pending );
+        calendar_db_pending = 0;
+        return( true );
+    }
+    /**
+     * sqlite rolls back on some errors, keep pending while the
+     * transaction is still open so the commit is retried
+     */
+    if ( sqlite3_get_autocommit( calendar_db ) ) {
+        CALENDAR_DB_ERROR_LOG("commit failed, %d writes rolled back", calendar_db_pending );
+        calendar_db_pending = 0;
+    }
+    else {
+        CALENDAR_DB_ERROR_LOG("commit failed, retry %d writes later", calendar_db_pending );
+    }
+    return( false );
+}
+
+uint32_t calendar_db_get_month( int year, int month ) {
+    uint32_t days = 0;
+    sqlite3_stmt *s = calendar_db_get_stmt( CALENDAR_DB_STMT_MONTH );
+
+    if ( !s ) {
+        return( days );
+    }
+
+    sqlite3_bind_int( s, 1, year );
+    sqlite3_bind_int( s, 2, month );
+    while ( sqlite3_step( s ) == SQLITE_ROW ) {
+        int day = sqlite3_column_int( s, 0 );
+        if ( day >= 0 && day < 32 ) {
+            days |= ( 1ul << day );
+        }
+    }
+    sqlite3_reset( s );
+    return( days );
+}
+
+int calendar_db_get_day( int year, int month, int day, CALENDAR_DB_ENTRY_FUNC callback, void *data ) {
+    int count = 0;
+    calendar_db_entry_t entry;
+    sqlite3_stmt *s = calendar_db_get_stmt( CALENDAR_DB_STMT_DAY );
+
+    if ( !s ) {
+        return( count );
+    }
+
+    sqlite3_bind_int( s, 1, year );
+    sqlite3_bind_int( s, 2, month );
+    sqlite3_bind_int( s, 3, day );
+    while ( sqlite3_step( s ) == SQLITE_ROW ) {
+        count++;
+        entry.rowid = sqlite3_column_int64( s, 0 );
+        entry.year = year;
+        entry.month = month;
+        entry.day = day;
+        entry.hour = sqlite3_column_int( s, 1 );
+        entry.min = sqlite3_column_int( s, 2 );
+        entry.content = (const char *)sqlite3_column_text( s, 3 );
+        if ( !entry.content ) {
+            entry.content = "";
+        }
+        if ( callback && !callback( &entry, data ) ) {
+            break;
+        }
+    }
+    sqlite3_reset( s );
+    return( count );
+}
+
+int64_t calendar_db_get_entry( int year, int month, int day, int hour, int min, char *content, size_t size ) {
+    int64_t rowid = -1;
+    sqlite3_stmt *s = calendar_db_get_stmt( CALENDAR_DB_STMT_ENTRY );
+
+    if ( !s ) {
+        return( rowid );
+    }
+
+    sqlite3_bind_int( s, 1, year );
+    sqlite3_bind_int( s, 2, month );
+    sqlite3_bind_int( s, 3, day );
+    sqlite3_bind_int( s, 4, hour );
+    sqlite3_bind_int( s, 5, min );
+    if ( sqlite3_step( s ) == SQLITE_ROW ) {
+        rowid = sqlite3_column_int64( s, 0 );
+        if ( content && size ) {
+            const char *text = (const char *)sqlite3_column_text( s, 1 );
+            snprintf( content, size, "%s", text ? text : "" );
+        }
+    }
+    sqlite3_reset( s );
+    return( rowid );
+}
+/**
+ * @brief bind date, year, month, day, hour, min and content starting at index first
+ */
+static void calendar_db_bind_entry( sqlite3_stmt *s, int first, int year, int month, int day, int hour, int min, const char *content ) {
+    sqlite3_int64 date = ( ( ( ( (sqlite3_int64)year * 100 + month ) * 100 + day ) * 100 + hour ) * 100 ) + min;
+
+    sqlite3_bind_int64( s, first, date );
+    sqlite3_bind_int( s, first + 1, year );
+    sqlite3_bind_int( s, first + 2, month );
+    sqlite3_bind_int( s, first + 3, day );
+    sqlite3_bind_int( s, first + 4, hour );
+    sqlite3_bind_int( s, first + 5, min );
+    sqlite3_bind_text( s, first + 6, content ? content : "", -1, SQLITE_TRANSIENT );
+}
+
+bool calendar_db_insert( int year, int month, int day, int hour, int min, const char *content ) {
+    sqlite3_stmt *s = calendar_db_get_stmt( CALENDAR_DB_STMT_INSERT );
+
+    if ( !s ) {
+        return( false );
+    }
+
+    calendar_db_bind_entry( s, 1, year, month, day, hour, min, content );
+    return( calendar_db_write( CALENDAR_DB_STMT_INSERT ) );
+}
+
+bool calendar_db_update( int64_t rowid, int year, int month, int day, int hour, int min, const char *content ) {
+    sqlite3_stmt *s = calendar_db_get_stmt( CALENDAR_DB_STMT_UPDATE );
+
+    if ( !s ) {
+        return( false );
+    }
+
+    sqlite3_bind_int64( s, 1, rowid );
+    calendar_db_bind_entry( s, 2, year, month, day, hour, min, content );
+    return( calendar_db_write( CALENDAR_DB_STMT_UPDATE ) );
+}
+
+bool calendar_db_delete( int64_t rowid ) {
+    sqlite3_stmt *s = calendar_db_get_stmt( CALENDAR_DB_STMT_DELETE );
+
+    if ( !s ) {
+        return( false );
+    }
+
+    sqlite3_bind_int64( s, 1, rowid );
+    return( calendar_db_write( CALENDAR_DB_STMT_DELETE ) );
+}
+
 static int calendar_db_exec_callback( void *data, int argc, char **argv, char **azColName ) {
     /**
      * exit if no database is open
@@ -232,3 +496,70 @@ bool calendar_db_exec( SQL_CALLBACK_FUNC callback, const char *sql ) {
     }
     return retval;
 }
+
+#ifdef CALENDAR_DB_BENCHMARK
+static int calendar_db_benchmark_callback( void *data, int argc, char **argv, char **azColName ) {
+    uint32_t *days = (uint32_t*)data;
+    if ( argc && argv[0] ) {
+        *days |= ( 1ul << ( atoi( argv[0] ) & 31 ) );
+    }
+    return 0;
+}
+
+static void calendar_db_benchmark( void ) {
+    const int year = 1970;
+    uint32_t days = 0;
+    char sql[128] = "";
+
+    if ( !calendar_db_open() ) {
+        return;
+    }
+    /**
+     * insert events, spread over one year
+     */
+    uint64_t start = micros();
+    for ( int i = 0 ; i < CALENDAR_DB_BENCHMARK_EVENTS ; i++ ) {
+        calendar_db_insert( year, 1 + ( i % 12 ), 1 + ( ( i * 7 ) % 28 ), i % 24, ( i % 4 ) * 15, "benchmark" );
+    }
+    calendar_db_commit();
+    CALENDAR_DB_INFO_LOG("benchmark: insert %d events in %lu us", CALENDAR_DB_BENCHMARK_EVENTS, (unsigned long)( micros() - start ) );
+    /**
+     * month overview with the prepared statement
+     */
+    start = micros();
+    for ( int month = 1 ; month <= 12 ; month++ ) {
+        days |= calendar_db_get_month( year, month );
+    }
+    CALENDAR_DB_INFO_LOG("benchmark: 12 month queries, prepared: %lu us, days = %08x", (unsigned long)( micros() - start ), days );
+    /**
+     * month overview with sqlite3_exec, parsed on every call
+     */
+    days = 0;
+    start = micros();
+    for ( int month = 1 ; month <= 12 ; month++ ) {
+        snprintf( sql, sizeof( sql ), "SELECT day FROM calendar WHERE year == %d AND month == %d;", year, month );
+        sqlite3_exec( calendar_db, sql, calendar_db_benchmark_callback, &days, NULL );
+    }
+    CALENDAR_DB_INFO_LOG("benchmark: 12 month queries, sqlite3_exec: %lu us, days = %08x", (unsigned long)( micros() - start ), days );
+    /**
+     * remove benchmark events
+     */
+    snprintf( sql, sizeof( sql ), "DELETE FROM calendar WHERE year == %d;", year );
+    calendar_db_exec( calendar_db_exec_callback, sql );
+    #ifdef SQLITE_ESP32VFS_BENCHMARK
+        /**
+         * raw vfs throughput with and without sector cache
+         */
+        char filename[256] = "";
+        filepath_convert( filename, sizeof( filename ), "/spiffs/vfsbench.db" );
+        for ( int cache = 0 ; cache < 2 ; cache++ ) {
+            esp32vfs_benchmark_t result;
+            int rc = sqlite3_ESP32vfs_benchmark( filename, 64, cache, &result );
+            CALENDAR_DB_INFO_LOG("vfs benchmark: rc = %d, cache = %d, write %lu us, sync %lu us, read %lu us, random %lu us, hit/miss %u/%u, sectors read/written %u/%u",
+                                    rc, result.bCache,
+                                    (unsigned long)result.iWrite, (unsigned long)result.iSync, (unsigned long)result.iRead, (unsigned long)result.iRandom,
+                                    result.stats.nHit, result.stats.nMiss, result.stats.nRead, result.stats.nWrite );
+        }
+    #endif // SQLITE_ESP32VFS_BENCHMARK
+}
+#endif // CALENDAR_DB_BENCHMARK
@@ -16,8 +16,12 @@
 #ifndef _CALENDAR_DB_H
     #define _CALENDAR_DB_H
 
+    #include <stdint.h>
+    #include <stddef.h>
+
     // #define CALENDAR_DB_FORCE_CREATE_DB
     #define CALENDAR_DB_CREATE_TEST_DATA
+    // #define CALENDAR_DB_BENCHMARK                            /** @brief insert and query CALENDAR_DB_BENCHMARK_EVENTS events on setup and log the timing */
 
     #define CALENDAR_DB_INFO_LOG    log_d
     #define CALENDAR_DB_DEBUG_LOG   log_d
@@ -25,6 +29,31 @@
 
 //    #define CALENDAR_DB_FILE        "/home/sharan/.hedge/spiffs/calendar.db"       /** @brief calendar database file */
     #define CALENDAR_DB_FILE        "/spiffs/calendar.db"       /** @brief calendar database file */
+    #define CALENDAR_DB_VERSION     2                           /** @brief database version, 2 adds the (year, month, day) index */
+    #define CALENDAR_DB_BATCH       16                          /** @brief max writes per transaction before an intermediate commit */
+    #define CALENDAR_DB_BENCHMARK_EVENTS    2000                /** @brief events inserted by the benchmark */
+    #define CALENDAR_DB_CONTENT_SIZE        256                 /** @brief max content size of an entry */
+    /**
+     * @brief calendar entry
+     */
+    typedef struct {
+        int64_t rowid;                                      /** @brief database row id */
+        int year;                                           /** @brief year */
+        int month;                                          /** @brief month 1..12 */
+        int day;                                            /** @brief day 1..31 */
+        int hour;                                           /** @brief hour 0..23 */
+        int min;                                            /** @brief minute 0..59 */
+        const char *content;                                /** @brief content, only valid inside the callback */
+    } calendar_db_entry_t;
+    /**
+     * @brief entry callback function definition, this function is called on every entry
+     *
+     * @param   entry       pointer to the entry
+     * @param   data        user define data
+     *
+     * @return  true to continue, false to stop
+     */
+    typedef bool ( * CALENDAR_DB_ENTRY_FUNC ) ( calendar_db_entry_t *entry, void *data );
     /**
      * @brief sql exec callback function definition, this function is called on every result line
      * 
@@ -39,15 +68,72 @@
      */
     void calendar_db_setup( void );
     /**
-     * @brief open calendar db and holds it open in background
+     * @brief open calendar db and holds it open in background, a no-op if already open
      * 
      * @return  true if no error, false if failed
      */
     bool calendar_db_open( void );
     /**
-     * @brief close calendar db
+     * @brief commit pending writes, the db stays open until standby
      */
     void calendar_db_close( void );
+    /**
+     * @brief get days with entries in a month
+     *
+     * @param   year        year
+     * @param   month       month 1..12
+     *
+     * @return  bitmap, bit n set if day n has an entry
+     */
+    uint32_t calendar_db_get_month( int year, int month );
+    /**
+     * @brief get all entries of a day ordered by time
+     *
+     * @param   year        year
+     * @param   month       month 1..12
+     * @param   day         day 1..31
+     * @param   callback    called for each entry
+     * @param   data        user define data
+     *
+     * @return  number of entries
+     */
+    int calendar_db_get_day( int year, int month, int day, CALENDAR_DB_ENTRY_FUNC callback, void *data );
+    /**
+     * @brief get the entry at a given time
+     *
+     * @param   year        year
+     * @param   month       month 1..12
+     * @param   day         day 1..31
+     * @param   hour        hour
+     * @param   min         minute
+     * @param   content     buffer for the content
+     * @param   size        size of the content buffer
+     *
+     * @return  rowid of the entry or -1 if no entry exist
+     */
+    int64_t calendar_db_get_entry( int year, int month, int day, int hour, int min, char *content, size_t size );
+    /**
+     * @brief insert an entry
+     *
+     * @return  true if success
+     */
+    bool calendar_db_insert( int year, int month, int day, int hour, int min, const char *content );
+    /**
+     * @brief update an entry
+     *
+     * @param   rowid       rowid of the entry
+     *
+     * @return  true if success
+     */
+    bool calendar_db_update( int64_t rowid, int year, int month, int day, int hour, int min, const char *content );
+    /**
+     * @brief delete an entry
+     *
+     * @param   rowid       rowid of the entry
+     *
+     * @return  true if success
+     */
+    bool calendar_db_delete( int64_t rowid );
     /**
      * @brief query an sql request
      * 
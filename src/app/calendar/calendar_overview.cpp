@@ -73,7 +73,6 @@ lv_calendar_date_t *calendar_overview_highlighted_days = NULL;
 /**
  * internal variables
  */
-static bool calendar_overview_highlight_table[ CALENDAR_OVREVIEW_HIGHLIGHTED_DAYS ];/** @brief highlighted days table bool table for sql query */
 static int calendar_year = 0;                                                       /** @brief current year in calendar overview */
 static int calendar_month = 0;                                                      /** @brief current month in calendar overview */
 static int calendar_day = 0;                                                        /** @brief current day in calendar overview */
@@ -82,7 +81,6 @@ static int calendar_day = 0;
  */
 static void calendar_overview_exit_event_cb( lv_obj_t * obj, lv_event_t event );
 static void calendar_overview_date_event_cb( lv_obj_t * obj, lv_event_t event );
-static int calendar_overview_highlight_day_callback( void *data, int argc, char **argv, char **azColName );
 static int calendar_overview_highlight_day( int year, int month );
 static void calendar_overview_build_ui( void );
 static void calendar_overview_refresh_today_ui( void );
@@ -257,60 +255,23 @@ uint32_t calendar_overview_get_tile( void ) {
     return( calendar_ovreview_tile_num );
 }
 
-static int calendar_overview_highlight_day_callback( void *data, int argc, char **argv, char **azColName ) {
-    String Result = "";
-    /**
-     * count all key/values pairs
-     */
-    for ( int i = 0; i < argc ; i++ ) {
-       /**
-         * build an result string for one line presentation
-         */
-        Result += i != 0 ? "," : "";
-        Result += azColName[i];
-        Result += "=";
-        Result += argv[i] ? argv[i] : "NULL";
-        /**
-         * mark day in calendar_overview_highlight_table as a day with an date
-         */
-        if ( !strcmp( azColName[ i ], "day") ) {
-            calendar_overview_highlight_table[ atoi( argv[ i ] ) ] = true;
-            CALENDAR_OVREVIEW_DEBUG_LOG("highlight day %d", atoi( argv[ i ] ) );
-        }
-    }
-    CALENDAR_OVREVIEW_DEBUG_LOG("Result = %s", Result.c_str() );
-    return 0;
-}
-
 static int calendar_overview_highlight_day( int year, int month ) {
     int hitcounter = 0;
     /**
-     * clear calendar_overview_highlight_table table
-     */
-    for ( int i = 0 ; i < CALENDAR_OVREVIEW_HIGHLIGHTED_DAYS ; i++ ) {
-        calendar_overview_highlight_table[ i ] = false;
-    }
-    /**
-     * build sql query string
+     * get a bitmap of days with dates, bit n is set for day n
      */
-    char sql[ 512 ] = "";
-    snprintf( sql, sizeof( sql ), "SELECT rowid, year, month, day, hour, min, content FROM calendar WHERE year == %d AND month == %d;", year, month );
+    uint32_t days = calendar_db_get_month( year, month );
     /**
-     * exec sql query
+     * marked days with dates
      */
-    if ( calendar_db_exec( calendar_overview_highlight_day_callback, sql ) ) {
-        /**
-         * count day with day and marked days with dates
-         */
-        for ( int i = 0 ; i < CALENDAR_OVREVIEW_HIGHLIGHTED_DAYS ; i++ ) {
-            if ( calendar_overview_highlight_table[ i ] ) {
-                CALENDAR_OVREVIEW_DEBUG_LOG("add year %d and month %d to highlight", year, month );
-                calendar_overview_highlighted_days[ hitcounter ].day = i;
-                calendar_overview_highlighted_days[ hitcounter ].month = month;
-                calendar_overview_highlighted_days[ hitcounter ].year = year;
-                hitcounter++;
-            }
+    for ( int i = 1 ; i < 32 && hitcounter < CALENDAR_OVREVIEW_HIGHLIGHTED_DAYS ; i++ ) {
+        if ( days & ( 1ul << i ) ) {
+            CALENDAR_OVREVIEW_DEBUG_LOG("highlight day %d", i );
+            calendar_overview_highlighted_days[ hitcounter ].day = i;
+            calendar_overview_highlighted_days[ hitcounter ].month = month;
+            calendar_overview_highlighted_days[ hitcounter ].year = year;
+            hitcounter++;
         }
     }
     return( hitcounter );
-}
\ No newline at end of file
+}
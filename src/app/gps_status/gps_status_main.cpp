@@ -217,12 +217,7 @@ void gps_status_main_setup(uint32_t tile_num) {
      */
     gpsctl_register_cb(     GPSCTL_FIX 
                           | GPSCTL_NOFIX
-                          | GPSCTL_UPDATE_LOCATION
-                          | GPSCTL_UPDATE_SATELLITE
-                          | GPSCTL_UPDATE_SATELLITE_TYPE
-                          | GPSCTL_UPDATE_SPEED
-                          | GPSCTL_UPDATE_ALTITUDE
-                          | GPSCTL_UPDATE_SOURCE
+                          | GPSCTL_UPDATE_DATA
                           , gpsctl_gps_status_event_cb
                           , "gpsctl gps status" );
     /** register avtivate and hibernate callback function */
@@ -262,42 +257,44 @@ bool gpsctl_gps_status_event_cb( EventBits_t event, void *arg ) {
             lv_label_set_text( speed_value, "n/a" );
             lv_label_set_text( source_value, "n/a" );
             break;
-        case GPSCTL_UPDATE_LOCATION:
-            if( gps_data->valid_location )
-                snprintf( temp, sizeof( temp ), "%.4f/%.4f", gps_data->lat, gps_data->lon );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( pos_longlat_value, temp );
-            break;
-        case GPSCTL_UPDATE_SATELLITE:
-            if ( gps_data->valid_satellite )
-                snprintf( temp, sizeof( temp ), "%d", gps_data->satellites );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( num_satellites_value, temp );
-            break;
-        case GPSCTL_UPDATE_SATELLITE_TYPE:
-            snprintf( temp, sizeof( temp ), "GP %d, GL %d, BD %d", gps_data->satellite_types.gps_satellites,
-                                                                   gps_data->satellite_types.glonass_satellites,
-                                                                   gps_data->satellite_types.baidou_satellites );
-            lv_label_set_text( satellite_type, temp );
-            break;
-        case GPSCTL_UPDATE_SPEED:
-            if ( gps_data->valid_speed )
-                snprintf( temp, sizeof( temp ), "%.2fkm/h", gps_data->speed_kmh );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( speed_value, temp );
-            break;
-        case GPSCTL_UPDATE_ALTITUDE:
-            if ( gps_data->valid_altitude )
-                snprintf( temp, sizeof( temp ), "%.1fm", gps_data->altitude_meters );
-            else
-                snprintf( temp, sizeof( temp ), "n/a" );
-            lv_label_set_text( altitude_value, temp);
-            break;
-        case GPSCTL_UPDATE_SOURCE:
-            lv_label_set_text( source_value, gpsctl_get_source_str( gps_data->gps_source ) );
+        case GPSCTL_UPDATE_DATA:
+            if ( gps_data->changed & GPS_DATA_LOCATION ) {
+                if( gps_data->valid_location )
+                    snprintf( temp, sizeof( temp ), "%.4f/%.4f", gps_data->lat, gps_data->lon );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( pos_longlat_value, temp );
+            }
+            if ( gps_data->changed & GPS_DATA_SATELLITE ) {
+                if ( gps_data->valid_satellite )
+                    snprintf( temp, sizeof( temp ), "%d", gps_data->satellites );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( num_satellites_value, temp );
+            }
+            if ( gps_data->changed & GPS_DATA_SATELLITE_TYPE ) {
+                snprintf( temp, sizeof( temp ), "GP %d, GL %d, BD %d", gps_data->satellite_types.gps_satellites,
+                                                                       gps_data->satellite_types.glonass_satellites,
+                                                                       gps_data->satellite_types.baidou_satellites );
+                lv_label_set_text( satellite_type, temp );
+            }
+            if ( gps_data->changed & GPS_DATA_SPEED ) {
+                if ( gps_data->valid_speed )
+                    snprintf( temp, sizeof( temp ), "%.2fkm/h", gps_data->speed_kmh );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( speed_value, temp );
+            }
+            if ( gps_data->changed & GPS_DATA_ALTITUDE ) {
+                if ( gps_data->valid_altitude )
+                    snprintf( temp, sizeof( temp ), "%.1fm", gps_data->altitude_meters );
+                else
+                    snprintf( temp, sizeof( temp ), "n/a" );
+                lv_label_set_text( altitude_value, temp);
+            }
+            if ( gps_data->changed & GPS_DATA_SOURCE ) {
+                lv_label_set_text( source_value, gpsctl_get_source_str( gps_data->gps_source ) );
+            }
             break;
     }
 
@@ -25,6 +25,11 @@
     #include "gui/icon.h"
     #include "kodi_remote_config.h"
 
+    #define KODI_REMOTE_QUEUE_SIZE          8       /** @brief json-rpc calls waiting for the worker task */
+    #define KODI_REMOTE_PAYLOAD_SIZE        512     /** @brief max json-rpc request or batch size */
+    #define KODI_REMOTE_JSON_SIZE           3000    /** @brief json document size for a batch response */
+    #define KODI_REMOTE_INFO_SIZE           32      /** @brief artist and title buffer size */
+
     typedef struct {
         volatile bool changed = false;
         volatile bool success = false;
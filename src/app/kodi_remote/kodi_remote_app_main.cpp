@@ -38,6 +38,7 @@
     #include "utils/logging.h"
     #include "utils/millis.h"
     #include <string>
+    #include <curl/curl.h>
 
     using namespace std;
     #define String string
@@ -47,11 +48,34 @@
     #include "esp_task_wdt.h"
 #endif
 
+#ifdef NATIVE_64BIT
+    #define kodi_remote_millis()        ( micros() / 1000 )
+#else
+    #define kodi_remote_millis()        millis()
+#endif
+
+/**
+ * @brief json-rpc call queued for the worker task, an empty method requests a refresh
+ */
+typedef struct {
+    char method[32];                    /** @brief json-rpc method */
+    char params[64];                    /** @brief json-rpc params object */
+} kodi_remote_request_t;
+
 static const char* buttons[] = {"Info","Up","Context","\n","Left","OK","Right","\n","Back","Down","Exit",""};
 volatile bool kodi_remote_state = false;
 volatile bool kodi_remote_open_state = false;
 volatile bool kodi_remote_play_state = false;
 static uint64_t nextmillis = 0;
+static volatile bool kodi_remote_refresh_pending = false;
+static volatile uint32_t kodi_remote_requests = 0;
+#ifdef NATIVE_64BIT
+    static CURL *kodi_remote_curl = NULL;
+    static struct curl_slist *kodi_remote_curl_headers = NULL;
+#else
+    static HTTPClient kodi_remote_client;
+    static QueueHandle_t kodi_remote_queue = NULL;
+#endif
 
 lv_obj_t *kodi_remote_player_main_tile = NULL;
 lv_obj_t *kodi_remote_control_main_tile = NULL;
@@ -96,15 +120,22 @@ static void kodi_remote_button_event_cb( lv_obj_t * obj, lv_event_t event );
 static void kodi_remote_control_button(char cmd);
 
 #ifndef NATIVE_64BIT
-    TaskHandle_t kodi_remote_refresh_handle;
+    TaskHandle_t kodi_remote_worker_handle;
+    static void kodi_remote_worker( void *parameter );
 #endif
 kodi_remote_result_t kodi_remote_refresh_result;
 
-void kodi_remote_refresh(void *parameter);
+static void kodi_remote_request( const char* method, const char* params );
+static void kodi_remote_process( kodi_remote_request_t *request );
+static void kodi_remote_refresh( void );
 int16_t kodi_remote_get_active_player_id();
-void kodi_remote_get_active_player_state();
-void kodi_remote_get_active_player_item();
-void kodi_remote_get_active_players();
+static void kodi_remote_parse_players( JsonVariant response );
+static void kodi_remote_parse_player_state( JsonVariant response );
+static void kodi_remote_parse_player_item( JsonVariant response );
+static int kodi_remote_add_call( char *payload, size_t size, int len, const char* method, const char* params, uint32_t id );
+static JsonVariant kodi_remote_get_response( SpiRamJsonDocument &doc, uint32_t id );
+static bool kodi_remote_post_batch( const char *calls, int len, SpiRamJsonDocument* doc );
+static int kodi_remote_post( const char* payload, SpiRamJsonDocument* doc );
 int kodi_remote_publish(const char* method, const char* params, SpiRamJsonDocument* doc = nullptr);
 void kodi_remote_app_task( lv_task_t * task );
 
@@ -249,7 +280,7 @@ static void kodi_remote_play_event_cb( lv_obj_t * obj, lv_event_t event ) {
                 
                 char parameters[24];
                 snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d }", player);
-                kodi_remote_publish("Player.PlayPause", parameters);
+                kodi_remote_request("Player.PlayPause", parameters);
                 nextmillis = 0;
             } else {
                 lv_obj_set_hidden( kodi_remote_play, true );
@@ -258,7 +289,7 @@ static void kodi_remote_play_event_cb( lv_obj_t * obj, lv_event_t event ) {
                 
                 char parameters[24];
                 snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d }", player);
-                kodi_remote_publish("Player.PlayPause", parameters);
+                kodi_remote_request("Player.PlayPause", parameters);
                 nextmillis = 0;
             }
             break;
@@ -268,7 +299,7 @@ static void kodi_remote_play_event_cb( lv_obj_t * obj, lv_event_t event ) {
 static void kodi_remote_volume_up_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):
-            kodi_remote_publish("Application.SetVolume", "{ \"volume\": \"increment\" }");
+            kodi_remote_request("Application.SetVolume", "{ \"volume\": \"increment\" }");
             break;
     }
 }
@@ -276,7 +307,7 @@ static void kodi_remote_volume_up_event_cb( lv_obj_t * obj, lv_event_t event ) {
 static void kodi_remote_volume_down_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):
-            kodi_remote_publish("Application.SetVolume", "{ \"volume\": \"decrement\" }");
+            kodi_remote_request("Application.SetVolume", "{ \"volume\": \"decrement\" }");
             break;
     }
 }
@@ -289,7 +320,7 @@ static void kodi_remote_next_event_cb( lv_obj_t * obj, lv_event_t event ) {
 
             char parameters[42];
             snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"to\": \"next\" }", player);
-            kodi_remote_publish("Player.GoTo", parameters);
+            kodi_remote_request("Player.GoTo", parameters);
             nextmillis = 0;
             break;
     }
@@ -303,7 +334,7 @@ static void kodi_remote_prev_event_cb( lv_obj_t * obj, lv_event_t event ) {
 
             char parameters[42];
             snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"to\": \"previous\" }", player);
-            kodi_remote_publish("Player.GoTo", parameters);
+            kodi_remote_request("Player.GoTo", parameters);
             nextmillis = 0;
             break;
     }
@@ -320,31 +351,31 @@ static void kodi_remote_button_event_cb( lv_obj_t * obj, lv_event_t event ) {
 static void kodi_remote_control_button(char cmd) {
     switch( cmd ) {
         case 'I': //Info
-            kodi_remote_publish("Input.Info", "{}");
+            kodi_remote_request("Input.Info", "{}");
             break;
         case 'U': //Up
-            kodi_remote_publish("Input.Up", "{}");
+            kodi_remote_request("Input.Up", "{}");
             break;
         case 'C': //Context
-            kodi_remote_publish("Input.ContextMenu", "{}");
+            kodi_remote_request("Input.ContextMenu", "{}");
             break;
         case 'L': //Left
-            kodi_remote_publish("Input.Left", "{}");
+            kodi_remote_request("Input.Left", "{}");
             break;
         case 'O': //OK
-            kodi_remote_publish("Input.Select", "{}");
+            kodi_remote_request("Input.Select", "{}");
             break;
         case 'R': //Right
-            kodi_remote_publish("Input.Right", "{}");
+            kodi_remote_request("Input.Right", "{}");
             break;
         case 'B': //Back
-            kodi_remote_publish("Input.Back", "{}");
+            kodi_remote_request("Input.Back", "{}");
             break;
         case 'D': //Down
-            kodi_remote_publish("Input.Down", "{}");
+            kodi_remote_request("Input.Down", "{}");
             break;
         case 'E': //Exit
-            kodi_remote_publish("Input.Home", "{}");
+            kodi_remote_request("Input.Home", "{}");
             break;
     }
 }
@@ -359,18 +390,20 @@ void kodi_remote_app_task( lv_task_t * task ) {
             nextmillis = millis() + 60000L;
         }
         
-        if (kodi_remote_refresh_result.artist == nullptr) kodi_remote_refresh_result.artist = (volatile char*)CALLOC(32, sizeof(char));
-        if (kodi_remote_refresh_result.title == nullptr) kodi_remote_refresh_result.title = (volatile char*)CALLOC(32, sizeof(char));
-
-        kodi_remote_app_set_indicator( ICON_INDICATOR_UPDATE );
-        #ifdef NATIVE_64BIT
-            kodi_remote_refresh( NULL );
-        #else
-            xTaskCreatePinnedToCore(kodi_remote_refresh, "kodi_remote_refresh", 5000, NULL, 0, &kodi_remote_refresh_handle, 1);
-        #endif
+        if (kodi_remote_refresh_result.artist == nullptr) kodi_remote_refresh_result.artist = (volatile char*)CALLOC(KODI_REMOTE_INFO_SIZE, sizeof(char));
+        if (kodi_remote_refresh_result.title == nullptr) kodi_remote_refresh_result.title = (volatile char*)CALLOC(KODI_REMOTE_INFO_SIZE, sizeof(char));
+
+        // a refresh still waiting in the queue covers this one
+        if (!kodi_remote_refresh_pending) {
+            kodi_remote_refresh_pending = true;
+            kodi_remote_app_set_indicator( ICON_INDICATOR_UPDATE );
+            kodi_remote_request( NULL, NULL );
+        }
     }
 
     if (kodi_remote_refresh_result.changed) {
+        kodi_remote_refresh_result.changed = false;
+
         if ( kodi_remote_play_state == true ) {
             char val[32];
 
@@ -398,16 +431,106 @@ void kodi_remote_app_task( lv_task_t * task ) {
     }
 }
 
-void kodi_remote_refresh(void *parameter) {
+static void kodi_remote_request( const char* method, const char* params ) {
+    kodi_remote_request_t request;
+
+    snprintf( request.method, sizeof( request.method ), "%s", method ? method : "" );
+    snprintf( request.params, sizeof( request.params ), "%s", params ? params : "{}" );
+
+#ifdef NATIVE_64BIT
+    kodi_remote_process( &request );
+#else
+    // start the worker on first use, it keeps the connection to kodi open between calls
+    if ( kodi_remote_queue == NULL ) {
+        kodi_remote_queue = xQueueCreate( KODI_REMOTE_QUEUE_SIZE, sizeof( kodi_remote_request_t ) );
+        xTaskCreatePinnedToCore(kodi_remote_worker, "kodi_remote_worker", 5000, NULL, 0, &kodi_remote_worker_handle, 1);
+    }
+
+    if ( xQueueSend( kodi_remote_queue, &request, 0 ) != pdTRUE ) {
+        log_w("kodi_remote queue full, %s dropped", request.method[0] ? request.method : "refresh" );
+        if ( !request.method[0] ) kodi_remote_refresh_pending = false;
+    }
+#endif
+}
+
+static void kodi_remote_process( kodi_remote_request_t *request ) {
+    if ( request->method[0] == '\0' ) {
+        kodi_remote_refresh();
+        kodi_remote_refresh_pending = false;
+    } else {
+        kodi_remote_publish( request->method, request->params );
+    }
+}
+
+#ifndef NATIVE_64BIT
+    static void kodi_remote_worker( void *parameter ) {
+        kodi_remote_request_t request;
+
+        while ( true ) {
+            if ( xQueueReceive( kodi_remote_queue, &request, portMAX_DELAY ) == pdTRUE ) kodi_remote_process( &request );
+        }
+    }
+#endif
+
+static void kodi_remote_refresh( void ) {
     if (!kodi_remote_state) return;
 
-    kodi_remote_get_active_players();
-    kodi_remote_get_active_player_state();
-    kodi_remote_get_active_player_item();
+    uint32_t requests = kodi_remote_requests;
+    uint64_t start = kodi_remote_millis();
+    SpiRamJsonDocument doc( KODI_REMOTE_JSON_SIZE );
+
+    /**
+     * ask for the active players and, in the same batch, for the state and item
+     * of the last known player; only a player change costs a second request
+     */
+    int16_t player = kodi_remote_get_active_player_id();
+    uint32_t id = kodi_remote_refresh_result.kodi_remote_id;
+    char parameters[64];
+    char payload[KODI_REMOTE_PAYLOAD_SIZE];
+    int len = kodi_remote_add_call( payload, sizeof( payload ), 0, "Player.GetActivePlayers", "{}", id );
+    if ( player >= 0 ) {
+        snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"properties\": [\"speed\", \"partymode\"] }", player);
+        len = kodi_remote_add_call( payload, sizeof( payload ), len, "Player.GetProperties", parameters, id + 1 );
+        snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"properties\": [\"title\", \"artist\"] }", player);
+        len = kodi_remote_add_call( payload, sizeof( payload ), len, "Player.GetItem", parameters, id + 2 );
+    }
+    kodi_remote_refresh_result.kodi_remote_id = id + 3;
+
+    bool success = kodi_remote_post_batch( payload, len, &doc );
+    if ( success ) {
+        kodi_remote_parse_players( kodi_remote_get_response( doc, id ) );
+
+        if ( kodi_remote_get_active_player_id() != player ) {
+            player = kodi_remote_get_active_player_id();
+            id = kodi_remote_refresh_result.kodi_remote_id;
+            len = 0;
+            if ( player >= 0 ) {
+                snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"properties\": [\"speed\", \"partymode\"] }", player);
+                len = kodi_remote_add_call( payload, sizeof( payload ), len, "Player.GetProperties", parameters, id );
+                snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"properties\": [\"title\", \"artist\"] }", player);
+                len = kodi_remote_add_call( payload, sizeof( payload ), len, "Player.GetItem", parameters, id + 1 );
+                kodi_remote_refresh_result.kodi_remote_id = id + 2;
+                doc.clear();
+                success = kodi_remote_post_batch( payload, len, &doc );
+            }
+        } else {
+            id++;
+        }
+    }
+
+    if ( success && player >= 0 ) {
+        kodi_remote_parse_player_state( kodi_remote_get_response( doc, id ) );
+        kodi_remote_parse_player_item( kodi_remote_get_response( doc, id + 1 ) );
+    } else if ( player < 0 ) {
+        kodi_remote_play_state = false;
+        kodi_remote_refresh_result.artist[0] = '\0';
+        kodi_remote_refresh_result.title[0] = '\0';
+    }
+
+    kodi_remote_refresh_result.changed = true;
+    kodi_remote_refresh_result.success = success;
 
-    #ifndef NATIVE_64BIT
-        vTaskDelete(NULL);
-    #endif
+    log_d("kodi_remote refresh took %d requests in %lu ms", kodi_remote_requests - requests, (unsigned long)( kodi_remote_millis() - start ) );
 }
 
 int16_t kodi_remote_get_active_player_id() {
@@ -418,145 +541,95 @@ int16_t kodi_remote_get_active_player_id() {
     return player;
 }
 
-void kodi_remote_get_active_players() {
-    SpiRamJsonDocument doc( 1000 );
-    int httpcode = kodi_remote_publish("Player.GetActivePlayers", "{}", &doc);
-    if (httpcode >= 200 && httpcode < 400) {
-        if (doc.containsKey("result")) {
-            kodi_remote_refresh_result.kodi_remote_videoplayer_id = -1;
-            kodi_remote_refresh_result.kodi_remote_audioplayer_id = -1;
-            kodi_remote_refresh_result.kodi_remote_pictureplayer_id = -1;
-
-            JsonArray players = doc["result"].as<JsonArray>();
-            for (JsonObject player : players) {
-                if (!player.containsKey("type")) continue;
-                if (strncmp(player["type"], "video", 6) == 0) kodi_remote_refresh_result.kodi_remote_videoplayer_id = player["playerid"].as<int16_t>();
-                if (strncmp(player["type"], "audio", 6) == 0) kodi_remote_refresh_result.kodi_remote_audioplayer_id = player["playerid"].as<int16_t>();
-                if (strncmp(player["type"], "picture", 8) == 0) kodi_remote_refresh_result.kodi_remote_pictureplayer_id = player["playerid"].as<int16_t>();
-            }
-        }
+static void kodi_remote_parse_players( JsonVariant response ) {
+    if ( !response.containsKey("result") ) return;
 
-        doc.clear();
-        
-        kodi_remote_refresh_result.changed = true;
-        kodi_remote_refresh_result.success = true;
-    } else {
-        doc.clear();
-        
-        kodi_remote_refresh_result.changed = true;
-        kodi_remote_refresh_result.success = false;
-    }
-}
+    kodi_remote_refresh_result.kodi_remote_videoplayer_id = -1;
+    kodi_remote_refresh_result.kodi_remote_audioplayer_id = -1;
+    kodi_remote_refresh_result.kodi_remote_pictureplayer_id = -1;
 
-void kodi_remote_get_active_player_state() {
-    int16_t player = kodi_remote_get_active_player_id();
-    if (player < 0) {
-        lv_obj_set_hidden( kodi_remote_play, false );
-        lv_obj_set_hidden( kodi_remote_pause, true );
-        kodi_remote_play_state = false;
-        return;
+    JsonArray players = response["result"].as<JsonArray>();
+    for (JsonObject player : players) {
+        if (!player.containsKey("type")) continue;
+        if (strncmp(player["type"], "video", 6) == 0) kodi_remote_refresh_result.kodi_remote_videoplayer_id = player["playerid"].as<int16_t>();
+        if (strncmp(player["type"], "audio", 6) == 0) kodi_remote_refresh_result.kodi_remote_audioplayer_id = player["playerid"].as<int16_t>();
+        if (strncmp(player["type"], "picture", 8) == 0) kodi_remote_refresh_result.kodi_remote_pictureplayer_id = player["playerid"].as<int16_t>();
     }
+}
 
-    char parameters[64];
-    snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"properties\": [\"speed\", \"partymode\"] }", player);
-
-    SpiRamJsonDocument doc( 1000 );
-    int httpcode = kodi_remote_publish("Player.GetProperties", parameters, &doc);
-    if (httpcode >= 200 && httpcode < 400) {
-        kodi_remote_app_set_indicator( ICON_INDICATOR_OK );
-
-        if ( doc.containsKey("result") ) {
-            if ( doc["result"].containsKey("speed") ) {
-                if( doc["result"]["speed"].as<uint8_t>() == 0 ) {
-                    lv_obj_set_hidden( kodi_remote_play, false );
-                    lv_obj_set_hidden( kodi_remote_pause, true );
-                    kodi_remote_play_state = false;
-                } else {
-                    lv_obj_set_hidden( kodi_remote_play, true );
-                    lv_obj_set_hidden( kodi_remote_pause, false );                
-                    kodi_remote_play_state = true;
-                }
-            }
-        }
-
-        doc.clear();
-        
-        kodi_remote_refresh_result.changed = true;
-        kodi_remote_refresh_result.success = true;
-    } else {
-        doc.clear();
+static void kodi_remote_parse_player_state( JsonVariant response ) {
+    if ( !response["result"].containsKey("speed") ) return;
 
-        kodi_remote_refresh_result.changed = true;
-        kodi_remote_refresh_result.success = false;
-    }
+    kodi_remote_play_state = response["result"]["speed"].as<int>() != 0;
 }
 
-void kodi_remote_get_active_player_item() {
-    int16_t player = kodi_remote_get_active_player_id();
-    if (player < 0) {
+static void kodi_remote_parse_player_item( JsonVariant response ) {
+    JsonVariant item = response["result"]["item"];
+    if ( item.isNull() ) {
         kodi_remote_refresh_result.artist[0] = '\0';
         kodi_remote_refresh_result.title[0] = '\0';
         return;
     }
 
-    char parameters[64];
-    snprintf(parameters, sizeof( parameters ), "{ \"playerid\": %d, \"properties\": [\"title\", \"artist\"] }", player);
-
-    SpiRamJsonDocument doc( 1000 );
-    int httpcode = kodi_remote_publish("Player.GetItem", parameters, &doc);
-    if (httpcode >= 200 && httpcode < 400) {
-        kodi_remote_app_set_indicator( ICON_INDICATOR_OK );
-
-        if ( doc.containsKey("result") ) {
-            if ( doc["result"].containsKey("item") ) {
-                if ( doc["result"]["item"].containsKey("artist") ) {
-                    if ( doc["result"]["item"]["artist"].is<JsonArray>() ) {
-                        JsonArray artists = doc["result"]["item"]["artist"].as<JsonArray>();
-
-                        uint8_t num = 0;
-                        String artistList;
-                        for (JsonVariant artist : artists) {
-                            if (num > 0) artistList += ", ";
-                            artistList += artist.as<const char*>();
-                            num++;
-                        }
-                        
-                        const char* value = artistList.c_str();
-                        for (uint8_t i = 0; i < strlen(value); i++) kodi_remote_refresh_result.artist[i] = value[i];
-                    } else {
-                        const char* value = doc["result"]["item"]["artist"].as<const char*>();
-                        for (uint8_t i = 0; i < strlen(value); i++) kodi_remote_refresh_result.artist[i] = value[i];
-                    }
-                } else {
-                    kodi_remote_refresh_result.artist[0] = '\0';
-                }
-                
-                if (doc["result"]["item"].containsKey("title")) {
-                    const char* value = doc["result"]["item"]["title"].as<const char*>();
-                    for (uint8_t i = 0; i < strlen(value); i++) kodi_remote_refresh_result.title[i] = value[i];
-                } else {
-                    kodi_remote_refresh_result.title[0] = '\0';
-                }
-            } else {
-                kodi_remote_refresh_result.artist[0] = '\0';
-                kodi_remote_refresh_result.title[0] = '\0';
-            }
+    if ( item["artist"].is<JsonArray>() ) {
+        uint8_t num = 0;
+        String artistList;
+        for (JsonVariant artist : item["artist"].as<JsonArray>()) {
+            if (num > 0) artistList += ", ";
+            artistList += artist.as<const char*>();
+            num++;
         }
-
-        doc.clear();
-        
-        kodi_remote_refresh_result.changed = true;
-        kodi_remote_refresh_result.success = true;
+        snprintf( (char*)kodi_remote_refresh_result.artist, KODI_REMOTE_INFO_SIZE, "%s", artistList.c_str() );
     } else {
-        kodi_remote_app_set_indicator( ICON_INDICATOR_FAIL );
-        doc.clear();
+        snprintf( (char*)kodi_remote_refresh_result.artist, KODI_REMOTE_INFO_SIZE, "%s", item["artist"] | "" );
+    }
+
+    snprintf( (char*)kodi_remote_refresh_result.title, KODI_REMOTE_INFO_SIZE, "%s", item["title"] | "" );
+}
 
-        kodi_remote_refresh_result.changed = true;
-        kodi_remote_refresh_result.success = false;
+static int kodi_remote_add_call( char *payload, size_t size, int len, const char* method, const char* params, uint32_t id ) {
+    if ( len < 0 || (size_t)len >= size ) return( len );
+
+    len += snprintf( payload + len, size - len, "%s{ \"jsonrpc\": \"2.0\", \"method\": \"%s\", \"params\": %s, \"id\": %lu }", len ? ", " : "", method, params, (unsigned long)id );
+    return( len );
+}
+
+static JsonVariant kodi_remote_get_response( SpiRamJsonDocument &doc, uint32_t id ) {
+    for ( JsonVariant response : doc.as<JsonArray>() ) {
+        if ( response["id"].as<uint32_t>() == id ) return( response );
+    }
+    return( JsonVariant() );
+}
+
+static bool kodi_remote_post_batch( const char *calls, int len, SpiRamJsonDocument* doc ) {
+    if ( len <= 0 || len >= KODI_REMOTE_PAYLOAD_SIZE - 2 ) {
+        log_e("kodi_remote batch exceeds %d bytes", KODI_REMOTE_PAYLOAD_SIZE );
+        return( false );
     }
+
+    char payload[KODI_REMOTE_PAYLOAD_SIZE + 2];
+    snprintf( payload, sizeof( payload ), "[%s]", calls );
+
+    int httpcode = kodi_remote_post( payload, doc );
+    return( httpcode >= 200 && httpcode < 300 && doc->is<JsonArray>() );
 }
 
 int kodi_remote_publish(const char* method, const char* params, SpiRamJsonDocument* doc) {
+    char payload[KODI_REMOTE_PAYLOAD_SIZE];
+    kodi_remote_add_call( payload, sizeof( payload ), 0, method, params, kodi_remote_refresh_result.kodi_remote_id++ );
+
+    return( kodi_remote_post( payload, doc ) );
+}
+
+#ifdef NATIVE_64BIT
+    static size_t kodi_remote_response_write( char *data, size_t size, size_t nmemb, void *userp ) {
+        String *response = (String*)userp;
+        response->append( data, size * nmemb );
+        return( size * nmemb );
+    }
+#endif
+
+static int kodi_remote_post( const char* payload, SpiRamJsonDocument* doc ) {
     int httpcode = -1;
     if (!kodi_remote_state) return httpcode;
 
@@ -566,31 +639,59 @@ int kodi_remote_publish(const char* method, const char* params, SpiRamJsonDocume
     char url[128] = "";
     snprintf( url, sizeof( url ), "http://%s:%d/jsonrpc", kodi_remote_config->host, kodi_remote_config->port );
 
+    uint64_t start = kodi_remote_millis();
+    String response;
+
 #ifdef NATIVE_64BIT
-    return( 200 );
+    // curl keeps the connection of the easy handle alive between calls
+    if ( kodi_remote_curl == NULL ) {
+        curl_global_init( CURL_GLOBAL_ALL );
+        kodi_remote_curl = curl_easy_init();
+        kodi_remote_curl_headers = curl_slist_append( NULL, "Content-Type: application/json" );
+        curl_easy_setopt( kodi_remote_curl, CURLOPT_HTTPHEADER, kodi_remote_curl_headers );
+        curl_easy_setopt( kodi_remote_curl, CURLOPT_CONNECTTIMEOUT_MS, 1000L );
+        curl_easy_setopt( kodi_remote_curl, CURLOPT_TIMEOUT_MS, 2000L );
+        curl_easy_setopt( kodi_remote_curl, CURLOPT_WRITEFUNCTION, kodi_remote_response_write );
+        curl_easy_setopt( kodi_remote_curl, CURLOPT_USERAGENT, HARDWARE_NAME "-" __FIRMWARE__ );
+    }
+    curl_easy_setopt( kodi_remote_curl, CURLOPT_URL, url );
+    curl_easy_setopt( kodi_remote_curl, CURLOPT_USERNAME, strlen( kodi_remote_config->user ) ? kodi_remote_config->user : NULL );
+    curl_easy_setopt( kodi_remote_curl, CURLOPT_PASSWORD, strlen( kodi_remote_config->user ) ? kodi_remote_config->pass : NULL );
+    curl_easy_setopt( kodi_remote_curl, CURLOPT_POSTFIELDS, payload );
+    curl_easy_setopt( kodi_remote_curl, CURLOPT_WRITEDATA, (void *)&response );
+
+    CURLcode res = curl_easy_perform( kodi_remote_curl );
+    if ( res != CURLE_OK ) {
+        log_e("kodi_remote post failed: %s", curl_easy_strerror( res ) );
+    } else {
+        long code = 0;
+        curl_easy_getinfo( kodi_remote_curl, CURLINFO_RESPONSE_CODE, &code );
+        httpcode = code;
+    }
 #else
-    char payload[256] = "";
-    snprintf( payload, sizeof( payload ), "{ \"jsonrpc\": \"2.0\", \"method\": \"%s\", \"params\": %s, \"id\": \"%d\" }", method, params, kodi_remote_refresh_result.kodi_remote_id++ );
-
-    HTTPClient publish_client;
-    publish_client.setConnectTimeout(1000);
-    publish_client.setTimeout(2000);
-    publish_client.useHTTP10( true );
-    publish_client.begin( url );
-    publish_client.addHeader("Content-Type", "application/json");
-    publish_client.setAuthorization( kodi_remote_config->user, kodi_remote_config->pass );
-    httpcode = publish_client.POST((uint8_t*)payload, strlen(payload));
-
-    if (httpcode >= 200 && httpcode < 300 && doc != NULL && doc != nullptr) {
-        DeserializationError error = deserializeJson( *(doc), publish_client.getStream() );
+    // http/1.1 with reuse keeps the connection alive between calls
+    kodi_remote_client.setReuse( true );
+    kodi_remote_client.setConnectTimeout(1000);
+    kodi_remote_client.setTimeout(2000);
+    kodi_remote_client.begin( url );
+    kodi_remote_client.addHeader("Content-Type", "application/json");
+    kodi_remote_client.setAuthorization( kodi_remote_config->user, kodi_remote_config->pass );
+    httpcode = kodi_remote_client.POST((uint8_t*)payload, strlen(payload));
+    // always drain the body, leftovers would end up in the next response on this connection
+    if (httpcode > 0) response = kodi_remote_client.getString();
+    kodi_remote_client.end();
+#endif
+
+    kodi_remote_requests++;
+    log_d("kodi_remote request %lu took %lu ms", (unsigned long)kodi_remote_requests, (unsigned long)( kodi_remote_millis() - start ) );
+
+    if (httpcode >= 200 && httpcode < 300 && doc != nullptr) {
+        DeserializationError error = deserializeJson( *(doc), response.c_str() );
         if (error) {
             log_e("kodi_remote deserializeJson() failed: %s", error.c_str() );
-            publish_client.end();
             return( -2 );
         }
     }
 
-    publish_client.end();
     return httpcode;
-#endif
-}
\ No newline at end of file
+}
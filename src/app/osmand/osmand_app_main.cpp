@@ -162,6 +162,7 @@ void osmand_app_main_setup( uint32_t tile_num ) {
     mainbar_add_tile_hibernate_cb( tile_num, osmand_hibernate_cb );
 
     gadgetbridge_register_cb( GADGETBRIDGE_JSON_MSG | GADGETBRIDGE_CONNECT | GADGETBRIDGE_DISCONNECT , osmand_bluetooth_message_event_cb, "OsmAnd main" );
+    gadgetbridge_register_json_filter( "notify", "src,title" );
     styles_register_cb( STYLE_CHANGE, osmand_style_change_event_cb, "osmand style" );
     osmand_app_main_tile_task = lv_task_create( osmand_app_main_tile_time_update_task, 1000, LV_TASK_PRIO_MID, NULL );
 }
@@ -61,6 +61,8 @@
 
     uint32_t eventmask = 0;
     const uint8_t * osm_server_json_start = osmtileserver_json;
+
+    #define osmmap_millis()         ( micros() / 1000 )
 #else
     #include <Arduino.h>
     #include <FS.h>
@@ -73,6 +75,8 @@
 
     extern const uint8_t osm_server_json_start[] asm("_binary_src_utils_osm_map_osmtileserver_json_start");
     extern const uint8_t osm_server_json_end[] asm("_binary_src_utils_osm_map_osmtileserver_json_end");
+
+    #define osmmap_millis()         millis()
 #endif
 
 lv_task_t *osmmap_main_tile_task;                               /** @brief osm active/inactive task for show/hide user interface */
@@ -111,6 +115,9 @@ static volatile bool osmmap_gps_state = false;                  /** @brief osm g
 static volatile bool osmmap_gps_on_standby_state = false;       /** @brief osm gps on standby on enter osmmap */
 static volatile bool osmmap_wifi_state = false;                 /** @brief osm wifi state on enter osmmap */
 static volatile uint64_t last_touch = 0;
+static volatile uint64_t osmmap_nav_timestamp = 0;              /** @brief time of the last pan/zoom gesture, 0 means none pending */
+static volatile bool osmmap_nav_paint_pending = false;          /** @brief the tile image for the last pan/zoom gesture is set and waits to be painted */
+static lv_design_cb_t osmmap_app_tile_img_ancestor_design = NULL;   /** @brief lv_img design function */
 osm_location_t *osmmap_location = NULL;             /** @brief osm location obj */
 osmmap_config_t osmmap_config;
 
@@ -141,6 +148,7 @@ static void zoom_out_osmmap_app_main_event_cb( lv_obj_t * obj, lv_event_t event
 static void exit_osmmap_app_main_event_cb( lv_obj_t * obj, lv_event_t event );
 static void osmmap_tile_server_event_cb( lv_obj_t * obj, lv_event_t event );
 static void layers_btn_app_main_event_cb( lv_obj_t * obj, lv_event_t event );
+static lv_design_res_t osmmap_app_tile_img_design_cb( lv_obj_t * obj, const lv_area_t * clip_area, lv_design_mode_t mode );
 void osmmap_update_map( osm_location_t *osmmap_location, double lon, double lat, uint32_t zoom );
 bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg );
 void osmmap_add_tile_server_list( lv_obj_t *layers_list );
@@ -188,6 +196,8 @@ void osmmap_app_main_setup( uint32_t tile_num ) {
     lv_obj_set_width( osmmap_app_tile_img, lv_disp_get_hor_res( NULL )>512?lv_disp_get_hor_res( NULL ):240 );
     lv_obj_set_height( osmmap_app_tile_img, lv_disp_get_hor_res( NULL )>512?lv_disp_get_hor_res( NULL ):240 );
     lv_img_set_src( osmmap_app_tile_img, osm_map_get_no_data_image() );
+    osmmap_app_tile_img_ancestor_design = lv_obj_get_design_cb( osmmap_app_tile_img );
+    lv_obj_set_design_cb( osmmap_app_tile_img, osmmap_app_tile_img_design_cb );
 #ifdef M5PAPER
     lv_img_set_zoom( osmmap_app_tile_img, 540 );
 #endif
@@ -283,7 +293,7 @@ void osmmap_app_main_setup( uint32_t tile_num ) {
     mainbar_add_tile_activate_cb( tile_num, osmmap_activate_cb );
     mainbar_add_tile_hibernate_cb( tile_num, osmmap_hibernate_cb );
     mainbar_add_tile_button_cb( tile_num, osmmap_button_cb );
-    gpsctl_register_cb( GPSCTL_SET_APP_LOCATION | GPSCTL_UPDATE_LOCATION, osmmap_gpsctl_event_cb, "osm" );
+    gpsctl_register_cb( GPSCTL_SET_APP_LOCATION | GPSCTL_UPDATE_DATA, osmmap_gpsctl_event_cb, "osm" );
     touch_register_cb( TOUCH_UPDATE , osmmap_app_touch_event_cb, "osm touch" );
 #ifdef NATIVE_64BIT
     eventmask = 0;
@@ -361,7 +371,10 @@ void osmmap_app_set_setting_menu( lv_obj_t *menu ) {
         lv_obj_set_event_cb( menu_entry, osmmap_app_get_setting_menu_cb );
         menu_entry = lv_list_add_btn( menu, osmmap_config.load_ahead ? &checked_dark_16px : &unchecked_dark_16px, "load ahead" );
         lv_obj_set_event_cb( menu_entry, osmmap_app_get_setting_menu_cb );
-        snprintf( cachestring, sizeof( cachestring ), "%dkB cached", osm_map_get_used_cache_size( osmmap_location ) / 1024 );
+        osm_map_cache_stats_t cache_stats;
+        osm_map_get_cache_stats( osmmap_location, &cache_stats );
+        uint32_t lookups = cache_stats.hits + cache_stats.misses;
+        snprintf( cachestring, sizeof( cachestring ), "%dkB cached, %d%% hits", osm_map_get_used_cache_size( osmmap_location ) / 1024, lookups ? cache_stats.hits * 100 / lookups : 0 );
         menu_entry = lv_list_add_btn( menu, NULL, cachestring );
         lv_obj_set_event_cb( menu_entry, osmmap_app_get_setting_menu_cb );
     }
@@ -469,12 +482,14 @@ bool osmmap_gpsctl_event_cb( EventBits_t event, void *arg ) {
             if ( osmmap_app_active )
                 osmmap_update_request();
             break;
-        case GPSCTL_UPDATE_LOCATION:
+        case GPSCTL_UPDATE_DATA:
             /**
              * update location and tile map image on new location
              */
-            OSMMAP_APP_LOG("get new gps coor.");
             gps_data = ( gps_data_t *)arg;
+            if ( !( gps_data->changed & GPS_DATA_LOCATION ) )
+                break;
+            OSMMAP_APP_LOG("get new gps coor.");
             osm_map_set_lon_lat( osmmap_location, gps_data->lon, gps_data->lat );
             snprintf( lonlat, sizeof( lonlat ), "%f° / %f°", gps_data->lat, gps_data->lon );
             lv_label_set_text( osmmap_lonlat_label, (const char*)lonlat );
@@ -550,6 +565,7 @@ void osmmap_load_ahead_Task( void * pvParameters ) {
          */
         vTaskDelay( 25 );
     }
+    osm_map_close_connection( osmmap_location, true );
     OSMMAP_APP_INFO_LOG("finsh osm map load ahead background task, heap: %d", ESP.getFreeHeap() );
     vTaskDelete( NULL );    
 #endif
@@ -570,6 +586,8 @@ void osmmap_update_Task( void * pvParameters ) {
                 lv_img_set_src( osmmap_app_tile_img, osm_map_get_tile_image( osmmap_location ) );
             }
             lv_obj_align( osmmap_app_tile_img, lv_obj_get_parent( osmmap_app_tile_img ), LV_ALIGN_CENTER, 0 , 0 );
+            if ( osmmap_nav_timestamp )
+                osmmap_nav_paint_pending = true;
             eventmask |= OSM_APP_LOAD_AHEAD_REQUEST;
         }
         /**
@@ -604,6 +622,8 @@ void osmmap_update_Task( void * pvParameters ) {
                     lv_img_set_src( osmmap_app_tile_img, osm_map_get_tile_image( osmmap_location ) );
                 }
                 lv_obj_align( osmmap_app_tile_img, lv_obj_get_parent( osmmap_app_tile_img ), LV_ALIGN_CENTER, 0 , 0 );
+                if ( osmmap_nav_timestamp )
+                    osmmap_nav_paint_pending = true;
                 gui_give();
                 xEventGroupSetBits( osmmap_event_handle, OSM_APP_LOAD_AHEAD_REQUEST );
             }
@@ -638,11 +658,26 @@ void osmmap_update_Task( void * pvParameters ) {
          */
         vTaskDelay( 25 );
     }
+    osm_map_close_connection( osmmap_location, false );
     OSMMAP_APP_INFO_LOG("finsh osm map tile background update task, heap: %d", ESP.getFreeHeap() );
     vTaskDelete( NULL );    
 #endif
 }
 
+/**
+ * @brief draw the tile image and log the time from the pan/zoom gesture to the first paint of the new tile
+ */
+static lv_design_res_t osmmap_app_tile_img_design_cb( lv_obj_t * obj, const lv_area_t * clip_area, lv_design_mode_t mode ) {
+    lv_design_res_t res = osmmap_app_tile_img_ancestor_design( obj, clip_area, mode );
+
+    if ( mode == LV_DESIGN_DRAW_MAIN && osmmap_nav_paint_pending ) {
+        osmmap_nav_paint_pending = false;
+        OSMMAP_APP_INFO_LOG("pan to paint: %d ms", (int)( osmmap_millis() - osmmap_nav_timestamp ) );
+        osmmap_nav_timestamp = 0;
+    }
+    return( res );
+}
+
 static void exit_osmmap_app_main_event_cb( lv_obj_t * obj, lv_event_t event ) {
     switch( event ) {
         case( LV_EVENT_CLICKED ):
@@ -687,6 +722,7 @@ static void nav_direction_osmmap_app_main_event_cb( lv_obj_t * obj, lv_event_t e
             else {
                 OSMMAP_APP_LOG("direction source unknown");
             }
+            osmmap_nav_timestamp = osmmap_millis();
             if ( osmmap_app_active )
                 osmmap_update_request();
             break;
@@ -727,6 +763,7 @@ static void nav_center_osmmap_app_main_event_cb( lv_obj_t * obj, lv_event_t even
                 OSMMAP_APP_LOG("zoom source unknown");
                 osm_map_nav_direction( osmmap_location, east );
             }
+            osmmap_nav_timestamp = osmmap_millis();
             if ( osmmap_app_active )
                 osmmap_update_request();
             break;
@@ -935,6 +972,11 @@ void osmmap_hibernate_cb( void ) {
      */
 #ifdef NATIVE_64BIT
     eventmask |= OSM_APP_TASK_EXIT_REQUEST;
+    /**
+     * no background tasks here, close the tile server connections directly
+     */
+    osm_map_close_connection( osmmap_location, false );
+    osm_map_close_connection( osmmap_location, true );
 #else
     xEventGroupSetBits( osmmap_event_handle, OSM_APP_TASK_EXIT_REQUEST );
 #endif
@@ -88,12 +88,8 @@ void printer3d_app_setup( void ) {
     printer3d_load_config();
 
     // register 2 vertical tiles and get the first tile number and save it for later use
-    #ifdef NATIVE_64BIT
-        printer3d_app_main_tile_num = mainbar_add_app_tile( 1, 1, "3d printer app" );
-    #else
-        uint8_t tiles = strlen(printer3d_config.camera) > 0 ? 2 : 1;
-        printer3d_app_main_tile_num = mainbar_add_app_tile( tiles, 1, "3d printer app" );
-    #endif
+    uint8_t tiles = strlen(printer3d_config.camera) > 0 ? 2 : 1;
+    printer3d_app_main_tile_num = mainbar_add_app_tile( tiles, 1, "3d printer app" );
     printer3d_app_setup_tile_num = mainbar_add_setup_tile( 1, 1, "3d printer app setup" );
 
     // register app icon on the app tile
@@ -26,6 +26,8 @@
 
     #define PRINTER3D_JSON_CONFIG_FILE        "/printer3d.json"
     #define PRINTER3D_MJPEG_BUFFER_SIZE       4096
+    #define PRINTER3D_MJPEG_STREAM_SIZE       262144
+    #define PRINTER3D_VIDEO_REFRESH           20
 
     typedef struct {
         char host[32] = "";
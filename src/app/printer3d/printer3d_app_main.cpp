@@ -34,12 +34,14 @@
 
 #include "hardware/powermgm.h"
 #include "hardware/wifictl.h"
+#include "utils/alloc.h"
 #include "utils/json_psram_allocator.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
     #include "utils/millis.h"
     #include <string>
+    #include <curl/curl.h>
 
     using namespace std;
     #define String string
@@ -49,18 +51,58 @@
     #include "esp_task_wdt.h"
 #endif
 
+#ifdef NATIVE_64BIT
+    #define printer3d_millis()      ( micros() / 1000 )
+#else
+    #define printer3d_millis()      millis()
+#endif
+
+/**
+ * @brief mjpeg byte source handed to the decoder as device
+ */
+typedef struct {
+    #ifdef NATIVE_64BIT
+        uint8_t *data;              /** @brief receive buffer filled by curl */
+        size_t len;                 /** @brief bytes in the receive buffer */
+        size_t pos;                 /** @brief decoder read position */
+        size_t end;                 /** @brief end of the frame to decode */
+    #else
+        WiFiClient *client;         /** @brief http stream */
+        uint8_t soi;                /** @brief start-of-image marker bytes consumed by the frame sync */
+        int32_t remaining;          /** @brief bytes left in the frame from the part header content length, -1 if unknown */
+    #endif
+    size_t frame_size;              /** @brief bytes read by the decoder for the last frame */
+} printer3d_mjpeg_stream_t;
+
 volatile bool printer3d_state = false;
 volatile bool printer3d_open_state = false;
 static uint64_t nextmillis = 0;
 
 static uint8_t* mjpeg_buffer = nullptr;
-static uint8_t* mjpeg_frame = nullptr;
+static lv_color_t* mjpeg_frame[ 2 ] = { nullptr, nullptr };
+static volatile uint8_t mjpeg_back = 0;
+static volatile bool mjpeg_ready = false;
+static uint32_t mjpeg_step = 1 << 16;
+static int32_t mjpeg_offset_x = 0;
+static int32_t mjpeg_offset_y = 0;
+static volatile uint32_t mjpeg_decoded = 0;
+static volatile uint32_t mjpeg_skipped = 0;
+static volatile uint64_t mjpeg_decode_us = 0;
+static uint32_t mjpeg_shown = 0;
+static uint64_t mjpeg_stats_millis = 0;
 static char* mjpeg_url;
+#ifdef NATIVE_64BIT
+    static CURLM *mjpeg_curl_multi = nullptr;
+    static CURL *mjpeg_curl = nullptr;
+    static JDEC *mjpeg_decoder = nullptr;
+    static printer3d_mjpeg_stream_t mjpeg_stream;
+#endif
 
 lv_obj_t *printer3d_app_main_tile = NULL;
 lv_obj_t *printer3d_app_video_tile = NULL;
 
 lv_task_t * _printer3d_app_task;
+lv_task_t * _printer3d_video_task = nullptr;
 
 lv_style_t printer3d_heading_big_style;
 lv_style_t printer3d_heading_small_style;
@@ -74,11 +116,10 @@ lv_obj_t* printer3d_extruder_label;
 lv_obj_t* printer3d_extruder_temp;
 lv_obj_t* printer3d_printbed_label;
 lv_obj_t* printer3d_printbed_temp;
-#ifndef NATIVE_64BIT
-    lv_style_t printer3d_app_video_style;
-    lv_obj_t* printer3d_video_img;
-    static lv_img_dsc_t printer3d_video;
-#endif
+lv_style_t printer3d_app_video_style;
+lv_obj_t* printer3d_video_img;
+lv_obj_t* printer3d_video_info;
+static lv_img_dsc_t printer3d_video[ 2 ];
 
 LV_IMG_DECLARE(refresh_32px);
 
@@ -102,15 +143,14 @@ void printer3d_refresh(void *parameter);
 void printer3d_send(WiFiClient client, char* buffer, const char* command);
 void printer3d_app_task( lv_task_t * task );
 void printer3d_mjpeg_init( void );
+static void printer3d_video_task( lv_task_t * task );
 
 void printer3d_app_main_setup( uint32_t tile_num ) {
 
     mainbar_add_tile_activate_cb( tile_num, printer3d_setup_activate_callback );
     mainbar_add_tile_hibernate_cb( tile_num, printer3d_setup_hibernate_callback );
     printer3d_app_main_tile = mainbar_get_tile_obj( tile_num );
-    #ifndef NATIVE_64BIT
-        printer3d_app_video_tile = mainbar_get_tile_obj( tile_num + 1 );
-    #endif
+    printer3d_app_video_tile = mainbar_get_tile_obj( tile_num + 1 );
 
     // menu buttons
     lv_obj_t * exit_btn = wf_add_exit_button( printer3d_app_main_tile, exit_printer3d_app_main_event_cb );
@@ -202,17 +242,22 @@ void printer3d_app_main_setup( uint32_t tile_num ) {
     lv_obj_align( printer3d_printbed_temp, printer3d_app_main_tile, LV_ALIGN_IN_BOTTOM_RIGHT, -10, -65 );
 
     // video img
-    #ifndef NATIVE_64BIT
-        printer3d_video_img = lv_img_create(printer3d_app_video_tile, NULL);
-        lv_style_copy(&printer3d_app_video_style, APP_ICON_STYLE );
-        lv_style_set_text_font(&printer3d_app_video_style, LV_STATE_DEFAULT, &lv_font_montserrat_32);
-        lv_obj_add_style( printer3d_video_img, LV_OBJ_PART_MAIN, &printer3d_app_video_style );
-        lv_img_set_src( printer3d_video_img, LV_SYMBOL_IMAGE );
-        lv_obj_align( printer3d_video_img, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, (RES_X_MAX / 2) - 16, (RES_Y_MAX / 2) - 16 );
-
-        lv_obj_t * video_exit_btn = wf_add_exit_button( printer3d_app_video_tile, exit_printer3d_app_main_event_cb );
-        lv_obj_align(video_exit_btn, printer3d_app_video_tile, LV_ALIGN_IN_BOTTOM_LEFT, THEME_ICON_PADDING, -THEME_ICON_PADDING );
-    #endif
+    printer3d_video_img = lv_img_create(printer3d_app_video_tile, NULL);
+    lv_style_copy(&printer3d_app_video_style, APP_ICON_STYLE );
+    lv_style_set_text_font(&printer3d_app_video_style, LV_STATE_DEFAULT, &lv_font_montserrat_32);
+    lv_obj_add_style( printer3d_video_img, LV_OBJ_PART_MAIN, &printer3d_app_video_style );
+    lv_img_set_src( printer3d_video_img, LV_SYMBOL_IMAGE );
+    lv_obj_align( printer3d_video_img, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, (RES_X_MAX / 2) - 16, (RES_Y_MAX / 2) - 16 );
+
+    // video frame rate and decode time
+    printer3d_video_info = lv_label_create( printer3d_app_video_tile, NULL);
+    lv_obj_add_style( printer3d_video_info, LV_OBJ_PART_MAIN, &printer3d_heading_small_style );
+    lv_label_set_text( printer3d_video_info, "");
+    lv_obj_align( printer3d_video_info, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, 10, 10 );
+    lv_label_set_align( printer3d_video_info, LV_LABEL_ALIGN_LEFT );
+
+    lv_obj_t * video_exit_btn = wf_add_exit_button( printer3d_app_video_tile, exit_printer3d_app_main_event_cb );
+    lv_obj_align(video_exit_btn, printer3d_app_video_tile, LV_ALIGN_IN_BOTTOM_LEFT, THEME_ICON_PADDING, -THEME_ICON_PADDING );
 
     // callbacks
     powermgm_register_cb( POWERMGM_STANDBY | POWERMGM_STANDBY_REQUEST, printer3d_powermgm_event_cb, "printer3d powermgm");
@@ -538,72 +583,224 @@ void printer3d_send(WiFiClient client, char* buffer, const char* command) {
     log_d("3dprinter received: %s", buffer);
 }
 
-#ifndef NATIVE_64BIT
-    static uint32_t printer3d_mjpeg_input(JDEC* decoder, uint8_t* buffer, uint32_t size) {
-        WiFiClient* stream = (WiFiClient*)decoder->device;
+static unsigned int printer3d_mjpeg_input( JDEC* decoder, uint8_t* buffer, unsigned int size ) {
+    printer3d_mjpeg_stream_t *stream = (printer3d_mjpeg_stream_t*)decoder->device;
+    unsigned int len = 0;
 
+    #ifdef NATIVE_64BIT
+        // read from the frame in the receive buffer
+        len = stream->end - stream->pos < size ? stream->end - stream->pos : size;
+        if ( buffer ) memcpy( buffer, stream->data + stream->pos, len );
+        stream->pos += len;
+    #else
+        // hand out the start-of-image marker already consumed by printer3d_mjpeg_sync() first
+        while ( stream->soi && len < size ) {
+            if ( buffer ) buffer[ len ] = stream->soi == 2 ? 0xFF : 0xD8;
+            stream->soi--;
+            len++;
+        }
+        // never read past the frame into the next multipart boundary
+        if ( stream->remaining >= 0 && size - len > (unsigned int)stream->remaining )
+            size = len + stream->remaining;
         // read from the image stream
-        if (buffer) {
-            return stream->readBytes(buffer, size);
-        } else {
-            char temp[size];
-            return stream->readBytes(temp, size);
+        while ( len < size ) {
+            uint8_t temp[ 64 ];
+            size_t chunk = buffer ? size - len : ( size - len < sizeof( temp ) ? size - len : sizeof( temp ) );
+            size_t read = stream->client->readBytes( buffer ? buffer + len : temp, chunk );
+            if ( !read ) break;
+            if ( stream->remaining >= 0 ) stream->remaining -= read;
+            len += read;
+        }
+    #endif
+
+    stream->frame_size += len;
+    return( len );
+}
+
+static int printer3d_mjpeg_output( JDEC* decoder, void* data, JRECT* rect ) {
+    if ( !printer3d_state || !printer3d_open_state ) return( 0 );
+
+    const uint8_t *rgb = (const uint8_t*)data;
+    const uint32_t row_width = rect->right - rect->left + 1;
+    lv_color_t *frame = mjpeg_frame[ mjpeg_back ];
+
+    /**
+     * write the partial decoded image into the display sized back buffer, source
+     * rows and columns falling onto the same display pixel as their predecessor
+     * are dropped (nearest neighbour), pixels outside the display are cropped
+     */
+    for ( uint32_t y = rect->top; y <= rect->bottom; y++, rgb += row_width * 3 ) {
+        int32_t dst_y = (int32_t)( ( y * mjpeg_step ) >> 16 ) - mjpeg_offset_y;
+        if ( dst_y < 0 || dst_y >= RES_Y_MAX ) continue;
+        if ( y && ( ( y * mjpeg_step ) >> 16 ) == ( ( ( y - 1 ) * mjpeg_step ) >> 16 ) ) continue;
+
+        lv_color_t *dst = frame + dst_y * RES_X_MAX;
+        const uint8_t *src = rgb;
+        for ( uint32_t x = rect->left; x <= rect->right; x++, src += 3 ) {
+            int32_t dst_x = (int32_t)( ( x * mjpeg_step ) >> 16 ) - mjpeg_offset_x;
+            if ( dst_x < 0 || dst_x >= RES_X_MAX ) continue;
+            if ( x && ( ( x * mjpeg_step ) >> 16 ) == ( ( ( x - 1 ) * mjpeg_step ) >> 16 ) ) continue;
+            dst[ dst_x ] = lv_color_make( src[ 0 ], src[ 1 ], src[ 2 ] );
         }
+    }
+
+    return( 1 );
+}
+
+static JRESULT printer3d_mjpeg_decode( JDEC *decoder, printer3d_mjpeg_stream_t *stream ) {
+    uint64_t start = micros();
+
+    stream->frame_size = 0;
+    JRESULT result = jd_prepare( decoder, printer3d_mjpeg_input, mjpeg_buffer, PRINTER3D_MJPEG_BUFFER_SIZE, stream );
+    if ( result != JDR_OK ) return( result );
+
+    /**
+     * let the decoder downscale by 1/2, 1/4 or 1/8 as far as the frame still
+     * covers the display, the remaining step is done in printer3d_mjpeg_output()
+     */
+    uint8_t scale = 0;
+    while ( scale < 3 && ( decoder->width >> ( scale + 1 ) ) >= RES_X_MAX && ( decoder->height >> ( scale + 1 ) ) >= RES_Y_MAX )
+        scale++;
+    uint32_t width = ( decoder->width + ( 1 << scale ) - 1 ) >> scale;
+    uint32_t height = ( decoder->height + ( 1 << scale ) - 1 ) >> scale;
+
+    // fill the display, crop the longer side centered and never upscale
+    uint32_t step_x = ( ( RES_X_MAX << 16 ) + width - 1 ) / width;
+    uint32_t step_y = ( ( RES_Y_MAX << 16 ) + height - 1 ) / height;
+    mjpeg_step = step_x > step_y ? step_x : step_y;
+    if ( mjpeg_step > ( 1 << 16 ) ) mjpeg_step = 1 << 16;
+    mjpeg_offset_x = ( (int32_t)( ( width * mjpeg_step ) >> 16 ) - RES_X_MAX ) / 2;
+    mjpeg_offset_y = ( (int32_t)( ( height * mjpeg_step ) >> 16 ) - RES_Y_MAX ) / 2;
+
+    result = jd_decomp( decoder, printer3d_mjpeg_output, scale );
+    if ( result != JDR_OK ) return( result );
+    log_d("3dprinter decoded a %dx%d video frame at 1/%d scale", decoder->width, decoder->height, 1 << scale );
+
+    // hand the back buffer over to printer3d_video_task()
+    mjpeg_decode_us += micros() - start;
+    mjpeg_decoded++;
+    mjpeg_ready = true;
+
+    return( result );
+}
+
+#ifdef NATIVE_64BIT
+    static size_t printer3d_mjpeg_write( char *data, size_t size, size_t nmemb, void *userp ) {
+        size_t len = size * nmemb;
+
+        // hold the transfer back while the receive buffer is full
+        if ( mjpeg_stream.len + len > PRINTER3D_MJPEG_STREAM_SIZE ) return( CURL_WRITEFUNC_PAUSE );
 
-        return 0;
+        memcpy( mjpeg_stream.data + mjpeg_stream.len, data, len );
+        mjpeg_stream.len += len;
+        return( len );
     }
 
-    static int32_t printer3d_mjpeg_output(JDEC* decoder, void* data, JRECT* rect) {
-        uint8_t* buffer = (uint8_t*)data;
-        const uint16_t row_width = rect->right - rect->left + 1;
-
-        // write partial decoded image into frame buffer
-        for ( uint16_t y = rect->top; y <= rect->bottom; y++ ) {
-            if (!printer3d_state || !printer3d_open_state) break;
-            if (!decoder->width || !decoder->height) break;
-            if (!mjpeg_frame) break;
-
-            // convert raw output into the corresponding color depth pixels
-            #if LV_COLOR_DEPTH == 32
-                uint8_t pixelsize = 4;
-                uint32_t offset = y * decoder->width * pixelsize + rect->left * pixelsize;
-                for ( uint32_t i = 0; i < row_width; i++ ) {
-                    mjpeg_frame[offset + 3] = 0xff;
-                    mjpeg_frame[offset + 2] = *buffer++;
-                    mjpeg_frame[offset + 1] = *buffer++;
-                    mjpeg_frame[offset + 0] = *buffer++;
-                    offset += 4;
-                }
-            #elif LV_COLOR_DEPTH == 16
-                uint8_t pixelsize = 2;
-                uint32_t offset = y * decoder->width * pixelsize + rect->left * pixelsize;
-                for ( uint32_t i = 0; i < row_width; i++ ) {
-                    uint32_t col_16bit = (*buffer++ & 0xf8) << 8;
-                    col_16bit |= (*buffer++ & 0xFC) << 3;
-                    col_16bit |= (*buffer++ >> 3);
-                    #ifdef LV_BIG_ENDIAN_SYSTEM
-                        mjpeg_frame[offset++] = col_16bit >> 8;
-                        mjpeg_frame[offset++] = col_16bit & 0xff;
-                    #else
-                        mjpeg_frame[offset++] = col_16bit & 0xff;
-                        mjpeg_frame[offset++] = col_16bit >> 8;
-                    #endif
-                }
-            #elif LV_COLOR_DEPTH == 8
-                uint8_t pixelsize = 1;
-                uint32_t offset = y * decoder->width * pixelsize + rect->left * pixelsize;
-                for ( uint32_t i = 0; i < row_width; i++ ) {
-                    uint8_t col_8bit = (*buffer++ & 0xC0);
-                    col_8bit |= (*buffer++ & 0xe0) >> 2;
-                    col_8bit |= (*buffer++ & 0xe0) >> 5;
-                    mjpeg_frame[offset++] = col_8bit;
-                }
-            #else
-                #error Unsupported LV_COLOR_DEPTH
-            #endif
+    static size_t printer3d_mjpeg_find_marker( size_t pos, uint8_t marker ) {
+        for ( ; pos + 1 < mjpeg_stream.len; pos++ ) {
+            if ( mjpeg_stream.data[ pos ] == 0xFF && mjpeg_stream.data[ pos + 1 ] == marker ) return( pos );
+        }
+        return( mjpeg_stream.len );
+    }
+
+    static void printer3d_mjpeg_close( void ) {
+        if ( mjpeg_buffer == nullptr ) return;
+
+        log_i("3dprinter closing connection to video stream at %s", mjpeg_url);
+        curl_multi_remove_handle( mjpeg_curl_multi, mjpeg_curl );
+        curl_easy_cleanup( mjpeg_curl );
+        curl_multi_cleanup( mjpeg_curl_multi );
+        curl_global_cleanup();
+
+        free( mjpeg_stream.data );
+        free( mjpeg_decoder );
+        free( mjpeg_buffer );
+        mjpeg_buffer = nullptr;
+    }
+
+    static void printer3d_mjpeg_poll( void ) {
+        int running = 0;
+        int queued = 0;
+        CURLMsg *msg;
+
+        curl_multi_perform( mjpeg_curl_multi, &running );
+        while ( ( msg = curl_multi_info_read( mjpeg_curl_multi, &queued ) ) ) {
+            if ( msg->msg != CURLMSG_DONE ) continue;
+            if ( msg->data.result != CURLE_OK ) {
+                log_w("3dprinter lost connection to video stream at %s: %s", mjpeg_url, curl_easy_strerror( msg->data.result ) );
+                printer3d_mjpeg_close();
+                return;
+            }
+            // a finished transfer is a recorded stream, play it again
+            curl_multi_remove_handle( mjpeg_curl_multi, mjpeg_curl );
+            curl_multi_add_handle( mjpeg_curl_multi, mjpeg_curl );
+        }
+
+        // find the newest complete frame, all frames before are stale
+        size_t start = 0;
+        size_t end = 0;
+        while ( true ) {
+            size_t soi = printer3d_mjpeg_find_marker( end, 0xD8 );
+            if ( soi == mjpeg_stream.len ) break;
+            size_t eoi = printer3d_mjpeg_find_marker( soi + 2, 0xD9 );
+            if ( eoi == mjpeg_stream.len ) break;
+            if ( end ) mjpeg_skipped++;
+            start = soi;
+            end = eoi + 2;
+        }
+
+        if ( !end ) {
+            if ( mjpeg_stream.len == PRINTER3D_MJPEG_STREAM_SIZE ) {
+                log_w("3dprinter video frame exceeds %d bytes", PRINTER3D_MJPEG_STREAM_SIZE );
+                mjpeg_stream.len = 0;
+                curl_easy_pause( mjpeg_curl, CURLPAUSE_CONT );
+            }
+            return;
+        }
+
+        mjpeg_stream.pos = start;
+        mjpeg_stream.end = end;
+        JRESULT result = printer3d_mjpeg_decode( mjpeg_decoder, &mjpeg_stream );
+        if ( result != JDR_OK ) log_d("3dprinter could not decode a video frame (%d)", result );
+
+        memmove( mjpeg_stream.data, mjpeg_stream.data + end, mjpeg_stream.len - end );
+        mjpeg_stream.len -= end;
+        curl_easy_pause( mjpeg_curl, CURLPAUSE_CONT );
+    }
+#else
+    static bool printer3d_mjpeg_sync( printer3d_mjpeg_stream_t *stream ) {
+        char line[ 32 ];
+        uint8_t line_len = 0;
+        int last = -1;
+
+        stream->soi = 0;
+        stream->remaining = -1;
+
+        // read up to the next start-of-image marker, picking up the content length from the part header
+        while ( printer3d_state && printer3d_open_state && stream->client->connected() ) {
+            if ( !stream->client->available() ) {
+                delay(1);
+                continue;
+            }
+
+            int c = stream->client->read();
+            if ( last == 0xFF && c == 0xD8 ) {
+                stream->soi = 2;
+                if ( stream->remaining >= 2 ) stream->remaining -= 2;
+                return( true );
+            }
+
+            if ( c == '\n' ) {
+                line[ line_len ] = '\0';
+                if ( !strncasecmp( line, "Content-Length:", 15 ) ) stream->remaining = atoi( line + 15 );
+                line_len = 0;
+            } else if ( c != '\r' && line_len < sizeof( line ) - 1 ) {
+                line[ line_len++ ] = c;
+            }
+            last = c;
         }
 
-        return 1;
+        return( false );
     }
 
     void printer3d_mjpeg_task(void *parameter) {
@@ -616,12 +813,6 @@ void printer3d_send(WiFiClient client, char* buffer, const char* command) {
         int httpcode = mjpeg_client.GET();
         if (httpcode < 200 || httpcode >= 400) {
             log_w("3dprinter could not connect to video stream at %s", mjpeg_url);
-            
-            if (mjpeg_buffer != nullptr) {
-                free(mjpeg_buffer);
-                mjpeg_buffer = nullptr;
-            }
-            vTaskDelete(NULL);
         } else {
             log_i("3dprinter connected to video stream at %s", mjpeg_url);
 
@@ -635,8 +826,11 @@ void printer3d_send(WiFiClient client, char* buffer, const char* command) {
                 delay(10);
             }
 
-            // prepare frame buffer and decoder
+            // prepare decoder
             JDEC* decoder = (JDEC*)MALLOC(sizeof(JDEC));
+            printer3d_mjpeg_stream_t mjpeg_stream;
+            mjpeg_stream.client = &stream;
+            mjpeg_stream.frame_size = 0;
             JRESULT result;
 
             uint8_t failcount = 0;
@@ -652,122 +846,150 @@ void printer3d_send(WiFiClient client, char* buffer, const char* command) {
 
                 // wait for more frames
                 if (!stream.available()) {
-                    log_d("3dprinter waiting for more data in video stream at %s", mjpeg_url);
-                    delay(100);
+                    delay(10);
                     continue;
                 }
 
-                // decode frames and notify lvgl image
-                result = jd_prepare( decoder, printer3d_mjpeg_input, mjpeg_buffer, PRINTER3D_MJPEG_BUFFER_SIZE, &(stream) );
+                // find the next frame
+                if (!printer3d_mjpeg_sync(&mjpeg_stream)) continue;
+
+                /**
+                 * decoding fell behind the stream when more than a frame is waiting in
+                 * the receive buffer or lvgl still holds the last decoded frame, skip
+                 * stale frames to show the newest one
+                 */
+                while (mjpeg_stream.frame_size && (size_t)stream.available() > mjpeg_stream.frame_size && printer3d_mjpeg_sync(&mjpeg_stream)) {
+                    mjpeg_skipped++;
+                }
+                if (mjpeg_ready) {
+                    mjpeg_skipped++;
+                    delay(1);
+                    continue;
+                }
+
+                // decode frame into the back buffer
+                result = printer3d_mjpeg_decode( decoder, &mjpeg_stream );
                 if (result == JDR_OK) {
-                    log_d("3dprinter successfully prepared a %dx%d video frame", decoder->width, decoder->height);
-
-                    // use decoded size to allocate memory
-                    bool first_frame = false;
-                    size_t mjpeg_size = decoder->width * decoder->height * LV_COLOR_DEPTH / 8;
-                    if (mjpeg_frame == nullptr) {
-                        mjpeg_frame = (uint8_t*)MALLOC(mjpeg_size);
-                        first_frame = true;
-                    }
-                    
-                    result = jd_decomp( decoder, printer3d_mjpeg_output, 0 );
-                    if (result == JDR_OK) {
-                        log_d("3dprinter successfully decoded a %dx%d video frame with %d bytes", decoder->width, decoder->height, mjpeg_size);
-
-                        printer3d_video.header.always_zero = 0;
-                        printer3d_video.header.cf = LV_IMG_CF_TRUE_COLOR;
-                        printer3d_video.header.w = decoder->width;
-                        printer3d_video.header.h = decoder->height;
-                        printer3d_video.data = mjpeg_frame;
-                        printer3d_video.data_size = mjpeg_size;
-
-                        if (first_frame) {
-                            bool landscape = decoder->width > decoder->height;
-                            uint8_t ratio = RES_Y_MAX * 100 / RES_X_MAX;
-                            uint16_t maxX = landscape ? (decoder->height * 100 / ratio) : decoder->width;
-                            uint16_t maxY = landscape ? decoder->height : (decoder->width * 100 / ratio);
-                            uint8_t zoomFactor = (landscape ? RES_Y_MAX : RES_X_MAX) * 100 / (landscape ? decoder->height : decoder->width);
-
-                            lv_obj_set_hidden( printer3d_video_img, true );
-                            lv_img_set_src( printer3d_video_img, &printer3d_video );
-                            lv_img_set_antialias( printer3d_video_img, false );
-                            lv_img_set_auto_size( printer3d_video_img, false );
-                            lv_obj_set_size( printer3d_video_img, decoder->width, decoder->height );
-                            lv_img_set_zoom( printer3d_video_img, LV_IMG_ZOOM_NONE * zoomFactor / 100 );
-                            lv_img_set_pivot( printer3d_video_img, 0, 0 );
-                            lv_img_set_offset_x( printer3d_video_img, landscape ? (maxX - decoder->width) / 2 : 0 );
-                            lv_img_set_offset_y( printer3d_video_img, landscape ? 0 : (maxY - decoder->height) / 2 );
-                            lv_obj_align( printer3d_video_img, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, 0, 0 );
-                            lv_obj_set_hidden( printer3d_video_img, false );
-                        } else {
-                            lv_obj_invalidate( printer3d_video_img );
-                        }
-                    } else {
-                        log_d("3dprinter could not decode a video frame");
-                    }
-
-                    // give the µC some time to breath after each frame
                     failcount = 0;
-                    delay(10);
-                } else if (result == JDR_FMT1 || result == JDR_FMT2 || result == JDR_FMT3) {
+                } else if (result == JDR_FMT2 || result == JDR_FMT3) {
                     // close connection after multiple wrong frames
-                    if (result == JDR_FMT2 || result == JDR_FMT3) {
-                        log_w("3dprinter received not supported format or JPEG from %s", mjpeg_url);
-                        if (failcount++ >= 3) break;
-                    } else log_d("3dprinter needs to find the next video frame");
-
-                    // try to jump to the next end-of-image 0xFFD9 marker
-                    bool found = false;
-                    while ( !found && printer3d_state && printer3d_open_state && stream.connected() ) {
-                        uint16_t available = stream.available();
-                        if (!available) {
-                            delay(1);
-                            continue;
-                        }
-
-                        for ( uint16_t i = 0; i < available; i++ ) {
-                            if (stream.read() != 0xFF) continue;
-                            if (stream.read() != 0xD9) continue;
-
-                            log_d("3dprinter found the next video frame");
-                            found = true;
-                            break;
-                        }
-                    }
+                    log_w("3dprinter received not supported format or JPEG from %s", mjpeg_url);
+                    if (failcount++ >= 3) break;
+                } else {
+                    log_d("3dprinter could not decode a video frame (%d)", result);
                 }
             }
 
-            if (mjpeg_frame != nullptr) {
-                free(mjpeg_frame);
-                mjpeg_frame = nullptr;
-            }
-
             free(decoder);
         }
 
+        mjpeg_client.end();
+
         if (mjpeg_buffer != nullptr) {
             free(mjpeg_buffer);
             mjpeg_buffer = nullptr;
         }
-
-        mjpeg_client.end();
         vTaskDelete(NULL);
     }
 #endif
 
+static void printer3d_video_task( lv_task_t * task ) {
+    #ifdef NATIVE_64BIT
+        if ( printer3d_state && printer3d_open_state && mjpeg_buffer != nullptr ) printer3d_mjpeg_poll();
+    #endif
+
+    // show the decoded frame and swap buffers
+    if ( mjpeg_ready ) {
+        lv_img_set_src( printer3d_video_img, &printer3d_video[ mjpeg_back ] );
+        lv_obj_align( printer3d_video_img, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, 0, 0 );
+        mjpeg_back ^= 1;
+        mjpeg_ready = false;
+        mjpeg_shown++;
+    }
+
+    // report achieved frame rate and decode time once a second
+    uint64_t now = printer3d_millis();
+    if ( now - mjpeg_stats_millis >= 1000 ) {
+        char val[32];
+        if ( mjpeg_decoded ) {
+            snprintf( val, sizeof( val ), "%lu fps %lu ms", (unsigned long)( mjpeg_shown * 1000 / ( now - mjpeg_stats_millis ) ), (unsigned long)( mjpeg_decode_us / mjpeg_decoded / 1000 ) );
+            log_d("3dprinter video %s, %lu frames skipped", val, (unsigned long)mjpeg_skipped );
+        } else {
+            snprintf( val, sizeof( val ), "-- fps" );
+        }
+        lv_label_set_text( printer3d_video_info, val );
+        mjpeg_shown = 0;
+        mjpeg_decoded = 0;
+        mjpeg_decode_us = 0;
+        mjpeg_skipped = 0;
+        mjpeg_stats_millis = now;
+    }
+
+    // release the frame buffers after the stream is closed
+    if ( !printer3d_state || !printer3d_open_state ) {
+        #ifdef NATIVE_64BIT
+            printer3d_mjpeg_close();
+        #endif
+        if ( mjpeg_buffer != nullptr ) return;
+
+        lv_img_set_src( printer3d_video_img, LV_SYMBOL_IMAGE );
+        lv_obj_align( printer3d_video_img, printer3d_app_video_tile, LV_ALIGN_IN_TOP_LEFT, (RES_X_MAX / 2) - 16, (RES_Y_MAX / 2) - 16 );
+        lv_label_set_text( printer3d_video_info, "" );
+        for ( uint8_t i = 0; i < 2; i++ ) {
+            lv_img_cache_invalidate_src( &printer3d_video[ i ] );
+            free( mjpeg_frame[ i ] );
+            mjpeg_frame[ i ] = nullptr;
+        }
+        mjpeg_ready = false;
+        lv_task_del( task );
+        _printer3d_video_task = nullptr;
+    }
+}
+
 void printer3d_mjpeg_init( void ) {
     if (!printer3d_state) return;
     if (!printer3d_open_state) return;
 
-    #ifdef NATIVE_64BIT
-        return;
-    #endif
-
     printer3d_config_t *printer3d_config = printer3d_get_config();
     if (mjpeg_buffer == nullptr && strlen(printer3d_config->camera) > 0) {
         mjpeg_url = printer3d_config->camera;
 
+        // display sized double buffer, the decoder writes the back buffer while lvgl shows the front buffer
+        for ( uint8_t i = 0; i < 2; i++ ) {
+            if ( mjpeg_frame[ i ] == nullptr ) {
+                mjpeg_frame[ i ] = (lv_color_t*)CALLOC_ASSERT( RES_X_MAX * RES_Y_MAX, sizeof( lv_color_t ), "3dprinter video frame calloc failed" );
+            }
+            printer3d_video[ i ].header.always_zero = 0;
+            printer3d_video[ i ].header.cf = LV_IMG_CF_TRUE_COLOR;
+            printer3d_video[ i ].header.w = RES_X_MAX;
+            printer3d_video[ i ].header.h = RES_Y_MAX;
+            printer3d_video[ i ].data = (const uint8_t*)mjpeg_frame[ i ];
+            printer3d_video[ i ].data_size = RES_X_MAX * RES_Y_MAX * sizeof( lv_color_t );
+        }
+        mjpeg_back = 0;
+        mjpeg_ready = false;
+        if ( _printer3d_video_task == nullptr ) {
+            mjpeg_stats_millis = printer3d_millis();
+            _printer3d_video_task = lv_task_create( printer3d_video_task, PRINTER3D_VIDEO_REFRESH, LV_TASK_PRIO_MID, NULL );
+        }
+
         mjpeg_buffer = (uint8_t*)malloc(PRINTER3D_MJPEG_BUFFER_SIZE);
-        xTaskCreatePinnedToCore(printer3d_mjpeg_task, "printer3d_mjpeg", 2500, NULL, 0, &printer3d_mjpeg_handle, 1);
+        #ifdef NATIVE_64BIT
+            mjpeg_decoder = (JDEC*)MALLOC_ASSERT( sizeof( JDEC ), "3dprinter video decoder malloc failed" );
+            mjpeg_stream.data = (uint8_t*)MALLOC_ASSERT( PRINTER3D_MJPEG_STREAM_SIZE, "3dprinter video stream malloc failed" );
+            mjpeg_stream.len = 0;
+
+            curl_global_init( CURL_GLOBAL_ALL );
+            mjpeg_curl = curl_easy_init();
+            curl_easy_setopt( mjpeg_curl, CURLOPT_URL, mjpeg_url );
+            curl_easy_setopt( mjpeg_curl, CURLOPT_CONNECTTIMEOUT_MS, 1000L );
+            curl_easy_setopt( mjpeg_curl, CURLOPT_WRITEFUNCTION, printer3d_mjpeg_write );
+            curl_easy_setopt( mjpeg_curl, CURLOPT_USERAGENT, HARDWARE_NAME "-" __FIRMWARE__ );
+            mjpeg_curl_multi = curl_multi_init();
+            curl_multi_add_handle( mjpeg_curl_multi, mjpeg_curl );
+            log_i("3dprinter connecting to video stream at %s", mjpeg_url);
+        #else
+            xTaskCreatePinnedToCore(printer3d_mjpeg_task, "printer3d_mjpeg", 2500, NULL, 0, &printer3d_mjpeg_handle, 1);
+        #endif
     }
-}
\ No newline at end of file
+}
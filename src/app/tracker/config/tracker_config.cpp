@@ -32,6 +32,7 @@ bool tracker_config_t::onSave(JsonDocument& doc) {
     doc["vibe_on_fix"] = vibe_on_fix;
     doc["piep_on_fix"] = piep_on_fix;
     doc["storage"] = storage;
+    doc["simplify"] = simplify;
     return true;
 }
 
@@ -43,6 +44,7 @@ bool tracker_config_t::onLoad(JsonDocument& doc) {
     vibe_on_fix = doc["vibe_on_fix"] | false;
     piep_on_fix = doc["piep_on_fix"] | false;
     strncpy( storage, doc["storage"] | "/spiffs", sizeof( storage ) );
+    simplify = doc["simplify"] | 1.0f;
     return true;
 }
 
@@ -54,5 +56,6 @@ bool tracker_config_t::onDefault( void ) {
     vibe_on_fix = false;
     piep_on_fix = false;
     strncpy( storage, "/spiffs", sizeof( storage ) );
+    simplify = 1.0f;
     return true;
 }
\ No newline at end of file
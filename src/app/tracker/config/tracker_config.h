@@ -39,6 +39,7 @@
         bool vibe_on_fix = true;            /** @brief vibe when fix */
         bool piep_on_fix = true;            /** @brief piep when fix */
         char storage[32] = "/spiffs";      /** @brief file storage prefix */
+        float simplify = 1.0f;              /** @brief gpx export simplification tolerance in meter, 0 exports all points */
 
         protected:
         ////////////// Available for overloading: //////////////
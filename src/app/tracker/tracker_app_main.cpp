@@ -27,6 +27,7 @@
 #include "tracker_app.h"
 #include "tracker_app_main.h"
 #include "tracker_app_view.h"
+#include "tracker_recorder.h"
 #include "config/tracker_config.h"
 
 #include "gui/mainbar/mainbar.h"
@@ -122,7 +123,7 @@ void tracker_app_main_setup( uint32_t tile ) {
     lv_obj_set_style_local_text_font(tracker_info_label, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, &Ubuntu_32px );
     tracker_file_info_label = wf_add_label( mainbar_get_tile_obj( tile ), "", APP_ICON_LABEL_STYLE );
 
-    gpsctl_register_cb( GPSCTL_FIX | GPSCTL_NOFIX | GPSCTL_DISABLE | GPSCTL_ENABLE | GPSCTL_UPDATE_LOCATION | GPSCTL_UPDATE_ALTITUDE | GPSCTL_UPDATE_SOURCE | GPSCTL_UPDATE_SPEED | GPSCTL_UPDATE_SATELLITE, tracker_app_main_gps_event_cb, "tracker gps" );
+    gpsctl_register_cb( GPSCTL_FIX | GPSCTL_NOFIX | GPSCTL_DISABLE | GPSCTL_ENABLE | GPSCTL_UPDATE_DATA, tracker_app_main_gps_event_cb, "tracker gps" );
     mainbar_add_tile_activate_cb( tile, tracker_app_main_activate_cb );
     mainbar_add_tile_hibernate_cb( tile, tracker_app_main_hibernate_cb );
     mainbar_add_tile_button_cb( tile, tracker_app_main_button_cb );
@@ -226,13 +227,17 @@ static bool tracker_app_main_gps_event_cb( EventBits_t event, void *arg ) {
             counter = 0;
             break;
         case GPSCTL_DISABLE:
+            if( tracker_logging_state )
+                tracker_app_main_logging( false, NULL );
             tracker_logging_gps_state = false;
             tracker_logging_state = false;
             lv_obj_set_style_local_line_color( tracker_progress_arc, LV_ARC_PART_INDIC, LV_STATE_DEFAULT, LV_COLOR_RED );
             lv_arc_set_end_angle( tracker_progress_arc, 0 );
             counter = 0;
             break;
-        case GPSCTL_UPDATE_LOCATION:
+        case GPSCTL_UPDATE_DATA:
+            if( !( gps_data->changed & GPS_DATA_LOCATION ) )
+                break;
             if( tracker_logging_gps_state && tracker_logging_state ) {
                 /**
                  * calc distance between current gps pos and last gpx pos and avoid large distance jumps
@@ -255,14 +260,6 @@ static bool tracker_app_main_gps_event_cb( EventBits_t event, void *arg ) {
             }
             memcpy( tracker_gps_data, gps_data, sizeof( gps_data_t ) );
             break;
-        case GPSCTL_UPDATE_ALTITUDE:
-            break;
-        case GPSCTL_UPDATE_SOURCE:
-            break;
-        case GPSCTL_UPDATE_SPEED:
-            break;
-        case GPSCTL_UPDATE_SATELLITE:
-            break;
         default:
             break;
     }
@@ -279,103 +276,56 @@ static bool tracker_app_main_gps_event_cb( EventBits_t event, void *arg ) {
  */
 const char *tracker_app_main_logging( bool start, gps_data_t *gps_data ) {
     static bool logging = false;        /** @brief logging state variable, true for loggings active **/
-    static char *filename = NULL;       /** @brief current full file name, if NULL no action **/
-    static size_t size = 0;             /** @brief file size write counter **/
-    
-    FILE *fp;
+    tracker_recorder_stats_t stats;
     time_t now;
-    struct tm info;
     time( &now );
-    localtime_r( &now, &info );
 
     if( start ) {
         if( !logging ) {
-            if( filename )
-                return( "error" );
-            filename = (char*)MALLOC_ASSERT( 256, "malloc failed" );
+            char filename[ 256 ] = "";
+            struct tm info;
+            localtime_r( &now, &info );
             /**
              * gen filename with timestamp and add storage prefix
              */
             char temp_filename[ 128 ];
-            strftime( temp_filename, 128, GPX_LOGFILE, &info );
+            strftime( temp_filename, 128, TRACKER_LOGFILE, &info );
             char prefix_filename[ 128 ] = "";
             strncat( prefix_filename, tracker_config.storage, sizeof( prefix_filename ) );
             strncat( prefix_filename, temp_filename, sizeof( prefix_filename ) );
             /**
-             * convert filename to local filename
-             */
-            filepath_convert( filename, 256, prefix_filename );
-            /**
-             * create file
+             * convert filename to local filename and create the track file
              */
-            fp = fopen( filename, "w+" );
-            if( fp ) {
-                /**
-                 * write gpx file header ...
-                 */
-                size_t size = 0;
-                size += fprintf( fp, GPX_HEADER );
-                size += fprintf( fp, GPX_START );
-                size += fprintf( fp, GPX_METADATA );
-                size += fprintf( fp, GPX_TRACK_START );
-                size += fprintf( fp, GPX_TRACK_SEGMENT_START );
-                fclose( fp );
-                logging = true;
-                wf_label_printf( tracker_file_info_label, mainbar_get_tile_obj( tracker_app_get_app_main_tile_num() ), LV_ALIGN_IN_BOTTOM_MID, 0, -THEME_PADDING, "%d bytes writen", size );
-            }
-            else {
-                free( filename );
-                filename = NULL;
-                logging = false;
-                size = 0;
-            }
+            filepath_convert( filename, sizeof( filename ), prefix_filename );
+            logging = tracker_recorder_start( filename );
         }
         else {
             if( !gps_data )
                 return( "error" );
             /**
-             * open file for append
+             * add tracking point, the recorder writes it with the next full block
              */
-            fp = fopen( filename, "at" );
-            if( fp ) {
-                /**
-                 * write tracking pointer
-                 */
-                char timestamp[ 128 ];
-                strftime( timestamp, 128, GPX_TRACK_SEGMENT_POINT_TIME_SRF, &info );
-                size += fprintf( fp, GPX_TRACK_SEGMENT_POINT_START, gps_data->lat, gps_data->lon );
-                size += fprintf( fp, GPX_TRACK_SEGMENT_POINT_ELE, gps_data->altitude_meters );
-                size += fprintf( fp, GPX_TRACK_SEGMENT_POINT_TIME, timestamp );
-                size += fprintf( fp, GPX_TRACK_SEGMENT_POINT_END );
-                fclose( fp );
-                wf_label_printf( tracker_file_info_label, mainbar_get_tile_obj( tracker_app_get_app_main_tile_num() ), LV_ALIGN_IN_BOTTOM_MID, 0, -THEME_PADDING, "%d bytes writen", size );
-            }
-            else {
-                free( filename );
-                filename = NULL;
-                logging = false;
-                size = 0;
-            }
+            tracker_recorder_add( gps_data->lat, gps_data->lon, gps_data->altitude_meters, now );
         }
     }
-    else {
-        fp = fopen( filename, "at" );
-        if( fp ) {
-            /**
-             * close file
-             */
-            size += fprintf( fp, GPX_TRACK_SEGMENT_END );
-            size += fprintf( fp, GPX_TRACK_END );
-            size += fprintf( fp, GPX_END );
-            fclose( fp );
-            wf_label_printf( tracker_file_info_label, mainbar_get_tile_obj( tracker_app_get_app_main_tile_num() ), LV_ALIGN_IN_BOTTOM_MID, 0, -THEME_PADDING, "%d bytes writen", size );
+    else if( logging ) {
+        /**
+         * write pending points and export the track next to the track file
+         */
+        char gpx_filename[ 256 ] = "";
+        tracker_recorder_stop();
+        strncpy( gpx_filename, tracker_recorder_get_filename(), sizeof( gpx_filename ) - 1 );
+        char *ext = strrchr( gpx_filename, '.' );
+        if( ext && ext + sizeof( ".gpx" ) <= gpx_filename + sizeof( gpx_filename ) ) {
+            strcpy( ext, ".gpx" );
+            tracker_recorder_export_file( tracker_recorder_get_filename(), gpx_filename, TRACKER_EXPORT_GPX, tracker_config.simplify );
         }
-        free( filename );
-        filename = NULL;
         logging = false;
-        size = 0;
     }
-    return( filename ? filename : "" );
+    tracker_recorder_get_stats( &stats );
+    wf_label_printf( tracker_file_info_label, mainbar_get_tile_obj( tracker_app_get_app_main_tile_num() ), LV_ALIGN_IN_BOTTOM_MID, 0, -THEME_PADDING, "%d bytes writen", stats.bytes );
+
+    return( logging ? tracker_recorder_get_filename() : "" );
 }
 /**
  * @brief event call back function when the setup button was clicked
@@ -413,6 +363,7 @@ static void tracker_app_main_enter_location_cb( lv_obj_t * obj, lv_event_t event
                 }
                 else {
                     tracker_logging_state = false;
+                    tracker_app_main_logging( false, NULL );
                     gpsctl_off();
                     sdcard_block_unmounting( false );
                     gpsctl_set_enable_on_standby( tracker_gps_on_standby_state );
@@ -469,7 +420,7 @@ static void tracker_app_main_enter_trash_cb( lv_obj_t * obj, lv_event_t event )
             if( d ) {
                 int file_count = 0;
                 while( ( dir = readdir( d ) ) != NULL ) {
-                    if( strstr( dir->d_name, ".gpx" ) ) {
+                    if( strstr( dir->d_name, ".gpx" ) || strstr( dir->d_name, ".trk" ) ) {
                         char filename[ 256 ] = "";
                         snprintf( path, sizeof( path ), "%s/%s", tracker_config.storage, dir->d_name );
                         filepath_convert( filename, sizeof( filename ), path );
@@ -26,6 +26,7 @@
 #include "tracker_app.h"
 #include "tracker_app_main.h"
 #include "tracker_app_view.h"
+#include "tracker_downsample.h"
 #include "config/tracker_config.h"
 
 #include "gui/mainbar/mainbar.h"
@@ -35,13 +36,13 @@
 #include "gui/widget_factory.h"
 
 #include "hardware/gpsctl.h"
+
+#include "utils/alloc.h"
 /**
  * local vaiables
  */
-lv_coord_t tracker_speed_min = -1;
-lv_coord_t tracker_speed_max = -1;
-lv_coord_t tracker_altitude_min = -1;
-lv_coord_t tracker_altitude_max = -1;
+static tracker_summary_t *tracker_speed_summary = NULL;         /** @brief min/max summary of the whole session speed */
+static tracker_summary_t *tracker_altitude_summary = NULL;      /** @brief min/max summary of the whole session altitude */
 /**
  * local lv obj 
  */
@@ -57,6 +58,7 @@ lv_chart_series_t *tracker_altitude_series = NULL;
  * 
  */
 static bool tracker_app_view_button_cb( EventBits_t event, void *arg );
+static uint32_t tracker_app_view_update_chart( lv_obj_t *chart, lv_chart_series_t *series, tracker_summary_t *summary, int32_t sample );
 /**
  * 
  */
@@ -92,6 +94,13 @@ void tracker_app_view_setup( uint32_t tile ) {
 
     tracker_speed_series = lv_chart_add_series( tracker_speed_chart, LV_COLOR_GREEN );
     tracker_altitude_series = lv_chart_add_series( tracker_altitude_chart, LV_COLOR_BLUE );
+    /**
+     * each summary bucket is shown as min and max point
+     */
+    tracker_speed_summary = (tracker_summary_t *)MALLOC_ASSERT( sizeof( tracker_summary_t ), "tracker speed summary alloc failed" );
+    tracker_altitude_summary = (tracker_summary_t *)MALLOC_ASSERT( sizeof( tracker_summary_t ), "tracker altitude summary alloc failed" );
+    tracker_summary_init( tracker_speed_summary, lv_chart_get_point_count( tracker_speed_chart ) / 2 );
+    tracker_summary_init( tracker_altitude_summary, lv_chart_get_point_count( tracker_altitude_chart ) / 2 );
 
     lv_obj_t *tracker_speed_label = wf_add_label( mainbar_get_tile_obj( tile ), "speed", APP_ICON_LABEL_STYLE );
     lv_obj_align( tracker_speed_label, tracker_speed_chart, LV_ALIGN_IN_TOP_LEFT, THEME_PADDING * 2, THEME_PADDING  * 2);
@@ -136,45 +145,54 @@ static bool tracker_app_view_button_cb( EventBits_t event, void *arg ) {
     return( true );
 }
 
-void tracker_app_view_add_data( gps_data_t *gps_data ) {
-    lv_chart_set_next( tracker_speed_chart, tracker_speed_series, gps_data->speed_kmh );
-    lv_chart_set_next( tracker_altitude_chart, tracker_altitude_series, gps_data->altitude_meters );
-
-    lv_coord_t speed = gps_data->speed_kmh;
-    lv_coord_t altitude = gps_data->altitude_meters;
-
-    if( tracker_speed_min == -1 && tracker_speed_max == -1 ) {
-        tracker_speed_min = tracker_speed_max = speed;
+/**
+ * @brief add a sample to a summary and update only the chart points that changed
+ *
+ * @param chart         pointer to the chart
+ * @param series        pointer to the chart series
+ * @param summary       pointer to the summary
+ * @param sample        new sample
+ * @return uint32_t     TRACKER_SUMMARY_* mask
+ */
+static uint32_t tracker_app_view_update_chart( lv_obj_t *chart, lv_chart_series_t *series, tracker_summary_t *summary, int32_t sample ) {
+    uint32_t changed = tracker_summary_add( summary, sample );
+    uint32_t first_bucket = ( changed & TRACKER_SUMMARY_MERGED ) ? 0 : summary->buckets - 1;
+    int32_t first, second;
+    /**
+     * after a merge all buckets moved, otherwise only the last bucket changed
+     */
+    for( uint32_t bucket = first_bucket ; bucket < summary->buckets ; bucket++ ) {
+        tracker_summary_get( summary, bucket, &first, &second );
+        lv_chart_set_point_id( chart, series, first, bucket * 2 );
+        lv_chart_set_point_id( chart, series, second, bucket * 2 + 1 );
+    }
+    if ( changed & TRACKER_SUMMARY_MERGED ) {
+        for( uint32_t point = summary->buckets * 2 ; point < lv_chart_get_point_count( chart ) ; point++ ) {
+            lv_chart_set_point_id( chart, series, LV_CHART_POINT_DEF, point );
+        }
     }
-    else {
-        if( speed > tracker_speed_max )
-            tracker_speed_max = speed;
-        else if( speed < tracker_speed_min )
-            tracker_speed_min = speed;
-        lv_chart_set_y_range( tracker_speed_chart, lv_chart_get_series_axis( tracker_speed_chart, tracker_speed_series ), tracker_speed_min, tracker_speed_max );
-        wf_label_printf( tracker_speed_min_label, tracker_speed_chart, LV_ALIGN_IN_BOTTOM_RIGHT, -THEME_PADDING * 2, -THEME_PADDING  * 2, "%dkm/h", tracker_speed_min );
-        wf_label_printf( tracker_speed_max_label, tracker_speed_chart, LV_ALIGN_IN_TOP_RIGHT, -THEME_PADDING * 2, THEME_PADDING  * 2, "%dkm/h", tracker_speed_max );
+    if ( ( changed & TRACKER_SUMMARY_RANGE ) && summary->max > summary->min ) {
+        lv_chart_set_y_range( chart, lv_chart_get_series_axis( chart, series ), summary->min, summary->max );
     }
+    lv_chart_refresh( chart );
 
-    if( tracker_altitude_min == -1 && tracker_altitude_max == -1 ) {
-        tracker_altitude_min = tracker_altitude_max = altitude;
+    return( changed );
+}
+
+void tracker_app_view_add_data( gps_data_t *gps_data ) {
+    if( tracker_app_view_update_chart( tracker_speed_chart, tracker_speed_series, tracker_speed_summary, gps_data->speed_kmh ) & TRACKER_SUMMARY_RANGE ) {
+        wf_label_printf( tracker_speed_min_label, tracker_speed_chart, LV_ALIGN_IN_BOTTOM_RIGHT, -THEME_PADDING * 2, -THEME_PADDING  * 2, "%dkm/h", tracker_speed_summary->min );
+        wf_label_printf( tracker_speed_max_label, tracker_speed_chart, LV_ALIGN_IN_TOP_RIGHT, -THEME_PADDING * 2, THEME_PADDING  * 2, "%dkm/h", tracker_speed_summary->max );
     }
-    else {
-        if( altitude > tracker_altitude_max )
-            tracker_altitude_max = altitude;
-        else if( altitude < tracker_altitude_min )
-            tracker_altitude_min = altitude;
-        lv_chart_set_y_range( tracker_altitude_chart, lv_chart_get_series_axis( tracker_altitude_chart, tracker_altitude_series ), tracker_altitude_min, tracker_altitude_max );
-        wf_label_printf( tracker_altitude_min_label, tracker_altitude_chart, LV_ALIGN_IN_BOTTOM_RIGHT, -THEME_PADDING * 2, -THEME_PADDING  * 2, "%dm", tracker_altitude_min );
-        wf_label_printf( tracker_altitude_max_label, tracker_altitude_chart, LV_ALIGN_IN_TOP_RIGHT, -THEME_PADDING * 2, THEME_PADDING  * 2, "%dm", tracker_altitude_max );
+    if( tracker_app_view_update_chart( tracker_altitude_chart, tracker_altitude_series, tracker_altitude_summary, gps_data->altitude_meters ) & TRACKER_SUMMARY_RANGE ) {
+        wf_label_printf( tracker_altitude_min_label, tracker_altitude_chart, LV_ALIGN_IN_BOTTOM_RIGHT, -THEME_PADDING * 2, -THEME_PADDING  * 2, "%dm", tracker_altitude_summary->min );
+        wf_label_printf( tracker_altitude_max_label, tracker_altitude_chart, LV_ALIGN_IN_TOP_RIGHT, -THEME_PADDING * 2, THEME_PADDING  * 2, "%dm", tracker_altitude_summary->max );
     }
 }
 
 void tracker_app_view_clean_data( void ) {
     lv_chart_clear_series( tracker_speed_chart, tracker_speed_series );
     lv_chart_clear_series( tracker_altitude_chart, tracker_altitude_series );
-    tracker_speed_min = -1;
-    tracker_speed_max = -1;
-    tracker_altitude_min = -1;
-    tracker_altitude_max = -1;
+    tracker_summary_init( tracker_speed_summary, lv_chart_get_point_count( tracker_speed_chart ) / 2 );
+    tracker_summary_init( tracker_altitude_summary, lv_chart_get_point_count( tracker_altitude_chart ) / 2 );
 }
\ No newline at end of file
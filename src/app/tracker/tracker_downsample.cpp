@@ -0,0 +1,199 @@
+/****************************************************************************
+ *   Oct 17 21:05:37 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+#include <math.h>
+
+#include "tracker_downsample.h"
+
+#define TRACKER_METER_PER_DEGREE        111320.0        /** @brief meter per degree latitude */
+
+void tracker_summary_init( tracker_summary_t *summary, uint32_t capacity ) {
+    memset( summary, 0, sizeof( tracker_summary_t ) );
+
+    if ( capacity > TRACKER_SUMMARY_BUCKETS ) {
+        capacity = TRACKER_SUMMARY_BUCKETS;
+    }
+    summary->capacity = capacity < 2 ? 2 : capacity & ~1;
+    summary->width = 1;
+}
+
+uint32_t tracker_summary_add( tracker_summary_t *summary, int32_t sample ) {
+    uint32_t changed = TRACKER_SUMMARY_BUCKET;
+    tracker_bucket_t *bucket;
+    /**
+     * track the overall range
+     */
+    if ( !summary->samples || sample < summary->min || sample > summary->max ) {
+        if ( !summary->samples || sample < summary->min ) {
+            summary->min = sample;
+        }
+        if ( !summary->samples || sample > summary->max ) {
+            summary->max = sample;
+        }
+        changed |= TRACKER_SUMMARY_RANGE;
+    }
+    summary->samples++;
+    /**
+     * add to the last bucket until it has width samples
+     */
+    if ( summary->buckets && summary->fill < summary->width ) {
+        bucket = &summary->bucket[ summary->buckets - 1 ];
+        if ( sample < bucket->min ) {
+            bucket->min = sample;
+            bucket->max_first = true;
+        }
+        if ( sample > bucket->max ) {
+            bucket->max = sample;
+            bucket->max_first = false;
+        }
+        summary->fill++;
+        return( changed );
+    }
+    /**
+     * summary full, merge pairs of buckets and double the width
+     */
+    if ( summary->buckets == summary->capacity ) {
+        for( uint32_t i = 0 ; i < summary->capacity / 2 ; i++ ) {
+            tracker_bucket_t *a = &summary->bucket[ i * 2 ];
+            tracker_bucket_t *b = &summary->bucket[ i * 2 + 1 ];
+            tracker_bucket_t merged;
+            bool min_from_a = a->min <= b->min;
+            bool max_from_a = a->max >= b->max;
+
+            merged.min = min_from_a ? a->min : b->min;
+            merged.max = max_from_a ? a->max : b->max;
+            if ( min_from_a == max_from_a ) {
+                merged.max_first = min_from_a ? a->max_first : b->max_first;
+            }
+            else {
+                merged.max_first = max_from_a;
+            }
+            summary->bucket[ i ] = merged;
+        }
+        summary->buckets = summary->capacity / 2;
+        summary->width *= 2;
+        changed |= TRACKER_SUMMARY_MERGED;
+    }
+    bucket = &summary->bucket[ summary->buckets++ ];
+    bucket->min = sample;
+    bucket->max = sample;
+    bucket->max_first = false;
+    summary->fill = 1;
+
+    return( changed );
+}
+
+void tracker_summary_get( tracker_summary_t *summary, uint32_t bucket, int32_t *first, int32_t *second ) {
+    tracker_bucket_t *b = &summary->bucket[ bucket ];
+
+    *first = b->max_first ? b->max : b->min;
+    *second = b->max_first ? b->min : b->max;
+}
+
+uint32_t tracker_simplify( const double *lat, const double *lon, uint32_t count, double tolerance, bool *keep ) {
+    uint16_t stack[ 64 ][ 2 ];
+    uint32_t sp = 0;
+    uint32_t kept = 0;
+
+    if ( count == 0 ) {
+        return( 0 );
+    }
+    /**
+     * keep everything for short paths or without tolerance
+     */
+    for( uint32_t i = 0 ; i < count ; i++ ) {
+        keep[ i ] = ( count < 3 || tolerance <= 0 );
+    }
+    keep[ 0 ] = true;
+    keep[ count - 1 ] = true;
+    if ( count < 3 || tolerance <= 0 ) {
+        return( count );
+    }
+    /**
+     * project into a local plane in meter, good enough for the few km of a track segment
+     */
+    double lon_scale = cos( lat[ 0 ] * M_PI / 180.0 ) * TRACKER_METER_PER_DEGREE;
+
+    stack[ sp ][ 0 ] = 0;
+    stack[ sp ][ 1 ] = count - 1;
+    sp++;
+
+    while( sp ) {
+        sp--;
+        uint32_t first = stack[ sp ][ 0 ];
+        uint32_t last = stack[ sp ][ 1 ];
+        double ax = lon[ first ] * lon_scale;
+        double ay = lat[ first ] * TRACKER_METER_PER_DEGREE;
+        double dx = lon[ last ] * lon_scale - ax;
+        double dy = lat[ last ] * TRACKER_METER_PER_DEGREE - ay;
+        double len2 = dx * dx + dy * dy;
+        double max_dist = 0;
+        uint32_t max_index = first;
+        /**
+         * find the point with the largest distance to the segment first/last
+         */
+        for( uint32_t i = first + 1 ; i < last ; i++ ) {
+            double px = lon[ i ] * lon_scale - ax;
+            double py = lat[ i ] * TRACKER_METER_PER_DEGREE - ay;
+            double dist;
+
+            if ( len2 > 0 ) {
+                double t = ( px * dx + py * dy ) / len2;
+                t = t < 0 ? 0 : ( t > 1 ? 1 : t );
+                dist = hypot( px - t * dx, py - t * dy );
+            }
+            else {
+                dist = hypot( px, py );
+            }
+            if ( dist > max_dist ) {
+                max_dist = dist;
+                max_index = i;
+            }
+        }
+        /**
+         * split at the farthest point if it is out of tolerance
+         */
+        if ( max_dist > tolerance ) {
+            keep[ max_index ] = true;
+            if ( sp + 2 > sizeof( stack ) / sizeof( stack[ 0 ] ) ) {
+                /**
+                 * stack exhausted, keep the rest of this segment
+                 */
+                for( uint32_t i = first + 1 ; i < last ; i++ ) {
+                    keep[ i ] = true;
+                }
+                continue;
+            }
+            stack[ sp ][ 0 ] = first;
+            stack[ sp ][ 1 ] = max_index;
+            sp++;
+            stack[ sp ][ 0 ] = max_index;
+            stack[ sp ][ 1 ] = last;
+            sp++;
+        }
+    }
+
+    for( uint32_t i = 0 ; i < count ; i++ ) {
+        kept += keep[ i ] ? 1 : 0;
+    }
+    return( kept );
+}
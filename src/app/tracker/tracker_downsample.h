@@ -0,0 +1,93 @@
+/****************************************************************************
+ *   Oct 17 21:05:37 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TRACKER_DOWNSAMPLE_H
+    #define _TRACKER_DOWNSAMPLE_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+
+    #define TRACKER_SUMMARY_BUCKETS             128             /** @brief max buckets per summary */
+
+    #define TRACKER_SUMMARY_BUCKET              0x01            /** @brief last bucket changed */
+    #define TRACKER_SUMMARY_MERGED              0x02            /** @brief all buckets changed */
+    #define TRACKER_SUMMARY_RANGE               0x04            /** @brief overall min/max changed */
+    /**
+     * @brief one bucket, min and max in the order they occured
+     */
+    typedef struct {
+        int32_t min;                                    /** @brief smallest sample */
+        int32_t max;                                    /** @brief largest sample */
+        bool max_first;                                 /** @brief true if the max was seen before the min */
+    } tracker_bucket_t;
+    /**
+     * @brief fixed size min/max summary of a whole sample stream, buckets
+     * are merged pairwise and double their width when the summary is full
+     */
+    typedef struct {
+        tracker_bucket_t bucket[ TRACKER_SUMMARY_BUCKETS ];
+        uint32_t capacity;                              /** @brief usable buckets, even and <= TRACKER_SUMMARY_BUCKETS */
+        uint32_t buckets;                               /** @brief used buckets */
+        uint32_t width;                                 /** @brief samples per bucket */
+        uint32_t fill;                                  /** @brief samples in the last bucket */
+        uint32_t samples;                               /** @brief samples since init */
+        int32_t min;                                    /** @brief overall min */
+        int32_t max;                                    /** @brief overall max */
+    } tracker_summary_t;
+    /**
+     * @brief reset a summary
+     *
+     * @param   summary     pointer to the summary
+     * @param   capacity    number of buckets, two chart points per bucket
+     */
+    void tracker_summary_init( tracker_summary_t *summary, uint32_t capacity );
+    /**
+     * @brief add a sample in constant time, amortized over the merges
+     *
+     * @param   summary     pointer to the summary
+     * @param   sample      sample value
+     *
+     * @return  TRACKER_SUMMARY_* mask
+     */
+    uint32_t tracker_summary_add( tracker_summary_t *summary, int32_t sample );
+    /**
+     * @brief get the two chart points of a bucket in time order
+     *
+     * @param   summary     pointer to the summary
+     * @param   bucket      bucket number
+     * @param   first       pointer to the first point
+     * @param   second      pointer to the second point
+     */
+    void tracker_summary_get( tracker_summary_t *summary, uint32_t bucket, int32_t *first, int32_t *second );
+    /**
+     * @brief Douglas-Peucker simplification of a path
+     *
+     * @param   lat         latitude in degree
+     * @param   lon         longitude in degree
+     * @param   count       number of points
+     * @param   tolerance   max distance in meter between the path and the simplified path
+     * @param   keep        true for each point that is kept
+     *
+     * @return  number of kept points
+     */
+    uint32_t tracker_simplify( const double *lat, const double *lon, uint32_t count, double tolerance, bool *keep );
+
+#endif // _TRACKER_DOWNSAMPLE_H
@@ -0,0 +1,428 @@
+/****************************************************************************
+ *   Oct 17 18:42:10 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "tracker_recorder.h"
+#include "tracker_downsample.h"
+#include "utils/alloc.h"
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+#endif
+
+enum {
+    TRACKER_EXPORT_HEADER = 0,
+    TRACKER_EXPORT_POINTS,
+    TRACKER_EXPORT_FOOTER,
+    TRACKER_EXPORT_DONE
+};
+
+static tracker_trk_block_t *tracker_ring = NULL;            /** @brief block ring, NULL if not recording */
+static uint32_t tracker_ring_head = 0;                      /** @brief block currently filled */
+static uint32_t tracker_ring_full = 0;                      /** @brief full blocks waiting in front of the head */
+static uint16_t tracker_seq = 0;                            /** @brief next block sequence number */
+static int32_t tracker_last_lat = 0;                        /** @brief last point latitude in 1e-6 degree */
+static int32_t tracker_last_lon = 0;                        /** @brief last point longitude in 1e-6 degree */
+static int32_t tracker_last_ele = 0;                        /** @brief last point elevation in decimeter */
+static uint32_t tracker_last_time = 0;                      /** @brief last point utc time */
+static char tracker_filename[ 256 ] = "";                   /** @brief current or last track file */
+static tracker_recorder_stats_t tracker_stats;              /** @brief current or last track statistics */
+
+static uint32_t tracker_crc32( const uint8_t *data, size_t len );
+static void tracker_block_seal( tracker_trk_block_t *block );
+static bool tracker_block_valid( tracker_trk_block_t *block );
+static void tracker_recorder_flush( bool partial );
+static void tracker_export_resync( tracker_export_t *exporter );
+
+bool tracker_recorder_start( const char *filename ) {
+    if ( tracker_ring ) {
+        return( false );
+    }
+    /**
+     * create an empty track file
+     */
+    FILE *fp = fopen( filename, "wb" );
+    if ( !fp ) {
+        log_e("create %s failed", filename );
+        return( false );
+    }
+    fclose( fp );
+
+    tracker_ring = (tracker_trk_block_t *)CALLOC_ASSERT( TRACKER_TRK_RING_BLOCKS, sizeof( tracker_trk_block_t ), "tracker ring alloc failed" );
+    tracker_ring_head = 0;
+    tracker_ring_full = 0;
+    tracker_seq = 0;
+    strncpy( tracker_filename, filename, sizeof( tracker_filename ) - 1 );
+    memset( &tracker_stats, 0, sizeof( tracker_stats ) );
+
+    return( true );
+}
+
+void tracker_recorder_add( double lat, double lon, double ele, time_t utc ) {
+    if ( !tracker_ring ) {
+        return;
+    }
+
+    tracker_trk_block_t *block = &tracker_ring[ tracker_ring_head ];
+    int32_t ilat = lround( lat * TRACKER_TRK_SCALE );
+    int32_t ilon = lround( lon * TRACKER_TRK_SCALE );
+    int32_t iele = lround( ele * 10 );
+    int64_t dlat = (int64_t)ilat - tracker_last_lat;
+    int64_t dlon = (int64_t)ilon - tracker_last_lon;
+    int64_t dele = (int64_t)iele - tracker_last_ele;
+    int64_t dtime = (int64_t)utc - tracker_last_time;
+    /**
+     * start a new block when the current one is full or the delta does not fit
+     */
+    if ( block->header.count ) {
+        if (    block->header.count > TRACKER_TRK_DELTAS
+             || dlat < INT16_MIN || dlat > INT16_MAX
+             || dlon < INT16_MIN || dlon > INT16_MAX
+             || dele < INT16_MIN || dele > INT16_MAX
+             || dtime < 0 || dtime > UINT16_MAX ) {
+            tracker_block_seal( block );
+            tracker_ring_full++;
+            tracker_ring_head = ( tracker_ring_head + 1 ) % TRACKER_TRK_RING_BLOCKS;
+            /**
+             * write full blocks, drop the oldest if the ring is still full
+             */
+            tracker_recorder_flush( false );
+            if ( tracker_ring_full >= TRACKER_TRK_RING_BLOCKS ) {
+                tracker_ring_full--;
+                tracker_stats.dropped++;
+            }
+            block = &tracker_ring[ tracker_ring_head ];
+            memset( block, 0, sizeof( tracker_trk_block_t ) );
+        }
+    }
+
+    if ( block->header.count == 0 ) {
+        block->header.magic = TRACKER_TRK_MAGIC;
+        block->header.seq = tracker_seq++;
+        block->header.time = utc;
+        block->header.lat = ilat;
+        block->header.lon = ilon;
+        block->header.ele = iele;
+    }
+    else {
+        tracker_trk_delta_t *delta = &block->delta[ block->header.count - 1 ];
+        delta->lat = dlat;
+        delta->lon = dlon;
+        delta->ele = dele;
+        delta->time = dtime;
+    }
+    block->header.count++;
+
+    tracker_last_lat = ilat;
+    tracker_last_lon = ilon;
+    tracker_last_ele = iele;
+    tracker_last_time = utc;
+
+    if ( !tracker_stats.points ) {
+        tracker_stats.start = utc;
+    }
+    tracker_stats.end = utc;
+    tracker_stats.points++;
+}
+
+void tracker_recorder_stop( void ) {
+    if ( !tracker_ring ) {
+        return;
+    }
+    tracker_recorder_flush( true );
+
+    uint32_t duration = tracker_stats.end > tracker_stats.start ? tracker_stats.end - tracker_stats.start : 1;
+    log_i("track %s: %u points, %u blocks, %u writes, %u bytes, %u dropped blocks, %.1f bytes/point, %.1f writes/hour",
+            tracker_filename, tracker_stats.points, tracker_stats.blocks, tracker_stats.writes, tracker_stats.bytes, tracker_stats.dropped,
+            tracker_stats.points ? (float)tracker_stats.bytes / tracker_stats.points : 0.0f,
+            (float)tracker_stats.writes * 3600 / duration );
+
+    free( tracker_ring );
+    tracker_ring = NULL;
+}
+
+const char *tracker_recorder_get_filename( void ) {
+    return( tracker_filename );
+}
+
+void tracker_recorder_get_stats( tracker_recorder_stats_t *stats ) {
+    *stats = tracker_stats;
+}
+
+static void tracker_recorder_flush( bool partial ) {
+    tracker_trk_block_t *head = &tracker_ring[ tracker_ring_head ];
+    bool write_head = partial && head->header.count;
+
+    if ( !tracker_ring_full && !write_head ) {
+        return;
+    }
+    /**
+     * append all full blocks and on request the partial head block with one open/close
+     */
+    FILE *fp = fopen( tracker_filename, "r+b" );
+    if ( !fp ) {
+        fp = fopen( tracker_filename, "wb" );
+    }
+    if ( !fp ) {
+        log_e("open %s failed, %u blocks pending", tracker_filename, tracker_ring_full );
+        return;
+    }
+    /**
+     * a torn write leaves a partial block at the end, write over it so
+     * all following blocks stay block aligned
+     */
+    fseek( fp, 0, SEEK_END );
+    long end = ftell( fp );
+    long pos = end > 0 ? end - end % sizeof( tracker_trk_block_t ) : 0;
+    if ( pos != end ) {
+        log_w("%s: %ld bytes of a torn block overwritten", tracker_filename, end - pos );
+    }
+    fseek( fp, pos, SEEK_SET );
+
+    while( tracker_ring_full ) {
+        tracker_trk_block_t *block = &tracker_ring[ ( tracker_ring_head + TRACKER_TRK_RING_BLOCKS - tracker_ring_full ) % TRACKER_TRK_RING_BLOCKS ];
+        if ( fwrite( block, sizeof( tracker_trk_block_t ), 1, fp ) != 1 || fflush( fp ) ) {
+            log_e("write %s failed, %u blocks pending", tracker_filename, tracker_ring_full );
+            break;
+        }
+        tracker_stats.blocks++;
+        tracker_stats.bytes += sizeof( tracker_trk_block_t );
+        tracker_ring_full--;
+    }
+    if ( write_head && !tracker_ring_full ) {
+        tracker_block_seal( head );
+        if ( fwrite( head, sizeof( tracker_trk_block_t ), 1, fp ) == 1 && !fflush( fp ) ) {
+            tracker_stats.blocks++;
+            tracker_stats.bytes += sizeof( tracker_trk_block_t );
+        }
+    }
+    tracker_stats.writes++;
+    fclose( fp );
+}
+
+static uint32_t tracker_crc32( const uint8_t *data, size_t len ) {
+    uint32_t crc = 0xffffffff;
+
+    while( len-- ) {
+        crc ^= *data++;
+        for( int bit = 0 ; bit < 8 ; bit++ ) {
+            crc = ( crc >> 1 ) ^ ( 0xedb88320 & -( crc & 1 ) );
+        }
+    }
+    return( ~crc );
+}
+
+static void tracker_block_seal( tracker_trk_block_t *block ) {
+    block->header.crc = tracker_crc32( (const uint8_t *)&block->header.seq, sizeof( tracker_trk_block_t ) - offsetof( tracker_trk_header_t, seq ) );
+}
+
+static bool tracker_block_valid( tracker_trk_block_t *block ) {
+    if ( block->header.magic != TRACKER_TRK_MAGIC || block->header.count == 0 || block->header.count > TRACKER_TRK_DELTAS + 1 ) {
+        return( false );
+    }
+    return( block->header.crc == tracker_crc32( (const uint8_t *)&block->header.seq, sizeof( tracker_trk_block_t ) - offsetof( tracker_trk_header_t, seq ) ) );
+}
+
+/**
+ * @brief move the file position to the next block magic behind an invalid block,
+ * a torn write shifts all following blocks by its length
+ * 
+ * @param   exporter    exporter with the invalid block just read
+ */
+static void tracker_export_resync( tracker_export_t *exporter ) {
+    const uint8_t *data = (const uint8_t *)&exporter->block;
+    const uint32_t magic = TRACKER_TRK_MAGIC;
+
+    for( size_t i = 1 ; i + sizeof( magic ) <= sizeof( tracker_trk_block_t ) ; i++ ) {
+        if ( !memcmp( &data[ i ], &magic, sizeof( magic ) ) ) {
+            fseek( exporter->fp, (long)i - (long)sizeof( tracker_trk_block_t ), SEEK_CUR );
+            return;
+        }
+    }
+    /**
+     * no magic in this block, keep the last bytes as they may start one
+     */
+    fseek( exporter->fp, 1 - (long)sizeof( magic ), SEEK_CUR );
+}
+
+bool tracker_recorder_export_open( tracker_export_t *exporter, const char *filename, tracker_export_format_t format, double tolerance ) {
+    memset( exporter, 0, sizeof( tracker_export_t ) );
+    exporter->format = format;
+    exporter->tolerance = tolerance;
+    exporter->fp = fopen( filename, "rb" );
+
+    return( exporter->fp != NULL );
+}
+
+size_t tracker_recorder_export_read( tracker_export_t *exporter, char *buf, size_t len ) {
+    size_t size = 0;
+
+    while( size < len ) {
+        /**
+         * return pending text first
+         */
+        if ( exporter->text_pos < exporter->text_len ) {
+            size_t chunk = exporter->text_len - exporter->text_pos;
+            if ( chunk > len - size ) {
+                chunk = len - size;
+            }
+            memcpy( buf + size, exporter->text + exporter->text_pos, chunk );
+            exporter->text_pos += chunk;
+            size += chunk;
+            continue;
+        }
+        exporter->text_len = 0;
+        exporter->text_pos = 0;
+
+        switch( exporter->state ) {
+            case TRACKER_EXPORT_HEADER:
+                if ( exporter->format == TRACKER_EXPORT_KML ) {
+                    exporter->text_len = snprintf( exporter->text, sizeof( exporter->text ), KML_HEADER KML_START );
+                }
+                else {
+                    exporter->text_len = snprintf( exporter->text, sizeof( exporter->text ), GPX_HEADER GPX_START GPX_METADATA GPX_TRACK_START GPX_TRACK_SEGMENT_START );
+                }
+                exporter->state = TRACKER_EXPORT_POINTS;
+                break;
+            case TRACKER_EXPORT_POINTS: {
+                tracker_trk_block_t *block = &exporter->block;
+                /**
+                 * read and decode the next valid block, torn or foreign blocks are skipped
+                 */
+                if ( exporter->point >= exporter->count ) {
+                    exporter->point = 0;
+                    exporter->count = 0;
+                    if ( !exporter->fp || fread( block, sizeof( tracker_trk_block_t ), 1, exporter->fp ) != 1 ) {
+                        exporter->state = TRACKER_EXPORT_FOOTER;
+                        break;
+                    }
+                    if ( !tracker_block_valid( block ) ) {
+                        exporter->bad_blocks++;
+                        tracker_export_resync( exporter );
+                        break;
+                    }
+                    int32_t lat = block->header.lat;
+                    int32_t lon = block->header.lon;
+                    int32_t ele = block->header.ele;
+                    uint32_t time = block->header.time;
+
+                    for( uint32_t i = 0 ; i < block->header.count ; i++ ) {
+                        if ( i ) {
+                            lat += block->delta[ i - 1 ].lat;
+                            lon += block->delta[ i - 1 ].lon;
+                            ele += block->delta[ i - 1 ].ele;
+                            time += block->delta[ i - 1 ].time;
+                        }
+                        exporter->lat[ i ] = (double)lat / TRACKER_TRK_SCALE;
+                        exporter->lon[ i ] = (double)lon / TRACKER_TRK_SCALE;
+                        exporter->ele[ i ] = (double)ele / 10;
+                        exporter->time[ i ] = time;
+                    }
+                    exporter->count = block->header.count;
+                    tracker_simplify( exporter->lat, exporter->lon, exporter->count, exporter->tolerance, exporter->keep );
+                }
+                /**
+                 * format the next kept point
+                 */
+                uint32_t point = exporter->point++;
+
+                if ( !exporter->keep[ point ] ) {
+                    break;
+                }
+                exporter->points++;
+
+                if ( exporter->format == TRACKER_EXPORT_KML ) {
+                    exporter->text_len = snprintf( exporter->text, sizeof( exporter->text ), KML_POINT, exporter->lon[ point ], exporter->lat[ point ], exporter->ele[ point ] );
+                }
+                else {
+                    char timestamp[ 32 ];
+                    struct tm info;
+                    time_t now = exporter->time[ point ];
+
+                    gmtime_r( &now, &info );
+                    strftime( timestamp, sizeof( timestamp ), GPX_TRACK_SEGMENT_POINT_TIME_SRF, &info );
+                    exporter->text_len = snprintf( exporter->text, sizeof( exporter->text ), GPX_TRACK_SEGMENT_POINT_START GPX_TRACK_SEGMENT_POINT_ELE GPX_TRACK_SEGMENT_POINT_TIME GPX_TRACK_SEGMENT_POINT_END, exporter->lat[ point ], exporter->lon[ point ], exporter->ele[ point ], timestamp );
+                }
+                break;
+            }
+            case TRACKER_EXPORT_FOOTER:
+                if ( exporter->format == TRACKER_EXPORT_KML ) {
+                    exporter->text_len = snprintf( exporter->text, sizeof( exporter->text ), KML_END );
+                }
+                else {
+                    exporter->text_len = snprintf( exporter->text, sizeof( exporter->text ), GPX_TRACK_SEGMENT_END GPX_TRACK_END GPX_END );
+                }
+                exporter->state = TRACKER_EXPORT_DONE;
+                break;
+            default:
+                exporter->bytes += size;
+                return( size );
+        }
+        if ( exporter->text_len >= sizeof( exporter->text ) ) {
+            exporter->text_len = sizeof( exporter->text ) - 1;
+        }
+    }
+    exporter->bytes += size;
+    return( size );
+}
+
+void tracker_recorder_export_close( tracker_export_t *exporter ) {
+    if ( exporter->fp ) {
+        fclose( exporter->fp );
+        exporter->fp = NULL;
+    }
+}
+
+bool tracker_recorder_export_file( const char *filename, const char *dst, tracker_export_format_t format, double tolerance ) {
+    tracker_export_t *exporter = (tracker_export_t *)MALLOC_ASSERT( sizeof( tracker_export_t ), "tracker export alloc failed" );
+    char buf[ 512 ];
+    size_t len;
+    bool retval = false;
+
+    if ( tracker_recorder_export_open( exporter, filename, format, tolerance ) ) {
+        FILE *fp = fopen( dst, "wb" );
+        if ( fp ) {
+            retval = true;
+            while( ( len = tracker_recorder_export_read( exporter, buf, sizeof( buf ) ) ) > 0 ) {
+                if ( fwrite( buf, 1, len, fp ) != len ) {
+                    retval = false;
+                    break;
+                }
+            }
+            fclose( fp );
+            /**
+             * compare against the old path, one open/close and a gpx record per point
+             */
+            log_i("export %s: %u points, %u bytes, %u bad blocks, %.1f bytes/point",
+                    dst, exporter->points, exporter->bytes, exporter->bad_blocks,
+                    exporter->points ? (float)exporter->bytes / exporter->points : 0.0f );
+        }
+        tracker_recorder_export_close( exporter );
+    }
+    free( exporter );
+    return( retval );
+}
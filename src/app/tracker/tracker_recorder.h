@@ -0,0 +1,203 @@
+/****************************************************************************
+ *   Oct 17 18:42:10 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _TRACKER_RECORDER_H
+    #define _TRACKER_RECORDER_H
+
+    #include <stdio.h>
+    #include <stdint.h>
+    #include <stddef.h>
+    #include <time.h>
+
+    #define TRACKER_TRK_MAGIC                   0x314b5254      /** @brief "TRK1" at the start of each block */
+    #define TRACKER_TRK_BLOCK_SIZE              512             /** @brief on-disk block size, one flash page/sd sector */
+    #define TRACKER_TRK_RING_BLOCKS             4               /** @brief in-ram blocks, absorbs failed or delayed writes */
+    #define TRACKER_TRK_SCALE                   1000000         /** @brief lat/lon fixed point scale, 1e-6 degree */
+    /**
+     * @brief gpx file definitions
+     */
+    #define     GPX_HEADER                          "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>\r\n"
+    #define     GPX_START                           "<gpx version=\"1.1\" creator=\"gps tracker\">\r\n"
+    #define     GPX_METADATA                        " <metadata> <!-- Metadaten --> </metadata>\r\n"
+    #define     GPX_TRACK_START                     " <trk>\r\n"
+    #define     GPX_TRACK_SEGMENT_START             "  <trkseg>\r\n"
+    #define     GPX_TRACK_SEGMENT_POINT_START       "   <trkpt lat=\"%f\" lon=\"%f\">\r\n"
+    #define     GPX_TRACK_SEGMENT_POINT_ELE         "    <ele>%f</ele>\r\n"
+    #define     GPX_TRACK_SEGMENT_POINT_TIME_SRF    "%Y-%m-%dT%H:%M:%SZ"
+    #define     GPX_TRACK_SEGMENT_POINT_TIME        "    <time>%s</time>\r\n"
+    #define     GPX_TRACK_SEGMENT_POINT_END         "   </trkpt>\r\n"
+    #define     GPX_TRACK_SEGMENT_END               "  </trkseg>\r\n"
+    #define     GPX_TRACK_END                       " </trk>\r\n"
+    #define     GPX_END                             "</gpx>\r\n"
+    /**
+     * @brief kml file definitions
+     */
+    #define     KML_HEADER                          "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+    #define     KML_START                           "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\r\n <Document>\r\n  <Placemark>\r\n   <name>gps tracker</name>\r\n   <LineString>\r\n    <altitudeMode>absolute</altitudeMode>\r\n    <coordinates>\r\n"
+    #define     KML_POINT                           "     %f,%f,%f\r\n"
+    #define     KML_END                             "    </coordinates>\r\n   </LineString>\r\n  </Placemark>\r\n </Document>\r\n</kml>\r\n"
+    /**
+     * @brief block header, the base point is stored absolute
+     */
+    typedef struct __attribute__((packed)) {
+        uint32_t magic;                                 /** @brief TRACKER_TRK_MAGIC */
+        uint32_t crc;                                   /** @brief crc32 over the block behind this field */
+        uint16_t seq;                                   /** @brief block sequence number */
+        uint16_t count;                                 /** @brief number of points including the base point */
+        uint32_t time;                                  /** @brief base point utc time */
+        int32_t lat;                                    /** @brief base point latitude in 1e-6 degree */
+        int32_t lon;                                    /** @brief base point longitude in 1e-6 degree */
+        int32_t ele;                                    /** @brief base point elevation in decimeter */
+    } tracker_trk_header_t;
+    /**
+     * @brief point relative to the previous point
+     */
+    typedef struct __attribute__((packed)) {
+        int16_t lat;                                    /** @brief latitude delta in 1e-6 degree */
+        int16_t lon;                                    /** @brief longitude delta in 1e-6 degree */
+        int16_t ele;                                    /** @brief elevation delta in decimeter */
+        uint16_t time;                                  /** @brief time delta in seconds */
+    } tracker_trk_delta_t;
+
+    #define TRACKER_TRK_DELTAS  ( ( TRACKER_TRK_BLOCK_SIZE - sizeof( tracker_trk_header_t ) ) / sizeof( tracker_trk_delta_t ) )
+    /**
+     * @brief one on-disk block, always written in full so a torn write only damages one block
+     */
+    typedef struct __attribute__((packed)) {
+        tracker_trk_header_t header;
+        tracker_trk_delta_t delta[ TRACKER_TRK_DELTAS ];
+        uint8_t reserved[ TRACKER_TRK_BLOCK_SIZE - sizeof( tracker_trk_header_t ) - TRACKER_TRK_DELTAS * sizeof( tracker_trk_delta_t ) ];
+    } tracker_trk_block_t;
+    /**
+     * @brief recorder statistics
+     */
+    typedef struct {
+        uint32_t points;                                /** @brief recorded points */
+        uint32_t blocks;                                /** @brief blocks written */
+        uint32_t writes;                                /** @brief file open/write/close cycles */
+        uint32_t bytes;                                 /** @brief bytes written */
+        uint32_t dropped;                               /** @brief blocks dropped on a full ring */
+        uint32_t start;                                 /** @brief utc time of the first point */
+        uint32_t end;                                   /** @brief utc time of the last point */
+    } tracker_recorder_stats_t;
+    /**
+     * @brief export formats
+     */
+    typedef enum {
+        TRACKER_EXPORT_GPX = 0,
+        TRACKER_EXPORT_KML
+    } tracker_export_format_t;
+    /**
+     * @brief streaming export state
+     */
+    typedef struct {
+        FILE *fp;                                       /** @brief track file */
+        tracker_export_format_t format;                 /** @brief output format */
+        uint32_t state;                                 /** @brief export state */
+        double tolerance;                               /** @brief Douglas-Peucker tolerance in meter, 0 exports all points */
+        tracker_trk_block_t block;                      /** @brief current block */
+        uint32_t point;                                 /** @brief next point in block */
+        uint32_t count;                                 /** @brief decoded points in block */
+        double lat[ TRACKER_TRK_DELTAS + 1 ];           /** @brief decoded latitude in degree */
+        double lon[ TRACKER_TRK_DELTAS + 1 ];           /** @brief decoded longitude in degree */
+        double ele[ TRACKER_TRK_DELTAS + 1 ];           /** @brief decoded elevation in meter */
+        uint32_t time[ TRACKER_TRK_DELTAS + 1 ];        /** @brief decoded utc time */
+        bool keep[ TRACKER_TRK_DELTAS + 1 ];            /** @brief points kept by the simplification */
+        char text[ 256 ];                               /** @brief formated output not yet returned */
+        size_t text_len;                                /** @brief chars in text */
+        size_t text_pos;                                /** @brief chars of text already returned */
+        uint32_t points;                                /** @brief exported points */
+        uint32_t bytes;                                 /** @brief exported bytes */
+        uint32_t bad_blocks;                            /** @brief skipped blocks with bad magic or crc */
+    } tracker_export_t;
+    /**
+     * @brief start recording into a new track file
+     *
+     * @param   filename    local track file name
+     *
+     * @return  true if success
+     */
+    bool tracker_recorder_start( const char *filename );
+    /**
+     * @brief add a point, full blocks are written to the track file
+     *
+     * @param   lat         latitude in degree
+     * @param   lon         longitude in degree
+     * @param   ele         elevation in meter
+     * @param   utc         utc time
+     */
+    void tracker_recorder_add( double lat, double lon, double ele, time_t utc );
+    /**
+     * @brief write all pending blocks and stop recording
+     */
+    void tracker_recorder_stop( void );
+    /**
+     * @brief get the current or last track file name
+     *
+     * @return  local file name or "" if none
+     */
+    const char *tracker_recorder_get_filename( void );
+    /**
+     * @brief get recorder statistics of the current or last track
+     *
+     * @param   stats       pointer to a tracker_recorder_stats_t structure
+     */
+    void tracker_recorder_get_stats( tracker_recorder_stats_t *stats );
+    /**
+     * @brief open a track file for export
+     *
+     * @param   exporter    pointer to the export state
+     * @param   filename    local track file name
+     * @param   format      TRACKER_EXPORT_GPX or TRACKER_EXPORT_KML
+     * @param   tolerance   Douglas-Peucker tolerance in meter per block, 0 for all points
+     *
+     * @return  true if success
+     */
+    bool tracker_recorder_export_open( tracker_export_t *exporter, const char *filename, tracker_export_format_t format, double tolerance );
+    /**
+     * @brief read the next chunk of the export
+     *
+     * @param   exporter    pointer to the export state
+     * @param   buf         pointer to the output buffer
+     * @param   len         size of the output buffer
+     *
+     * @return  number of bytes, 0 at the end
+     */
+    size_t tracker_recorder_export_read( tracker_export_t *exporter, char *buf, size_t len );
+    /**
+     * @brief close the export
+     *
+     * @param   exporter    pointer to the export state
+     */
+    void tracker_recorder_export_close( tracker_export_t *exporter );
+    /**
+     * @brief export a track file into a gpx or kml file
+     *
+     * @param   filename    local track file name
+     * @param   dst         local gpx/kml file name
+     * @param   format      TRACKER_EXPORT_GPX or TRACKER_EXPORT_KML
+     * @param   tolerance   Douglas-Peucker tolerance in meter per block, 0 for all points
+     *
+     * @return  true if success
+     */
+    bool tracker_recorder_export_file( const char *filename, const char *dst, tracker_export_format_t format, double tolerance );
+
+#endif // _TRACKER_RECORDER_H
@@ -25,6 +25,7 @@
 #include "gui/mainbar/mainbar.h"
 #include "gui/mainbar/app_tile/app_tile.h"
 #include "utils/alloc.h"
+#include "utils/frametime.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -34,15 +35,22 @@
 
 size_t app_autocall_counter = 0;                   /** @brief counter for registered setup functions */
 app_autocall_table_t *app_autocall_table = NULL;  /** @brief table for registered setup functions */
+static icon_t *app_autocall_reuse_icon = NULL;    /** @brief placeholder icon taken over by the next app_register() call */
+static lv_task_t *app_autocall_idle_task = NULL;  /** @brief task for deferred setups in idle time */
+
+static void app_autocall_run( app_autocall_table_t *entry );
+static void app_autocall_free_table( void );
+static void app_autocall_deferred_event_cb( lv_obj_t *obj, lv_event_t event );
+static void app_autocall_idle_task_cb( lv_task_t *task );
 
 /**
- * @brief register a app with prio
+ * @brief add an entry to the autocall table
  * 
  * @param function      pointer to a function
  * @param prio          priority of the function, 0 first, 1 second, ...
- * @return int 
+ * @return app_autocall_table_t*
  */
-int app_autocall_function( APP_AUTOCALL_FUNC function, size_t prio ) {
+static app_autocall_table_t *app_autocall_add( APP_AUTOCALL_FUNC function, size_t prio ) {
     /**
      * register a setup function
      */
@@ -57,36 +65,191 @@ int app_autocall_function( APP_AUTOCALL_FUNC function, size_t prio ) {
     /**
      * store registration function
      */
-    app_autocall_table[ app_autocall_counter - 1 ].function = function;
-    app_autocall_table[ app_autocall_counter - 1 ].prio = prio;
-    
+    app_autocall_table_t *entry = &app_autocall_table[ app_autocall_counter - 1 ];
+    entry->function = function;
+    entry->prio = prio;
+    entry->appname = NULL;
+    entry->icon = NULL;
+    entry->app = NULL;
+    entry->done = false;
+
+    return( entry );
+}
+
+/**
+ * @brief register a app with prio
+ * 
+ * @param function      pointer to a function
+ * @param prio          priority of the function, 0 first, 1 second, ...
+ * @return int 
+ */
+int app_autocall_function( APP_AUTOCALL_FUNC function, size_t prio ) {
+    app_autocall_add( function, prio );
+    return( 1 );
+}
+
+int app_autocall_deferred( const char *appname, const lv_img_dsc_t *icon, APP_AUTOCALL_FUNC function, size_t prio ) {
+    app_autocall_table_t *entry = app_autocall_add( function, prio );
+
+    entry->appname = appname;
+    entry->icon = icon;
+
     return( 1 );
 }
 
 void app_autocall_all_setup_functions( void ) {
+    size_t deferred = 0;
     /**
      * start core servies
      */
     if( app_autocall_counter && app_autocall_table ) {
         /**
-         * call all registered setup functions
+         * call all registered setup functions, deferred apps only get their icon
          */
         for( size_t prio = 0 ; prio < 32 ; prio++ ) {
             for( size_t i = 0 ; i < app_autocall_counter ; i++ ) {
-                if( app_autocall_table[ i ].prio == prio )
-                    app_autocall_table[ i ].function();
+                app_autocall_table_t *entry = &app_autocall_table[ i ];
+
+                if( entry->prio != prio )
+                    continue;
+
+                if( APP_AUTOCALL_DEFERRED && entry->appname ) {
+                    uint32_t start = frametime_get_boot_us();
+                    entry->app = app_register( entry->appname, entry->icon, app_autocall_deferred_event_cb );
+                    log_i("autocall %2d: %-16s at %7uus, %6uus, deferred", (int)prio, entry->appname, start, frametime_get_boot_us() - start );
+                    deferred++;
+                }
+                else {
+                    app_autocall_run( entry );
+                }
             }
         }
+        log_i("autocall done at %uus, %d deferred", frametime_get_boot_us(), (int)deferred );
+        /**
+         * free the table or keep it until all deferred setups have run
+         */
+        if( deferred )
+            app_autocall_idle_task = lv_task_create( app_autocall_idle_task_cb, APP_AUTOCALL_IDLE_INTERVAL, LV_TASK_PRIO_LOWEST, NULL );
+        else
+            app_autocall_free_table();
+    }
+}
+
+/**
+ * @brief run the setup function of an autocall entry and log it into the boot timeline
+ * 
+ * @param entry         pointer to an autocall table entry
+ */
+static void app_autocall_run( app_autocall_table_t *entry ) {
+    uint32_t start = frametime_get_boot_us();
+    /**
+     * let app_register() take over the placeholder icon of a deferred app
+     */
+    app_autocall_reuse_icon = entry->app;
+    entry->done = true;
+    entry->function();
+    app_autocall_reuse_icon = NULL;
+
+    if( entry->appname )
+        log_i("autocall %2d: %-16s at %7uus, %6uus", (int)entry->prio, entry->appname, start, frametime_get_boot_us() - start );
+    else
+        log_i("autocall %2d: %-16p at %7uus, %6uus", (int)entry->prio, (void*)entry->function, start, frametime_get_boot_us() - start );
+}
+
+/**
+ * @brief free the autocall table after all setup functions have run
+ */
+static void app_autocall_free_table( void ) {
+    app_autocall_counter = 0;
+    free( app_autocall_table );
+    app_autocall_table = NULL;
+
+    if( app_autocall_idle_task ) {
+        lv_task_del( app_autocall_idle_task );
+        app_autocall_idle_task = NULL;
+    }
+}
+
+/**
+ * @brief get the next deferred entry with a pending setup in order of priority
+ * 
+ * @return app_autocall_table_t* or NULL if all setups have run
+ */
+static app_autocall_table_t *app_autocall_get_pending( void ) {
+    app_autocall_table_t *pending = NULL;
+
+    for( size_t i = 0 ; i < app_autocall_counter ; i++ ) {
+        app_autocall_table_t *entry = &app_autocall_table[ i ];
+
+        if( !entry->done && ( !pending || entry->prio < pending->prio ) )
+            pending = entry;
+    }
+    return( pending );
+}
+
+/**
+ * @brief click on a deferred app icon, run the setup and pass the click to the real event callback
+ * 
+ * @param obj           icon object
+ * @param event         event
+ */
+static void app_autocall_deferred_event_cb( lv_obj_t *obj, lv_event_t event ) {
+    if( event != LV_EVENT_CLICKED )
+        return;
+
+    for( size_t i = 0 ; i < app_autocall_counter ; i++ ) {
+        app_autocall_table_t *entry = &app_autocall_table[ i ];
+
+        if( entry->done || !entry->app || entry->app->icon_img != obj )
+            continue;
+
+        app_autocall_run( entry );
+        if( !app_autocall_get_pending() )
+            app_autocall_free_table();
         /**
-         * free the table
+         * the setup function has replaced the event callback with the app one
          */
-        app_autocall_counter = 0;
-        free( app_autocall_table );
-        app_autocall_table = NULL;
+        lv_event_send( obj, LV_EVENT_CLICKED, NULL );
+        return;
     }
 }
 
+/**
+ * @brief run one deferred setup per call when the user is idle
+ * 
+ * @param task          pointer to the task
+ */
+static void app_autocall_idle_task_cb( lv_task_t *task ) {
+    if( lv_disp_get_inactive_time( NULL ) < APP_AUTOCALL_IDLE_DELAY )
+        return;
+
+    app_autocall_table_t *entry = app_autocall_get_pending();
+    if( entry )
+        app_autocall_run( entry );
+
+    if( !app_autocall_get_pending() )
+        app_autocall_free_table();
+}
+
 icon_t *app_register( const char* appname, const lv_img_dsc_t *icon, lv_event_cb_t event_cb ) {
+    /**
+     * a deferred app takes over the icon registered at boot
+     */
+    if ( app_autocall_reuse_icon ) {
+        icon_t *app = app_autocall_reuse_icon;
+        app_autocall_reuse_icon = NULL;
+
+        lv_label_set_text( app->label, appname );
+        lv_obj_align( app->label , app->icon_cont, LV_ALIGN_OUT_BOTTOM_MID, 0, 0 );
+        lv_imgbtn_set_src( app->icon_img, LV_BTN_STATE_RELEASED, icon);
+        lv_imgbtn_set_src( app->icon_img, LV_BTN_STATE_PRESSED, icon);
+        lv_imgbtn_set_src( app->icon_img, LV_BTN_STATE_CHECKED_RELEASED, icon);
+        lv_imgbtn_set_src( app->icon_img, LV_BTN_STATE_CHECKED_PRESSED, icon);
+        lv_obj_set_event_cb( app->icon_img, event_cb );
+        lv_obj_invalidate( app->icon_cont );
+
+        return( app );
+    }
 
     icon_t *app = app_tile_get_free_app_icon();
 
@@ -23,6 +23,12 @@
     #define _APP_H
     
     #include "gui/icon.h"
+
+    #ifndef APP_AUTOCALL_DEFERRED
+        #define APP_AUTOCALL_DEFERRED       1       /** @brief 1 to defer the setup of apps registered with app_autocall_deferred, 0 to run them at boot */
+    #endif
+    #define APP_AUTOCALL_IDLE_DELAY         2000    /** @brief ms without user input before a deferred setup runs in idle time */
+    #define APP_AUTOCALL_IDLE_INTERVAL      250     /** @brief ms between two deferred setups in idle time */
     /**
      * @brief core autocall type definition
      */
@@ -33,6 +39,10 @@
     typedef struct {
         APP_AUTOCALL_FUNC function;             /** @brief pointer to a callback function */
         size_t prio;                            /** @brief priority of the callback function */
+        const char *appname;                    /** @brief app name for a deferred setup, NULL if not deferred */
+        const lv_img_dsc_t *icon;               /** @brief app icon for a deferred setup */
+        icon_t *app;                            /** @brief placeholder app icon until the deferred setup has run */
+        bool done;                              /** @brief true if the setup function has run */
     } app_autocall_table_t;
     /**
      * @brief autocall function for module setup
@@ -41,6 +51,20 @@
      * @param prio              priority of the module
      */
     int app_autocall_function( APP_AUTOCALL_FUNC function, size_t prio );
+    /**
+     * @brief autocall function for a deferred app setup. At boot only the app icon is
+     * registered, the setup function runs on the first click on the icon or in idle time
+     * after the boot. The app_register() call from the setup function takes over the icon.
+     * 
+     * @param appname           app name shown under the icon
+     * @param icon              pointer to an 64x64px icon
+     * @param function          pointer to the app setup function
+     * @param prio              priority of the app
+     */
+    int app_autocall_deferred( const char *appname, const lv_img_dsc_t *icon, APP_AUTOCALL_FUNC function, size_t prio );
+    /**
+     * @brief call all registered setup functions in order of priority
+     */
     void app_autocall_all_setup_functions( void );
     /**
      * @brief register an application icon
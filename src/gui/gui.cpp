@@ -55,6 +55,7 @@
 #include "hardware/display.h"
 #include "hardware/hardware.h"
 #include "utils/filepath_convert.h"
+#include "utils/frametime.h"
 
 #ifdef NATIVE_64BIT
     #include <iostream>
@@ -372,7 +373,9 @@ bool gui_powermgm_loop_event_cb( EventBits_t event, void *arg ) {
         }
     #endif
 
+    frametime_handler_start();
     lv_task_handler();
+    frametime_handler_end();
 
     if ( force_redraw ) {
         force_redraw = !force_redraw;
@@ -126,6 +126,8 @@ void bluetooth_media_tile_setup( void ) {
     lv_obj_align( bluetooth_media_volume_up, bluetooth_media_speaker, LV_ALIGN_OUT_RIGHT_MID, THEME_ICON_SIZE, 0 );
 
     gadgetbridge_register_cb( GADGETBRIDGE_JSON_MSG, bluetooth_media_event_cb, "bluetooth media" );
+    gadgetbridge_register_json_filter( "musicstate", "state" );
+    gadgetbridge_register_json_filter( "musicinfo", "track,artist" );
     mainbar_add_tile_activate_cb( bluetooth_media_tile_num, bluetooth_media_activate_cb );
     bluetooth_media_app = app_register( "media\nplayer", &play_64px, enter_bluetooth_media_cb );
 }
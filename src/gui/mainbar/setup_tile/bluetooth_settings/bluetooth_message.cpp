@@ -41,6 +41,7 @@
 
 #include "utils/alloc.h"
 #include "utils/msg_chain.h"
+#include "utils/msg_history.h"
 #include "utils/bluejsonrequest.h"
 
 #ifdef NATIVE_64BIT
@@ -286,12 +287,26 @@ void bluetooth_message_tile_setup( void ) {
     lv_obj_align( bluetooth_message_entrys_label, bluetooth_message_next_msg_btn, LV_ALIGN_OUT_LEFT_MID, 0, 0 );
 
     gadgetbridge_register_cb( GADGETBRIDGE_JSON_MSG, bluetooth_message_event_cb, "bluetooth_message" );
+    /**
+     * notify and weather msgs are stored as they are
+     */
+    gadgetbridge_register_json_filter( "notify", "*" );
+    gadgetbridge_register_json_filter( "weather", "*" );
+    gadgetbridge_register_json_filter( "notify-", "id" );
     styles_register_cb( STYLE_CHANGE, bluetooth_message_style_change_event_cb, "bluetooth message style" );
     button_register_cb( BUTTON_NOTIFY_TEST | BUTTON_NOTIFY_DEL_TEST, bluetooth_message_button_event_cb, "bluetooth message button cb" );
     mainbar_add_tile_button_cb( bluetooth_message_tile_num, bluetooth_message_button_event_cb );
     mainbar_add_tile_activate_cb( bluetooth_message_tile_num, bluetooth_message_activate_cb );
     mainbar_add_tile_hibernate_cb( bluetooth_message_tile_num, bluetooth_message_hibernate_cb );
     messages_app = app_register( "messages", &message_64px, enter_bluetooth_messages_cb );
+    /*
+     * load persistent msg history index
+     */
+    msg_history_setup();
+
+#if defined( NATIVE_64BIT ) && defined( MSG_CHAIN_BENCHMARK )
+    msg_chain_benchmark();
+#endif
 }
 
 static bool bluetooth_message_button_event_cb( EventBits_t event, void *arg ) {
@@ -516,7 +531,7 @@ bool bluetooth_message_queue_msg( BluetoothJsonRequest &doc ) {
         * if msg an notify or weather msg?
         */
         if( !strcmp( doc["t"], "notify" ) || !strcmp( doc["t"], "weather" ) ) {
-            int len = doc.memoryUsage();
+            int len = measureJson( doc ) + 1;
             char *msg = (char *)MALLOC_ASSERT( len, "bluetooth message alloc failed" );
 
             serializeJson( doc, msg, len );
@@ -559,11 +574,23 @@ bool bluetooth_message_queue_msg( const char *msg ) {
     /*
      * add msg to the msg chain
      */
-    bluetooth_msg_chain = msg_chain_add_msg( bluetooth_msg_chain, msg );
+    bool added = false;
+    bluetooth_msg_chain = msg_chain_add_msg( bluetooth_msg_chain, msg, &added );
+    if ( !added ) {
+        log_e("msg not added to msg chain");
+        return( false );
+    }
     /*
      * only alert or alret and showing msg
      */
     int32_t entry = bluetooth_current_msg = msg_chain_get_entrys( bluetooth_msg_chain ) - 1;
+    /*
+     * store msg in the persistent msg history
+     */
+    time_t *timestamp = msg_chain_get_msg_timestamp_entry( bluetooth_msg_chain, entry );
+    if ( timestamp ) {
+        msg_history_add( msg, *timestamp );
+    }
     bluetooth_message_show_msg( entry );
     /**
      * show on notification if enabled
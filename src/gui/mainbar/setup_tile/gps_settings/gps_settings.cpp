@@ -96,7 +96,7 @@ void gps_settings_tile_setup( void ) {
     lv_label_set_text( gps_latlon_label, "fix: - lat: - lon: -");
     lv_obj_align( gps_latlon_label, gps_settings_tile, LV_ALIGN_IN_BOTTOM_MID, 0, -5 );
 
-    gpsctl_register_cb( GPSCTL_FIX | GPSCTL_NOFIX | GPSCTL_UPDATE_LOCATION, gps_settings_latlon_update_cb, "gps settings" );
+    gpsctl_register_cb( GPSCTL_FIX | GPSCTL_NOFIX | GPSCTL_UPDATE_DATA, gps_settings_latlon_update_cb, "gps settings" );
     gpsctl_register_cb( GPSCTL_UPDATE_CONFIG, gps_settings_config_update_cb, "gps settings" );
 
     #if defined( M5PAPER )
@@ -154,8 +154,11 @@ bool gps_settings_latlon_update_cb( EventBits_t event, void *arg ) {
     char msg[64] = "";
 
     switch( event ) {
-        case GPSCTL_UPDATE_LOCATION:
+        case GPSCTL_UPDATE_DATA:
             gps_data = (gps_data_t*)arg;
+            if ( !( gps_data->changed & GPS_DATA_LOCATION ) ) {
+                return( true );
+            }
             lat = gps_data->lat;
             lon = gps_data->lon;
             break;
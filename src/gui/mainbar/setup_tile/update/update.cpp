@@ -250,6 +250,7 @@ static void update_event_handler(lv_obj_t * obj, lv_event_t event) {
     #else
             if ( reset ) {
                 log_i("System reboot by user");
+                powermgm_save_config();
                 motor_vibe(20);
                 delay(20);
                 SPIFFS.end();
@@ -34,6 +34,7 @@
 #include "hardware/display.h"
 #include "hardware/gpsctl.h"
 #include "hardware/pmu.h"
+#include "hardware/powermgm.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -277,6 +278,7 @@ static void reboot_utilities_event_cb( lv_obj_t * obj, lv_event_t event ) {
 
 #else
             log_i("System reboot by user");
+            powermgm_save_config();
             motor_vibe(20);
             delay(20);
             SPIFFS.end();
@@ -296,6 +298,7 @@ static void poweroff_utilities_event_cb( lv_obj_t * obj, lv_event_t event ) {
 
 #else
             log_i("System poweroff by user");
+            powermgm_save_config();
             motor_vibe(20);
             delay(20);
             SPIFFS.end();
@@ -32,9 +32,12 @@
 #include "hardware/blectl.h"
 #include "hardware/rtcctl.h"
 #include "hardware/sound.h"
+#include "hardware/ble/gadgetbridge.h"
 #include "gui/mainbar/setup_tile/bluetooth_settings/bluetooth_message.h"
 #include "time.h"
 
+#define WATCHFACE_EXPR_CONSTANT     1       /** @brief te_expr node type of a constant */
+
 static double time_hour;
 static double time_min;
 static double time_sec;
@@ -55,6 +58,15 @@ static double gps = 0.; // disabled=0, enabled(no fix)=1, enabled+fix=2
 // Alarm
 static double alarm_state = 0.;
 
+// Sources changed by producer events
+static volatile uint32_t watchface_expr_dirty = 0;
+#ifdef NATIVE_64BIT
+#else
+    static portMUX_TYPE watchface_expr_dirty_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+static void watchface_expr_set_dirty( uint32_t sources );
+
 extern "C" {
     /**
      * Adapter functions.
@@ -99,13 +111,87 @@ void watchface_expr_update( tm &new_info ) {
 }
 
 te_expr * watchface_expr_compile(const char* str, int *error) {
-    return te_compile(str, watchface_expr_vars, sizeof(watchface_expr_vars), error);
+    return te_compile(str, watchface_expr_vars, sizeof(watchface_expr_vars) / sizeof(te_variable), error);
 }
 
 double watchface_expr_eval( te_expr *expr) {
     return te_eval( expr );
 }
 
+uint32_t watchface_expr_get_sources( te_expr *expr ) {
+    uint32_t sources = 0;
+    int type;
+
+    if ( expr == NULL )
+        return( 0 );
+
+    type = expr->type & 0x1f;
+    /**
+     * variables, see watchface_expr_vars
+     */
+    if ( type == TE_VARIABLE ) {
+        if ( expr->bound == &time_sec )
+            return( WATCHFACE_SRC_SEC );
+        if ( expr->bound == &time_min || expr->bound == &time_hour )
+            return( WATCHFACE_SRC_MIN );
+        return( WATCHFACE_SRC_STATE );
+    }
+    /**
+     * functions and closures, arity is in the lower 3 bits
+     */
+    if ( type >= TE_FUNCTION0 && type <= TE_CLOSURE7 ) {
+        if ( expr->function == (const void*)get_battery_percent || expr->function == (const void*)get_battery_voltage )
+            sources |= WATCHFACE_SRC_BATTERY;
+        else if ( expr->function == (const void*)get_bluetooth_nb_msg )
+            sources |= WATCHFACE_SRC_BLE_MSG;
+        else if ( expr->function == (const void*)get_stepcounter )
+            sources |= WATCHFACE_SRC_STEPS;
+
+        for( int i = 0 ; i < ( type & 0x7 ) ; i++ )
+            sources |= watchface_expr_get_sources( (te_expr*)expr->parameters[ i ] );
+    }
+    return( sources );
+}
+
+uint32_t watchface_expr_get_dirty( void ) {
+    return( watchface_expr_dirty );
+}
+
+void watchface_expr_clear_dirty( uint32_t sources ) {
+    /**
+     * producer events come from other tasks, the read-modify-write
+     * must not lose a bit set between the read and the write
+     */
+    #ifdef NATIVE_64BIT
+    #else
+        portENTER_CRITICAL( &watchface_expr_dirty_mux );
+    #endif
+    watchface_expr_dirty &= ~sources;
+    #ifdef NATIVE_64BIT
+    #else
+        portEXIT_CRITICAL( &watchface_expr_dirty_mux );
+    #endif
+}
+
+static void watchface_expr_set_dirty( uint32_t sources ) {
+    #ifdef NATIVE_64BIT
+    #else
+        portENTER_CRITICAL( &watchface_expr_dirty_mux );
+    #endif
+    watchface_expr_dirty |= sources;
+    #ifdef NATIVE_64BIT
+    #else
+        portEXIT_CRITICAL( &watchface_expr_dirty_mux );
+    #endif
+}
+
+bool watchface_expr_is_constant( te_expr *expr ) {
+    /**
+     * te_compile folds constant subtrees into one node, TE_CONSTANT in tinyexpr.c
+     */
+    return( expr != NULL && ( expr->type & 0x1f ) == WATCHFACE_EXPR_CONSTANT );
+}
+
 bool watchface_expr_gpsctl_event_cb( EventBits_t event, void *arg ) {
     switch( event ) {
         case GPSCTL_DISABLE:
@@ -121,6 +207,7 @@ bool watchface_expr_gpsctl_event_cb( EventBits_t event, void *arg ) {
             gps = 1.;
             break;
     }
+    watchface_expr_set_dirty( WATCHFACE_SRC_STATE );
     return( true );
 }
 
@@ -133,6 +220,7 @@ bool watchface_expr_soundctl_event_cb( EventBits_t event, void *arg ) {
             sound_volume = *(uint8_t*)arg;
             break;
     }
+    watchface_expr_set_dirty( WATCHFACE_SRC_STATE );
     return( true );
 }
 
@@ -145,6 +233,7 @@ bool watchface_expr_rtcctl_event_cb( EventBits_t event, void *arg ) {
             alarm_state = 0.;
             break;
     }
+    watchface_expr_set_dirty( WATCHFACE_SRC_STATE );
     return( true );
 }
 
@@ -163,6 +252,7 @@ bool watchface_expr_blectl_event_cb( EventBits_t event, void *arg ) {
             ble = 1.;
             break;
     }
+    watchface_expr_set_dirty( WATCHFACE_SRC_STATE );
     return( true );
 }
 
@@ -181,6 +271,22 @@ bool watchface_expr_wifictl_event_cb( EventBits_t event, void *arg ) {
             wifi = 1.;
             break;
     }
+    watchface_expr_set_dirty( WATCHFACE_SRC_STATE );
+    return( true );
+}
+
+bool watchface_expr_pmuctl_event_cb( EventBits_t event, void *arg ) {
+    watchface_expr_set_dirty( WATCHFACE_SRC_BATTERY );
+    return( true );
+}
+
+bool watchface_expr_bmactl_event_cb( EventBits_t event, void *arg ) {
+    watchface_expr_set_dirty( WATCHFACE_SRC_STEPS );
+    return( true );
+}
+
+bool watchface_expr_gadgetbridge_event_cb( EventBits_t event, void *arg ) {
+    watchface_expr_set_dirty( WATCHFACE_SRC_BLE_MSG );
     return( true );
 }
 
@@ -190,4 +296,7 @@ void watchface_expr_setup( void ) {
     rtcctl_register_cb( RTCCTL_ALARM_ENABLED | RTCCTL_ALARM_DISABLED, watchface_expr_rtcctl_event_cb, "rtc state" );
     sound_register_cb( SOUNDCTL_ENABLED | SOUNDCTL_VOLUME, watchface_expr_soundctl_event_cb, "sound state");
     gpsctl_register_cb( GPSCTL_DISABLE | GPSCTL_ENABLE | GPSCTL_FIX | GPSCTL_NOFIX, watchface_expr_gpsctl_event_cb, "gps state" );
+    pmu_register_cb( PMUCTL_STATUS, watchface_expr_pmuctl_event_cb, "battery state" );
+    bma_register_cb( BMACTL_STEPCOUNTER | BMACTL_STEPCOUNTER_RESET, watchface_expr_bmactl_event_cb, "stepcounter state" );
+    gadgetbridge_register_cb( GADGETBRIDGE_JSON_MSG, watchface_expr_gadgetbridge_event_cb, "bluetooth messages state" );
 }
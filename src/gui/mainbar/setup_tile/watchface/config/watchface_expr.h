@@ -20,6 +20,17 @@
 #include "utils/tinyexpr/tinyexpr.h"
 #include "time.h"
 
+/**
+ * Sources a watchface element depends on
+ */
+#define WATCHFACE_SRC_SEC           _BV(0)      /** @brief changes every second */
+#define WATCHFACE_SRC_MIN           _BV(1)      /** @brief changes every minute, hour and day changes included */
+#define WATCHFACE_SRC_BATTERY       _BV(2)      /** @brief battery percent or voltage */
+#define WATCHFACE_SRC_STEPS         _BV(3)      /** @brief stepcounter */
+#define WATCHFACE_SRC_BLE_MSG       _BV(4)      /** @brief number of bluetooth messages */
+#define WATCHFACE_SRC_STATE         _BV(5)      /** @brief wifi, bluetooth, gps, sound or alarm state */
+#define WATCHFACE_SRC_ALL           0x3f        /** @brief all sources */
+
 /**
  * Available variables
  */
@@ -40,6 +51,26 @@ te_expr * watchface_expr_compile(const char* str, int *error);
  */
 double watchface_expr_eval( te_expr *expr);
 
+/**
+ * @brief check if a precompiled expression is folded into a constant
+ */
+bool watchface_expr_is_constant( te_expr *expr );
+
+/**
+ * @brief get the WATCHFACE_SRC_* sources a precompiled expression depends on
+ */
+uint32_t watchface_expr_get_sources( te_expr *expr );
+
+/**
+ * @brief get the WATCHFACE_SRC_* sources changed by producer events since the last clear
+ */
+uint32_t watchface_expr_get_dirty( void );
+
+/**
+ * @brief clear changed sources
+ */
+void watchface_expr_clear_dirty( uint32_t sources );
+
 /**
  * @brief setup the watchface expression module
  */
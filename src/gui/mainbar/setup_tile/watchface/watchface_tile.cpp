@@ -55,6 +55,7 @@
     #include <sys/types.h>
     #include <pwd.h>
     #include "utils/logging.h"
+    #include "utils/millis.h"
 #else
     #include <WiFi.h>
     #include <Arduino.h>
@@ -98,6 +99,43 @@ lv_obj_t *watchface_label[ WATCHFACE_LABEL_NUM ];
 lv_style_t *watchface_app_label_style[ WATCHFACE_LABEL_NUM ];
 lv_style_t watchface_app_tile_style;
 lv_style_t watchface_app_image_style;
+/**
+ * watchface label and image bindings
+ */
+watchface_binding_t watchface_label_binding[ WATCHFACE_LABEL_NUM ];
+watchface_binding_t watchface_image_binding[ WATCHFACE_IMAGE_NUM ];
+int32_t watchface_label_bindings = 0;
+int32_t watchface_image_bindings = 0;
+/**
+ * watchface sources, forced and last drawn time
+ */
+uint32_t watchface_sources = 0;
+uint32_t watchface_hand_sources = 0;
+uint32_t watchface_dirty = WATCHFACE_SRC_ALL;
+int32_t watchface_last_sec = -1;
+int32_t watchface_last_min = -1;
+/**
+ * watchface update stats
+ */
+watchface_stats_t watchface_stats;
+/**
+ * theme config type names and their binding
+ */
+static const struct {
+    const char *name;
+    watchface_bind_t type;
+} watchface_bind_names[] = {
+    { "date", WATCHFACE_BIND_DATE },
+    { "text", WATCHFACE_BIND_TEXT },
+    { "battery_percent", WATCHFACE_BIND_BATTERY_PERCENT },
+    { "battery_voltage", WATCHFACE_BIND_BATTERY_VOLTAGE },
+    { "bluetooth_messages", WATCHFACE_BIND_BLUETOOTH_MESSAGES },
+    { "steps", WATCHFACE_BIND_STEPS },
+    { "expr", WATCHFACE_BIND_EXPR },
+    { "time_hour", WATCHFACE_BIND_TIME_HOUR },
+    { "time_min", WATCHFACE_BIND_TIME_MIN },
+    { "time_sec", WATCHFACE_BIND_TIME_SEC }
+};
 /**
  * default watchface
  */
@@ -127,14 +165,16 @@ static void exit_watchface_app_tile_event_cb( lv_obj_t * obj, lv_event_t event )
 void watchface_app_tile_update_task( lv_task_t *task );
 bool watchface_rtcctl_event_cb( EventBits_t event, void *arg );
 bool watchface_powermgm_event_cb( EventBits_t event, void *arg );
+bool watchface_powermgm_loop_cb( EventBits_t event, void *arg );
 void watchface_avtivate_cb( void );
 void watchface_hibernate_cb( void );
 void watchface_remove_theme_files ( void );
 lv_font_t *watchface_get_font( const char *font, int32_t font_size );
 lv_color_t watchface_get_color( char *color );
 lv_align_t watchface_get_align( char *align );
-void watchface_app_label_update( tm &info );
-void watchface_app_image_update( tm &info );
+void watchface_app_label_update( tm &info, uint32_t dirty );
+void watchface_app_image_update( tm &info, uint32_t dirty );
+void watchface_compile_bindings( void );
 
 void watchface_tile_setup( void ) {
     watchface_app_tile_num = mainbar_add_app_tile( 1, 1, "WatchFace Tile" );
@@ -271,6 +311,7 @@ void watchface_tile_setup( void ) {
      * setup powermgm and touch callback function
      */
     powermgm_register_cb( POWERMGM_STANDBY, watchface_powermgm_event_cb, "watchface powermgm" );
+    powermgm_register_loop_cb( POWERMGM_WAKEUP, watchface_powermgm_loop_cb, "watchface loop" );
     /**
      * setup watchface background task
      */
@@ -598,6 +639,7 @@ void watchface_reload_theme( void ) {
      * write clear json back
      */
     watchface_theme_config->save( 32000 );
+    watchface_compile_bindings();
     watchface_app_tile_update();
     lv_img_cache_set_size(250);
     lv_obj_invalidate( lv_scr_act() );
@@ -809,11 +851,25 @@ bool watchface_powermgm_event_cb( EventBits_t event, void *arg ) {
     return( true );
 }
 
+bool watchface_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    /**
+     * run the update task when a producer has changed a source the watchface depends on
+     */
+    if ( watchface_active && ( watchface_expr_get_dirty() & watchface_sources ) )
+        lv_task_ready( watchface_tile_task );
+    return( true );
+}
+
 void watchface_avtivate_cb( void ) {
     /**
      * set watchface active flag
      */
     watchface_active = true;
+    /**
+     * redraw all elements now
+     */
+    watchface_dirty = WATCHFACE_SRC_ALL;
+    lv_task_ready( watchface_tile_task );
     /**
      * save block show messages state
      */
@@ -831,190 +887,395 @@ void watchface_hibernate_cb( void ) {
     powermgm_set_normal_mode();
 }
 
+/**
+ * @brief count a redrawn element in the stats
+ * 
+ * @param obj       redrawn object
+ */
+static void watchface_count_redraw( lv_obj_t *obj ) {
+    watchface_stats.redraws++;
+    watchface_stats.redraw_px += lv_obj_get_width( obj ) * lv_obj_get_height( obj );
+}
+
+/**
+ * @brief set an image angle on change
+ * 
+ * @param img       image object
+ * @param angle     new angle
+ */
+static void watchface_set_angle( lv_obj_t *img, int32_t angle ) {
+    if ( lv_img_get_angle( img ) == angle )
+        return;
+
+    lv_img_set_angle( img, angle );
+    if ( !lv_obj_get_hidden( img ) )
+        watchface_count_redraw( img );
+}
+
 void watchface_app_tile_update( void ) {
 	if ( watchface_active ) {
+        uint32_t start = micros();
         tm info;
         time_t now;
         time(&now);
         localtime_r( &now, &info );
+        /**
+         * collect the changed sources, forced ones, producer events and time
+         */
+        uint32_t dirty = watchface_dirty | watchface_expr_get_dirty();
+        int32_t minute = ( info.tm_yday * 24 + info.tm_hour ) * 60 + info.tm_min;
+
+        watchface_dirty = 0;
+        watchface_expr_clear_dirty( dirty );
+        if ( info.tm_sec != watchface_last_sec )
+            dirty |= WATCHFACE_SRC_SEC;
+        if ( minute != watchface_last_min )
+            dirty |= WATCHFACE_SRC_MIN;
+        watchface_last_sec = info.tm_sec;
+        watchface_last_min = minute;
 
         // Update global context
         watchface_expr_update( info );
 
-        //Angle calculation for Hands
-        int Angle_S = (int)((info.tm_sec % 60) * 60 );
-        int Angle_M = (int)((info.tm_min % 60) * 60 ) + ( watchface_theme_config->dial.min.smooth ? (int)(info.tm_sec % 60) : 0 );
-        int Angle_H = (int)((info.tm_hour % 12 ) * 300 ) + (int)((info.tm_min % 60 ) * 5);
+        if ( dirty & watchface_hand_sources ) {
+            //Angle calculation for Hands
+            int Angle_S = (int)((info.tm_sec % 60) * 60 );
+            int Angle_M = (int)((info.tm_min % 60) * 60 ) + ( watchface_theme_config->dial.min.smooth ? (int)(info.tm_sec % 60) : 0 );
+            int Angle_H = (int)((info.tm_hour % 12 ) * 300 ) + (int)((info.tm_min % 60 ) * 5);
+
+            while (Angle_S >= 3600)
+                Angle_S = Angle_S - 3600;
+            while (Angle_M >= 3600)
+                Angle_M = Angle_M - 3600;
+            while (Angle_H >= 3600)
+                Angle_H = Angle_H - 3600;
+
+            watchface_set_angle( watchface_hour_img, Angle_H );
+            watchface_set_angle( watchface_min_img, Angle_M );
+            watchface_set_angle( watchface_sec_img, Angle_S );
+
+            watchface_set_angle( watchface_hour_s_img, Angle_H );
+            watchface_set_angle( watchface_min_s_img, Angle_M );
+            watchface_set_angle( watchface_sec_s_img, Angle_S );
+        }
+
+        watchface_app_label_update( info, dirty );
+        watchface_app_image_update( info, dirty );
+        /**
+         * sleep until the next second or the next minute
+         */
+        lv_task_set_period( watchface_tile_task, ( watchface_sources & WATCHFACE_SRC_SEC ) ? 1000 : ( 60 - info.tm_sec ) * 1000 );
+        /**
+         * update stats
+         */
+        uint32_t update_us = micros() - start;
+        watchface_stats.wakeups++;
+        watchface_stats.update_sum_us += update_us;
+        if ( update_us > watchface_stats.update_max_us )
+            watchface_stats.update_max_us = update_us;
+        if ( lv_tick_elaps( watchface_stats.start ) >= WATCHFACE_STATS_PERIOD ) {
+            WATCHFACE_LOG("%d wakeups, %d redraws, %dpx redrawn, update %uus mean, %uus max", watchface_stats.wakeups, watchface_stats.redraws, watchface_stats.redraw_px, watchface_stats.update_sum_us / watchface_stats.wakeups, watchface_stats.update_max_us );
+            memset( &watchface_stats, 0, sizeof( watchface_stats ) );
+            watchface_stats.start = lv_tick_get();
+        }
+    }
+}
+
+void watchface_tile_get_stats( watchface_stats_t *stats ) {
+    *stats = watchface_stats;
+}
+
+/**
+ * @brief get the binding of a type name from the theme config
+ * 
+ * @param type      type name
+ * @return  binding or WATCHFACE_BIND_NONE if unknown
+ */
+static watchface_bind_t watchface_get_bind_type( const char *type ) {
+    for( size_t i = 0 ; i < sizeof( watchface_bind_names ) / sizeof( watchface_bind_names[ 0 ] ) ; i++ ) {
+        if ( !strcmp( watchface_bind_names[ i ].name, type ) )
+            return( watchface_bind_names[ i ].type );
+    }
+    return( WATCHFACE_BIND_NONE );
+}
+
+/**
+ * @brief setup a binding for a label or image slot
+ * 
+ * @param binding   pointer to the binding
+ * @param slot      label or image number
+ * @param widget    pointer to the theme widget
+ * @return  true if the slot can be shown, false if it is always disabled
+ */
+static bool watchface_setup_binding( watchface_binding_t *binding, int32_t slot, watchface_widget_t *widget ) {
+    /**
+     * slots without enable are hidden on reload, constant enables are evaluated only once
+     */
+    if ( widget->enable == NULL )
+        return( false );
 
-        while (Angle_S >= 3600)
-            Angle_S = Angle_S - 3600;
-        while (Angle_M >= 3600)
-            Angle_M = Angle_M - 3600;
-        while (Angle_H >= 3600)
-            Angle_H = Angle_H - 3600;
+    binding->enable = widget->enable;
+    if ( watchface_expr_is_constant( widget->enable ) ) {
+        if ( !watchface_expr_eval( widget->enable ) )
+            return( false );
+        binding->enable = NULL;
+    }
+    binding->slot = slot;
+    binding->type = watchface_get_bind_type( widget->type );
+    binding->enabled = -1;
+    binding->hidden = -1;
+    binding->sources = watchface_expr_get_sources( binding->enable );
+    binding->align = LV_ALIGN_CENTER;
+    binding->text[ 0 ] = '\0';
+    binding->drawn = false;
 
-        lv_img_set_angle( watchface_hour_img, Angle_H );
-        lv_img_set_angle( watchface_min_img, Angle_M );
-        lv_img_set_angle( watchface_sec_img, Angle_S );
+    if ( widget->hide_interval )
+        binding->sources |= WATCHFACE_SRC_SEC;
 
-        lv_img_set_angle( watchface_hour_s_img, Angle_H );
-        lv_img_set_angle( watchface_min_s_img, Angle_M );
-        lv_img_set_angle( watchface_sec_s_img, Angle_S );
+    return( true );
+}
 
-        watchface_app_label_update( info );
-        watchface_app_image_update( info );
+/**
+ * @brief get the sources of a strftime format
+ * 
+ * @param format    strftime format
+ * @return  WATCHFACE_SRC_SEC if the format contains seconds, otherwise WATCHFACE_SRC_MIN
+ */
+static uint32_t watchface_get_date_sources( const char *format ) {
+    for( const char *c = strchr( format, '%' ) ; c && c[ 1 ] ; c = strchr( c + 2, '%' ) ) {
+        const char *conversion = c + 1;
+        /**
+         * skip E and O modifier
+         */
+        if ( ( *conversion == 'E' || *conversion == 'O' ) && conversion[ 1 ] )
+            conversion++;
+        if ( strchr( "STXcrs+", *conversion ) )
+            return( WATCHFACE_SRC_SEC );
     }
+    return( WATCHFACE_SRC_MIN );
 }
 
-void watchface_app_image_update( tm &info ) {
+void watchface_compile_bindings( void ) {
+    watchface_label_bindings = 0;
+    watchface_image_bindings = 0;
+    watchface_sources = 0;
+
+    for( int i = 0 ; i < WATCHFACE_LABEL_NUM ; i++ ) {
+        watchface_label_t *label = &watchface_theme_config->dial.label[ i ];
+        watchface_binding_t *binding = &watchface_label_binding[ watchface_label_bindings ];
+
+        if ( !watchface_setup_binding( binding, i, label ) )
+            continue;
+
+        if ( binding->type == WATCHFACE_BIND_EXPR && label->expr == NULL )
+            binding->type = WATCHFACE_BIND_NONE;
+        switch( binding->type ) {
+            case WATCHFACE_BIND_DATE:               binding->sources |= watchface_get_date_sources( label->label );
+                                                    break;
+            case WATCHFACE_BIND_BATTERY_PERCENT:
+            case WATCHFACE_BIND_BATTERY_VOLTAGE:    binding->sources |= WATCHFACE_SRC_BATTERY;
+                                                    break;
+            case WATCHFACE_BIND_BLUETOOTH_MESSAGES: binding->sources |= WATCHFACE_SRC_BLE_MSG;
+                                                    break;
+            case WATCHFACE_BIND_STEPS:              binding->sources |= WATCHFACE_SRC_STEPS;
+                                                    break;
+            case WATCHFACE_BIND_EXPR:               binding->sources |= watchface_expr_get_sources( label->expr );
+                                                    break;
+            default:                                break;
+        }
+        binding->align = watchface_get_align( label->align );
+        watchface_sources |= binding->sources;
+        watchface_label_bindings++;
+    }
+
     for( int i = 0 ; i < WATCHFACE_IMAGE_NUM ; i++ ) {
+        watchface_binding_t *binding = &watchface_image_binding[ watchface_image_bindings ];
+
+        if ( !watchface_setup_binding( binding, i, &watchface_theme_config->dial.image[ i ] ) )
+            continue;
+
+        switch( binding->type ) {
+            case WATCHFACE_BIND_BATTERY_PERCENT:
+            case WATCHFACE_BIND_BATTERY_VOLTAGE:    binding->sources |= WATCHFACE_SRC_BATTERY;
+                                                    break;
+            case WATCHFACE_BIND_TIME_SEC:           binding->sources |= WATCHFACE_SRC_SEC;
+                                                    break;
+            case WATCHFACE_BIND_TIME_MIN:
+            case WATCHFACE_BIND_TIME_HOUR:          binding->sources |= WATCHFACE_SRC_MIN;
+                                                    break;
+            default:                                break;
+        }
+        watchface_sources |= binding->sources;
+        watchface_image_bindings++;
+    }
+    /**
+     * hands, a smooth min hand moves every second
+     */
+    watchface_t *dial = &watchface_theme_config->dial;
+
+    watchface_hand_sources = 0;
+    if ( dial->hour.enable || dial->hour_shadow.enable || dial->min.enable || dial->min_shadow.enable )
+        watchface_hand_sources |= WATCHFACE_SRC_MIN;
+    if ( dial->sec.enable || dial->sec_shadow.enable || ( dial->min.smooth && ( dial->min.enable || dial->min_shadow.enable ) ) )
+        watchface_hand_sources |= WATCHFACE_SRC_SEC;
+    watchface_sources |= watchface_hand_sources;
+    /**
+     * redraw all on the next update
+     */
+    watchface_dirty = WATCHFACE_SRC_ALL;
+    WATCHFACE_LOG("compiled %d label and %d image bindings, sources 0x%02x", watchface_label_bindings, watchface_image_bindings, watchface_sources );
+}
+
+/**
+ * @brief evaluate the enable state of a binding and show or hide the container on change
+ * 
+ * @param binding   pointer to the binding
+ * @param cont      label or image container
+ * @return  true if enabled
+ */
+static bool watchface_binding_enabled( watchface_binding_t *binding, lv_obj_t *cont ) {
+    int8_t enabled = binding->enable ? watchface_expr_eval( binding->enable ) != 0 : true;
+
+    if ( enabled != binding->enabled ) {
+        lv_obj_set_hidden( cont, !enabled );
+        watchface_count_redraw( cont );
+        binding->enabled = enabled;
+    }
+    return( enabled );
+}
+
+/**
+ * @brief get the hide state of a hide interval
+ * 
+ * a positive hide interval means hide/show toggle interval
+ * a negative hide interval means show/hide toggle interval
+ * 
+ * @param hide_interval     hide interval in seconds, 0 means never hide
+ * @param info              current time
+ * @return  true if hidden
+ */
+static bool watchface_get_hidden( int32_t hide_interval, tm &info ) {
+    if ( !hide_interval )
+        return( false );
+
+    bool odd = ( info.tm_sec / abs( hide_interval ) ) % 2;
+
+    return( hide_interval > 0 ? odd : !odd );
+}
+
+/**
+ * @brief set the hide state of an object on change
+ * 
+ * @param binding   pointer to the binding
+ * @param obj       label or image
+ * @param hidden    new hide state
+ */
+static void watchface_binding_set_hidden( watchface_binding_t *binding, lv_obj_t *obj, bool hidden ) {
+    if ( (int8_t)hidden != binding->hidden ) {
+        lv_obj_set_hidden( obj, hidden );
+        watchface_count_redraw( obj );
+        binding->hidden = hidden;
+    }
+}
+
+void watchface_app_image_update( tm &info, uint32_t dirty ) {
+    for( int i = 0 ; i < watchface_image_bindings ; i++ ) {
+        watchface_binding_t *binding = &watchface_image_binding[ i ];
+        watchface_image_t *image = &watchface_theme_config->dial.image[ binding->slot ];
+        lv_obj_t *obj = watchface_image[ binding->slot ];
+        int32_t angle = 0;
         /**
-         * check if label enabled
+         * skip image if none of its sources has changed
          */
-        if ( watchface_theme_config->dial.image[ i ].enable != NULL && watchface_expr_eval( watchface_theme_config->dial.image[ i ].enable ) ) {
-            int32_t angle = 0;
-            /**
-             * check label type
-             */
-            if ( !strcmp( "battery_percent", watchface_theme_config->dial.image[ i ].type ) ) {
-                angle = watchface_theme_config->dial.image[ i ].rotation_start + ( ( pmu_get_battery_percent() * watchface_theme_config->dial.image[ i ].rotation_range ) / 100 );
-            }
-            if ( !strcmp( "battery_voltage", watchface_theme_config->dial.image[ i ].type ) ) {
-                angle = watchface_theme_config->dial.image[ i ].rotation_start + ( ( ( pmu_get_battery_voltage() / 1000 ) * watchface_theme_config->dial.image[ i ].rotation_range ) / 5 );
-            }
-            else if ( !strcmp( "time_hour", watchface_theme_config->dial.image[ i ].type ) ) {
-                angle = watchface_theme_config->dial.image[ i ].rotation_start + ( ( info.tm_hour * watchface_theme_config->dial.image[ i ].rotation_range ) / 24 );
-            }
-            else if ( !strcmp( "time_min", watchface_theme_config->dial.image[ i ].type ) ) {
-                angle = watchface_theme_config->dial.image[ i ].rotation_start + ( ( info.tm_min * watchface_theme_config->dial.image[ i ].rotation_range ) / 60 );
-            }
-            else if ( !strcmp( "time_sec", watchface_theme_config->dial.image[ i ].type ) ) {
-                angle = watchface_theme_config->dial.image[ i ].rotation_start + ( ( info.tm_sec * watchface_theme_config->dial.image[ i ].rotation_range ) / 60 );
-            }
-            angle = angle % 3600;
-            lv_img_set_angle( watchface_image[ i ], angle );
-            /**
-             * check toggle option
-             */
-            if ( watchface_theme_config->dial.image[ i ].hide_interval ) {
-                /**
-                 * temp toggle value
-                 */
-                int32_t hide_interval = watchface_theme_config->dial.image[ i ].hide_interval;
-                if ( hide_interval < 0 ) {
-                    hide_interval = abs( hide_interval );
-                }
-                /**
-                 * toggle hide depend
-                 * 
-                 * a positive hide interval means hide/show toggle interval
-                 * a negative hide interval means show/hide toggle interval                    
-                 */
-                if ( ( info.tm_sec / hide_interval ) % 2 ) {
-                    /**
-                     */
-                    if ( watchface_theme_config->dial.image[ i ].hide_interval > 0 ) {
-                        lv_obj_set_hidden( watchface_image[ i ], true );
-                    }
-                    else {
-                        lv_obj_set_hidden( watchface_image[ i ], false );
-                    }
-                }
-                else {
-                    if ( watchface_theme_config->dial.label[ i ].hide_interval > 0 ) {
-                        lv_obj_set_hidden( watchface_image[ i ], false );
-                    }
-                    else {
-                        lv_obj_set_hidden( watchface_image[ i ], true );
-                    }
-                }
-            }
-            else {
-                lv_obj_set_hidden( watchface_image[ i ], false );                
-            }
+        if ( binding->enabled != -1 && !( binding->sources & dirty ) )
+            continue;
+        /**
+         * check if image enabled
+         */
+        if ( !watchface_binding_enabled( binding, lv_obj_get_parent( obj ) ) )
+            continue;
+        /**
+         * get image angle
+         */
+        switch( binding->type ) {
+            case WATCHFACE_BIND_BATTERY_PERCENT:
+                angle = image->rotation_start + ( ( pmu_get_battery_percent() * image->rotation_range ) / 100 );
+                break;
+            case WATCHFACE_BIND_BATTERY_VOLTAGE:
+                angle = image->rotation_start + ( ( ( pmu_get_battery_voltage() / 1000 ) * image->rotation_range ) / 5 );
+                break;
+            case WATCHFACE_BIND_TIME_HOUR:
+                angle = image->rotation_start + ( ( info.tm_hour * image->rotation_range ) / 24 );
+                break;
+            case WATCHFACE_BIND_TIME_MIN:
+                angle = image->rotation_start + ( ( info.tm_min * image->rotation_range ) / 60 );
+                break;
+            case WATCHFACE_BIND_TIME_SEC:
+                angle = image->rotation_start + ( ( info.tm_sec * image->rotation_range ) / 60 );
+                break;
+            default:
+                break;
         }
+        watchface_set_angle( obj, angle % 3600 );
+        watchface_binding_set_hidden( binding, obj, watchface_get_hidden( image->hide_interval, info ) );
     }
 }
 
-void watchface_app_label_update( tm &info ) {
-    for( int i = 0 ; i < WATCHFACE_LABEL_NUM ; i++ ) {
-        char temp_str[ 64 ] = "";
+void watchface_app_label_update( tm &info, uint32_t dirty ) {
+    for( int i = 0 ; i < watchface_label_bindings ; i++ ) {
+        watchface_binding_t *binding = &watchface_label_binding[ i ];
+        watchface_label_t *label = &watchface_theme_config->dial.label[ binding->slot ];
+        lv_obj_t *obj = watchface_label[ binding->slot ];
+        char temp_str[ WATCHFACE_BIND_TEXT_SIZE ] = "";
+        /**
+         * skip label if none of its sources has changed
+         */
+        if ( binding->enabled != -1 && !( binding->sources & dirty ) )
+            continue;
         /**
          * check if label enabled
          */
-        if ( watchface_theme_config->dial.label[ i ].enable != NULL && watchface_expr_eval( watchface_theme_config->dial.label[ i ].enable ) ) {
-            /**
-             * check label type
-             */
-            if ( !strcmp( "date", watchface_theme_config->dial.label[ i ].type ) ) {
-                strftime( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, &info );
-            }
-            else if ( !strcmp( "text", watchface_theme_config->dial.label[ i ].type ) ) {
-                snprintf( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, NULL );
-            }
-            else if ( !strcmp( "battery_percent", watchface_theme_config->dial.label[ i ].type ) ) {
-                snprintf( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, pmu_get_battery_percent() );
-            }
-            else if ( !strcmp( "battery_voltage", watchface_theme_config->dial.label[ i ].type ) ) {
-                snprintf( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, pmu_get_battery_voltage() / 1000 );
-            }
-            else if ( !strcmp( "bluetooth_messages", watchface_theme_config->dial.label[ i ].type ) ) {
-                snprintf( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, bluetooth_get_number_of_msg() );
-            }
-            else if ( !strcmp( "steps", watchface_theme_config->dial.label[ i ].type ) ) {
-                snprintf( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, bma_get_stepcounter() );
-            }
-            else if ( !strcmp( "expr", watchface_theme_config->dial.label[ i ].type ) && watchface_theme_config->dial.label[ i ].expr != NULL ) {
-                double val = watchface_expr_eval(watchface_theme_config->dial.label[ i ].expr);
-                snprintf( temp_str, sizeof( temp_str ), watchface_theme_config->dial.label[ i ].label, val );
-            }
-            else {
+        if ( !watchface_binding_enabled( binding, lv_obj_get_parent( obj ) ) )
+            continue;
+        /**
+         * get label text
+         */
+        switch( binding->type ) {
+            case WATCHFACE_BIND_DATE:
+                strftime( temp_str, sizeof( temp_str ), label->label, &info );
+                break;
+            case WATCHFACE_BIND_TEXT:
+                snprintf( temp_str, sizeof( temp_str ), label->label, NULL );
+                break;
+            case WATCHFACE_BIND_BATTERY_PERCENT:
+                snprintf( temp_str, sizeof( temp_str ), label->label, pmu_get_battery_percent() );
+                break;
+            case WATCHFACE_BIND_BATTERY_VOLTAGE:
+                snprintf( temp_str, sizeof( temp_str ), label->label, pmu_get_battery_voltage() / 1000 );
+                break;
+            case WATCHFACE_BIND_BLUETOOTH_MESSAGES:
+                snprintf( temp_str, sizeof( temp_str ), label->label, bluetooth_get_number_of_msg() );
+                break;
+            case WATCHFACE_BIND_STEPS:
+                snprintf( temp_str, sizeof( temp_str ), label->label, bma_get_stepcounter() );
+                break;
+            case WATCHFACE_BIND_EXPR:
+                snprintf( temp_str, sizeof( temp_str ), label->label, watchface_expr_eval( label->expr ) );
+                break;
+            default:
                 snprintf( temp_str, sizeof( temp_str ), "n/a" );
-            }
-            /**
-             * check toggle option
-             */
-            if ( watchface_theme_config->dial.label[ i ].hide_interval ) {
-                /**
-                 * temp toggle value
-                 */
-                int32_t hide_interval = watchface_theme_config->dial.label[ i ].hide_interval;
-                if ( hide_interval < 0 ) {
-                    hide_interval = abs( hide_interval );
-                }
-                /**
-                 * toggle hide depend
-                 * 
-                 * a positive hide interval means hide/show toggle interval
-                 * a negative hide interval means show/hide toggle interval                    
-                 */
-                if ( ( info.tm_sec / hide_interval ) % 2 ) {
-                    /**
-                     */
-                    if ( watchface_theme_config->dial.label[ i ].hide_interval > 0 ) {
-                        lv_obj_set_hidden( watchface_label[ i ], true );
-                    }
-                    else {
-                        lv_obj_set_hidden( watchface_label[ i ], false );
-                    }
-                }
-                else {
-                    if ( watchface_theme_config->dial.label[ i ].hide_interval > 0 ) {
-                        lv_obj_set_hidden( watchface_label[ i ], false );
-                    }
-                    else {
-                        lv_obj_set_hidden( watchface_label[ i ], true );
-                    }
-                }
-            }
-            else {
-                lv_obj_set_hidden( watchface_label[ i ], false );                
-            }
-            /**
-             * align label
-             */
-            lv_label_set_text( watchface_label[ i ], temp_str );
-            lv_obj_align( watchface_label[ i ], lv_obj_get_parent( watchface_label[ i ] ), watchface_get_align( watchface_theme_config->dial.label[ i ].align ), 0, 0 );
+                break;
+        }
+        watchface_binding_set_hidden( binding, obj, watchface_get_hidden( label->hide_interval, info ) );
+        /**
+         * set and align label only if the text has changed
+         */
+        if ( !binding->drawn || strcmp( temp_str, binding->text ) ) {
+            strncpy( binding->text, temp_str, sizeof( binding->text ) );
+            lv_label_set_text( obj, temp_str );
+            lv_obj_align( obj, lv_obj_get_parent( obj ), binding->align, 0, 0 );
+            watchface_count_redraw( lv_obj_get_parent( obj ) );
+            binding->drawn = true;
         }
     }
 }
@@ -22,7 +22,53 @@
 #ifndef _WATCHFACE_APP_TILE_H
     #define _WATCHFACE_APP_TILE_H
 
+    #include "lvgl.h"
+    #include "utils/tinyexpr/tinyexpr.h"
+
     #define WATCHFACE_LOG                       log_d
+    #define WATCHFACE_BIND_TEXT_SIZE            64      /** @brief max label text size */
+    #define WATCHFACE_STATS_PERIOD              3600000 /** @brief log the update stats every n ms */
+    /**
+     * @brief value a watchface label or image is bound to
+     */
+    typedef enum {
+        WATCHFACE_BIND_NONE = 0,
+        WATCHFACE_BIND_DATE,
+        WATCHFACE_BIND_TEXT,
+        WATCHFACE_BIND_BATTERY_PERCENT,
+        WATCHFACE_BIND_BATTERY_VOLTAGE,
+        WATCHFACE_BIND_BLUETOOTH_MESSAGES,
+        WATCHFACE_BIND_STEPS,
+        WATCHFACE_BIND_EXPR,
+        WATCHFACE_BIND_TIME_HOUR,
+        WATCHFACE_BIND_TIME_MIN,
+        WATCHFACE_BIND_TIME_SEC
+    } watchface_bind_t;
+    /**
+     * @brief watchface label or image binding, compiled from the theme on reload
+     */
+    typedef struct {
+        int32_t slot;                                   /** @brief label or image number in the theme */
+        watchface_bind_t type;                          /** @brief bound value */
+        te_expr *enable;                                /** @brief enable expression, NULL if always enabled */
+        int8_t enabled;                                 /** @brief last enable state, -1 if not drawn */
+        int8_t hidden;                                  /** @brief last hide interval state, -1 if not drawn */
+        uint32_t sources;                               /** @brief WATCHFACE_SRC_* sources the element depends on */
+        lv_align_t align;                               /** @brief label align */
+        char text[ WATCHFACE_BIND_TEXT_SIZE ];          /** @brief last label text */
+        bool drawn;                                     /** @brief label text is drawn */
+    } watchface_binding_t;
+    /**
+     * @brief watchface update stats
+     */
+    typedef struct {
+        uint32_t start;                                 /** @brief lvgl tick at the start of the stats period */
+        uint32_t wakeups;                               /** @brief update task runs */
+        uint32_t redraws;                               /** @brief redrawn elements */
+        uint32_t redraw_px;                             /** @brief sum of the redrawn element areas */
+        uint32_t update_sum_us;                         /** @brief sum of the update times */
+        uint32_t update_max_us;                         /** @brief max update time */
+    } watchface_stats_t;
     /**
      * @brief watchface tile setup
      */
@@ -67,5 +113,11 @@
      * @param   enable  true enable antialias
      */
     void watchface_tile_set_antialias( bool enable );
+    /**
+     * @brief get the update stats of the current stats period
+     * 
+     * @param   stats   pointer to a watchface_stats_t structure
+     */
+    void watchface_tile_get_stats( watchface_stats_t *stats );
 
 #endif // _WATCHFACE_APP_TILE_H
\ No newline at end of file
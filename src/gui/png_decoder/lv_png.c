@@ -14,6 +14,7 @@
 
 #include "lv_png.h"
 #include "lodepng.h"
+#include "utils/alloc.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -80,6 +81,29 @@ void lv_4grey_as_png( const char* filename, const unsigned char* image, unsigned
     if(error) printf("error %u: %s\n", error, lodepng_error_text(error));
 }
 
+uint8_t * lv_png_decode_true_color( const uint8_t * png, size_t png_size, uint32_t * w, uint32_t * h ) {
+    unsigned char * rgb = NULL;
+    unsigned png_width, png_height;
+
+    unsigned error = lodepng_decode24( &rgb, &png_width, &png_height, png, png_size );
+    if(error) {
+        printf("error %u: %s\n", error, lodepng_error_text(error));
+        return NULL;
+    }
+
+    lv_color_t * img = MALLOC( png_width * png_height * sizeof( lv_color_t ) );
+    if(img) {
+        uint32_t i;
+        for(i = 0; i < png_width * png_height; i++) {
+            img[i] = lv_color_make( rgb[i*3 + 0], rgb[i*3 + 1], rgb[i*3 + 2] );
+        }
+        *w = png_width;
+        *h = png_height;
+    }
+    free( rgb );
+    return (uint8_t *)img;
+}
+
 /**
  * Get info about a PNG image
  * @param src can be file name or pointer to a C array
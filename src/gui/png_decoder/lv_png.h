@@ -13,6 +13,8 @@ extern "C" {
 /*********************
  *      INCLUDES
  *********************/
+#include <stdint.h>
+#include <stddef.h>
 
 /*********************
  *      DEFINES
@@ -34,6 +36,15 @@ void lv_rgb_as_png( const char* filename, const unsigned char* image, unsigned i
 void lv_rgba_as_png( const char* filename, const unsigned char* image, unsigned int w, unsigned int h );
 void lv_8grey_as_png( const char* filename, const unsigned char* image, unsigned int w, unsigned int h );
 void lv_4grey_as_png( const char* filename, const unsigned char* image, unsigned int w, unsigned int h );
+/**
+ * Decode a PNG from memory into the display color format for LV_IMG_CF_TRUE_COLOR
+ * @param png pointer to the PNG data
+ * @param png_size size of the PNG data in bytes
+ * @param w store the image width here
+ * @param h store the image height here
+ * @return pointer to the pixels, release it with free(), NULL if failed
+ */
+uint8_t * lv_png_decode_true_color( const uint8_t * png, size_t png_size, uint32_t * w, uint32_t * h );
 
 /**********************
  *      MACROS
@@ -43,6 +43,8 @@
 #include "gui/widget_styles.h"
 #include "gui/mainbar/mainbar.h"
 
+#include "utils/frametime.h"
+
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
 #else
@@ -65,6 +67,7 @@ static lv_obj_t *statusbar_wifiiplabel = NULL;
 static lv_obj_t *statusbar_bluetooth = NULL;
 static lv_obj_t *statusbar_gps = NULL;
 static lv_obj_t *statusbar_stepcounterlabel = NULL;
+static lv_obj_t *statusbar_frametimelabel = NULL;
 static lv_obj_t *statusbar_volume_slider = NULL;
 static lv_obj_t *statusbar_brightness_slider = NULL;
 static lv_obj_t *statusbar_sound_icon = NULL;
@@ -265,6 +268,13 @@ void statusbar_setup( void )
     lv_label_set_text( statusbar_stepcounterlabel, "0");
     lv_obj_align( statusbar_stepcounterlabel, statusbar, LV_ALIGN_IN_LEFT_MID, 5, 0 );
 
+    statusbar_frametimelabel = lv_label_create(statusbar, NULL );
+    lv_obj_reset_style_list( statusbar_frametimelabel, LV_OBJ_PART_MAIN );
+    lv_obj_add_style( statusbar_frametimelabel, LV_OBJ_PART_MAIN, &statusbarstyle[ STATUSBAR_STYLE_YELLOW ] );
+    lv_label_set_text( statusbar_frametimelabel, "");
+    lv_obj_align( statusbar_frametimelabel, statusbar_stepcounterlabel, LV_ALIGN_OUT_RIGHT_MID, 8, 0 );
+    lv_obj_set_hidden( statusbar_frametimelabel, true );
+
     lv_obj_t *statusbar_volume_cont = lv_obj_create( statusbar, NULL );
     lv_obj_add_style( statusbar_volume_cont, LV_OBJ_PART_MAIN, &style );
     lv_obj_set_size( statusbar_volume_cont, lv_disp_get_hor_res( NULL ) , 36 );
@@ -359,6 +369,29 @@ void statusbar_update_task( lv_task_t * task ) {
         statusbar_refresh();
         statusbar_refresh_update = false;
     }
+    /*
+     * frame time overlay, fps and mean render/flush time in ms
+     */
+    if ( frametime_get_overlay() ) {
+        frametime_summary_t summary;
+        char frametime[32] = "";
+        frametime_get_summary( &summary );
+        snprintf( frametime, sizeof( frametime ), "%dfps %d.%d/%d.%dms", summary.fps, summary.render_mean_us / 1000, ( summary.render_mean_us / 100 ) % 10, summary.flush_mean_us / 1000, ( summary.flush_mean_us / 100 ) % 10 );
+        /*
+         * only touch the label when the text changes, a new text invalidates
+         * the statusbar area and costs a redraw of its own
+         */
+        if ( strcmp( lv_label_get_text( statusbar_frametimelabel ), frametime ) ) {
+            lv_label_set_text( statusbar_frametimelabel, frametime );
+            lv_obj_align( statusbar_frametimelabel, statusbar_stepcounterlabel, LV_ALIGN_OUT_RIGHT_MID, 8, 0 );
+        }
+        if ( lv_obj_get_hidden( statusbar_frametimelabel ) ) {
+            lv_obj_set_hidden( statusbar_frametimelabel, false );
+        }
+    }
+    else if ( !lv_obj_get_hidden( statusbar_frametimelabel ) ) {
+        lv_obj_set_hidden( statusbar_frametimelabel, true );
+    }
 }
 
 bool statusbar_style_event_cb( EventBits_t event, void *arg ) {
@@ -534,6 +567,7 @@ bool statusbar_bmactl_event_cb( EventBits_t event, void *arg ) {
     switch( event ) {
         case BMACTL_STEPCOUNTER:    snprintf( stepcounter, sizeof( stepcounter ), "%d", *(uint32_t *)arg );
                                     lv_label_set_text( statusbar_stepcounterlabel, stepcounter );
+                                    lv_obj_align( statusbar_frametimelabel, statusbar_stepcounterlabel, LV_ALIGN_OUT_RIGHT_MID, 8, 0 );
                                     break;
     }
     return( true );
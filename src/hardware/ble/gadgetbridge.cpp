@@ -34,6 +34,19 @@
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
     #include "utils/millis.h"
+    /**
+     * millis() on the emulator counts seconds, the benchmark runs on a simulated clock
+     */
+    #ifdef GADGETBRIDGE_TX_BENCHMARK
+        static uint64_t gadgetbridge_fake_link_clock = 0;               /** @brief simulated time in us */
+        #define gadgetbridge_millis()       ( gadgetbridge_fake_link_clock / 1000 )
+    #else
+        #define gadgetbridge_millis()       ( micros() / 1000 )
+    #endif
+
+    static char *gadgetbridge_msg_transmit_queue[ GADGETBRIDGE_TX_QUEUE + 1 ];   /** @brief gadgetbridge transmit message ring */
+    static size_t gadgetbridge_msg_transmit_head = 0;                   /** @brief next free ring slot */
+    static size_t gadgetbridge_msg_transmit_tail = 0;                   /** @brief next msg to send */
 #else
     #if defined( M5PAPER )
     #elif defined( M5CORE2 )
@@ -47,20 +60,65 @@
     #include <Arduino.h>
     #include "NimBLEDescriptor.h"
 
+    #define gadgetbridge_millis()           millis()
+
     QueueHandle_t gadgetbridge_msg_transmit_queue;                      /** @brief gadgetbridge transmit message queue */
-    QueueHandle_t gadgetbridge_msg_receive_queue;                       /** @brief gadgetbridge receive message queue */
+    static portMUX_TYPE gadgetbridge_rx_mux = portMUX_INITIALIZER_UNLOCKED;    /** @brief guards the rx buffer between ble task and loop */
 #endif
+/**
+ * @brief notify result for the pending chunk
+ */
+typedef enum {
+    GADGETBRIDGE_TX_SENT = 0,                                           /** @brief chunk queued by the ble stack */
+    GADGETBRIDGE_TX_CONGESTED,                                          /** @brief no tx buffer left, retry the chunk later */
+    GADGETBRIDGE_TX_FAILED                                              /** @brief notify failed, drop the msg */
+} gadgetbridge_tx_status_t;
+/**
+ * @brief json key filter for one msg type
+ */
+typedef struct {
+    char type[ GADGETBRIDGE_RX_TYPE_SIZE ];                             /** @brief value of the "t" key */
+    bool all;                                                           /** @brief a subscriber needs all keys */
+    SpiRamJsonDocument *filter;                                         /** @brief keys to keep */
+} gadgetbridge_json_filter_t;
 /**
  * local buffer and callback table
  */
 static blectl_msg_t gadgetbridge_msg;                                   /** @brief gadgetbridge chunk message buffer */
 static callback_t *gadgetbridge_callback = NULL;                        /** @brief gadgetbridge callback structure */
-static CharBuffer gadgetbridge_RX_msg;                                  /** @brief RX msg buffer */
+static char *gadgetbridge_rx_buffer = NULL;                             /** @brief rx buffer, complete msgs are parsed in place */
+static size_t gadgetbridge_rx_len = 0;                                  /** @brief bytes in the rx buffer */
+static size_t gadgetbridge_rx_scan = 0;                                 /** @brief bytes already checked for framing */
+static size_t gadgetbridge_rx_start = 0;                                /** @brief start of the current msg in the rx buffer */
+static bool gadgetbridge_rx_overflow = false;                           /** @brief rx buffer was full and bytes got lost */
+static size_t gadgetbridge_rx_lost_first = 0;                           /** @brief buffer offset of the first lost bytes, set by the ble task */
+static size_t gadgetbridge_rx_lost_last = 0;                            /** @brief buffer offset of the last lost bytes, set by the ble task */
+static bool gadgetbridge_rx_drop = false;                               /** @brief drop the msgs that span the lost bytes */
+static size_t gadgetbridge_rx_drop_first = 0;                           /** @brief msgs ending at or after this offset are incomplete */
+static size_t gadgetbridge_rx_drop_last = 0;                            /** @brief the first msg ending at or after this offset is the last incomplete one */
+static BluetoothJsonRequest *gadgetbridge_rx_request = NULL;            /** @brief pooled json document for received msgs */
+static gadgetbridge_json_filter_t gadgetbridge_json_filter[ GADGETBRIDGE_RX_FILTER_MAX ];   /** @brief json key filter table */
+static int32_t gadgetbridge_json_filters = 0;                           /** @brief used json key filter entrys */
+static uint32_t gadgetbridge_tx_backoff = 0;                            /** @brief retry delay in ms after congestion, 0 if not congested */
+static uint64_t gadgetbridge_tx_retry = 0;                              /** @brief time in ms for the next try after congestion */
 /**
  * local function declaration
  */
+static bool gadgetbridge_transmit_queue_send( char *msg );
+static char *gadgetbridge_transmit_queue_receive( void );
+static int32_t gadgetbridge_get_chunksize( void );
 static void gadgetbridge_send_next_msg( char *msg );
+static void gadgetbridge_send_msg_free( void );
 static void gadgetbridge_send_chunk( unsigned char *msg, int32_t len );
+static void gadgetbridge_send_status( gadgetbridge_tx_status_t status );
+static void gadgetbridge_send_loop( void );
+static bool gadgetbridge_receive_write( const uint8_t *data, size_t len );
+static void gadgetbridge_receive_loop( void );
+static void gadgetbridge_receive_msg( char *msg );
+static BluetoothJsonRequest *gadgetbridge_parse_json( char *json );
+static bool gadgetbridge_check_json( const char *json );
+static bool gadgetbridge_get_json_type( const char *json, char *type, size_t size );
+static gadgetbridge_json_filter_t *gadgetbridge_find_json_filter( const char *type );
 static bool gadgetbridge_send_event_cb( EventBits_t event, void *arg );
 static bool gadgetbridge_powermgm_loop_cb( EventBits_t event, void *arg );
 static bool gadgetbridge_blectl_event_cb( EventBits_t event, void *arg );
@@ -72,6 +130,27 @@ static bool gadgetbridge_blectl_event_cb( EventBits_t event, void *arg );
      */
     NimBLECharacteristic *pGadgetbridgeTXCharacteristic = NULL;         /** @brief TX Characteristic */
     NimBLECharacteristic *pGadgetbridgeRXCharacteristic = NULL;         /** @brief RX Characteristic */
+    /**
+     * @brief TX characteristic callback, NimBLE reports the notify result from within notify()
+     */
+    class TXCharacteristicCallbacks: public NimBLECharacteristicCallbacks {
+
+        void onStatus( NimBLECharacteristic* pCharacteristic, Status s, int code ) {
+            switch( s ) {
+                case SUCCESS_NOTIFY:    gadgetbridge_send_status( GADGETBRIDGE_TX_SENT );
+                                        break;
+                case ERROR_GATT:        if ( code == BLE_HS_ENOMEM || code == BLE_HS_EBUSY )
+                                            gadgetbridge_send_status( GADGETBRIDGE_TX_CONGESTED );
+                                        else
+                                            gadgetbridge_send_status( GADGETBRIDGE_TX_FAILED );
+                                        break;
+                default:                log_e("notify failed, status %d, code %d", s, code );
+                                        gadgetbridge_send_status( GADGETBRIDGE_TX_FAILED );
+                                        break;
+            }
+        };
+    };
+
     class CharacteristicCallbacks: public NimBLECharacteristicCallbacks {
 
         void onRead(NimBLECharacteristic* pCharacteristic){
@@ -80,39 +159,60 @@ static bool gadgetbridge_blectl_event_cb( EventBits_t event, void *arg );
         };
 
         void onWrite(NimBLECharacteristic* pCharacteristic) {
-            size_t msgLen = pCharacteristic->getValue().length();
-            const char *msg = pCharacteristic->getValue().c_str();
+            /**
+             * framing and parsing is done in place in the powermgm loop
+             */
+            NimBLEAttValue value = pCharacteristic->getValue();
 
-            for ( int i = 0 ; i < msgLen ; i++ ) {
-                switch( msg[ i ] ) {
-                    case EndofText:         gadgetbridge_RX_msg.clear();
-                                            gadgetbridge_send_event_cb( GADGETBRIDGE_CONNECT, (void *)"connected" );
-                                            break;
-                    case DataLinkEscape:    gadgetbridge_RX_msg.clear();
-                                            break;
-                    case LineFeed:          {
-                                                size_t size = strlen( gadgetbridge_RX_msg.c_str() ) + 1;
-                                                /*
-                                                 * Duplicate message
-                                                 */
-                                                char *buff = (char *)CALLOC_ASSERT( size, 1, "buff calloc failed" );
-                                                strlcpy( buff, gadgetbridge_RX_msg.c_str(), size );
-                                                /*
-                                                 * Send message
-                                                 */
-                                                powermgm_resume_from_ISR();
-                                                if ( xQueueSendFromISR( gadgetbridge_msg_receive_queue, &buff, 0 ) != pdTRUE )
-                                                    log_e("fail to send a receive BLE msg (%d bytes)", size );
-                                                gadgetbridge_RX_msg.clear();
-                                                break;
-                                            }
-                    default:                gadgetbridge_RX_msg.append( msg[ i ] );
-                }
-            }
+            if ( gadgetbridge_receive_write( value.data(), value.length() ) )
+                powermgm_resume_from_ISR();
         };
     };
 
     static CharacteristicCallbacks GadgetbridgeCallbacks;
+    static TXCharacteristicCallbacks GadgetbridgeTXCallbacks;
+#endif
+
+#if defined( NATIVE_64BIT ) && defined( GADGETBRIDGE_TX_BENCHMARK )
+    #define GADGETBRIDGE_FAKE_LINK_INTERVAL     15000           /** @brief connection interval in us */
+    #define GADGETBRIDGE_FAKE_LINK_PER_EVENT    4               /** @brief notifications the phone takes per connection event */
+    #define GADGETBRIDGE_FAKE_LINK_BUFFERS      12              /** @brief host tx buffers, a notify is congested when all are in use */
+    #define GADGETBRIDGE_FAKE_LINK_LOOP         5000            /** @brief powermgm loop period in us */
+    #define GADGETBRIDGE_FAKE_LINK_BURST        8               /** @brief msgs queued at once */
+    #define GADGETBRIDGE_FAKE_LINK_BURST_GAP    250000          /** @brief time between bursts in us */
+    #define GADGETBRIDGE_FAKE_LINK_MSGS         64              /** @brief msgs per benchmark run */
+    /**
+     * @brief fake ble link, a notify takes a host buffer which is released when
+     * the phone takes the packet at the next connection event
+     */
+    typedef struct {
+        uint8_t end[ GADGETBRIDGE_FAKE_LINK_BUFFERS ];          /** @brief true if the buffered packet ends a msg */
+        int32_t first;                                          /** @brief oldest buffered packet */
+        int32_t count;                                          /** @brief buffered packets */
+        uint64_t next_event;                                    /** @brief time of the next connection event in us */
+        uint64_t queued[ GADGETBRIDGE_FAKE_LINK_MSGS ];         /** @brief time in us each msg was queued */
+        uint64_t latency;                                       /** @brief summed queue to delivery time in us */
+        uint64_t latency_max;                                   /** @brief worst queue to delivery time in us */
+        uint64_t busy;                                          /** @brief time with msgs pending in us */
+        uint64_t fixed;                                         /** @brief time fixed BLECTL_CHUNKSIZE chunks every 50ms would need in us */
+        int32_t delivered;                                      /** @brief msgs received by the phone */
+        uint32_t notifies;                                      /** @brief accepted notifications */
+        uint32_t congested;                                     /** @brief notifications rejected for lack of buffers */
+        uint32_t bytes;                                         /** @brief payload bytes */
+    } gadgetbridge_fake_link_t;
+
+    static gadgetbridge_fake_link_t gadgetbridge_fake_link;
+    static void gadgetbridge_fake_link_notify( unsigned char *msg, int32_t len );
+    static void gadgetbridge_tx_benchmark( void );
+#endif
+
+#if defined( NATIVE_64BIT ) && defined( GADGETBRIDGE_RX_BENCHMARK )
+    #define GADGETBRIDGE_RX_BENCHMARK_RUNS      500             /** @brief runs per captured msg */
+
+    static uint32_t gadgetbridge_rx_benchmark_msgs = 0;         /** @brief json msgs seen by the benchmark subscriber */
+    static size_t gadgetbridge_rx_benchmark_usage = 0;          /** @brief json document memory usage of the last msg */
+    static bool gadgetbridge_rx_benchmark_cb( EventBits_t event, void *arg );
+    static void gadgetbridge_rx_benchmark( void );
 #endif
 
 void gadgetbridge_setup( void ) {
@@ -123,16 +223,19 @@ void gadgetbridge_setup( void ) {
     gadgetbridge_msg.msg = NULL;
     gadgetbridge_msg.msglen = 0;
     gadgetbridge_msg.msgpos = 0;
+    gadgetbridge_msg.chunklen = 0;
+    /**
+     * allocate receive buffer
+     */
+    gadgetbridge_rx_buffer = (char *)MALLOC_ASSERT( GADGETBRIDGE_RX_BUFFER, "rx buffer alloc failed" );
 
     #ifdef NATIVE_64BIT
     #else
         /**
          * allocate send and receive queue
          */
-        gadgetbridge_msg_transmit_queue = xQueueCreate( 5, sizeof( char * ) );
+        gadgetbridge_msg_transmit_queue = xQueueCreate( GADGETBRIDGE_TX_QUEUE, sizeof( char * ) );
         ASSERT( gadgetbridge_msg_transmit_queue, "Failed to allocate msg queue" );
-        gadgetbridge_msg_receive_queue = xQueueCreate( 5, sizeof( char * ) );
-        ASSERT( gadgetbridge_msg_receive_queue, "Failed to allocate msg receive queue" );
         /**
          * Create the BLE Service
          */
@@ -144,6 +247,7 @@ void gadgetbridge_setup( void ) {
          */
         pGadgetbridgeTXCharacteristic = pGadgetbridgeService->createCharacteristic( NimBLEUUID( GADGETBRIDGE_CHARACTERISTIC_UUID_TX ), NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::READ );
         pGadgetbridgeTXCharacteristic->addDescriptor( new NimBLE2904() );
+        pGadgetbridgeTXCharacteristic->setCallbacks( &GadgetbridgeTXCallbacks );
         pGadgetbridgeRXCharacteristic = pGadgetbridgeService->createCharacteristic( NimBLEUUID( GADGETBRIDGE_CHARACTERISTIC_UUID_RX ), NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::READ );
         pGadgetbridgeRXCharacteristic->setCallbacks( &GadgetbridgeCallbacks );
         pGadgetbridgeService->start();
@@ -157,6 +261,13 @@ void gadgetbridge_setup( void ) {
      */
     powermgm_register_loop_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP, gadgetbridge_powermgm_loop_cb, "powermgm blectl loop" );
     blectl_register_cb( BLECTL_DISCONNECT, gadgetbridge_blectl_event_cb, "blectl gadgetbridge event cb");
+
+    #if defined( NATIVE_64BIT ) && defined( GADGETBRIDGE_TX_BENCHMARK )
+        gadgetbridge_tx_benchmark();
+    #endif
+    #if defined( NATIVE_64BIT ) && defined( GADGETBRIDGE_RX_BENCHMARK )
+        gadgetbridge_rx_benchmark();
+    #endif
     return;
 }
 
@@ -215,58 +326,110 @@ bool gadgetbridge_send_loop_msg( const char *format, ... ) {
 
 bool gadgetbridge_send_msg( const char *format, ... ) {
     bool retval = false;
-
-    #ifdef NATIVE_64BIT
-    #else
+    /**
+     * check if we connected
+     */
+    if ( blectl_get_event( BLECTL_CONNECT | BLECTL_AUTHWAIT ) ) {
         /**
-         * check if we connected
+         * build new string
          */
-        if ( blectl_get_event( BLECTL_CONNECT | BLECTL_AUTHWAIT ) ) {
-            /**
-             * build new string
-             */
-            va_list args;
-            va_start(args, format);
-            char *buffer = NULL;
-            vasprintf( &buffer, format, args );
-            va_end(args);
-            /**
-             * if we have a string, send it via msg_queue
-             */
-            if( buffer ) {
-                if ( xQueueSend( gadgetbridge_msg_transmit_queue, &buffer, 0 ) != pdTRUE )
-                    log_e("fail to send msg");
-                else
-                    retval = true;
+        va_list args;
+        va_start(args, format);
+        char *buffer = NULL;
+        vasprintf( &buffer, format, args );
+        va_end(args);
+        /**
+         * if we have a string, send it via msg_queue, the transmit path frees it
+         */
+        if( buffer ) {
+            if ( !gadgetbridge_transmit_queue_send( buffer ) ) {
+                log_e("fail to send msg");
+                free( buffer );
             }
+            else
+                retval = true;
         }
-        else {
-            log_e("msg can't send while bluetooth is not connected");
-        }
-    #endif
+    }
+    else {
+        log_e("msg can't send while bluetooth is not connected");
+    }
     
     return retval;
 }
 
 /**
- * @brief put a message into gadgetbridge chunk buffer
+ * @brief put a msg into the transmit queue
  * 
- * @param msg   pointer to a msg
+ * @param msg   pointer to a malloc'ed msg
+ * @return      true if queued, false if the queue is full
  */
-static void gadgetbridge_send_next_msg( char *msg ) {
-    if ( !gadgetbridge_msg.active && blectl_get_event( BLECTL_CONNECT ) ) {
+static bool gadgetbridge_transmit_queue_send( char *msg ) {
+    #ifdef NATIVE_64BIT
+        size_t next = ( gadgetbridge_msg_transmit_head + 1 ) % ( GADGETBRIDGE_TX_QUEUE + 1 );
+
+        if ( next == gadgetbridge_msg_transmit_tail )
+            return( false );
+
+        gadgetbridge_msg_transmit_queue[ gadgetbridge_msg_transmit_head ] = msg;
+        gadgetbridge_msg_transmit_head = next;
+        return( true );
+    #else
+        return( xQueueSend( gadgetbridge_msg_transmit_queue, &msg, 0 ) == pdTRUE );
+    #endif
+}
+
+/**
+ * @brief get the next msg from the transmit queue
+ * 
+ * @return      pointer to the msg or NULL if the queue is empty
+ */
+static char *gadgetbridge_transmit_queue_receive( void ) {
+    char *msg = NULL;
+
+    #ifdef NATIVE_64BIT
+        if ( gadgetbridge_msg_transmit_tail != gadgetbridge_msg_transmit_head ) {
+            msg = gadgetbridge_msg_transmit_queue[ gadgetbridge_msg_transmit_tail ];
+            gadgetbridge_msg_transmit_tail = ( gadgetbridge_msg_transmit_tail + 1 ) % ( GADGETBRIDGE_TX_QUEUE + 1 );
+        }
+    #else
+        if ( xQueueReceive( gadgetbridge_msg_transmit_queue, &msg, 0 ) != pdTRUE )
+            msg = NULL;
+    #endif
 
-        size_t size = strlen( (const char*)msg ) + 1;
+    return( msg );
+}
 
-        if ( gadgetbridge_msg.msg == NULL )
-            gadgetbridge_msg.msg = (char *)CALLOC_ASSERT( size, 1, "blectl_msg.msg calloc failed" );
+/**
+ * @brief get the chunksize for the negotiated mtu
+ * 
+ * @return      chunksize in bytes, between BLECTL_CHUNKSIZE and GADGETBRIDGE_TX_CHUNK_MAX
+ */
+static int32_t gadgetbridge_get_chunksize( void ) {
+    int32_t chunksize = blectl_get_mtu() - 3;
 
-        strncpy( gadgetbridge_msg.msg, msg, size );
+    if ( chunksize < BLECTL_CHUNKSIZE )
+        chunksize = BLECTL_CHUNKSIZE;
+    else if ( chunksize > GADGETBRIDGE_TX_CHUNK_MAX )
+        chunksize = GADGETBRIDGE_TX_CHUNK_MAX;
+
+    return( chunksize );
+}
+
+/**
+ * @brief put a message into gadgetbridge chunk buffer
+ * 
+ * @param msg   pointer to a malloc'ed msg, owned by the chunk buffer from now on
+ */
+static void gadgetbridge_send_next_msg( char *msg ) {
+    if ( !gadgetbridge_msg.active && blectl_get_event( BLECTL_CONNECT ) ) {
+        gadgetbridge_msg.msg = msg;
         gadgetbridge_msg.active = true;
-        gadgetbridge_msg.msglen = size;
+        gadgetbridge_msg.msglen = strlen( (const char*)msg ) + 1;
         gadgetbridge_msg.msgpos = 0;
+        gadgetbridge_msg.chunklen = 0;
     }
     else {
+        free( msg );
         log_e("blectl is send another msg or not connected");
         gadgetbridge_send_event_cb( GADGETBRIDGE_MSG_SEND_ABORT , (char*)"msg send abort, blectl is send another msg or not connected" );
         return;
@@ -274,22 +437,121 @@ static void gadgetbridge_send_next_msg( char *msg ) {
 }
 
 /**
- * @brief send a msg chunk to gadgetbridge over ble
+ * @brief free the msg in the gadgetbridge chunk buffer
+ */
+static void gadgetbridge_send_msg_free( void ) {
+    if ( gadgetbridge_msg.msg )
+        free( gadgetbridge_msg.msg );
+
+    gadgetbridge_msg.msg = NULL;
+    gadgetbridge_msg.active = false;
+    gadgetbridge_msg.msglen = 0;
+    gadgetbridge_msg.msgpos = 0;
+    gadgetbridge_msg.chunklen = 0;
+}
+
+/**
+ * @brief send a msg chunk to gadgetbridge over ble, the result is reported
+ * to gadgetbridge_send_status()
  * 
  * @param msg       pointer to a msg
- * @param len       chunk size (normaly 20bytes)
+ * @param len       chunk size, up to the negotiated mtu
  */
 static void gadgetbridge_send_chunk ( unsigned char *msg, int32_t len ) {
     /*
      * send msg chunk
      */
     #ifdef NATIVE_64BIT
+        #ifdef GADGETBRIDGE_TX_BENCHMARK
+            gadgetbridge_fake_link_notify( msg, len );
+        #endif
     #else
         pGadgetbridgeTXCharacteristic->setValue( msg, len );
         pGadgetbridgeTXCharacteristic->notify();
     #endif
 }
 
+/**
+ * @brief notify result for the pending chunk
+ * 
+ * @param status    GADGETBRIDGE_TX_SENT, GADGETBRIDGE_TX_CONGESTED or GADGETBRIDGE_TX_FAILED
+ */
+static void gadgetbridge_send_status( gadgetbridge_tx_status_t status ) {
+    if ( !gadgetbridge_msg.active || !gadgetbridge_msg.chunklen )
+        return;
+
+    switch( status ) {
+        case GADGETBRIDGE_TX_SENT:
+            gadgetbridge_msg.msgpos += gadgetbridge_msg.chunklen;
+            gadgetbridge_msg.chunklen = 0;
+            gadgetbridge_tx_backoff = 0;
+            if ( gadgetbridge_msg.msgpos >= gadgetbridge_msg.msglen ) {
+                gadgetbridge_send_msg_free();
+                gadgetbridge_send_event_cb( GADGETBRIDGE_MSG_SEND_SUCCESS , (char*)"msg send success" );
+            }
+            break;
+        case GADGETBRIDGE_TX_CONGESTED:
+            /**
+             * keep the chunk and back off, doubling the delay while the link stays congested
+             */
+            gadgetbridge_msg.chunklen = 0;
+            gadgetbridge_tx_backoff = gadgetbridge_tx_backoff ? gadgetbridge_tx_backoff * 2 : GADGETBRIDGE_TX_BACKOFF_MIN;
+            if ( gadgetbridge_tx_backoff > GADGETBRIDGE_TX_BACKOFF_MAX )
+                gadgetbridge_tx_backoff = GADGETBRIDGE_TX_BACKOFF_MAX;
+            gadgetbridge_tx_retry = gadgetbridge_millis() + gadgetbridge_tx_backoff;
+            break;
+        default:
+            gadgetbridge_send_msg_free();
+            gadgetbridge_send_event_cb( GADGETBRIDGE_MSG_SEND_ABORT , (char*)"msg send abort, notify failed" );
+            break;
+    }
+}
+
+/**
+ * @brief send chunks until the loop budget is used, the queue is empty or the link is congested
+ */
+static void gadgetbridge_send_loop( void ) {
+    int32_t budget = GADGETBRIDGE_TX_LOOP_BUDGET;
+    /**
+     * wait after a congested notify
+     */
+    if ( gadgetbridge_tx_backoff && gadgetbridge_millis() < gadgetbridge_tx_retry )
+        return;
+
+    while( budget-- > 0 ) {
+        /**
+         * copy next msg from the queue
+         */
+        if ( !gadgetbridge_msg.active ) {
+            char *msg = gadgetbridge_transmit_queue_receive();
+            if ( !msg )
+                break;
+            gadgetbridge_send_next_msg( msg );
+            if ( !gadgetbridge_msg.active )
+                continue;
+        }
+        /**
+         * send the next chunk, sized from the negotiated mtu
+         */
+        int32_t chunklen = gadgetbridge_msg.msglen - gadgetbridge_msg.msgpos;
+        if ( chunklen > gadgetbridge_get_chunksize() )
+            chunklen = gadgetbridge_get_chunksize();
+
+        gadgetbridge_msg.chunklen = chunklen;
+        gadgetbridge_send_chunk( (unsigned char *)&gadgetbridge_msg.msg[ gadgetbridge_msg.msgpos ], chunklen );
+        /**
+         * no status means no subscribed client
+         */
+        if ( gadgetbridge_msg.chunklen )
+            gadgetbridge_send_status( GADGETBRIDGE_TX_FAILED );
+        /**
+         * stop on congestion, gadgetbridge_tx_retry holds the next try
+         */
+        if ( gadgetbridge_tx_backoff )
+            break;
+    }
+}
+
 /**
  * @brief powermgm loop event callback funktion, handle gadgetbridge chunks and recieved msg
  * 
@@ -299,93 +561,581 @@ static void gadgetbridge_send_chunk ( unsigned char *msg, int32_t len ) {
  * @return false 
  */
 static bool gadgetbridge_powermgm_loop_cb( EventBits_t event, void *arg ) {
-    static uint64_t nextmillis = 0;
     /**
-     * check if we connected
+     * check if we connected, drop a partly send msg on disconnect
      */
-    if ( !blectl_get_event( BLECTL_CONNECT ) )
+    if ( !blectl_get_event( BLECTL_CONNECT ) ) {
+        gadgetbridge_tx_backoff = 0;
+        if ( gadgetbridge_msg.active ) {
+            gadgetbridge_send_msg_free();
+            gadgetbridge_send_event_cb( GADGETBRIDGE_MSG_SEND_ABORT , (char*)"msg send abort, disconnected" );
+        }
         return( true );
+    }
     /**
      * work on send queue
      */
+    gadgetbridge_send_loop();
+    /**
+     * work on recieve buffer
+     */
+    gadgetbridge_receive_loop();
+
+    return( true );
+}
+
+/**
+ * @brief append received bytes to the rx buffer, called from the ble task
+ * 
+ * @param data      pointer to the received bytes
+ * @param len       number of bytes
+ * @return          true if the bytes complete a msg or mark a new connection
+ */
+static bool gadgetbridge_receive_write( const uint8_t *data, size_t len ) {
     #ifdef NATIVE_64BIT
     #else
+        portENTER_CRITICAL( &gadgetbridge_rx_mux );
+    #endif
+    if ( gadgetbridge_rx_buffer && gadgetbridge_rx_len + len <= GADGETBRIDGE_RX_BUFFER ) {
+        memcpy( &gadgetbridge_rx_buffer[ gadgetbridge_rx_len ], data, len );
+        gadgetbridge_rx_len += len;
+    }
+    else {
         /**
-         * copy next msg from the queue
+         * remember where the bytes got lost, only the msgs spanning it are incomplete
          */
-        if ( !gadgetbridge_msg.active ) {
-            char *msg;
-            BaseType_t available = xQueueReceive( gadgetbridge_msg_transmit_queue, &msg, 0);
-            if ( available == pdTRUE && msg ) {
-                gadgetbridge_send_next_msg( msg );
-                free( msg );
-            }
-        }
+        if ( !gadgetbridge_rx_overflow )
+            gadgetbridge_rx_lost_first = gadgetbridge_rx_len;
+        gadgetbridge_rx_lost_last = gadgetbridge_rx_len;
+        gadgetbridge_rx_overflow = true;
+    }
+    #ifdef NATIVE_64BIT
+    #else
+        portEXIT_CRITICAL( &gadgetbridge_rx_mux );
     #endif
+
+    return( memchr( data, LineFeed, len ) || memchr( data, EndofText, len ) );
+}
+
+/**
+ * @brief split the rx buffer into msgs and dispatch all complete msgs
+ */
+static void gadgetbridge_receive_loop( void ) {
+    size_t len;
     /**
-     * send blectl_msg chunk when we have a active msg in it
+     * get the received bytes, the ble task only appends behind them
      */
-    if ( gadgetbridge_msg.active && nextmillis < millis() ) {
-        bool finish = true;
-        nextmillis = millis() + BLECTL_CHUNKDELAY;
-
-        if ( gadgetbridge_msg.msgpos < gadgetbridge_msg.msglen ) {
-            if ( ( gadgetbridge_msg.msglen - gadgetbridge_msg.msgpos ) > BLECTL_CHUNKSIZE ) {
-                gadgetbridge_send_chunk ( (unsigned char *)&gadgetbridge_msg.msg[ gadgetbridge_msg.msgpos ], BLECTL_CHUNKSIZE );
-                gadgetbridge_msg.msgpos += BLECTL_CHUNKSIZE;
-                finish = false;
-            }
-            else if ( ( gadgetbridge_msg.msglen - gadgetbridge_msg.msgpos ) > 0 ) {
-                gadgetbridge_send_chunk ( (unsigned char *)&gadgetbridge_msg.msg[ gadgetbridge_msg.msgpos ], gadgetbridge_msg.msglen - gadgetbridge_msg.msgpos );
-                gadgetbridge_send_event_cb( GADGETBRIDGE_MSG_SEND_SUCCESS , (char*)"msg send success" );
-            }
-            else {
-                gadgetbridge_send_event_cb( GADGETBRIDGE_MSG_SEND_ABORT , (char*)"msg send abort, malformed chunksize" );
-            }
-        }
+    #ifdef NATIVE_64BIT
+    #else
+        portENTER_CRITICAL( &gadgetbridge_rx_mux );
+    #endif
+    len = gadgetbridge_rx_len;
+    if ( gadgetbridge_rx_overflow ) {
+        if ( !gadgetbridge_rx_drop )
+            gadgetbridge_rx_drop_first = gadgetbridge_rx_lost_first;
+        gadgetbridge_rx_drop_last = gadgetbridge_rx_lost_last;
+        gadgetbridge_rx_overflow = false;
+        gadgetbridge_rx_drop = true;
+    }
+    #ifdef NATIVE_64BIT
+    #else
+        portEXIT_CRITICAL( &gadgetbridge_rx_mux );
+    #endif
 
-        if( finish ) {
-            gadgetbridge_msg.active = false;
-            gadgetbridge_msg.msglen = 0;
-            gadgetbridge_msg.msgpos = 0;
+    if ( gadgetbridge_rx_scan == len && !gadgetbridge_rx_drop )
+        return;
+    /**
+     * frame msgs in place, a msg ends with LineFeed and EndofText or DataLinkEscape start a new one
+     */
+    for( size_t i = gadgetbridge_rx_scan ; i < len ; i++ ) {
+        switch( gadgetbridge_rx_buffer[ i ] ) {
+            case EndofText:         gadgetbridge_rx_start = i + 1;
+                                    if ( gadgetbridge_rx_drop && i >= gadgetbridge_rx_drop_last )
+                                        gadgetbridge_rx_drop = false;
+                                    gadgetbridge_send_event_cb( GADGETBRIDGE_CONNECT, (void *)"connected" );
+                                    break;
+            case DataLinkEscape:    gadgetbridge_rx_start = i + 1;
+                                    if ( gadgetbridge_rx_drop && i >= gadgetbridge_rx_drop_last )
+                                        gadgetbridge_rx_drop = false;
+                                    break;
+            case LineFeed:          gadgetbridge_rx_buffer[ i ] = '\0';
+                                    /**
+                                     * msgs complete before the lost bytes are still valid
+                                     */
+                                    if ( gadgetbridge_rx_drop && i >= gadgetbridge_rx_drop_first ) {
+                                        log_e("rx buffer overflow, msg dropped (%d bytes)", (int)( i - gadgetbridge_rx_start ) );
+                                        if ( i >= gadgetbridge_rx_drop_last )
+                                            gadgetbridge_rx_drop = false;
+                                    }
+                                    else
+                                        gadgetbridge_receive_msg( &gadgetbridge_rx_buffer[ gadgetbridge_rx_start ] );
+                                    gadgetbridge_rx_start = i + 1;
+                                    break;
         }
     }
+    gadgetbridge_rx_scan = len;
     /**
-     * work on recieve queue
+     * the rest of an overflowed msg is not needed, make room for the next one
      */
-    #ifdef NATIVE_64BIT
-    #else
+    if ( gadgetbridge_rx_drop ) {
+        gadgetbridge_rx_start = len;
+        gadgetbridge_rx_drop_first = len;
+        gadgetbridge_rx_drop_last = len;
+    }
+    /**
+     * move the incomplete msg to the front
+     */
+    if ( gadgetbridge_rx_start ) {
+        #ifdef NATIVE_64BIT
+        #else
+            portENTER_CRITICAL( &gadgetbridge_rx_mux );
+        #endif
+        memmove( gadgetbridge_rx_buffer, &gadgetbridge_rx_buffer[ gadgetbridge_rx_start ], gadgetbridge_rx_len - gadgetbridge_rx_start );
+        gadgetbridge_rx_len -= gadgetbridge_rx_start;
+        gadgetbridge_rx_scan -= gadgetbridge_rx_start;
+        if ( gadgetbridge_rx_overflow ) {
+            gadgetbridge_rx_lost_first -= gadgetbridge_rx_start;
+            gadgetbridge_rx_lost_last -= gadgetbridge_rx_start;
+        }
+        if ( gadgetbridge_rx_drop ) {
+            gadgetbridge_rx_drop_first = gadgetbridge_rx_drop_first > gadgetbridge_rx_start ? gadgetbridge_rx_drop_first - gadgetbridge_rx_start : 0;
+            gadgetbridge_rx_drop_last = gadgetbridge_rx_drop_last > gadgetbridge_rx_start ? gadgetbridge_rx_drop_last - gadgetbridge_rx_start : 0;
+        }
+        gadgetbridge_rx_start = 0;
+        #ifdef NATIVE_64BIT
+        #else
+            portEXIT_CRITICAL( &gadgetbridge_rx_mux );
+        #endif
+    }
+}
+
+/**
+ * @brief dispatch a received msg
+ * 
+ * @param msg       pointer to the msg in the rx buffer
+ */
+static void gadgetbridge_receive_msg( char *msg ) {
+    /**
+     * check if we have a GB message
+     */
+    if( msg[ 0 ] == 'G' && msg[ 1 ] == 'B' && strlen( msg ) > 3 ) {
         /**
-         * get next msg from receive queue
+         * strip GB( and )
          */
-        char *gbmsg;
-        BaseType_t available = xQueueReceive( gadgetbridge_msg_receive_queue, &gbmsg, 0);
-        if ( available == pdTRUE && gbmsg ) {
-            /**
-             * check if we have a GB message
-             */
-            if( gbmsg[ 0 ] == 'G' && gbmsg[ 1 ] == 'B' ) {
-                /**
-                 * copy gbmsg pointer to a new pointer to prevent destroying gbmsg pointer
-                 */
-                char *GBmsg = gbmsg + 3;
-                GBmsg[ strlen( GBmsg ) - 1 ] = '\0';
+        char *GBmsg = msg + 3;
+        GBmsg[ strlen( GBmsg ) - 1 ] = '\0';
+
+        /**
+         * the in place parse rewrites the text, so msgs that are not valid
+         * json go to the raw subscribers before it gets touched
+         */
+        if ( !gadgetbridge_check_json( GBmsg ) ) {
+            gadgetbridge_send_event_cb( GADGETBRIDGE_MSG, (void *)GBmsg );
+            return;
+        }
+
+        BluetoothJsonRequest *request = gadgetbridge_parse_json( GBmsg );
+
+        if ( request->isValid() )
+            gadgetbridge_send_event_cb( GADGETBRIDGE_JSON_MSG, (void *)request );
+        else
+            log_e("drop msg, json parse failed after check");
+
+        request->clear();
+    }
+    else
+        gadgetbridge_send_event_cb( GADGETBRIDGE_MSG, (void *)msg );
+}
+
+/**
+ * @brief parse a json msg in place into the pooled json document
+ * 
+ * @param json      pointer to a json string, modified by the parser
+ * @return          pointer to the pooled json document
+ */
+static BluetoothJsonRequest *gadgetbridge_parse_json( char *json ) {
+    size_t size = strlen( json ) * 2;
+    char type[ GADGETBRIDGE_RX_TYPE_SIZE ];
+    JsonDocument *filter = NULL;
+    /**
+     * strings are not copied, so the document only holds the json tree,
+     * it grows for large msgs and is never shrunk
+     */
+    if ( size < GADGETBRIDGE_RX_JSON_SIZE )
+        size = GADGETBRIDGE_RX_JSON_SIZE;
 
-                BluetoothJsonRequest request( GBmsg, strlen( GBmsg ) * 4 );
+    if ( !gadgetbridge_rx_request || gadgetbridge_rx_request->capacity() < size ) {
+        if ( gadgetbridge_rx_request )
+            delete gadgetbridge_rx_request;
+        gadgetbridge_rx_request = new BluetoothJsonRequest( size );
+    }
+    /**
+     * only materialize the keys subscribers registered for this msg type
+     */
+    if ( gadgetbridge_get_json_type( json, type, sizeof( type ) ) ) {
+        gadgetbridge_json_filter_t *entry = gadgetbridge_find_json_filter( type );
+        if ( entry && !entry->all )
+            filter = entry->filter;
+    }
+    gadgetbridge_rx_request->parse( json, filter );
+
+    return( gadgetbridge_rx_request );
+}
+
+/**
+ * @brief check the json syntax without building a tree or modifying the text
+ * 
+ * @param json      pointer to a json string
+ * @return          true if valid json, false if not
+ */
+static bool gadgetbridge_check_json( const char *json ) {
+    StaticJsonDocument<16> doc;
+    StaticJsonDocument<16> filter;
+    /**
+     * a false filter skips every value, the const input is read only
+     */
+    filter.set( false );
+    return( !deserializeJson( doc, json, DeserializationOption::Filter( filter ) ) );
+}
 
-                if ( request.isValid() )
-                    gadgetbridge_send_event_cb( GADGETBRIDGE_JSON_MSG, (void *)&request );
-                else
-                    gadgetbridge_send_event_cb( GADGETBRIDGE_MSG, (void *)GBmsg );
+/**
+ * @brief get the "t" value of a json object without parsing it
+ * 
+ * @param json      pointer to a json string
+ * @param type      buffer for the value
+ * @param size      buffer size
+ * @return          true if found, false if not found or too long
+ */
+static bool gadgetbridge_get_json_type( const char *json, char *type, size_t size ) {
+    int32_t depth = 0;
+    bool key = false;
 
-                request.clear();
+    for( const char *p = json ; *p ; p++ ) {
+        switch( *p ) {
+            case '{':   depth++;
+                        key = ( depth == 1 );
+                        break;
+            case '[':   depth++;
+                        break;
+            case '}':
+            case ']':   depth--;
+                        break;
+            case ',':   key = ( depth == 1 );
+                        break;
+            case '"': {
+                        const char *str = ++p;
+                        while( *p && *p != '"' ) {
+                            if ( *p == '\\' && p[ 1 ] )
+                                p++;
+                            p++;
+                        }
+                        if ( !*p )
+                            return( false );
+                        /**
+                         * top level key "t", copy the following string value
+                         */
+                        if ( key && p - str == 1 && *str == 't' ) {
+                            p++;
+                            while( *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == ':' )
+                                p++;
+                            if ( *p != '"' )
+                                return( false );
+                            const char *value = ++p;
+                            while( *p && *p != '"' && *p != '\\' )
+                                p++;
+                            if ( *p != '"' || (size_t)( p - value ) >= size )
+                                return( false );
+                            memcpy( type, value, p - value );
+                            type[ p - value ] = '\0';
+                            return( true );
+                        }
+                        key = false;
+                        break;
             }
-            else
-                gadgetbridge_send_event_cb( GADGETBRIDGE_MSG, (void *)gbmsg );
+        }
+    }
+    return( false );
+}
 
-            free( gbmsg );
+/**
+ * @brief find the json key filter for a msg type
+ * 
+ * @param type      value of the "t" key
+ * @return          pointer to the filter or NULL if not registered
+ */
+static gadgetbridge_json_filter_t *gadgetbridge_find_json_filter( const char *type ) {
+    for( int32_t i = 0 ; i < gadgetbridge_json_filters ; i++ )
+        if ( !strcmp( gadgetbridge_json_filter[ i ].type, type ) )
+            return( &gadgetbridge_json_filter[ i ] );
+
+    return( NULL );
+}
+
+bool gadgetbridge_register_json_filter( const char *type, const char *keys ) {
+    gadgetbridge_json_filter_t *entry = gadgetbridge_find_json_filter( type );
+    /**
+     * new msg type, start with a filter for "t"
+     */
+    if ( !entry ) {
+        if ( gadgetbridge_json_filters >= GADGETBRIDGE_RX_FILTER_MAX || strlen( type ) >= GADGETBRIDGE_RX_TYPE_SIZE ) {
+            log_e("no json filter for \"%s\", all keys are kept", type );
+            return( false );
+        }
+        entry = &gadgetbridge_json_filter[ gadgetbridge_json_filters++ ];
+        strncpy( entry->type, type, sizeof( entry->type ) );
+        entry->all = false;
+        entry->filter = new SpiRamJsonDocument( GADGETBRIDGE_RX_FILTER_SIZE );
+        (*entry->filter)[ "t" ] = true;
+    }
+    /**
+     * add the comma separated keys
+     */
+    while( keys && *keys ) {
+        const char *end = strchr( keys, ',' );
+        size_t len = end ? end - keys : strlen( keys );
+        char key[ 32 ];
+
+        if ( len == 1 && *keys == '*' )
+            entry->all = true;
+        else if ( len && len < sizeof( key ) ) {
+            memcpy( key, keys, len );
+            key[ len ] = '\0';
+            (*entry->filter)[ key ] = true;
+        }
+        keys = end ? end + 1 : NULL;
+    }
+    /**
+     * keep all keys if the filter is incomplete
+     */
+    if ( entry->filter->overflowed() ) {
+        log_e("json filter for \"%s\" overflowed, all keys are kept", type );
+        entry->all = true;
+    }
+    return( true );
+}
+
+#if defined( NATIVE_64BIT ) && defined( GADGETBRIDGE_TX_BENCHMARK )
+/**
+ * @brief fake notify, takes a host buffer or reports congestion
+ * 
+ * @param msg       pointer to the chunk
+ * @param len       chunk size
+ */
+static void gadgetbridge_fake_link_notify( unsigned char *msg, int32_t len ) {
+    gadgetbridge_fake_link_t *link = &gadgetbridge_fake_link;
+
+    if ( link->count >= GADGETBRIDGE_FAKE_LINK_BUFFERS ) {
+        link->congested++;
+        gadgetbridge_send_status( GADGETBRIDGE_TX_CONGESTED );
+        return;
+    }
+
+    link->end[ ( link->first + link->count ) % GADGETBRIDGE_FAKE_LINK_BUFFERS ] = ( msg[ len - 1 ] == '\0' );
+    link->count++;
+    link->notifies++;
+    link->bytes += len;
+    gadgetbridge_send_status( GADGETBRIDGE_TX_SENT );
+}
+
+/**
+ * @brief connection event, the phone takes up to GADGETBRIDGE_FAKE_LINK_PER_EVENT packets
+ */
+static void gadgetbridge_fake_link_event( void ) {
+    gadgetbridge_fake_link_t *link = &gadgetbridge_fake_link;
+
+    if ( gadgetbridge_fake_link_clock < link->next_event )
+        return;
+
+    link->next_event += GADGETBRIDGE_FAKE_LINK_INTERVAL;
+
+    for( int i = 0 ; i < GADGETBRIDGE_FAKE_LINK_PER_EVENT && link->count ; i++ ) {
+        if ( link->end[ link->first ] && link->delivered < GADGETBRIDGE_FAKE_LINK_MSGS ) {
+            uint64_t latency = gadgetbridge_fake_link_clock - link->queued[ link->delivered ];
+            link->latency += latency;
+            if ( latency > link->latency_max )
+                link->latency_max = latency;
+            link->delivered++;
+        }
+        link->first = ( link->first + 1 ) % GADGETBRIDGE_FAKE_LINK_BUFFERS;
+        link->count--;
+    }
+}
+
+/**
+ * @brief send typical gadgetbridge msgs over the fake link at different mtu's
+ * and log throughput and latency
+ */
+static void gadgetbridge_tx_benchmark( void ) {
+    static const char *payload[] = {
+        "\r\n{\"t\":\"status\", \"bat\":87}\r\n",
+        "\r\n{\"t\":\"act\", \"stp\":1234}\r\n",
+        "\r\n{\"t\":\"music\", \"n\":\"play\"}\r\n",
+        "\r\n{\"t\":\"notify-\",\"id\":1650284927}\r\n",
+        "\r\n{\"t\":\"info\",\"msg\":\"gps tracker started\"}\r\n",
+        "\x03{\"app\":\"calendar\",\"r\":\"list\",\"items\":[{\"id\":1,\"t\":\"Dentist\",\"d\":\"2022-05-02T09:30\"},"
+        "{\"id\":2,\"t\":\"Team meeting\",\"d\":\"2022-05-03T14:00\"},{\"id\":3,\"t\":\"Birthday Anna\",\"d\":\"2022-05-07T00:00\"}]}\x03"
+    };
+    static const uint16_t mtu[] = { BLECTL_MIN_MTU, 185, 247 };
+    const int32_t payloads = sizeof( payload ) / sizeof( payload[ 0 ] );
+
+    for( int m = 0 ; m < (int)( sizeof( mtu ) / sizeof( mtu[ 0 ] ) ) ; m++ ) {
+        gadgetbridge_fake_link_t *link = &gadgetbridge_fake_link;
+        uint64_t next_burst = 0;
+        int32_t queued = 0;
+
+        memset( link, 0, sizeof( gadgetbridge_fake_link_t ) );
+        gadgetbridge_fake_link_clock = 0;
+        blectl_set_mtu( mtu[ m ] );
+        blectl_set_event( BLECTL_CONNECT );
+        /**
+         * queue msgs in bursts and run the powermgm loop until the phone has them all
+         */
+        while( link->delivered < GADGETBRIDGE_FAKE_LINK_MSGS && gadgetbridge_fake_link_clock < 120000000 ) {
+            if ( gadgetbridge_fake_link_clock >= next_burst ) {
+                for( int i = 0 ; i < GADGETBRIDGE_FAKE_LINK_BURST && queued < GADGETBRIDGE_FAKE_LINK_MSGS ; i++ ) {
+                    const char *msg = payload[ queued % payloads ];
+                    link->queued[ queued ] = gadgetbridge_fake_link_clock;
+                    if ( !gadgetbridge_send_msg( "%s", msg ) )
+                        break;
+                    link->fixed += ( ( strlen( msg ) + 1 + BLECTL_CHUNKSIZE - 1 ) / BLECTL_CHUNKSIZE ) * 50000;
+                    queued++;
+                }
+                next_burst += GADGETBRIDGE_FAKE_LINK_BURST_GAP;
+            }
+            if ( link->delivered < queued )
+                link->busy += GADGETBRIDGE_FAKE_LINK_LOOP;
+            gadgetbridge_powermgm_loop_cb( POWERMGM_WAKEUP, NULL );
+            gadgetbridge_fake_link_clock += GADGETBRIDGE_FAKE_LINK_LOOP;
+            gadgetbridge_fake_link_event();
         }
-    #endif
 
+        if ( link->delivered && link->busy ) {
+            log_i("gadgetbridge tx: mtu %d, chunk %d, %d msgs, %d bytes, %d notifies, %d congested",
+                    mtu[ m ], gadgetbridge_get_chunksize(), link->delivered, link->bytes, link->notifies, link->congested );
+            log_i("gadgetbridge tx: busy %lums, %lu bytes/s, latency avg %lums max %lums ( fixed %d byte chunks every 50ms: busy %lums, %lu bytes/s )",
+                    (unsigned long)( link->busy / 1000 ), (unsigned long)( (uint64_t)link->bytes * 1000000 / link->busy ),
+                    (unsigned long)( link->latency / link->delivered / 1000 ), (unsigned long)( link->latency_max / 1000 ),
+                    BLECTL_CHUNKSIZE, (unsigned long)( link->fixed / 1000 ), (unsigned long)( (uint64_t)link->bytes * 1000000 / link->fixed ) );
+        }
+        else {
+            log_e("gadgetbridge tx: mtu %d, no msg delivered", mtu[ m ] );
+        }
+        /**
+         * let the loop drop anything left over
+         */
+        blectl_clear_event( BLECTL_CONNECT );
+        gadgetbridge_powermgm_loop_cb( POWERMGM_WAKEUP, NULL );
+        while( char *msg = gadgetbridge_transmit_queue_receive() )
+            free( msg );
+    }
+    blectl_set_mtu( BLECTL_MIN_MTU );
+}
+#endif
+
+#if defined( NATIVE_64BIT ) && defined( GADGETBRIDGE_RX_BENCHMARK )
+/**
+ * @brief benchmark subscriber, reads "t" like the real subscribers do
+ */
+static bool gadgetbridge_rx_benchmark_cb( EventBits_t event, void *arg ) {
+    if ( event == GADGETBRIDGE_JSON_MSG ) {
+        BluetoothJsonRequest *request = (BluetoothJsonRequest *)arg;
+
+        if ( request->containsKey("t") )
+            gadgetbridge_rx_benchmark_msgs++;
+        gadgetbridge_rx_benchmark_usage = request->memoryUsage();
+    }
     return( true );
-}
\ No newline at end of file
+}
+
+/**
+ * @brief feed captured gadgetbridge traffic through the old copy and parse path
+ * and through the rx buffer, log time per msg and json document usage
+ */
+static void gadgetbridge_rx_benchmark( void ) {
+    static const char *capture[][ 2 ] = {
+        { "notify",     "\x10GB({\"t\":\"notify\",\"id\":1650284927,\"src\":\"WhatsApp\",\"title\":\"Anna\",\"subject\":\"\","
+                        "\"body\":\"Are we still on for lunch tomorrow? I booked a table at Luigi's for 12:30, see you there!\","
+                        "\"sender\":\"Anna\",\"tel\":\"+491701234567\"})\n" },
+        { "musicinfo",  "\x10GB({\"t\":\"musicinfo\",\"artist\":\"Daft Punk\",\"album\":\"Random Access Memories\",\"track\":\"Get Lucky\","
+                        "\"dur\":369,\"c\":-1,\"n\":-1})\n" },
+        { "weather",    "\x10GB({\"t\":\"weather\",\"temp\":288,\"hi\":291,\"lo\":282,\"hum\":72,\"rain\":10,\"uv\":1,\"code\":802,"
+                        "\"txt\":\"scattered clouds\",\"wind\":11.2,\"wdir\":250,\"loc\":\"Berlin\"})\n" },
+        { "call",       "\x10GB({\"t\":\"call\",\"cmd\":\"incoming\",\"name\":\"Anna\",\"number\":\"+491701234567\"})\n" }
+    };
+    static callback_t *benchmark_callback = NULL;
+    callback_t *callback = gadgetbridge_callback;
+    CharBuffer buffer;
+    /**
+     * same filters as the subscribers, route events to the benchmark subscriber
+     */
+    gadgetbridge_register_json_filter( "notify", "*" );
+    gadgetbridge_register_json_filter( "weather", "*" );
+    gadgetbridge_register_json_filter( "musicinfo", "track,artist" );
+    gadgetbridge_register_json_filter( "call", "cmd,name,number" );
+
+    if ( !benchmark_callback ) {
+        benchmark_callback = callback_init( "gadgetbridge rx benchmark" );
+        callback_register( benchmark_callback, GADGETBRIDGE_JSON_MSG | GADGETBRIDGE_MSG, gadgetbridge_rx_benchmark_cb, "gadgetbridge rx benchmark" );
+    }
+    gadgetbridge_callback = benchmark_callback;
+
+    for( int c = 0 ; c < (int)( sizeof( capture ) / sizeof( capture[ 0 ] ) ) ; c++ ) {
+        const char *wire = capture[ c ][ 1 ];
+        size_t len = strlen( wire );
+        uint64_t start;
+        unsigned long copy_us, inplace_us;
+        size_t copy_usage, inplace_usage;
+        uint32_t copy_msgs;
+        /**
+         * old path: append byte by byte, copy each msg, json document sized strlen * 4 with string copies
+         */
+        gadgetbridge_rx_benchmark_msgs = 0;
+        start = micros();
+        for( int run = 0 ; run < GADGETBRIDGE_RX_BENCHMARK_RUNS ; run++ ) {
+            for( size_t i = 0 ; i < len ; i++ ) {
+                switch( wire[ i ] ) {
+                    case EndofText:
+                    case DataLinkEscape:    buffer.clear();
+                                            break;
+                    case LineFeed:          {
+                                                size_t size = strlen( buffer.c_str() ) + 1;
+                                                char *msg = (char *)CALLOC_ASSERT( size, 1, "buff calloc failed" );
+                                                strncpy( msg, buffer.c_str(), size );
+                                                buffer.clear();
+
+                                                char *GBmsg = msg + 3;
+                                                GBmsg[ strlen( GBmsg ) - 1 ] = '\0';
+                                                BluetoothJsonRequest request( GBmsg, strlen( GBmsg ) * 4 );
+                                                if ( request.isValid() )
+                                                    gadgetbridge_rx_benchmark_cb( GADGETBRIDGE_JSON_MSG, (void *)&request );
+                                                request.clear();
+                                                free( msg );
+                                                break;
+                                            }
+                    default:                buffer.append( wire[ i ] );
+                }
+            }
+        }
+        copy_us = micros() - start;
+        copy_usage = gadgetbridge_rx_benchmark_usage;
+        copy_msgs = gadgetbridge_rx_benchmark_msgs;
+        gadgetbridge_rx_benchmark_msgs = 0;
+        /**
+         * new path: 20 byte ble writes into the rx buffer, framed and parsed in place into the pooled document
+         */
+        start = micros();
+        for( int run = 0 ; run < GADGETBRIDGE_RX_BENCHMARK_RUNS ; run++ ) {
+            for( size_t pos = 0 ; pos < len ; pos += BLECTL_CHUNKSIZE )
+                gadgetbridge_receive_write( (const uint8_t *)&wire[ pos ], len - pos > BLECTL_CHUNKSIZE ? BLECTL_CHUNKSIZE : len - pos );
+            gadgetbridge_receive_loop();
+        }
+        inplace_us = micros() - start;
+        inplace_usage = gadgetbridge_rx_benchmark_usage;
+
+        log_i("gadgetbridge rx: %s, %d bytes, copy and parse %d msgs in %lu us ( %d bytes json ), in place %d msgs in %lu us ( %d bytes json )",
+                capture[ c ][ 0 ], (int)len, copy_msgs, copy_us, (int)copy_usage,
+                gadgetbridge_rx_benchmark_msgs, inplace_us, (int)inplace_usage );
+    }
+    gadgetbridge_callback = callback;
+}
+#endif
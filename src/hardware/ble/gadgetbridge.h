@@ -46,16 +46,37 @@
     #define LineFeed                                            0x0a            /** @brief gadgetbridge LineFeed marker */
     #define DataLinkEscape                                      0x10            /** @brief gadgetbridge DataLinkEscape marker */
 
-    #define BLECTL_CHUNKSIZE                                    20              /** @brief chunksize for send msg */
-    #define BLECTL_CHUNKDELAY                                   50              /** @brief chunk delay in ms for each msg chunk */
+    #define BLECTL_CHUNKSIZE                                    20              /** @brief smallest chunksize for send msg, ATT payload at BLECTL_MIN_MTU */
+    #define GADGETBRIDGE_TX_CHUNK_MAX                           244             /** @brief largest chunksize, ATT payload of a 247 byte MTU that fits one LL packet */
+    #define GADGETBRIDGE_TX_QUEUE                               16              /** @brief transmit queue depth in msgs */
+    #define GADGETBRIDGE_TX_LOOP_BUDGET                         8               /** @brief max notifications per powermgm loop */
+    #define GADGETBRIDGE_TX_BACKOFF_MIN                         5               /** @brief first retry delay in ms after a congested notify */
+    #define GADGETBRIDGE_TX_BACKOFF_MAX                         80              /** @brief max retry delay in ms after repeated congestion */
+    /**
+     * Uncomment to run the transmit path against a fake ble link at setup
+     * and log throughput and latency, emulator only.
+     */
+    // #define GADGETBRIDGE_TX_BENCHMARK
+
+    #define GADGETBRIDGE_RX_BUFFER                              8192            /** @brief rx buffer, holds received bytes until a msg is complete */
+    #define GADGETBRIDGE_RX_JSON_SIZE                           4096            /** @brief initial size of the pooled json document, grows for larger msgs */
+    #define GADGETBRIDGE_RX_FILTER_MAX                          16              /** @brief max json msg types with a key filter */
+    #define GADGETBRIDGE_RX_FILTER_SIZE                         256             /** @brief json document size for the keys of one msg type */
+    #define GADGETBRIDGE_RX_TYPE_SIZE                           16              /** @brief max length of a json msg type incl. '\0' */
+    /**
+     * Uncomment to parse captured gadgetbridge traffic at setup and log the
+     * time per msg against the old copy and parse path, emulator only.
+     */
+    // #define GADGETBRIDGE_RX_BENCHMARK
     /**
      * @brief blectl send msg structure
      */
     typedef struct {
-        char *msg;                                                              /** @brief pointer to an sending msg */
+        char *msg;                                                              /** @brief pointer to an sending msg, owned by the transmit path */
         bool active;                                                            /** @brief send msg structure active */
         int32_t msglen;                                                         /** @brief msg lenght */
         int32_t msgpos;                                                         /** @brief msg postition for next send */
+        int32_t chunklen;                                                       /** @brief length of the chunk waiting for its notify status, 0 if none */
     } blectl_msg_t;
     /**
      * @brief setup gadgetbridge transmit/recieve over ble
@@ -86,6 +107,17 @@
      * @param   msg     pointer to a string
      */
     bool gadgetbridge_send_msg( const char *format, ... );
-
+    /**
+     * @brief set the keys a GADGETBRIDGE_JSON_MSG subscriber reads for a msg type,
+     * only registered keys and "t" are kept in the json document for this type.
+     * Keys from several calls for one type are merged, types without a filter
+     * are parsed complete.
+     * 
+     * @param   type    value of the "t" key, like "musicinfo"
+     * @param   keys    comma separated keys like "track,artist", "*" to keep all keys
+     * 
+     * @return  true if success, false if the filter table is full
+     */
+    bool gadgetbridge_register_json_filter( const char *type, const char *keys );
 
 #endif // _GADEGTBRIDGE_H
\ No newline at end of file
@@ -33,6 +33,7 @@
 #include "utils/charbuffer.h"
 #include "utils/alloc.h"
 #include "utils/bluejsonrequest.h"
+#include "ble/gadgetbridge.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -52,7 +53,6 @@
     #include <Arduino.h>
     #include "ble/blebatctl.h"
     #include "ble/blestepctl.h"
-    #include "ble/gadgetbridge.h"
     #include "ble/deviceinfo.h"
 
     #include "NimBLEDescriptor.h"
@@ -63,6 +63,7 @@
 
 blectl_config_t blectl_config;              /** @brief blectl config structure */
 callback_t *blectl_callback = NULL;         /** @brief blectl callback structure */
+static uint16_t blectl_mtu = BLECTL_MIN_MTU;/** @brief negotiated ATT MTU */
 
 static bool blectl_send_event_cb( EventBits_t event, void *arg );
 static bool blectl_powermgm_event_cb( EventBits_t event, void *arg );
@@ -79,6 +80,7 @@ static bool blectl_powermgm_event_cb( EventBits_t event, void *arg );
 
         void onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
             pServer->updateConnParams(desc->conn_handle, blectl_config.minInterval, blectl_config.maxInterval, blectl_config.latency, blectl_config.timeout );
+            blectl_set_mtu( BLECTL_MIN_MTU );
             blectl_set_event( BLECTL_AUTHWAIT );
             blectl_clear_event( BLECTL_DISCONNECT | BLECTL_CONNECT );
             powermgm_resume_from_ISR();
@@ -89,6 +91,7 @@ static bool blectl_powermgm_event_cb( EventBits_t event, void *arg );
 
         void onDisconnect(NimBLEServer* pServer) {
             log_d("BLE disconnected");
+            blectl_set_mtu( BLECTL_MIN_MTU );
             blectl_set_event( BLECTL_DISCONNECT );
             blectl_clear_event( BLECTL_CONNECT | BLECTL_AUTHWAIT );
             blectl_send_event_cb( BLECTL_DISCONNECT, (void *)"disconnected" );
@@ -102,6 +105,7 @@ static bool blectl_powermgm_event_cb( EventBits_t event, void *arg );
 
         void onMTUChange( uint16_t MTU, ble_gap_conn_desc* desc ) {
             log_i("MTU updated: %u for connection ID: %u\n", MTU, desc->conn_handle);
+            blectl_set_mtu( MTU );
         };
         
         uint32_t onPassKeyRequest(){
@@ -178,6 +182,10 @@ static bool blectl_powermgm_event_cb( EventBits_t event, void *arg );
 
 void blectl_setup( void ) {
     #ifdef NATIVE_64BIT
+        /**
+         * no ble stack on the emulator, setup gadgetbridge for the send/loop path only
+         */
+        gadgetbridge_setup();
     #else
         /**
          * allocate event group
@@ -301,6 +309,14 @@ bool blectl_get_event( EventBits_t bits ) {
     return( temp );
 }
 
+uint16_t blectl_get_mtu( void ) {
+    return( blectl_mtu );
+}
+
+void blectl_set_mtu( uint16_t mtu ) {
+    blectl_mtu = mtu < BLECTL_MIN_MTU ? BLECTL_MIN_MTU : mtu;
+}
+
 bool blectl_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
     if ( blectl_callback == NULL ) {
         blectl_callback = callback_init( "blectl" );
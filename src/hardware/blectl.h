@@ -33,6 +33,7 @@
     #include "hardware/config/blectlconfig.h"
 
     #define BLECTL_SCAN_TIME             30
+    #define BLECTL_MIN_MTU               23             /** @brief default ATT MTU until the client negotiates a larger one */
     /**
      * connection state
      */
@@ -96,6 +97,18 @@
      * @param   id                  pointer to an string
      */
     bool blectl_register_cb( EventBits_t event, CALLBACK_FUNC callback_func, const char *id );
+    /**
+     * @brief get the ATT MTU negotiated with the connected client
+     *
+     * @return  MTU in bytes, BLECTL_MIN_MTU if not connected or not negotiated
+     */
+    uint16_t blectl_get_mtu( void );
+    /**
+     * @brief set the negotiated ATT MTU, called on MTU exchange and (re)connect
+     *
+     * @param   mtu     MTU in bytes
+     */
+    void blectl_set_mtu( uint16_t mtu );
     /**
      * @brief enable blueetooth on standby
      * 
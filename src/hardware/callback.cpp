@@ -18,18 +18,137 @@
  *  along with this program; if not, write to the Free Software
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
+#include <string.h>
 #include "config.h"
 #include "callback.h"
 #include "utils/alloc.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
+    #include "utils/millis.h"
     #include "utils/yield.h"
 #else
     #include <Arduino.h>
 #endif
 
 callback_t *callback_head = NULL;
+callback_t *callback_tail = NULL;
+
+static uint8_t *callback_slab = NULL;                                   /** @brief current slab chunk */
+static size_t callback_slab_free = 0;                                   /** @brief free bytes in the current slab chunk */
+static void *callback_free_tables[ CALLBACK_TABLE_CLASSES ] = { NULL }; /** @brief free lists of table blocks per size class */
+static uint32_t callback_alloc_count = 0;                               /** @brief number of heap allocations */
+static size_t callback_alloc_bytes = 0;                                 /** @brief bytes allocated from heap */
+#ifndef NATIVE_64BIT
+    static portMUX_TYPE callback_mux = portMUX_INITIALIZER_UNLOCKED;    /** @brief guards table swaps against readers from other tasks */
+#endif
+
+#if defined( NATIVE_64BIT ) && defined( CALLBACK_BENCHMARK )
+    static void callback_benchmark( void );
+#endif
+
+static inline void callback_lock( void ) {
+#ifndef NATIVE_64BIT
+    portENTER_CRITICAL( &callback_mux );
+#endif
+}
+
+static inline void callback_unlock( void ) {
+#ifndef NATIVE_64BIT
+    portEXIT_CRITICAL( &callback_mux );
+#endif
+}
+
+/**
+ * @brief allocate zeroed memory from heap and count it
+ * 
+ * @param   size        size in bytes
+ * 
+ * @return  pointer to the memory
+ */
+static void *callback_heap_alloc( size_t size ) {
+    callback_alloc_count++;
+    callback_alloc_bytes += size;
+    return( CALLOC_ASSERT( size, 1, "callback memory calloc failed (%u bytes)", (uint32_t)size ) );
+}
+
+/**
+ * @brief allocate memory from the callback slab, memory from the slab is never freed
+ * 
+ * @param   size        size in bytes
+ * 
+ * @return  pointer to the zeroed memory
+ */
+static void *callback_slab_alloc( size_t size ) {
+    void *memory = NULL;
+    /**
+     * keep all slab blocks aligned
+     */
+    size = ( size + sizeof( uint64_t ) - 1 ) & ~( sizeof( uint64_t ) - 1 );
+    /**
+     * blocks bigger than a half slab get their own allocation
+     */
+    if ( size > CALLBACK_SLAB_SIZE / 2 ) {
+        return( callback_heap_alloc( size ) );
+    }
+    /**
+     * get a new slab chunk if the current one is full
+     */
+    if ( size > callback_slab_free ) {
+        callback_slab = (uint8_t*)callback_heap_alloc( CALLBACK_SLAB_SIZE );
+        callback_slab_free = CALLBACK_SLAB_SIZE;
+    }
+    memory = callback_slab;
+    callback_slab += size;
+    callback_slab_free -= size;
+
+    return( memory );
+}
+
+/**
+ * @brief allocate a callback table block with 2^size_class entrys
+ * 
+ * @param   size_class  size class
+ * 
+ * @return  pointer to the table block
+ */
+static void *callback_alloc_table( uint32_t size_class ) {
+    void *table = NULL;
+
+    ASSERT( size_class < CALLBACK_TABLE_CLASSES, "callback table size class %d to large", size_class );
+    /**
+     * reuse a free block from the same size class first
+     */
+    if ( callback_free_tables[ size_class ] ) {
+        table = callback_free_tables[ size_class ];
+        callback_free_tables[ size_class ] = *(void**)table;
+        memset( table, 0, sizeof( callback_table_t ) << size_class );
+    }
+    else {
+        table = callback_slab_alloc( sizeof( callback_table_t ) << size_class );
+    }
+    return( table );
+}
+
+/**
+ * @brief give a callback table block back to the free list of their size class
+ * 
+ * @param   table       pointer to the table block
+ * @param   size_class  size class
+ */
+static void callback_free_table( void *table, uint32_t size_class ) {
+    *(void**)table = callback_free_tables[ size_class ];
+    callback_free_tables[ size_class ] = table;
+}
+
+void callback_get_alloc_stats( uint32_t *count, size_t *bytes ) {
+    if ( count ) {
+        *count = callback_alloc_count;
+    }
+    if ( bytes ) {
+        *bytes = callback_alloc_bytes;
+    }
+}
 
 void callback_print( void ) {
     /**
@@ -42,6 +161,7 @@ void callback_print( void ) {
     /**
      * print out all callback tables
      */
+    log_i("callback heap allocations: %u, %u bytes", callback_alloc_count, (uint32_t)callback_alloc_bytes );
     callback_t *callback_counter = callback_head;
     do {
         log_i(" |");
@@ -54,6 +174,86 @@ void callback_print( void ) {
     while ( callback_counter );
 }
 
+void callback_print_stats( void ) {
+    /**
+     * check if callback head table allocated
+     */
+    if ( callback_head == NULL ) {
+        return;
+    }
+    /**
+     * print out all called callback entrys with their call times
+     */
+    log_i("callback heap allocations: %u, %u bytes", callback_alloc_count, (uint32_t)callback_alloc_bytes );
+    callback_t *callback_counter = callback_head;
+    do {
+        log_i(" |");
+        log_i(" +--'%s' ( %p / %d )", callback_counter->name, callback_counter, callback_counter->entrys );
+        for( int32_t i = 0 ; i < callback_counter->entrys ; i++ ) {
+            callback_stats_t *stats = &callback_counter->table[ i ].stats;
+            char histogram[ CALLBACK_HISTOGRAM_SIZE * 11 + 1 ] = "";
+
+            if ( stats->calls == 0 )
+                continue;
+
+            for( int slot = 0, pos = 0 ; slot < CALLBACK_HISTOGRAM_SIZE ; slot++ ) {
+                pos += snprintf( &histogram[ pos ], sizeof( histogram ) - pos, " %u", stats->histogram[ slot ] );
+            }
+            log_i(" |  +--id:'%s', calls: %u, min: %uus, max: %uus, mean: %uus, log2 histogram:%s", callback_counter->table[ i ].id, stats->calls, stats->time_min, stats->time_max, callback_get_stats_mean( stats ), histogram );
+        }
+        callback_counter = callback_counter->next_callback_t;
+    }
+    while ( callback_counter );
+}
+
+void callback_reset_stats( void ) {
+    callback_t *callback_counter = callback_head;
+
+    while ( callback_counter ) {
+        for( int32_t i = 0 ; i < callback_counter->entrys ; i++ ) {
+            memset( &callback_counter->table[ i ].stats, 0, sizeof( callback_stats_t ) );
+        }
+        callback_counter = callback_counter->next_callback_t;
+    }
+}
+
+callback_t *callback_get_head( void ) {
+    return( callback_head );
+}
+
+bool callback_get_stats( callback_t *callback, uint32_t entry, callback_stats_t *stats ) {
+    return( callback_get_entry_snapshot( callback, entry, NULL, stats ) );
+}
+
+bool callback_get_entry_snapshot( callback_t *callback, uint32_t entry, const char **id, callback_stats_t *stats ) {
+    bool retval = false;
+    /**
+     * check if callback and entry exist, with the table swap locked out
+     */
+    if ( callback == NULL ) {
+        return( retval );
+    }
+    callback_lock();
+    if ( entry < callback->entrys ) {
+        if ( id ) {
+            *id = callback->table[ entry ].id;
+        }
+        if ( stats ) {
+            *stats = callback->table[ entry ].stats;
+        }
+        retval = true;
+    }
+    callback_unlock();
+    return( retval );
+}
+
+uint32_t callback_get_stats_mean( callback_stats_t *stats ) {
+    if ( stats == NULL || stats->calls == 0 ) {
+        return( 0 );
+    }
+    return( stats->time_sum / stats->calls );
+}
+
 int callback_get_entrys( void ) {
     /**
      * check if callback head exist
@@ -87,84 +287,51 @@ callback_t *callback_init( const char *name ) {
     /**
      * allocate an callback table
      */
-    callback_t* callback = (callback_t*)CALLOC_ASSERT( sizeof( callback_t ), 1, "callback_t structure calloc faild for: %s", name );
+    callback_t* callback = (callback_t*)callback_slab_alloc( sizeof( callback_t ) );
     /**
      * if this the first callback table, set it as head table
      */
     if ( callback_head == NULL ) {
         callback_head = callback;
+        #ifdef NATIVE_64BIT
+            /**
+             * dump call time statistics at exit
+             */
+            atexit( callback_print_stats );
+        #endif
     }
     /**
      * clear callback table
      */
     callback->entrys = 0;
+    callback->size = 0;
     callback->debug = false;
     callback->table = NULL;
+    callback->dispatch = NULL;
+    callback->dispatch_size = 0;
+    callback->dispatch_dirty = true;
+    callback->dispatch_lock = 0;
     callback->name = name;
     callback->next_callback_t = NULL;
     /**
      * add the callback table to the callback table chain
      */
-    callback_t *callback_counter = callback_head;
-    if ( callback_head != callback ) {
-        while( callback_counter->next_callback_t ) {
-            callback_counter = callback_counter->next_callback_t;
-        }
-        callback_counter->next_callback_t = callback;
+    if ( callback_tail ) {
+        callback_tail->next_callback_t = callback;
     }
+    callback_tail = callback;
     log_d("init callback_t structure success for: %s", name );
 
+    #if defined( NATIVE_64BIT ) && defined( CALLBACK_BENCHMARK )
+        if ( callback == callback_head )
+            callback_benchmark();
+    #endif
+
     return( callback );
 }
 
 bool callback_register( callback_t *callback, EventBits_t event, CALLBACK_FUNC callback_func, const char *id ) {
-    bool retval = false;
-    /**
-     * check if callback table not NULL
-     */
-    if ( callback == NULL ) {
-        log_w("no callback_t structure found for: %s", id );
-        return( retval );
-    }
-    /**
-     *  check if callback function already exist
-     */
-    if( callback->entrys > 0 ) {
-        for( int i = 0 ; i < callback->entrys; i++ ) {
-            if( callback->table[ i ].callback_func == callback_func && callback->table[ i ].prio == CALL_CB_MIDDLE ) {
-                log_e("callback (%s) already exist", id );
-                while( true );
-            }
-        }
-    }
-    /**
-     * increment callback entry counter
-     */
-    callback->entrys++;
-    /**
-     * check if this entry is the first one for allocation or reallocate
-     */
-    if ( callback->table == NULL ) {
-        callback->table = ( callback_table_t * )CALLOC_ASSERT( sizeof( callback_table_t ) * callback->entrys, 1, "callback_table_t calloc faild for: %s", id );
-        retval = true;
-    }
-    else {
-        callback->table = ( callback_table_t * )REALLOC_ASSERT( callback->table, sizeof( callback_table_t ) * callback->entrys, "callback_table_t realloc faild for: %s", id );
-        retval = true;
-    }
-    /**
-     * set new entry
-     */
-    callback->table[ callback->entrys - 1 ].event = event;
-    callback->table[ callback->entrys - 1 ].callback_func = callback_func;
-    callback->table[ callback->entrys - 1 ].id = id;
-    callback->table[ callback->entrys - 1 ].active = true;
-    callback->table[ callback->entrys - 1 ].prio = CALL_CB_MIDDLE;
-    callback->table[ callback->entrys - 1 ].counter = 0;
-    if ( callback->debug ) {
-        log_d("register callback_func for %s success (%p:%s)", callback->name, callback->table[ callback->entrys - 1 ].callback_func, callback->table[ callback->entrys - 1 ].id );
-    }
-    return( retval );
+    return( callback_register_with_prio( callback, event, callback_func, id, CALL_CB_MIDDLE ) );
 }
 
 bool callback_set_active( callback_t *callback, CALLBACK_FUNC callback_func, callback_prio_t prio, bool active ) {
@@ -182,6 +349,7 @@ bool callback_set_active( callback_t *callback, CALLBACK_FUNC callback_func, cal
         for( int i = 0 ; i < callback->entrys; i++ ) {
             if( callback->table[ i ].callback_func == callback_func && callback->table[ i ].prio == prio ) {
                 callback->table[ i ].active = active;
+                callback->dispatch_dirty = true;
                 retval = true;
             }
         }
@@ -210,165 +378,382 @@ bool callback_register_with_prio( callback_t *callback, EventBits_t event, CALLB
         }
     }
     /**
-     * increment callback entry counter
-     */
-    callback->entrys++;
-    /**
-     * check if this entry is the first one for allocation or reallocate
+     * grow the table to the next size class if full, the new block is taken
+     * before the lock, the swap itself is guarded against snapshot readers
      */
-    if ( callback->table == NULL ) {
-        callback->table = ( callback_table_t * )CALLOC_ASSERT( sizeof( callback_table_t ) * callback->entrys, 1, "callback_table_t calloc faild for: %s", id  );
-        retval = true;
+    callback_table_t *table = NULL;
+    uint32_t size_class = 0;
+    if ( callback->entrys == callback->size ) {
+        size_class = callback->size ? __builtin_ctz( callback->size ) + 1 : CALLBACK_TABLE_MIN_CLASS;
+        table = ( callback_table_t * )callback_alloc_table( size_class );
     }
-    else {
-        callback->table = ( callback_table_t * )REALLOC_ASSERT( callback->table, sizeof( callback_table_t ) * callback->entrys,"callback_table_t realloc faild for: %s", id );
-        retval = true;
+    callback_lock();
+    if ( table ) {
+        callback_table_t *old_table = callback->table;
+
+        if ( old_table ) {
+            memcpy( table, old_table, sizeof( callback_table_t ) * callback->entrys );
+        }
+        callback->table = table;
+        callback->size = 1ul << size_class;
+        if ( old_table ) {
+            callback_free_table( old_table, size_class - 1 );
+        }
     }
     /**
-     * set new entry
+     * set new entry and increment callback entry counter
      */
-    callback->table[ callback->entrys - 1 ].event = event;
-    callback->table[ callback->entrys - 1 ].callback_func = callback_func;
-    callback->table[ callback->entrys - 1 ].id = id;
-    callback->table[ callback->entrys - 1 ].active = true;
-    callback->table[ callback->entrys - 1 ].prio = prio;
-    callback->table[ callback->entrys - 1 ].counter = 0;
+    callback->table[ callback->entrys ].event = event;
+    callback->table[ callback->entrys ].callback_func = callback_func;
+    callback->table[ callback->entrys ].id = id;
+    callback->table[ callback->entrys ].active = true;
+    callback->table[ callback->entrys ].prio = prio;
+    callback->table[ callback->entrys ].counter = 0;
+    memset( &callback->table[ callback->entrys ].stats, 0, sizeof( callback_stats_t ) );
+    callback->entrys++;
+    callback_unlock();
+    retval = true;
+    callback->dispatch_dirty = true;
     if ( callback->debug ) {
         log_d("register callback_func for %s success (%p:%s)", callback->name, callback->table[ callback->entrys - 1 ].callback_func, callback->table[ callback->entrys - 1 ].id );
     }
     return( retval );
 }
 
-bool callback_send( callback_t *callback, EventBits_t event, void *arg ) {
-    bool retval = false;
+/**
+ * @brief build the dispatch index for a callback table
+ * 
+ * the index is one allocation of uint16_t. the first CALLBACK_DISPATCH_HEADER
+ * slots hold offsets, slot n ( n < CALLBACK_DISPATCH_BITS ) is the start of the
+ * entry list for event bit n and ends where the list for bit n+1 starts. slot
+ * CALLBACK_DISPATCH_ORDER/CALLBACK_DISPATCH_END frame a list of all active entrys.
+ * all lists are sorted by prio and registration order, the same order the old
+ * crowl over all prio levels has called them.
+ * 
+ * @param   callback        pointer to a callback_t structure
+ */
+static void callback_build_dispatch( callback_t *callback ) {
+    uint32_t count[ CALLBACK_DISPATCH_BITS ] = { 0 };
+    uint32_t active = 0;
+    uint32_t size = CALLBACK_DISPATCH_HEADER;
     /**
-     * if callback table set?
+     * count active entrys per event bit
      */
-    if ( callback == NULL ) {
-        log_e("no callback structure found");
-        return( retval );
+    for( int entry = 0 ; entry < callback->entrys ; entry++ ) {
+        if( !callback->table[ entry ].active )
+            continue;
+        for( int bit = 0 ; bit < CALLBACK_DISPATCH_BITS ; bit++ ) {
+            if( callback->table[ entry ].event & ( 1ul << bit ) ) {
+                count[ bit ]++;
+                size++;
+            }
+        }
+        active++;
+        size++;
     }
+    ASSERT( size <= UINT16_MAX, "callback dispatch index to large for: %s", callback->name );
     /**
-     * has callback table entrys?
+     * reuse the index if it is big enough, otherwise alloc a new one
+     * rounded up to CALLBACK_DISPATCH_ROUND slots to absorb the next registrations
      */
-    if ( callback->entrys == 0 ) {
-        log_w("no callback found");
-        return( retval );
+    if( size > callback->dispatch_size ) {
+        if( callback->dispatch )
+            free( callback->dispatch );
+        callback->dispatch_size = ( size + CALLBACK_DISPATCH_ROUND - 1 ) & ~( CALLBACK_DISPATCH_ROUND - 1 );
+        callback->dispatch = (uint16_t*)callback_heap_alloc( sizeof( uint16_t ) * callback->dispatch_size );
     }
-
-    retval = true;
     /**
-     * crowl all callback entrys with their right mask and order
+     * set header offsets
+     */
+    uint16_t fill[ CALLBACK_DISPATCH_HEADER ];
+    uint16_t offset = CALLBACK_DISPATCH_HEADER;
+    for( int bit = 0 ; bit < CALLBACK_DISPATCH_BITS ; bit++ ) {
+        callback->dispatch[ bit ] = offset;
+        fill[ bit ] = offset;
+        offset += count[ bit ];
+    }
+    callback->dispatch[ CALLBACK_DISPATCH_ORDER ] = offset;
+    fill[ CALLBACK_DISPATCH_ORDER ] = offset;
+    callback->dispatch[ CALLBACK_DISPATCH_END ] = offset + active;
+    /**
+     * fill lists in prio and registration order
      */
     for( int prio = CALL_CB_NUM_START ; prio < CALL_CB_NUM ; prio++ ) {
-        for ( int entry = 0 ; entry < callback->entrys ; entry++ ) {
-            yield();
-            if ( event & callback->table[ entry ].event && callback->table[ entry ].prio == prio && callback->table[ entry ].active ) {
-                /**
-                 * print out callback event
-                 */
-                if ( callback->debug ) {
-                    log_i("call %s cb (%p:%04x:%s:%d)", callback->name, callback->table[ entry ].callback_func, event, callback->table[ entry ].id, callback->table[ entry ].prio );
+        for( int entry = 0 ; entry < callback->entrys ; entry++ ) {
+            if( !callback->table[ entry ].active || callback->table[ entry ].prio != prio )
+                continue;
+            for( int bit = 0 ; bit < CALLBACK_DISPATCH_BITS ; bit++ ) {
+                if( callback->table[ entry ].event & ( 1ul << bit ) )
+                    callback->dispatch[ fill[ bit ]++ ] = entry;
+            }
+            callback->dispatch[ fill[ CALLBACK_DISPATCH_ORDER ]++ ] = entry;
+        }
+    }
+    callback->dispatch_dirty = false;
+}
+
+/**
+ * @brief add a call time to the call time statistics
+ * 
+ * @param   stats           pointer to a callback_stats_t structure
+ * @param   time            call time in us
+ */
+static void callback_update_stats( callback_stats_t *stats, uint32_t time ) {
+    int slot = time ? 32 - __builtin_clz( time ) : 0;
+
+    if ( stats->calls == 0 || time < stats->time_min )
+        stats->time_min = time;
+    if ( time > stats->time_max )
+        stats->time_max = time;
+    stats->time_sum += time;
+    stats->calls++;
+    stats->histogram[ slot < CALLBACK_HISTOGRAM_SIZE ? slot : CALLBACK_HISTOGRAM_SIZE - 1 ]++;
+}
+
+/**
+ * @brief call a single callback table entry
+ * 
+ * @param   callback        pointer to a callback_t structure
+ * @param   entry           entry number in the callback table
+ * @param   event           event
+ * @param   arg             argument for the called callback function
+ * @param   log             true if logging allowed
+ * 
+ * @return  true if success or not called, false if the callback function failed
+ */
+static bool callback_call_entry( callback_t *callback, int entry, EventBits_t event, void *arg, bool log ) {
+    /**
+     * active state can change while dispatching
+     */
+    if ( !callback->table[ entry ].active )
+        return( true );
+    /**
+     * print out callback event
+     */
+    if ( log && callback->debug ) {
+        log_i("call %s cb (%p:%04x:%s:%d)", callback->name, callback->table[ entry ].callback_func, event, callback->table[ entry ].id, callback->table[ entry ].prio );
+    }
+    /**
+     * increment callback counter
+     */
+    callback->table[ entry ].counter++;
+    /**
+     * call callback an check the returnvalue
+     */
+    uint32_t start = micros();
+    bool retval = callback->table[ entry ].callback_func( event, arg );
+    callback_update_stats( &callback->table[ entry ].stats, micros() - start );
+
+    if ( !retval && log ) {
+        log_d("cb %s returns false", callback->table[ entry ].id );
+    }
+    return( retval );
+}
+
+/**
+ * @brief call all callback function thats match with the event mask
+ * 
+ * @param   callback        pointer to a callback_t structure
+ * @param   event           event filter mask
+ * @param   arg             argument for the called callback function
+ * @param   reverse         true for reverse order
+ * @param   log             true if logging allowed
+ * 
+ * @return  true if success, false if failed
+ */
+static bool callback_dispatch( callback_t *callback, EventBits_t event, void *arg, bool reverse, bool log ) {
+    bool retval = true;
+    /**
+     * rebuild dispatch index if needed and possible
+     */
+    if ( callback->dispatch_dirty && callback->dispatch_lock == 0 ) {
+        callback_build_dispatch( callback );
+    }
+    /**
+     * a nested send while the index is in use and outdated crowls the whole table
+     */
+    if ( callback->dispatch_dirty ) {
+        if ( reverse ) {
+            for( int prio = CALL_CB_NUM - 1 ; prio >= CALL_CB_NUM_START ; prio-- ) {
+                for ( int entry = callback->entrys - 1 ; entry >= 0 ; entry-- ) {
+                    if ( event & callback->table[ entry ].event && callback->table[ entry ].prio == prio ) {
+                        yield();
+                        if ( !callback_call_entry( callback, entry, event, arg, log ) )
+                            retval = false;
+                    }
                 }
-                /**
-                 * increment callback counter
-                 */
-                callback->table[ entry ].counter++;
-                /**
-                 * call callback an check the returnvalue
-                 */
-                if ( !callback->table[ entry ].callback_func( event, arg ) ) {
-                    log_d("cb %s returns false", callback->table[ entry ].id );
-                    retval = false;
+            }
+        }
+        else {
+            for( int prio = CALL_CB_NUM_START ; prio < CALL_CB_NUM ; prio++ ) {
+                for ( int entry = 0 ; entry < callback->entrys ; entry++ ) {
+                    if ( event & callback->table[ entry ].event && callback->table[ entry ].prio == prio ) {
+                        yield();
+                        if ( !callback_call_entry( callback, entry, event, arg, log ) )
+                            retval = false;
+                    }
                 }
             }
         }
+        return( retval );
+    }
+    /**
+     * a single event bit has it own list, all other use the prio
+     * sorted order list and check the mask
+     */
+    uint16_t start, end;
+    bool check_mask;
+
+    if ( event == 0 ) {
+        return( retval );
+    }
+    else if ( ( event & ( event - 1 ) ) == 0 ) {
+        int bit = __builtin_ctz( event );
+        start = callback->dispatch[ bit ];
+        end = callback->dispatch[ bit + 1 ];
+        check_mask = false;
     }
+    else {
+        start = callback->dispatch[ CALLBACK_DISPATCH_ORDER ];
+        end = callback->dispatch[ CALLBACK_DISPATCH_END ];
+        check_mask = true;
+    }
+    /**
+     * crowl the matching entrys, the index is locked against rebuild
+     * to keep it valid if a callback function register a new one
+     */
+    uint16_t *dispatch = callback->dispatch;
+    callback->dispatch_lock++;
+    for( int i = 0 ; i < end - start ; i++ ) {
+        int entry = dispatch[ reverse ? end - 1 - i : start + i ];
+        if ( check_mask && !( event & callback->table[ entry ].event ) )
+            continue;
+        yield();
+        if ( !callback_call_entry( callback, entry, event, arg, log ) )
+            retval = false;
+    }
+    callback->dispatch_lock--;
+
     return( retval );
 }
 
-bool callback_send_reverse( callback_t *callback, EventBits_t event, void *arg ) {
-    bool retval = false;
+bool callback_send( callback_t *callback, EventBits_t event, void *arg ) {
     /**
      * if callback table set?
      */
     if ( callback == NULL ) {
         log_e("no callback structure found");
-        return( retval );
+        return( false );
     }
     /**
      * has callback table entrys?
      */
     if ( callback->entrys == 0 ) {
         log_w("no callback found");
-        return( retval );
+        return( false );
     }
+    return( callback_dispatch( callback, event, arg, false, true ) );
+}
 
-    retval = true;
+bool callback_send_reverse( callback_t *callback, EventBits_t event, void *arg ) {
     /**
-     * crowl all callback entrys with their right mask
-     */
-    for( int prio = CALL_CB_NUM ; prio >= CALL_CB_NUM_START ; prio-- ) {
-        for ( int entry = callback->entrys - 1; entry >= 0 ; entry-- ) {
-            yield();
-            if ( event & callback->table[ entry ].event  && callback->table[ entry ].prio == prio && callback->table[ entry ].active ) {
-                /**
-                 * print out callback event
-                 */
-                if ( callback->debug ) {
-                    log_i("call %s cb (%p:%04x:%s:%d)", callback->name, callback->table[ entry ].callback_func, event, callback->table[ entry ].id, callback->table[ entry ].prio );
-                }
-                /**
-                 * increment callback counter
-                 */
-                callback->table[ entry ].counter++;
-                /**
-                 * call callback an check the returnvalue
-                 */
-                if ( !callback->table[ entry ].callback_func( event, arg ) ) {
-                    retval = false;
-                }
-            }
-        }
+     * if callback table set?
+     */
+    if ( callback == NULL ) {
+        log_e("no callback structure found");
+        return( false );
     }
-    return( retval );
+    /**
+     * has callback table entrys?
+     */
+    if ( callback->entrys == 0 ) {
+        log_w("no callback found");
+        return( false );
+    }
+    return( callback_dispatch( callback, event, arg, true, true ) );
 }
 
 bool callback_send_no_log( callback_t *callback, EventBits_t event, void *arg ) {
-    bool retval = false;
     /**
      * if callback table set?
      */
     if ( callback == NULL ) {
-        return( retval );
+        return( false );
     }
     /**
      * has callback table entrys?
      */
     if ( callback->entrys == 0 ) {
-        return( retval );
+        return( false );
     }
+    return( callback_dispatch( callback, event, arg, false, false ) );
+}
 
-    retval = true;
-    /**
-     * crowl all callback entrys with their right mask
-     */
-    for( int prio = CALL_CB_NUM_START ; prio < CALL_CB_NUM ; prio++ ) {
-        for ( int entry = 0 ; entry < callback->entrys ; entry++ ) {
-            yield();
-            if ( event & callback->table[ entry ].event  && callback->table[ entry ].prio == prio && callback->table[ entry ].active ) {
-                /**
-                 * increment callback counter
-                 */
-                callback->table[ entry ].counter++;
-                /**
-                 * call callback an check the returnvalue
-                 */
-                if ( !callback->table[ entry ].callback_func( event, arg ) ) {
-                    retval = false;
-                }
+#if defined( NATIVE_64BIT ) && defined( CALLBACK_BENCHMARK )
+static uint32_t callback_benchmark_calls = 0;                           /** @brief callback function calls during the benchmark */
+/**
+ * @brief benchmark callback function, one instance per registration because
+ * the same function can't be registered twice with the same prio
+ */
+template< int N > static bool callback_benchmark_cb( EventBits_t event, void *arg ) {
+    callback_benchmark_calls++;
+    return( true );
+}
+/**
+ * @brief fill a table with CALLBACK_BENCHMARK_ENTRYS benchmark callback functions
+ */
+template< int N > struct callback_benchmark_funcs {
+    static void fill( CALLBACK_FUNC *funcs ) {
+        funcs[ N - 1 ] = callback_benchmark_cb< N - 1 >;
+        callback_benchmark_funcs< N - 1 >::fill( funcs );
+    }
+};
+template<> struct callback_benchmark_funcs< 0 > {
+    static void fill( CALLBACK_FUNC *funcs ) {}
+};
+
+/**
+ * @brief register CALLBACK_BENCHMARK_ENTRYS callbacks, each on one event bit
+ * with rotating prio, send every event bit through the dispatch index and
+ * through the crowl over the whole table and log the time per send
+ */
+static void callback_benchmark( void ) {
+    static CALLBACK_FUNC funcs[ CALLBACK_BENCHMARK_ENTRYS ];
+    callback_t *callback = callback_init( "callback benchmark" );
+
+    callback_benchmark_funcs< CALLBACK_BENCHMARK_ENTRYS >::fill( funcs );
+    for( int i = 0 ; i < CALLBACK_BENCHMARK_ENTRYS ; i++ ) {
+        callback_register_with_prio( callback, 1ul << ( i % CALLBACK_DISPATCH_BITS ), funcs[ i ], "callback benchmark", (callback_prio_t)( CALL_CB_FIRST + i % 3 ) );
+    }
+
+    for( int path = 0 ; path < 2 ; path++ ) {
+        callback_benchmark_calls = 0;
+        /**
+         * an outdated and locked index makes callback_dispatch() crowl the whole table like before the index
+         */
+        if ( path == 1 ) {
+            callback->dispatch_dirty = true;
+            callback->dispatch_lock++;
+        }
+        uint64_t start = micros();
+        for( int run = 0 ; run < CALLBACK_BENCHMARK_RUNS ; run++ ) {
+            for( int bit = 0 ; bit < CALLBACK_DISPATCH_BITS ; bit++ ) {
+                callback_send_no_log( callback, 1ul << bit, NULL );
             }
         }
+        uint64_t time = micros() - start;
+        if ( path == 1 ) {
+            callback->dispatch_lock--;
+        }
+        log_i("callback benchmark: %s, %d callbacks, %d sends, %u calls, %lu ns per send",
+                path ? "table crowl" : "dispatch index", CALLBACK_BENCHMARK_ENTRYS, CALLBACK_BENCHMARK_RUNS * CALLBACK_DISPATCH_BITS,
+                callback_benchmark_calls, (unsigned long)( time * 1000 / ( CALLBACK_BENCHMARK_RUNS * CALLBACK_DISPATCH_BITS ) ) );
+    }
+    /**
+     * drop the benchmark callbacks from dispatching
+     */
+    for( int i = 0 ; i < CALLBACK_BENCHMARK_ENTRYS ; i++ ) {
+        callback_set_active( callback, funcs[ i ], (callback_prio_t)( CALL_CB_FIRST + i % 3 ), false );
     }
-    return( retval );
 }
+#endif
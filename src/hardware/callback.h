@@ -22,9 +22,28 @@
     #define _CALLBACK_H
 
     #include <stdint.h>
+    #include <stddef.h>
 
     typedef uint32_t EventBits_t;
 
+    #define CALLBACK_DISPATCH_BITS          32                                  /** @brief number of event bits in EventBits_t */
+    #define CALLBACK_DISPATCH_ORDER         CALLBACK_DISPATCH_BITS              /** @brief dispatch header slot for the start of the prio sorted order list */
+    #define CALLBACK_DISPATCH_END           ( CALLBACK_DISPATCH_BITS + 1 )      /** @brief dispatch header slot for the end of the prio sorted order list */
+    #define CALLBACK_DISPATCH_HEADER        ( CALLBACK_DISPATCH_BITS + 2 )      /** @brief dispatch header size */
+    #define CALLBACK_DISPATCH_ROUND         16                                  /** @brief dispatch index alloc granularity in slots, power of 2 */
+    #define CALLBACK_SLAB_SIZE              4096                                /** @brief size of a slab chunk for callback heads and tables */
+    #define CALLBACK_TABLE_MIN_CLASS        2                                   /** @brief smallest table size class, 2^n entrys */
+    #define CALLBACK_TABLE_CLASSES          16                                  /** @brief number of table size classes */
+    #define CALLBACK_HISTOGRAM_SIZE         16                                  /** @brief number of log2 histogram slots, slot n counts calls from 2^(n-1) to 2^n-1 us */
+    /**
+     * Uncomment to register CALLBACK_BENCHMARK_ENTRYS callbacks at the first
+     * callback_init() and log the callback_send() time through the dispatch
+     * index against the crowl over the whole table, emulator only.
+     */
+    // #define CALLBACK_BENCHMARK
+    #define CALLBACK_BENCHMARK_ENTRYS       256                                 /** @brief callbacks registered by the benchmark */
+    #define CALLBACK_BENCHMARK_RUNS         1000                                /** @brief callback_send() calls per event bit and path */
+
     /**
      * @brief prio type def
      */
@@ -46,6 +65,16 @@
      * @return          true if success or false if failed
      */
     typedef bool ( * CALLBACK_FUNC ) ( EventBits_t event, void *arg );
+    /**
+     * @brief callback function call time statistics
+     */
+    typedef struct {
+        uint32_t calls;                     /** @brief number of timed calls */
+        uint32_t time_min;                  /** @brief fastest call in us */
+        uint32_t time_max;                  /** @brief slowest call in us */
+        uint64_t time_sum;                  /** @brief sum of all call times in us */
+        uint32_t histogram[ CALLBACK_HISTOGRAM_SIZE ];  /** @brief log2 histogram of call times in us */
+    } callback_stats_t;
     /**
      * @brief callback table entry structure
      */
@@ -56,14 +85,20 @@
         bool active;                        /** @brief true if callback function is activated, false is deactivated */
         callback_prio_t prio;               /** @brief order to call cb functions, CALL_CB_FIRST means first */
         uint64_t counter;                   /** @brief callback function call counter thair returned true */
+        callback_stats_t stats;             /** @brief call time statistics */
     } callback_table_t;
     /**
      * @brief callback head structure
      */
     typedef struct callback_t {
         uint32_t entrys;                    /** @brief count callback entrys */
+        uint32_t size;                      /** @brief allocated callback entrys */
         bool debug;                         /** @brief debug flag, if TRUE to get debug messages */
         callback_table_t *table;            /** @brief pointer to an callback table */
+        uint16_t *dispatch;                 /** @brief per event bit and prio sorted dispatch index, see callback_build_dispatch() */
+        uint32_t dispatch_size;             /** @brief allocated dispatch index slots */
+        bool dispatch_dirty;                /** @brief true if the dispatch index has to be rebuild before the next send */
+        uint32_t dispatch_lock;             /** @brief >0 while a send walks the dispatch index, index can't be rebuild */
         const char *name;                   /** @brief id for the callback structure */
         callback_t *next_callback_t;        
     } callback_t;
@@ -100,6 +135,17 @@
      * @return  true if success, false if failed
      */
     bool callback_register_with_prio( callback_t *callback, EventBits_t event, CALLBACK_FUNC callback_func, const char *id, callback_prio_t prio );
+    /**
+     * @brief   activate or deactivate an registered callback function
+     * 
+     * @param   callback        pointer to a callback_t structure
+     * @param   callback_func   pointer to a callbackfunc
+     * @param   prio            prio the callback function was registered with
+     * @param   active          true to activate, false to deactivate
+     * 
+     * @return  true if success, false if failed
+     */
+    bool callback_set_active( callback_t *callback, CALLBACK_FUNC callback_func, callback_prio_t prio, bool active );
     /**
      * @brief   call all callback function thats match with the event filter mask
      * 
@@ -134,5 +180,56 @@
      * @brief prints out the complete callback table and their entrys
      */
     void callback_print( void );
+    /**
+     * @brief prints out the call time statistics of all callback table entrys thats was called
+     */
+    void callback_print_stats( void );
+    /**
+     * @brief reset the call time statistics of all callback table entrys
+     */
+    void callback_reset_stats( void );
+    /**
+     * @brief   get the number of heap allocations and their size made by the callback subsystem
+     * 
+     * @param   count           pointer to a uint32_t for the allocation count, can be NULL
+     * @param   bytes           pointer to a size_t for the allocated bytes, can be NULL
+     */
+    void callback_get_alloc_stats( uint32_t *count, size_t *bytes );
+    /**
+     * @brief get the first callback_t structure in the callback table chain, next one is in next_callback_t
+     * 
+     * @return  pointer to a callback_t structure, NULL if no one exist
+     */
+    callback_t *callback_get_head( void );
+    /**
+     * @brief   get a copy of the call time statistics from a callback table entry
+     * 
+     * @param   callback        pointer to a callback_t structure
+     * @param   entry           entry number in the callback table
+     * @param   stats           pointer to a callback_stats_t structure to fill
+     * 
+     * @return  true if success, false if failed
+     */
+    bool callback_get_stats( callback_t *callback, uint32_t entry, callback_stats_t *stats );
+    /**
+     * @brief   get a copy of the id and the call time statistics from a callback table entry,
+     *          safe to call from other tasks like the webserver while callbacks are registered
+     * 
+     * @param   callback        pointer to a callback_t structure
+     * @param   entry           entry number in the callback table
+     * @param   id              pointer to a const char pointer for the id, can be NULL
+     * @param   stats           pointer to a callback_stats_t structure to fill, can be NULL
+     * 
+     * @return  true if success, false if failed
+     */
+    bool callback_get_entry_snapshot( callback_t *callback, uint32_t entry, const char **id, callback_stats_t *stats );
+    /**
+     * @brief   get the mean call time from a callback_stats_t structure
+     * 
+     * @param   stats           pointer to a callback_stats_t structure
+     * 
+     * @return  mean call time in us
+     */
+    uint32_t callback_get_stats_mean( callback_stats_t *stats );
 
 #endif // _CALLBACK_H
\ No newline at end of file
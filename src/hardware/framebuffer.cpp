@@ -22,8 +22,11 @@
 #include "config.h"
 #include "lvgl.h"
 #include "framebuffer.h"
+#include "framebuffer_epd.h"
+#include "framebuffer_grey.h"
 #include "powermgm.h"
 #include "utils/alloc.h"
+#include "utils/frametime.h"
 /**
  * device depends includes and inits
  */
@@ -36,15 +39,14 @@
     #include <SDL2/SDL.h>
     #include "display/monitor.h"
     #include "utils/logging.h"
+    #include "utils/millis.h"
 #else
     #include <Arduino.h>
+    #include <esp_heap_caps.h>
     #if defined( M5PAPER )
         #include <M5EPD.h>
 
         M5EPD_Canvas canvas(&M5.EPD);
-        static uint64_t refreshdelay = 0;                                   /** @brief refresh delay counter to mark next screen refresh */
-        static lv_coord_t min_x = FRAMEBUFFER_BUFFER_W, max_x = 0;          /** @brief screen area to refresh */
-        static lv_coord_t min_y = FRAMEBUFFER_BUFFER_H, max_y = 0;          /** @brief screen area to refresh */
     #elif defined( M5CORE2 )
         #include <utility/In_eSPI.h>
 
@@ -65,19 +67,56 @@
     #endif
 #endif
 
+#if defined( M5PAPER )
+    #ifndef FRAMEBUFFER_REFRESH_DELAY
+        #define FRAMEBUFFER_REFRESH_DELAY   100
+    #endif
+    static bool framebuffer_refresh_pending = false;                /** @brief true if dirty rectangles wait for refresh */
+    static uint32_t framebuffer_refresh_tick = 0;                   /** @brief lvgl tick of the first flush since the last refresh */
+    static uint8_t *framebuffer_epd = NULL;                         /** @brief packed 4 bit pixel buffer for the e-ink panel */
+    static void framebuffer_rounder_cb( lv_disp_drv_t *disp_drv, lv_area_t *area );
+#endif
+
+#if defined( NATIVE_64BIT ) && !defined( M5PAPER )
+    #ifndef FRAMEBUFFER_SIM_SPI_HZ
+        #define FRAMEBUFFER_SIM_SPI_HZ      40000000                /** @brief simulated SPI clock, 0 disables the simulated transfer */
+    #endif
+    static lv_area_t framebuffer_sim_area;                          /** @brief area of the simulated transfer */
+    static lv_color_t *framebuffer_sim_color_p = NULL;              /** @brief pixel data of the simulated transfer */
+    static uint32_t framebuffer_sim_done = 0;                       /** @brief micros() when the simulated transfer is done */
+#endif
+#define FRAMEBUFFER_STATS_LOG_FRAMES        100                     /** @brief log the frame statistics every n frames */
+
 static bool framebuffer_drawing = true;                             /** @brief disable */
 static bool framebuffer_use_dma = false;
-lv_color_t *framebuffer_1 = NULL;                                     /** @brief pointer to a full size framebuffer */
-lv_color_t *framebuffer_2 = NULL;                                     /** @brief pointer to a full size framebuffer */
-uint32_t framebuffer_size = FRAMEBUFFER_BUFFER_SIZE;                /** @brief framebuffer size */
+static lv_disp_drv_t *framebuffer_dma_disp_drv = NULL;              /** @brief display driver with a transfer in flight, NULL if none */
+static uint32_t framebuffer_dma_start_us = 0;                       /** @brief micros() when the transfer in flight was started */
+static bool framebuffer_dma_last_frame = false;                     /** @brief true if the transfer in flight belongs to the last frame */
+static framebuffer_stats_t framebuffer_stats;                       /** @brief flush statistics of the last frame */
+static framebuffer_stats_t framebuffer_frame;                       /** @brief flush statistics of the frame in progress */
+lv_color_t *framebuffer_1 = NULL;                                     /** @brief pointer to a band framebuffer */
+lv_color_t *framebuffer_2 = NULL;                                     /** @brief pointer to a band framebuffer */
+uint32_t framebuffer_size = FRAMEBUFFER_BUFFER_SIZE;                /** @brief framebuffer size in pixel */
 
 bool framebuffer_powermgm_event_cb( EventBits_t event, void *arg );
 bool framebuffer_powermgm_loop_cb( EventBits_t event, void *arg );
 static void framebuffer_flush_cb( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p );
+static bool framebuffer_flush( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p );
+static void framebuffer_wait_cb( lv_disp_drv_t *disp_drv );
+static void framebuffer_monitor_cb( lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px );
+static uint32_t framebuffer_get_band_h( void );
+static void framebuffer_dma_start( lv_disp_drv_t *disp_drv );
+static bool framebuffer_dma_poll( void );
 
 void framebuffer_setup( void ) {
     static lv_disp_buf_t disp_buf;
     lv_disp_drv_t disp_drv;
+    /**
+     * build greyscale tables before the first flush
+     */
+    #if defined( MONOCHROME ) || defined( MONOCHROME_4BIT ) || defined( MONOCHROME_EINK ) || defined( M5PAPER )
+        framebuffer_grey_setup();
+    #endif
 
     #ifdef NATIVE_64BIT
         /**
@@ -94,10 +133,6 @@ void framebuffer_setup( void ) {
             canvas.createCanvas( 540, 960 );
             canvas.pushCanvas( UPDATE_MODE_GLD16 );
             canvas.deleteCanvas();
-            /**
-             * cleat next screen refresh time
-             */
-            refreshdelay = 0;
         #elif defined( M5CORE2 )
             tft.init();
             tft.setRotation(1);
@@ -141,48 +176,63 @@ void framebuffer_setup( void ) {
         #endif
     #endif
     /*
-     * allocate new framebuffer
+     * allocate new framebuffer, with DMA both band buffers go to DMA capable internal RAM
      */
-    if ( !framebuffer_1 ) {
-        if ( framebuffer_use_dma ) {
-            framebuffer_1 = (lv_color_t*)calloc( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H );
-        }
-        else {
-            framebuffer_1 = (lv_color_t*)CALLOC( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H );
+    if ( !framebuffer_1 && !framebuffer_2 ) {
+        framebuffer_stats.band_h = framebuffer_get_band_h();
+        framebuffer_size = FRAMEBUFFER_BUFFER_W * framebuffer_stats.band_h;
+
+        #ifndef NATIVE_64BIT
+            if ( framebuffer_use_dma ) {
+                framebuffer_1 = (lv_color_t*)heap_caps_calloc( framebuffer_size, sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL );
+                framebuffer_2 = (lv_color_t*)heap_caps_calloc( framebuffer_size, sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL );
+                /**
+                 * fall back to the non DMA path if internal RAM is short
+                 */
+                if ( !framebuffer_1 || !framebuffer_2 ) {
+                    log_w("no DMA capable framebuffer, disable DMA");
+                    heap_caps_free( framebuffer_1 );
+                    heap_caps_free( framebuffer_2 );
+                    framebuffer_1 = NULL;
+                    framebuffer_2 = NULL;
+                    framebuffer_use_dma = false;
+                }
+            }
+        #endif
+        if ( !framebuffer_use_dma ) {
+            framebuffer_1 = (lv_color_t*)CALLOC( sizeof(lv_color_t), framebuffer_size );
+            framebuffer_2 = (lv_color_t*)CALLOC( sizeof(lv_color_t), framebuffer_size );
         }
-        ASSERT( framebuffer_1, "framebuffer malloc failed" );
+        ASSERT( framebuffer_1 && framebuffer_2, "framebuffer malloc failed" );
         /**
          * log info about framebuffer
          */
         #ifdef NATIVE_64BIT
-            log_d("framebuffer 1: 0x%p (%ld bytes, %dx%dpx)", framebuffer_1, FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H * sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W, FRAMEBUFFER_BUFFER_H );
+            log_d("framebuffer 1: 0x%p, 2: 0x%p (%ld bytes each, %dx%dpx)", framebuffer_1, framebuffer_2, framebuffer_size * sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W, framebuffer_stats.band_h );
         #else
-            log_i("framebuffer 1: 0x%p (%d bytes, %dx%dpx)", framebuffer_1, FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H * sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W, FRAMEBUFFER_BUFFER_H );
+            log_i("framebuffer 1: 0x%p, 2: 0x%p (%d bytes each, %dx%dpx)", framebuffer_1, framebuffer_2, framebuffer_size * sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W, framebuffer_stats.band_h );
         #endif
     }
-    if ( !framebuffer_2 ) {
-        if ( framebuffer_use_dma ) {
-            framebuffer_2 = (lv_color_t*)calloc( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H );
-        }
-        else {
-            framebuffer_2 = (lv_color_t*)CALLOC( sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H );
-        }
-        ASSERT( framebuffer_2, "framebuffer malloc failed" );
+    #if defined( M5PAPER )
         /**
-         * log info about framebuffer
+         * allocate packed 4 bit buffer for the e-ink panel
          */
-        #ifdef NATIVE_64BIT
-            log_d("framebuffer 2: 0x%p (%ld bytes, %dx%dpx)", framebuffer_2, FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H * sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W, FRAMEBUFFER_BUFFER_H );
-        #else
-            log_i("framebuffer 2: 0x%p (%d bytes, %dx%dpx)", framebuffer_2, FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H * sizeof(lv_color_t), FRAMEBUFFER_BUFFER_W, FRAMEBUFFER_BUFFER_H );
-        #endif
-    }
+        if ( !framebuffer_epd ) {
+            framebuffer_epd = (uint8_t*)MALLOC_ASSERT( FRAMEBUFFER_BUFFER_SIZE / 2, "e-ink framebuffer malloc failed" );
+        }
+        framebuffer_refresh_pending = false;
+    #endif
     /*
      * set LVGL driver
      */
-    lv_disp_buf_init( &disp_buf, framebuffer_1, framebuffer_2, FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H );
+    lv_disp_buf_init( &disp_buf, framebuffer_1, framebuffer_2, framebuffer_size );
     lv_disp_drv_init( &disp_drv );
     disp_drv.flush_cb = framebuffer_flush_cb;
+    disp_drv.wait_cb = framebuffer_wait_cb;
+    disp_drv.monitor_cb = framebuffer_monitor_cb;
+    #if defined( M5PAPER )
+        disp_drv.rounder_cb = framebuffer_rounder_cb;
+    #endif
     disp_drv.buffer = &disp_buf;
     disp_drv.hor_res = RES_X_MAX;
     disp_drv.ver_res = RES_Y_MAX;
@@ -198,6 +248,7 @@ void framebuffer_setup( void ) {
 bool framebuffer_powermgm_event_cb( EventBits_t event, void *arg ) {
     switch( event ) {
         case POWERMGM_STANDBY:          log_d("go standby, refresh framebuffer");
+                                        while( framebuffer_dma_poll() );
                                         framebuffer_refresh();
                                         framebuffer_drawing = false;
                                         break;
@@ -212,46 +263,18 @@ bool framebuffer_powermgm_event_cb( EventBits_t event, void *arg ) {
 }
 
 bool framebuffer_powermgm_loop_cb( EventBits_t event, void *arg ) {
-    #ifdef NATIVE_64BIT
-    #else
-        #if defined( M5PAPER )
-            /**
-             * check if a refresh delay is set
-             */
-            if ( refreshdelay != 0 ) {
-                /**
-                 * check if refresh time is reached
-                 */
-                if ( refreshdelay < millis() ) {
-                    log_d("area: %d.%d / %d.%d", min_x, min_y, max_x, max_y );
-                    /**
-                     * check if we nee a full screen refresh or a specified area refresh
-                     */
-                    if ( min_x == FRAMEBUFFER_BUFFER_W && min_y == FRAMEBUFFER_BUFFER_H && max_x == 0 && max_y == 0 ) {
-                        log_d("refreshing full display");
-                        M5.EPD.UpdateFull( UPDATE_MODE_GC16 );
-                    }
-                    else {
-                        log_d("refreshing specified area display");
-                        M5.EPD.UpdateArea( min_x, min_y, max_x - min_x, max_y - min_y, UPDATE_MODE_GC16 );
-                    }
-                    /**
-                     * reset refreshdelay time an area
-                     */
-                    refreshdelay = 0;
-                    min_x = FRAMEBUFFER_BUFFER_W;
-                    max_x = 0;
-                    min_y = FRAMEBUFFER_BUFFER_H;
-                    max_y = 0;
-                }
-            }
-        #elif defined( M5CORE2 )
-        #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
-        #elif defined( LILYGO_WATCH_2021 )
-        #elif defined( WT32_SC01 )
-        #else
-            #error "no framebuffer powermgm loop event function implemented, please setup minimal drivers ( display/framebuffer/touch )"
-        #endif
+    /**
+     * hand a finished transfer back to lvgl even when it is not waiting
+     */
+    framebuffer_dma_poll();
+    #if defined( M5PAPER )
+        /**
+         * refresh all dirty rectangles when the refresh delay is reached
+         */
+        if ( framebuffer_refresh_pending && lv_tick_elaps( framebuffer_refresh_tick ) > FRAMEBUFFER_REFRESH_DELAY ) {
+            framebuffer_epd_refresh();
+            framebuffer_refresh_pending = false;
+        }
     #endif
     return( true );
 }
@@ -261,16 +284,12 @@ void framebuffer_refresh( void ) {
     #else
         #if defined( M5PAPER )
             /**
-             * do a full screen refresh
+             * do a full screen refresh, all dirty rectangles are covered
              */
             log_d("refreshing display");
-            log_d("area: %d.%d / %d.%d", min_x, min_y, max_x, max_y );
             M5.EPD.UpdateFull( UPDATE_MODE_GC16 );
-            refreshdelay = 0;
-            min_x = FRAMEBUFFER_BUFFER_W;
-            max_x = 0;
-            min_y = FRAMEBUFFER_BUFFER_H;
-            max_y = 0;
+            framebuffer_epd_clear();
+            framebuffer_refresh_pending = false;
         #elif defined( M5CORE2 )
         #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
         #elif defined( LILYGO_WATCH_2021 )
@@ -281,68 +300,211 @@ void framebuffer_refresh( void ) {
     #endif
 }
 
+void framebuffer_get_stats( framebuffer_stats_t *stats ) {
+    *stats = framebuffer_stats;
+}
+
+/**
+ * @brief get the band height, with DMA it is sized from the largest free internal block
+ * 
+ * @return  band height in lines
+ */
+static uint32_t framebuffer_get_band_h( void ) {
+    uint32_t band_h = FRAMEBUFFER_BAND_MIN_H;
+
+    #ifndef NATIVE_64BIT
+        if ( framebuffer_use_dma ) {
+            size_t largest = heap_caps_get_largest_free_block( MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL );
+            band_h = largest / FRAMEBUFFER_BAND_RAM_SHARE / ( FRAMEBUFFER_BUFFER_W * sizeof( lv_color_t ) );
+            band_h = LV_MATH_MAX( band_h, FRAMEBUFFER_BAND_MIN_H );
+            log_i("largest free internal block: %d bytes", largest );
+        }
+    #endif
+    return( LV_MATH_MIN( band_h, FRAMEBUFFER_BUFFER_H ) );
+}
+
+/**
+ * @brief check if the display transfer is still in flight
+ * 
+ * @return  true if busy
+ */
+static bool framebuffer_dma_busy( void ) {
+    #ifdef NATIVE_64BIT
+        #if defined( M5PAPER )
+            return( false );
+        #else
+            return( (int32_t)( (uint32_t)micros() - framebuffer_sim_done ) < 0 );
+        #endif
+    #else
+        #if defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
+            return( TTGOClass::getWatch()->tft->dmaBusy() );
+        #elif defined( LILYGO_WATCH_2021 ) || defined( WT32_SC01 )
+            return( tft.dmaBusy() );
+        #else
+            return( false );
+        #endif
+    #endif
+}
+
+/**
+ * @brief mark a transfer as in flight, lvgl gets the buffer back from framebuffer_dma_poll()
+ * 
+ * @param   disp_drv    display driver that owns the buffer
+ */
+static void framebuffer_dma_start( lv_disp_drv_t *disp_drv ) {
+    framebuffer_dma_start_us = micros();
+    framebuffer_dma_disp_drv = disp_drv;
+}
+
+/**
+ * @brief hand the buffer back to lvgl when the transfer is done
+ * 
+ * @return  true if a transfer is still in flight
+ */
+static bool framebuffer_dma_poll( void ) {
+    if ( !framebuffer_dma_disp_drv )
+        return( false );
+
+    if ( framebuffer_dma_busy() )
+        return( true );
+
+    #if !defined( NATIVE_64BIT ) && ( defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 ) )
+        /**
+         * release the spi transaction the flush left open for the DMA transfer
+         */
+        TTGOClass::getWatch()->tft->endWrite();
+    #endif
+    lv_disp_drv_t *disp_drv = framebuffer_dma_disp_drv;
+    framebuffer_stats_t *stats = framebuffer_dma_last_frame ? &framebuffer_stats : &framebuffer_frame;
+    framebuffer_dma_disp_drv = NULL;
+    framebuffer_dma_last_frame = false;
+    #if defined( NATIVE_64BIT ) && !defined( M5PAPER )
+        /**
+         * the simulated transfer reaches the window when it is done
+         */
+        stats->transfer_us += framebuffer_sim_done - framebuffer_dma_start_us;
+        monitor_flush( disp_drv, &framebuffer_sim_area, framebuffer_sim_color_p );
+    #else
+        /**
+         * without a completion interrupt the end is the moment it was seen
+         */
+        stats->transfer_us += (uint32_t)micros() - framebuffer_dma_start_us;
+    #endif
+    lv_disp_flush_ready( disp_drv );
+
+    return( false );
+}
+
+/**
+ * @brief called by lvgl while it waits for a flush, ends when the transfer is done
+ */
+static void framebuffer_wait_cb( lv_disp_drv_t *disp_drv ) {
+    uint32_t start = micros();
+
+    while( framebuffer_dma_poll() );
+    uint32_t elapsed = (uint32_t)micros() - start;
+    framebuffer_frame.wait_us += elapsed;
+    framebuffer_frame.flush_us += elapsed;
+}
+
+/**
+ * @brief called by lvgl after each refresh, closes the frame statistics
+ */
+static void framebuffer_monitor_cb( lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px ) {
+    framebuffer_frame.frames = framebuffer_stats.frames + 1;
+    framebuffer_frame.band_h = framebuffer_stats.band_h;
+    framebuffer_frame.px = px;
+    framebuffer_frame.frame_ms = time;
+    framebuffer_stats = framebuffer_frame;
+    frametime_add_frame( framebuffer_stats.frame_ms, framebuffer_stats.flush_us, framebuffer_stats.px, framebuffer_stats.bands );
+    framebuffer_frame = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    /**
+     * the last band may still be in flight, it counts to this frame
+     */
+    framebuffer_dma_last_frame = ( framebuffer_dma_disp_drv != NULL );
+
+    if ( framebuffer_stats.frames % FRAMEBUFFER_STATS_LOG_FRAMES == 0 )
+        log_d("frame %d: %dms, %d bands, transfer %dus, wait %dus", framebuffer_stats.frames, framebuffer_stats.frame_ms, framebuffer_stats.bands, framebuffer_stats.transfer_us, framebuffer_stats.wait_us );
+}
+
 static void framebuffer_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
-    if( !framebuffer_drawing )
-            lv_disp_flush_ready( disp_drv );
+    if( !framebuffer_drawing ) {
+        lv_disp_flush_ready( disp_drv );
+        return;
+    }
 
+    uint32_t start = micros();
+    bool in_flight = framebuffer_flush( disp_drv, area, color_p );
+    uint32_t elapsed = (uint32_t)micros() - start;
+
+    framebuffer_frame.bands++;
+    framebuffer_frame.flush_us += elapsed;
+    /**
+     * a synchronous transfer is done here, lvgl gets the buffer back now
+     */
+    if ( !in_flight ) {
+        framebuffer_frame.transfer_us += elapsed;
+        lv_disp_flush_ready( disp_drv );
+    }
+}
+
+/**
+ * @brief write a flush area to the display
+ * 
+ * @return  true if the transfer is still in flight and framebuffer_dma_poll() hands the buffer back
+ */
+static bool framebuffer_flush( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p ) {
     #ifdef NATIVE_64BIT
         /**
          * flush SDL screen
          */
         #if defined( MONOCHROME ) || defined( MONOCHROME_4BIT ) || defined( MONOCHROME_EINK )
-            lv_color_t *color = color_p;
-
-            for( int y = 0 ; y < ( area->y2 - area->y1 + 1 ); y++ ) {
-                for( int x = 0 ; x < ( area->x2 - area->x1 + 1 ); x++ ) {
-                    #if defined( MONOCHROME_4BIT )
-                        uint8_t brightness = ( lv_color_brightness( *color ) & 0xf0 );
-                    #elif defined( MONOCHROME_EINK )
-                        uint8_t brightness = ( lv_color_brightness( *color ) >> 2 ) * 3 + 64;
-                    #else
-                        uint8_t brightness = lv_color_brightness( *color );
-                    #endif
-                    *color = lv_color_make( brightness, brightness, brightness );
-                    color++;
-                }
-            }     
-            monitor_flush( disp_drv, area, color_p );
-        #else
-            monitor_flush( disp_drv, area, color_p );
+            #if defined( MONOCHROME_4BIT )
+                framebuffer_grey_convert( color_p, lv_area_get_size( area ), FRAMEBUFFER_GREY_4BIT );
+            #elif defined( MONOCHROME_EINK )
+                framebuffer_grey_convert( color_p, lv_area_get_size( area ), FRAMEBUFFER_GREY_EINK );
+            #else
+                framebuffer_grey_convert( color_p, lv_area_get_size( area ), FRAMEBUFFER_GREY_8BIT );
+            #endif
         #endif
-    #else
-        #if defined( M5PAPER )
-            lv_color_t *color = color_p;
+        #if !defined( M5PAPER )
             /**
-             * set/update area to freshing
+             * simulate a SPI display, the pixels reach the window when the transfer is done
              */
-            if ( min_x > area->x1 ) min_x = area->x1;
-            if ( min_y > area->y1 ) min_y = area->y1;
-            if ( max_x < area->x2 ) max_x = area->x2;
-            if ( max_y < area->y2 ) max_y = area->y2;
-            /**
-             * write buffer to display
-             */
-            canvas.createCanvas( area->x2 - area->x1, area->y2 - area->y1 );
+            if ( FRAMEBUFFER_SIM_SPI_HZ ) {
+                lv_area_copy( &framebuffer_sim_area, area );
+                framebuffer_sim_color_p = color_p;
+                framebuffer_dma_start( disp_drv );
+                framebuffer_sim_done = framebuffer_dma_start_us + (uint64_t)lv_area_get_size( area ) * 16 * 1000000 / FRAMEBUFFER_SIM_SPI_HZ;
+                return( true );
+            }
+        #endif
+        monitor_flush( disp_drv, area, color_p );
+        #if defined( M5PAPER )
             /**
-             * loop pixel data
+             * feed the e-ink refresh scheduler to simulate the panel
              */
-            for( int y = 0 ; y < ( area->y2 - area->y1 + 1 ); y++ ) {
-                for( int x = 0 ; x < ( area->x2 - area->x1 + 1 ); x++ ) {
-                    canvas.drawPixel( x, y, ( 255 - lv_color_brightness( *color ) ) >> 4 );
-                    color++;
-                }
+            framebuffer_epd_add_area( area, framebuffer_epd_pack( area, color_p, framebuffer_epd ) );
+            if ( !framebuffer_refresh_pending ) {
+                framebuffer_refresh_tick = lv_tick_get();
+                framebuffer_refresh_pending = true;
             }
+        #endif
+    #else
+        #if defined( M5PAPER )
             /**
-             * transfer canvas to the screen without update
-             * and delete canvas
+             * write packed 4 bit rows to the panel controller without update
+             * and add the area to the dirty rectangles
              */
-            canvas.pushCanvas( area->x1, area->y1, UPDATE_MODE_NONE );
-            canvas.deleteCanvas();
+            framebuffer_epd_mode_t mode = framebuffer_epd_pack( area, color_p, framebuffer_epd );
+            M5.EPD.WritePartGram4bpp( area->x1, area->y1, lv_area_get_width( area ), lv_area_get_height( area ), framebuffer_epd );
+            framebuffer_epd_add_area( area, mode );
             /**
              * set refresh time from now + FRAMEBUFFER_REFRESH_DELAY
              */
-            if ( refreshdelay == 0 ) {
-                refreshdelay = millis() + FRAMEBUFFER_REFRESH_DELAY;
+            if ( !framebuffer_refresh_pending ) {
+                framebuffer_refresh_tick = lv_tick_get();
+                framebuffer_refresh_pending = true;
             }
         #elif defined( M5CORE2 )
             /**
@@ -366,18 +528,29 @@ static void framebuffer_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
              */
             uint32_t size = (area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1) ;
             /**
+             * stop/wait last transmission
              * start data trnsmission
              * set the working window
              * and start DMA transfer if enabled
-             * stop transmission
              */
-            ttgo->tft->startWrite();
-            ttgo->tft->setAddrWindow(area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1));
-            if ( framebuffer_use_dma )
+            if ( framebuffer_use_dma ) {
+                ttgo->tft->endWrite();
+                ttgo->tft->startWrite();
+                ttgo->tft->setAddrWindow(area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1));
                 ttgo->tft->pushPixelsDMA(( uint16_t *)color_p, size);
-            else
+                /**
+                 * the transaction stays open while the DMA runs, endWrite() would wait for it.
+                 * lvgl gets the buffer back and the transaction is closed when the DMA transfer is done
+                 */
+                framebuffer_dma_start( disp_drv );
+                return( true );
+            }
+            else {
+                ttgo->tft->startWrite();
+                ttgo->tft->setAddrWindow(area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1));
                 ttgo->tft->pushPixels(( uint16_t *)color_p, size);
-            ttgo->tft->endWrite();
+                ttgo->tft->endWrite();
+            }
         #elif defined( LILYGO_WATCH_2021 )
             /**
              * get buffer size
@@ -393,6 +566,11 @@ static void framebuffer_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
                 tft.endWrite();
                 tft.startWrite();
                 tft.pushImageDMA( area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1), ( uint16_t *)color_p );
+                /**
+                 * lvgl gets the buffer back when the DMA transfer is done
+                 */
+                framebuffer_dma_start( disp_drv );
+                return( true );
             }
             else {
                 tft.startWrite();
@@ -415,6 +593,11 @@ static void framebuffer_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
                 tft.endWrite();
                 tft.startWrite();
                 tft.pushImageDMA( area->x1, area->y1, (area->x2 - area->x1 + 1), (area->y2 - area->y1 + 1), ( uint16_t *)color_p );
+                /**
+                 * lvgl gets the buffer back when the DMA transfer is done
+                 */
+                framebuffer_dma_start( disp_drv );
+                return( true );
             }
             else {
                 tft.startWrite();
@@ -426,5 +609,15 @@ static void framebuffer_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area,
             #error "no LVGL display driver function implemented, please setup minimal drivers ( display/framebuffer/touch )"
         #endif
     #endif
-    lv_disp_flush_ready( disp_drv );
+    return( false );
 }
+
+#if defined( M5PAPER )
+    /**
+     * @brief align flush areas to 4 pixel, so each packed 4 bit row starts and ends on a byte boundary
+     */
+    static void framebuffer_rounder_cb( lv_disp_drv_t *disp_drv, lv_area_t *area ) {
+        area->x1 = area->x1 & ~3;
+        area->x2 = ( area->x2 | 3 ) < disp_drv->hor_res ? ( area->x2 | 3 ) : disp_drv->hor_res - 1;
+    }
+#endif
@@ -25,31 +25,59 @@
     #include "lvgl.h"
     #include "config.h"
 
+    /**
+     * FRAMEBUFFER_BUFFER_H is the max band height, FRAMEBUFFER_BAND_MIN_H the band height
+     * without DMA or when internal RAM is short
+     */
     #ifdef NATIVE_64BIT
             #define FRAMEBUFFER_BUFFER_W        LV_HOR_RES_MAX
             #define FRAMEBUFFER_BUFFER_H        LV_VER_RES_MAX
+            #if defined( M5PAPER )
+                #define FRAMEBUFFER_BAND_MIN_H  LV_VER_RES_MAX
+            #else
+                #define FRAMEBUFFER_BAND_MIN_H  40
+            #endif
     #else
         #if defined( M5PAPER )
             #define FRAMEBUFFER_BUFFER_W        RES_X_MAX
             #define FRAMEBUFFER_BUFFER_H        RES_Y_MAX
+            #define FRAMEBUFFER_BAND_MIN_H      RES_Y_MAX
             #define FRAMEBUFFER_REFRESH_DELAY   100
         #elif defined( M5CORE2 )
             #define FRAMEBUFFER_BUFFER_W        RES_X_MAX
             #define FRAMEBUFFER_BUFFER_H        10
+            #define FRAMEBUFFER_BAND_MIN_H      10
         #elif defined( LILYGO_WATCH_2020_V1 ) || defined( LILYGO_WATCH_2020_V2 ) || defined( LILYGO_WATCH_2020_V3 )
             #define FRAMEBUFFER_BUFFER_W        RES_X_MAX
-            #define FRAMEBUFFER_BUFFER_H        10
+            #define FRAMEBUFFER_BUFFER_H        40
+            #define FRAMEBUFFER_BAND_MIN_H      10
         #elif defined( LILYGO_WATCH_2021 )
             #define FRAMEBUFFER_BUFFER_W        RES_X_MAX
-            #define FRAMEBUFFER_BUFFER_H        10
+            #define FRAMEBUFFER_BUFFER_H        40
+            #define FRAMEBUFFER_BAND_MIN_H      10
         #elif defined( WT32_SC01 )
             #define FRAMEBUFFER_BUFFER_W        RES_X_MAX
             #define FRAMEBUFFER_BUFFER_H        40
+            #define FRAMEBUFFER_BAND_MIN_H      10
         #endif
     #endif
 
+    #define FRAMEBUFFER_BAND_RAM_SHARE  8               /** @brief a DMA band buffer may use 1/8 of the largest free internal block */
     #define FRAMEBUFFER_BUFFER_SIZE     ( FRAMEBUFFER_BUFFER_W * FRAMEBUFFER_BUFFER_H )
 
+    /**
+     * @brief per frame flush statistics
+     */
+    typedef struct {
+        uint32_t frames;                                /** @brief number of refreshed frames */
+        uint32_t band_h;                                /** @brief band height in lines */
+        uint32_t bands;                                 /** @brief bands flushed in the last frame */
+        uint32_t px;                                    /** @brief pixel refreshed in the last frame */
+        uint32_t frame_ms;                              /** @brief refresh time of the last frame, rendering and flush */
+        uint32_t flush_us;                              /** @brief time the cpu spent in flush or waiting for a transfer in the last frame */
+        uint32_t transfer_us;                           /** @brief time the display transfers were in flight in the last frame */
+        uint32_t wait_us;                               /** @brief time lvgl waited for a transfer in the last frame */
+    } framebuffer_stats_t;
     /**
      * @brief setup framebuffer
      */
@@ -58,4 +86,10 @@
      * @brief force framebuffer refresh to screen/display
      */
     void framebuffer_refresh( void );
+    /**
+     * @brief get the flush statistics of the last frame
+     * 
+     * @param   stats       pointer to a framebuffer_stats_t structure
+     */
+    void framebuffer_get_stats( framebuffer_stats_t *stats );
 #endif // _FRAMEBUFFER_H
\ No newline at end of file
@@ -0,0 +1,162 @@
+/****************************************************************************
+ *   Oct 17 14:02:11 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "framebuffer_epd.h"
+#include "framebuffer_grey.h"
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+    #if defined( M5PAPER )
+        #include <M5EPD.h>
+    #endif
+#endif
+
+static framebuffer_epd_rect_t framebuffer_epd_rect[ FRAMEBUFFER_EPD_RECTS ];   /** @brief dirty rectangle list */
+static int framebuffer_epd_rects = 0;                                           /** @brief number of dirty rectangles */
+static framebuffer_epd_stats_t framebuffer_epd_stats;                           /** @brief refresh statistics */
+
+/**
+ * @brief get the cost to refresh an area
+ * 
+ * @param   area        pointer to the area
+ * 
+ * @return  cost in pixel
+ */
+static uint32_t framebuffer_epd_cost( const lv_area_t *area ) {
+    return( FRAMEBUFFER_EPD_UPDATE_COST + lv_area_get_size( area ) );
+}
+
+/**
+ * @brief get the extra cost when two rectangles are merged
+ * 
+ * @param   a           pointer to the first rectangle
+ * @param   b           pointer to the second rectangle
+ * @param   merged      pointer to an area for the merged rectangle
+ * 
+ * @return  extra cost in pixel, negative if the merge is cheaper
+ */
+static int32_t framebuffer_epd_merge_cost( const framebuffer_epd_rect_t *a, const framebuffer_epd_rect_t *b, lv_area_t *merged ) {
+    merged->x1 = LV_MATH_MIN( a->area.x1, b->area.x1 );
+    merged->y1 = LV_MATH_MIN( a->area.y1, b->area.y1 );
+    merged->x2 = LV_MATH_MAX( a->area.x2, b->area.x2 );
+    merged->y2 = LV_MATH_MAX( a->area.y2, b->area.y2 );
+
+    return( (int32_t)framebuffer_epd_cost( merged ) - (int32_t)framebuffer_epd_cost( &a->area ) - (int32_t)framebuffer_epd_cost( &b->area ) );
+}
+
+framebuffer_epd_mode_t framebuffer_epd_pack( const lv_area_t *area, const lv_color_t *color_p, uint8_t *dst ) {
+    /**
+     * DU can only drive full black or white
+     */
+    if ( framebuffer_grey_pack_4bit( color_p, dst, lv_area_get_size( area ) ) )
+        return( FRAMEBUFFER_EPD_MODE_DU );
+    return( FRAMEBUFFER_EPD_MODE_GC16 );
+}
+
+void framebuffer_epd_add_area( const lv_area_t *area, framebuffer_epd_mode_t mode ) {
+    framebuffer_epd_rect_t rect;
+    lv_area_t merged;
+
+    lv_area_copy( &rect.area, area );
+    rect.mode = mode;
+    /**
+     * merge with all dirty rectangles where the merge is cheaper, restart after
+     * each merge because the grown rectangle can make other merges cheaper
+     */
+    for( int i = 0 ; i < framebuffer_epd_rects ; i++ ) {
+        if ( framebuffer_epd_merge_cost( &framebuffer_epd_rect[ i ], &rect, &merged ) <= 0 ) {
+            lv_area_copy( &rect.area, &merged );
+            rect.mode = LV_MATH_MAX( rect.mode, framebuffer_epd_rect[ i ].mode );
+            framebuffer_epd_rect[ i ] = framebuffer_epd_rect[ --framebuffer_epd_rects ];
+            i = -1;
+        }
+    }
+    /**
+     * if the list is full, merge with the rectangle thats cost the least
+     */
+    if ( framebuffer_epd_rects == FRAMEBUFFER_EPD_RECTS ) {
+        int best = 0;
+        int32_t best_cost = INT32_MAX;
+
+        for( int i = 0 ; i < framebuffer_epd_rects ; i++ ) {
+            int32_t cost = framebuffer_epd_merge_cost( &framebuffer_epd_rect[ i ], &rect, &merged );
+            if ( cost < best_cost ) {
+                best_cost = cost;
+                best = i;
+            }
+        }
+        framebuffer_epd_merge_cost( &framebuffer_epd_rect[ best ], &rect, &merged );
+        lv_area_copy( &rect.area, &merged );
+        rect.mode = LV_MATH_MAX( rect.mode, framebuffer_epd_rect[ best ].mode );
+        framebuffer_epd_rect[ best ] = framebuffer_epd_rect[ --framebuffer_epd_rects ];
+    }
+    framebuffer_epd_rect[ framebuffer_epd_rects++ ] = rect;
+}
+
+int framebuffer_epd_get_rects( void ) {
+    return( framebuffer_epd_rects );
+}
+
+void framebuffer_epd_refresh( void ) {
+    uint32_t frame_ms = 0;
+    uint32_t frame_pixels = 0;
+
+    if ( framebuffer_epd_rects == 0 ) {
+        return;
+    }
+
+    for( int i = 0 ; i < framebuffer_epd_rects ; i++ ) {
+        framebuffer_epd_rect_t *rect = &framebuffer_epd_rect[ i ];
+        uint32_t pixels = lv_area_get_size( &rect->area );
+        /**
+         * update the area on the panel
+         */
+        #if !defined( NATIVE_64BIT ) && defined( M5PAPER )
+            M5.EPD.UpdateArea( rect->area.x1, rect->area.y1, lv_area_get_width( &rect->area ), lv_area_get_height( &rect->area ), rect->mode == FRAMEBUFFER_EPD_MODE_DU ? UPDATE_MODE_DU : UPDATE_MODE_GC16 );
+        #endif
+        /**
+         * panel model: waveform time per update plus pixel transfer time
+         */
+        frame_ms += ( rect->mode == FRAMEBUFFER_EPD_MODE_DU ? FRAMEBUFFER_EPD_DU_MS : FRAMEBUFFER_EPD_GC16_MS ) + pixels / FRAMEBUFFER_EPD_PX_PER_MS;
+        frame_pixels += pixels;
+        framebuffer_epd_stats.updates++;
+        if ( rect->mode == FRAMEBUFFER_EPD_MODE_DU )
+            framebuffer_epd_stats.du_updates++;
+        log_d("epd update %d.%d / %d.%d, mode: %s", rect->area.x1, rect->area.y1, rect->area.x2, rect->area.y2, rect->mode == FRAMEBUFFER_EPD_MODE_DU ? "DU" : "GC16" );
+    }
+    framebuffer_epd_stats.frames++;
+    framebuffer_epd_stats.pixels += frame_pixels;
+    framebuffer_epd_stats.cost_ms += frame_ms;
+    log_d("epd frame %d: %d updates, %d px, ~%dms", framebuffer_epd_stats.frames, framebuffer_epd_rects, frame_pixels, frame_ms );
+
+    framebuffer_epd_rects = 0;
+}
+
+void framebuffer_epd_clear( void ) {
+    framebuffer_epd_rects = 0;
+}
+
+framebuffer_epd_stats_t *framebuffer_epd_get_stats( void ) {
+    return( &framebuffer_epd_stats );
+}
@@ -0,0 +1,95 @@
+/****************************************************************************
+ *   Oct 17 14:02:11 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _FRAMEBUFFER_EPD_H
+    #define _FRAMEBUFFER_EPD_H
+
+    #include "lvgl.h"
+    #include "config.h"
+
+    #define FRAMEBUFFER_EPD_RECTS           8               /** @brief max number of dirty rectangles */
+    #define FRAMEBUFFER_EPD_UPDATE_COST     32768           /** @brief fixed cost of one area update in pixel, used to decide if a merge is cheaper */
+    #define FRAMEBUFFER_EPD_DU_MS           260             /** @brief simulated waveform time for a DU update */
+    #define FRAMEBUFFER_EPD_GC16_MS         450             /** @brief simulated waveform time for a GC16 update */
+    #define FRAMEBUFFER_EPD_PX_PER_MS       2000            /** @brief simulated 4bpp pixel transfer rate to the panel controller */
+    /**
+     * @brief e-ink update mode for a dirty rectangle
+     */
+    typedef enum {
+        FRAMEBUFFER_EPD_MODE_DU = 0,                        /** @brief fast black/white update */
+        FRAMEBUFFER_EPD_MODE_GC16                           /** @brief 16 level greyscale update */
+    } framebuffer_epd_mode_t;
+    /**
+     * @brief dirty rectangle
+     */
+    typedef struct {
+        lv_area_t area;                                     /** @brief area to refresh */
+        framebuffer_epd_mode_t mode;                        /** @brief update mode */
+    } framebuffer_epd_rect_t;
+    /**
+     * @brief e-ink refresh statistics
+     */
+    typedef struct {
+        uint32_t frames;                                    /** @brief number of refresh runs */
+        uint32_t updates;                                   /** @brief number of area updates */
+        uint32_t du_updates;                                /** @brief number of DU area updates */
+        uint64_t pixels;                                    /** @brief refreshed pixels */
+        uint64_t cost_ms;                                   /** @brief simulated refresh time in ms */
+    } framebuffer_epd_stats_t;
+    /**
+     * @brief convert a flush area into packed 4 bit rows, two pixels per byte with the left one in the high nibble
+     * 
+     * @param   area        area to convert, x1 and width must be aligned to 4 pixel
+     * @param   color_p     pointer to the lvgl pixel data
+     * @param   dst         pointer to the packed destination, ( width * height ) / 2 bytes
+     * 
+     * @return  FRAMEBUFFER_EPD_MODE_DU if all pixels are black or white, otherwise FRAMEBUFFER_EPD_MODE_GC16
+     */
+    framebuffer_epd_mode_t framebuffer_epd_pack( const lv_area_t *area, const lv_color_t *color_p, uint8_t *dst );
+    /**
+     * @brief add a dirty rectangle, it is merged with other ones only when the merge is cheaper than two updates
+     * 
+     * @param   area        area to refresh
+     * @param   mode        update mode
+     */
+    void framebuffer_epd_add_area( const lv_area_t *area, framebuffer_epd_mode_t mode );
+    /**
+     * @brief get the number of dirty rectangles
+     * 
+     * @return  number of dirty rectangles
+     */
+    int framebuffer_epd_get_rects( void );
+    /**
+     * @brief refresh all dirty rectangles, on native build the refresh is simulated
+     */
+    void framebuffer_epd_refresh( void );
+    /**
+     * @brief drop all dirty rectangles, e.g. after a full screen refresh
+     */
+    void framebuffer_epd_clear( void );
+    /**
+     * @brief get the refresh statistics
+     * 
+     * @return  pointer to the refresh statistics
+     */
+    framebuffer_epd_stats_t *framebuffer_epd_get_stats( void );
+
+#endif // _FRAMEBUFFER_EPD_H
@@ -0,0 +1,261 @@
+/****************************************************************************
+ *   Oct 17 15:20:42 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include "framebuffer_grey.h"
+
+#ifdef NATIVE_64BIT
+    #include <stdlib.h>
+    #include <string.h>
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+#endif
+/**
+ * channel table size, only 16 and 32 bit colors are converted by table
+ */
+#if LV_COLOR_DEPTH == 16
+    #define FRAMEBUFFER_GREY_R_SIZE     32
+    #define FRAMEBUFFER_GREY_G_SIZE     64
+    #define FRAMEBUFFER_GREY_B_SIZE     32
+    #define FRAMEBUFFER_GREY_TABLE
+#elif LV_COLOR_DEPTH == 32
+    #define FRAMEBUFFER_GREY_R_SIZE     256
+    #define FRAMEBUFFER_GREY_G_SIZE     256
+    #define FRAMEBUFFER_GREY_B_SIZE     256
+    #define FRAMEBUFFER_GREY_TABLE
+#endif
+
+static bool framebuffer_grey_ready = false;                                                 /** @brief true if the tables are ready */
+#ifdef FRAMEBUFFER_GREY_TABLE
+    static uint16_t framebuffer_grey_r[ FRAMEBUFFER_GREY_R_SIZE ];                          /** @brief weighted red part of the brightness */
+    static uint16_t framebuffer_grey_g[ FRAMEBUFFER_GREY_G_SIZE ];                          /** @brief weighted green part of the brightness */
+    static uint16_t framebuffer_grey_b[ FRAMEBUFFER_GREY_B_SIZE ];                          /** @brief weighted blue part of the brightness */
+#endif
+static uint8_t framebuffer_grey_map[ FRAMEBUFFER_GREY_MAPS ][ 256 ];                        /** @brief brightness to mapped grey value */
+static lv_color_t framebuffer_grey_color[ FRAMEBUFFER_GREY_MAPS ][ 256 ];                   /** @brief brightness to mapped grey lvgl color */
+
+/**
+ * @brief get the brightness of a pixel, same result as lv_color_brightness()
+ * but the channel expansion and weighting is done by table
+ * 
+ * @param   color       lvgl color
+ * 
+ * @return  brightness 0..255
+ */
+#if defined( NATIVE_64BIT ) && defined( FRAMEBUFFER_GREY_BENCHMARK )
+    static void framebuffer_grey_benchmark( void );
+#endif
+
+static inline uint8_t framebuffer_grey_brightness( lv_color_t color ) {
+#ifdef FRAMEBUFFER_GREY_TABLE
+    return( ( framebuffer_grey_r[ LV_COLOR_GET_R( color ) ] + framebuffer_grey_g[ LV_COLOR_GET_G( color ) ] + framebuffer_grey_b[ LV_COLOR_GET_B( color ) ] ) >> 3 );
+#else
+    return( lv_color_brightness( color ) );
+#endif
+}
+
+void framebuffer_grey_setup( void ) {
+    if ( framebuffer_grey_ready )
+        return;
+#ifdef FRAMEBUFFER_GREY_TABLE
+    /**
+     * expand each channel with lvgl's own color conversion and store it
+     * with the lv_color_brightness() weights 3/4/1
+     */
+    for( int i = 0 ; i < FRAMEBUFFER_GREY_R_SIZE ; i++ ) {
+        lv_color_t color;
+        color.full = 0;
+        LV_COLOR_SET_R( color, i );
+        lv_color32_t c32;
+        c32.full = lv_color_to32( color );
+        framebuffer_grey_r[ i ] = 3 * c32.ch.red;
+    }
+    for( int i = 0 ; i < FRAMEBUFFER_GREY_G_SIZE ; i++ ) {
+        lv_color_t color;
+        color.full = 0;
+        LV_COLOR_SET_G( color, i );
+        lv_color32_t c32;
+        c32.full = lv_color_to32( color );
+        framebuffer_grey_g[ i ] = 4 * c32.ch.green;
+    }
+    for( int i = 0 ; i < FRAMEBUFFER_GREY_B_SIZE ; i++ ) {
+        lv_color_t color;
+        color.full = 0;
+        LV_COLOR_SET_B( color, i );
+        lv_color32_t c32;
+        c32.full = lv_color_to32( color );
+        framebuffer_grey_b[ i ] = c32.ch.blue;
+    }
+#endif
+    /**
+     * build the grey mappings and their lvgl colors
+     */
+    for( int i = 0 ; i < 256 ; i++ ) {
+        framebuffer_grey_map[ FRAMEBUFFER_GREY_8BIT ][ i ] = i;
+        framebuffer_grey_map[ FRAMEBUFFER_GREY_4BIT ][ i ] = i & 0xf0;
+        framebuffer_grey_map[ FRAMEBUFFER_GREY_EINK ][ i ] = ( i >> 2 ) * 3 + 64;
+        framebuffer_grey_map[ FRAMEBUFFER_GREY_INVERT_4BIT ][ i ] = ( 255 - i ) >> 4;
+
+        for( int map = 0 ; map < FRAMEBUFFER_GREY_MAPS ; map++ ) {
+            uint8_t grey = framebuffer_grey_map[ map ][ i ];
+            framebuffer_grey_color[ map ][ i ] = lv_color_make( grey, grey, grey );
+        }
+    }
+    framebuffer_grey_ready = true;
+#if defined( NATIVE_64BIT ) && LV_COLOR_DEPTH == 16
+    /**
+     * check the tables against lvgl, it is cheap enough on the host
+     */
+    for( uint32_t i = 0 ; i < 0x10000 ; i++ ) {
+        lv_color_t color;
+        color.full = i;
+        if ( framebuffer_grey_brightness( color ) != lv_color_brightness( color ) ) {
+            log_e("greyscale table differs from lv_color_brightness() at 0x%04x", i );
+            break;
+        }
+    }
+#endif
+#if defined( NATIVE_64BIT ) && defined( FRAMEBUFFER_GREY_BENCHMARK )
+    framebuffer_grey_benchmark();
+#endif
+}
+
+void framebuffer_grey_convert( lv_color_t *color_p, uint32_t size, framebuffer_grey_map_t map ) {
+    framebuffer_grey_setup();
+
+    const lv_color_t *grey_color = framebuffer_grey_color[ map ];
+    uint32_t i = 0;
+    /**
+     * two pixel per round to keep both table lookups in flight
+     */
+    for( ; i + 1 < size ; i += 2 ) {
+        uint8_t left = framebuffer_grey_brightness( color_p[ i ] );
+        uint8_t right = framebuffer_grey_brightness( color_p[ i + 1 ] );
+        color_p[ i ] = grey_color[ left ];
+        color_p[ i + 1 ] = grey_color[ right ];
+    }
+    if ( i < size )
+        color_p[ i ] = grey_color[ framebuffer_grey_brightness( color_p[ i ] ) ];
+}
+
+void framebuffer_grey_to_8bit( const lv_color_t *color_p, uint8_t *dst, uint32_t size, framebuffer_grey_map_t map ) {
+    framebuffer_grey_setup();
+
+    const uint8_t *grey_map = framebuffer_grey_map[ map ];
+    uint32_t i = 0;
+
+    for( ; i + 1 < size ; i += 2 ) {
+        uint8_t left = framebuffer_grey_brightness( color_p[ i ] );
+        uint8_t right = framebuffer_grey_brightness( color_p[ i + 1 ] );
+        dst[ i ] = grey_map[ left ];
+        dst[ i + 1 ] = grey_map[ right ];
+    }
+    if ( i < size )
+        dst[ i ] = grey_map[ framebuffer_grey_brightness( color_p[ i ] ) ];
+}
+
+bool framebuffer_grey_pack_4bit( const lv_color_t *color_p, uint8_t *dst, uint32_t size ) {
+    framebuffer_grey_setup();
+
+    const uint8_t *grey_map = framebuffer_grey_map[ FRAMEBUFFER_GREY_INVERT_4BIT ];
+    uint8_t grey = 0;
+
+    for( uint32_t i = 0 ; i + 1 < size ; i += 2 ) {
+        uint8_t left = grey_map[ framebuffer_grey_brightness( color_p[ i ] ) ];
+        uint8_t right = grey_map[ framebuffer_grey_brightness( color_p[ i + 1 ] ) ];
+        /**
+         * ( n + 1 ) & 0xe is zero only for 0x0 and 0xf, so grey
+         * collects any level between black and white without a branch
+         */
+        grey |= ( ( left + 1 ) & 0xe ) | ( ( right + 1 ) & 0xe );
+        *dst++ = ( left << 4 ) | right;
+    }
+    return( grey == 0 );
+}
+
+#if defined( NATIVE_64BIT ) && defined( FRAMEBUFFER_GREY_BENCHMARK )
+/**
+ * @brief pixels per second from a run time
+ */
+static uint32_t framebuffer_grey_benchmark_rate( uint64_t start ) {
+    uint64_t time = micros() - start;
+    return( time ? ( uint64_t )FRAMEBUFFER_GREY_BENCHMARK_RUNS * 0x10000 * 1000000 / time : 0 );
+}
+
+static void framebuffer_grey_benchmark( void ) {
+    const char *map_name[ FRAMEBUFFER_GREY_MAPS ] = { "8bit", "4bit", "eink", "invert 4bit" };
+    lv_color_t *src = (lv_color_t *)malloc( sizeof( lv_color_t ) * 0x10000 );
+    lv_color_t *buf = (lv_color_t *)malloc( sizeof( lv_color_t ) * 0x10000 );
+    uint8_t *dst = (uint8_t *)malloc( 0x10000 );
+    uint32_t sum = 0;
+    uint64_t start;
+
+    if ( src && buf && dst ) {
+        for( uint32_t i = 0 ; i < 0x10000 ; i++ )
+            src[ i ].full = i;
+
+        for( int map = 0 ; map < FRAMEBUFFER_GREY_MAPS ; map++ ) {
+            /**
+             * per pixel path as it was done before the tables, the source is restored each run
+             */
+            start = micros();
+            for( int run = 0 ; run < FRAMEBUFFER_GREY_BENCHMARK_RUNS ; run++ ) {
+                memcpy( buf, src, sizeof( lv_color_t ) * 0x10000 );
+                for( uint32_t i = 0 ; i < 0x10000 ; i++ ) {
+                    uint8_t grey = framebuffer_grey_map[ map ][ lv_color_brightness( buf[ i ] ) ];
+                    buf[ i ] = lv_color_make( grey, grey, grey );
+                }
+                sum += buf[ run ].full;
+            }
+            uint32_t plain = framebuffer_grey_benchmark_rate( start );
+
+            start = micros();
+            for( int run = 0 ; run < FRAMEBUFFER_GREY_BENCHMARK_RUNS ; run++ ) {
+                memcpy( buf, src, sizeof( lv_color_t ) * 0x10000 );
+                framebuffer_grey_convert( buf, 0x10000, (framebuffer_grey_map_t)map );
+                sum += buf[ run ].full;
+            }
+            uint32_t convert = framebuffer_grey_benchmark_rate( start );
+
+            start = micros();
+            for( int run = 0 ; run < FRAMEBUFFER_GREY_BENCHMARK_RUNS ; run++ ) {
+                framebuffer_grey_to_8bit( src, dst, 0x10000, (framebuffer_grey_map_t)map );
+                sum += dst[ run ];
+            }
+            uint32_t to_8bit = framebuffer_grey_benchmark_rate( start );
+
+            log_i("grey benchmark %s: per pixel %u, convert %u, to 8bit %u pixels/s", map_name[ map ], plain, convert, to_8bit );
+        }
+
+        start = micros();
+        for( int run = 0 ; run < FRAMEBUFFER_GREY_BENCHMARK_RUNS ; run++ ) {
+            framebuffer_grey_pack_4bit( src, dst, 0x10000 );
+            sum += dst[ run ];
+        }
+        log_i("grey benchmark pack 4bit: %u pixels/s (%u)", framebuffer_grey_benchmark_rate( start ), sum & 0xff );
+    }
+    free( src );
+    free( buf );
+    free( dst );
+}
+#endif
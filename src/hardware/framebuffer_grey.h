@@ -0,0 +1,75 @@
+/****************************************************************************
+ *   Oct 17 15:20:42 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _FRAMEBUFFER_GREY_H
+    #define _FRAMEBUFFER_GREY_H
+
+    #include "lvgl.h"
+    #include "config.h"
+    /**
+     * Uncomment to log the pixels/s of each conversion against the plain
+     * per pixel lv_color_brightness() path at setup, emulator only.
+     */
+    // #define FRAMEBUFFER_GREY_BENCHMARK
+    #define FRAMEBUFFER_GREY_BENCHMARK_RUNS     100     /** @brief runs over all 65536 colors per mode */
+    /**
+     * @brief greyscale mapping applied after the brightness conversion
+     */
+    typedef enum {
+        FRAMEBUFFER_GREY_8BIT = 0,                          /** @brief 256 grey levels, same as lv_color_brightness() */
+        FRAMEBUFFER_GREY_4BIT,                              /** @brief 16 grey levels, lower nibble cleared */
+        FRAMEBUFFER_GREY_EINK,                              /** @brief e-ink look, range 64..253 */
+        FRAMEBUFFER_GREY_INVERT_4BIT,                       /** @brief inverted 16 grey levels as 0..15, 0 is white */
+        FRAMEBUFFER_GREY_MAPS                               /** @brief number of mappings */
+    } framebuffer_grey_map_t;
+    /**
+     * @brief build the conversion tables, is called on first use if not done before
+     */
+    void framebuffer_grey_setup( void );
+    /**
+     * @brief convert a pixel run in place into grey lvgl colors
+     * 
+     * @param   color_p     pointer to the lvgl pixel data
+     * @param   size        number of pixel
+     * @param   map         greyscale mapping
+     */
+    void framebuffer_grey_convert( lv_color_t *color_p, uint32_t size, framebuffer_grey_map_t map );
+    /**
+     * @brief convert a pixel run into one byte per pixel
+     * 
+     * @param   color_p     pointer to the lvgl pixel data
+     * @param   dst         pointer to the destination, size bytes
+     * @param   size        number of pixel
+     * @param   map         greyscale mapping
+     */
+    void framebuffer_grey_to_8bit( const lv_color_t *color_p, uint8_t *dst, uint32_t size, framebuffer_grey_map_t map );
+    /**
+     * @brief convert a pixel run into inverted 4 bit pixel, two pixel per byte with the left one in the high nibble
+     * 
+     * @param   color_p     pointer to the lvgl pixel data
+     * @param   dst         pointer to the destination, size / 2 bytes
+     * @param   size        number of pixel, must be even
+     * 
+     * @return  true if all pixels are full black or white
+     */
+    bool framebuffer_grey_pack_4bit( const lv_color_t *color_p, uint8_t *dst, uint32_t size );
+
+#endif // _FRAMEBUFFER_GREY_H
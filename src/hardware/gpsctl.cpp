@@ -23,22 +23,36 @@
 #include "gpsctl.h"
 #include "powermgm.h"
 #include "callback.h"
+#include "utils/nmea.h"
 #include <math.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
 
 #ifdef NATIVE_64BIT
+    #include <stdio.h>
     #include "utils/logging.h"
     #include "utils/millis.h"
+    #include "utils/filepath_convert.h"
 
     #define DEG_TO_RAD 0.017453292519943295769236907684886
     #define RAD_TO_DEG 57.295779513082320876798154814105
 
     #define radians(deg) ((deg)*DEG_TO_RAD)
     #define degrees(rad) ((rad)*RAD_TO_DEG)
+    /**
+     * native millis() counts seconds
+     */
+    #define gpsctl_millis()     ( micros() / 1000 )
+
+    static const uint32_t GPSBaud = 9600;
 
+    static FILE *gpsctl_replay = NULL;                  /** @brief nmea log replayed as gps receiver */
+    static uint64_t gpsctl_replay_start = 0;            /** @brief micros() at replay start */
+    static uint64_t gpsctl_replay_bytes = 0;            /** @brief bytes replayed since replay start */
 #else
+    #define gpsctl_millis()     millis()
+
     #if defined( M5PAPER )
         #include <M5EPD.h>
     #elif defined( M5CORE2 )
@@ -47,15 +61,8 @@
         #include <TTGO.h>
     #endif
 
-    #include <TinyGPS++.h>
-
     static const uint32_t GPSBaud = 9600;
 
-    TinyGPSPlus gps;
-    TinyGPSCustom TGC_sats_in_view_gps;
-    TinyGPSCustom TGC_sats_in_view_glonass;
-    TinyGPSCustom TGC_sats_in_view_baidou;
-
     #if defined( USE_SOFTWARE_SERIAL )
         #include <SoftwareSerial.h>
         SoftwareSerial *gps_serial = NULL;
@@ -70,12 +77,17 @@ static bool gpsctl_enable = false;
 gpsctl_config_t gpsctl_config;
 callback_t *gpsctl_callback = NULL;
 gps_data_t gps_data;
+static nmea_parser_t gpsctl_nmea;
 
 bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg );
 bool gpsctl_powermgm_event_cb( EventBits_t event, void *arg );
 bool gpsctl_send_cb( EventBits_t event, void *arg );
 void gpsctl_autoon_on( void );
 void gpsctl_autoon_off( void );
+bool gpsctl_get_available( void );
+static void gpsctl_reset_data( void );
+static void gpsctl_read( bool flush );
+static void gpsctl_update_data( void );
 
 void gpsctl_setup( void ) {
     /*
@@ -90,7 +102,14 @@ void gpsctl_setup( void ) {
     gpsctl_config.load();
 
     #ifdef NATIVE_64BIT
-
+        /**
+         * use a recorded nmea log as gps receiver if there is one
+         */
+        char filename[256];
+        gpsctl_replay = fopen( filepath_convert( filename, sizeof( filename ), GPSCTL_REPLAY_FILE ), "rb" );
+        if ( gpsctl_replay ) {
+            GPSCTL_INFO_LOG("replay nmea log %s", filename );
+        }
     #else
         /**
          * check if pin config valid
@@ -116,7 +135,7 @@ void gpsctl_setup( void ) {
             GPSCTL_ERROR_LOG("set default gps RX on pin %d/TX on pin %d!", gpsctl_config.RXPin, gpsctl_config.TXPin );
         }
         /**
-         * init tinyGPS++ if we have a valid RX/TX config
+         * init gps serial if we have a valid RX/TX config
          */
         if( gpsctl_config.RXPin > 0 && gpsctl_config.TXPin > 0 ) {
             
@@ -125,12 +144,9 @@ void gpsctl_setup( void ) {
                 gps_serial->begin( GPSBaud );
             #else
                 gps_serial = &Serial2;
+                gps_serial->setRxBufferSize( GPSCTL_RX_BUFFER );
                 gps_serial->begin( GPSBaud, SERIAL_8N1, gpsctl_config.RXPin, gpsctl_config.TXPin );
             #endif
-
-            TGC_sats_in_view_gps.begin( gps, "GPGSV", 3);
-            TGC_sats_in_view_glonass.begin( gps, "GLGSV", 3);
-            TGC_sats_in_view_baidou.begin( gps, "BDGSV", 3);
         }
     #endif
     /**
@@ -139,6 +155,7 @@ void gpsctl_setup( void ) {
     powermgm_register_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP, gpsctl_powermgm_event_cb, "powermgm gpsctl" );
     powermgm_register_loop_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP, gpsctl_powermgm_loop_cb, "powermgm gpsctl loop" );
 
+    gpsctl_reset_data();
     gpsctl_init = true;
 
     gpsctl_send_cb( GPSCTL_UPDATE_CONFIG, NULL );
@@ -147,7 +164,12 @@ void gpsctl_setup( void ) {
 
 bool gpsctl_get_available( void ) {
     #ifdef NATIVE_64BIT
-        return( false );
+        if ( gpsctl_replay ) {
+            return( true );
+        }
+        else {
+            return( false );
+        }
     #else
         if ( gps_serial ) {
             return( true );
@@ -159,7 +181,7 @@ bool gpsctl_get_available( void ) {
 }
 
 bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
-    static uint64_t nextmillis = millis();
+    static uint64_t nextmillis = gpsctl_millis();
     /*
      * check if gpsctl already init or turn off
      */
@@ -167,134 +189,177 @@ bool gpsctl_powermgm_loop_cb( EventBits_t event, void *arg ) {
         return( true );
     }
     /**
-     * special case
+     * run any second, otherwise only read when the rx buffer fills up
      */
+    if ( nextmillis < gpsctl_millis() ) {
+        nextmillis = gpsctl_millis() + GPSCTL_INTERVAL;
+        gpsctl_read( true );
+        gpsctl_update_data();
+    }
+    else {
+        gpsctl_read( false );
+    }
+    return( true );
+}
+
+static void gpsctl_read( bool flush ) {
+    char buf[ GPSCTL_RX_BLOCK ];
+
     #ifdef NATIVE_64BIT
+        if ( !gpsctl_replay ) {
+            return;
+        }
+        /**
+         * replay the nmea log at receiver speed, 10 bits per byte
+         */
+        uint64_t pending = ( micros() - gpsctl_replay_start ) * GPSBaud / 10 / 1000000 - gpsctl_replay_bytes;
 
+        if ( pending < GPSCTL_RX_BLOCK && !flush ) {
+            return;
+        }
+        while( pending > 0 ) {
+            size_t len = fread( buf, 1, pending < sizeof( buf ) ? pending : sizeof( buf ), gpsctl_replay );
+            /**
+             * start over at the end of the log
+             */
+            if ( len == 0 ) {
+                GPSCTL_INFO_LOG("nmea replay: %u bytes, %u sentences, %u checksum errors, %u overflows", gpsctl_nmea.stats.bytes, gpsctl_nmea.stats.sentences, gpsctl_nmea.stats.checksum_errors, gpsctl_nmea.stats.overflows );
+                rewind( gpsctl_replay );
+                len = fread( buf, 1, pending < sizeof( buf ) ? pending : sizeof( buf ), gpsctl_replay );
+                if ( len == 0 ) {
+                    break;
+                }
+            }
+            nmea_parse( &gpsctl_nmea, buf, len );
+            gpsctl_replay_bytes += len;
+            pending -= len;
+        }
     #else
-        powermgm_set_perf_mode();
         /**
          * abort if we have no serial init
          */
-        if ( gps_serial ) {
+        if ( !gps_serial ) {
+            return;
+        }
+        #if !defined( USE_SOFTWARE_SERIAL )
             /**
-             * check for serial data and read
+             * let the uart driver collect a block, software serial has only a small buffer
              */
-            while ( gps_serial->available() > 0 )
-                gps.encode( gps_serial->read() );
+            if ( gps_serial->available() < GPSCTL_RX_BLOCK && !flush ) {
+                return;
+            }
+        #endif
+        int available;
+
+        while( ( available = gps_serial->available() ) > 0 ) {
+            size_t len = gps_serial->readBytes( buf, available < (int)sizeof( buf ) ? available : sizeof( buf ) );
+            nmea_parse( &gpsctl_nmea, buf, len );
         }
     #endif
+}
+
+static void gpsctl_update_data( void ) {
+    nmea_data_t *nmea = &gpsctl_nmea.data;
+    uint32_t changed = nmea_clear_changed( &gpsctl_nmea );
     /**
-     * run any second
+     * without a receiver gps_data is only set by gpsctl_set_location()
      */
-    if ( nextmillis < millis() ) {
-        nextmillis = millis() + GPSCTL_INTERVAL;
-        #ifdef NATIVE_64BIT
-        #else
-            /*
-            * store valid state
-            */
-            gps_data.valid_location = gps.location.isValid();
-            gps_data.valid_speed = gps.speed.isValid();
-            gps_data.valid_satellite = gps.satellites.isValid();
-            gps_data.valid_altitude = gps.altitude.isValid();
-            gps_data.valid_course = gps.course.isValid();
-            /*
-            * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
-            */
-            if ( gps_data.valid_location != gps_data.gpsfix ) {
-                gps_data.gpsfix = gps_data.valid_location;
-                if ( gps_data.gpsfix ) {
-                    /*
-                    * send FIX and SET_APP_LOCATION event 
-                    */
-                    gpsctl_send_cb( GPSCTL_FIX, NULL );
-                    if ( gpsctl_get_app_use_gps() ) {
-                        gps_data.lat = gps.location.lat();
-                        gps_data.lon = gps.location.lng();
-                        gpsctl_send_cb( GPSCTL_SET_APP_LOCATION, (void*)&gps_data );
-                    }
-                    gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );
-                }
-                else {
-                    /*
-                    * send NOFIX event
-                    */
-                    gpsctl_send_cb( GPSCTL_NOFIX, NULL );
-                }
-            }                
-            /*
-            * check for data updates
-            */
-            if ( gps.location.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.lat = gps.location.lat();
-                gps_data.lon = gps.location.lng();
-                gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new lat/lon: %f/%f", gps_data.lat, gps_data.lon );
-            }
-            if ( gps.speed.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.speed_mph = gps.speed.mph();
-                gps_data.speed_mps = gps.speed.mps();
-                gps_data.speed_kmh = gps.speed.kmph();
-                gpsctl_send_cb( GPSCTL_UPDATE_SPEED, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new speed: %fkmh / %fmph / %mps", gps_data.speed_kmh, gps_data.speed_mph, gps_data.speed_mps );
-            }
-            if ( gps.altitude.isUpdated()) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.altitude_feed = gps.altitude.feet();
-                gps_data.altitude_meters = gps.altitude.meters();
-                gpsctl_send_cb( GPSCTL_UPDATE_ALTITUDE, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new altitude: %fmeters / %ffeed", gps_data.altitude_meters, gps_data.altitude_feed );
-            }
-            if( gps.course.isUpdated() ) {
-                gps_data.gps_source = GPS_SOURCE_GPS;
-                gps_data.course = gps.course.value();
-                gpsctl_send_cb( GPSCTL_UPDATE_COURSE, (void*)&gps_data );
-                GPSCTL_DEBUG_LOG("new course: %f", gps_data.course );
-            }
-            if ( gps.satellites.isUpdated() ) {
-                if ( gps_data.satellites != gps.satellites.value() ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellites = gps.satellites.value();
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE, (void*)&gps_data );
-                    GPSCTL_DEBUG_LOG("new satellites: %d", gps_data.satellites );
-                }
-            }
-            /*
-            * Update Custom GNSS values
-            */
-            if ( TGC_sats_in_view_gps.isUpdated() )
-            {
-                if ( gps_data.satellite_types.gps_satellites != atoi( TGC_sats_in_view_gps.value() ) ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellite_types.gps_satellites = atoi( TGC_sats_in_view_gps.value() );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
-                    GPSCTL_DEBUG_LOG("gps satellites: %d", gps_data.satellite_types.gps_satellites );
-                }
-            }
-            if ( TGC_sats_in_view_glonass.isUpdated() )
-            {
-                if ( gps_data.satellite_types.glonass_satellites != atoi( TGC_sats_in_view_glonass.value() ) ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellite_types.glonass_satellites = atoi( TGC_sats_in_view_glonass.value() );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
-                    GPSCTL_DEBUG_LOG("glosnass satellites: %d", gps_data.satellite_types.glonass_satellites );
-                }
-            }
-            if ( TGC_sats_in_view_baidou.isUpdated() )
-            {
-                if ( gps_data.satellite_types.baidou_satellites != atoi( TGC_sats_in_view_baidou.value() ) ) {
-                    gps_data.gps_source = GPS_SOURCE_GPS;
-                    gps_data.satellite_types.baidou_satellites = atoi( TGC_sats_in_view_baidou.value() );
-                    gpsctl_send_cb( GPSCTL_UPDATE_SATELLITE_TYPE, (void *)&gps_data );
-                    GPSCTL_DEBUG_LOG("baidou satellites: %d", gps_data.satellite_types.baidou_satellites );
-                }
+    if ( !gpsctl_get_available() ) {
+        return;
+    }
+    /*
+     * store valid state
+     */
+    gps_data.valid_location = nmea->valid_location;
+    gps_data.valid_speed = nmea->valid_speed;
+    gps_data.valid_satellite = nmea->valid_satellite;
+    gps_data.valid_altitude = nmea->valid_altitude;
+    gps_data.valid_course = nmea->valid_course;
+    /*
+     * collect data updates
+     */
+    if ( changed & NMEA_LOCATION ) {
+        gps_data.lat = nmea->lat;
+        gps_data.lon = nmea->lon;
+        gps_data.changed |= GPS_DATA_LOCATION;
+        GPSCTL_DEBUG_LOG("new lat/lon: %f/%f", gps_data.lat, gps_data.lon );
+    }
+    if ( changed & NMEA_SPEED ) {
+        gps_data.speed_kmh = nmea->speed_knots * 1.852;
+        gps_data.speed_mph = nmea->speed_knots * 1.15077945;
+        gps_data.speed_mps = nmea->speed_knots * 0.51444444;
+        gps_data.changed |= GPS_DATA_SPEED;
+        GPSCTL_DEBUG_LOG("new speed: %fkmh / %fmph / %fmps", gps_data.speed_kmh, gps_data.speed_mph, gps_data.speed_mps );
+    }
+    if ( changed & NMEA_ALTITUDE ) {
+        gps_data.altitude_meters = nmea->altitude;
+        gps_data.altitude_feed = nmea->altitude * 3.2808399;
+        gps_data.changed |= GPS_DATA_ALTITUDE;
+        GPSCTL_DEBUG_LOG("new altitude: %fmeters / %ffeed", gps_data.altitude_meters, gps_data.altitude_feed );
+    }
+    if ( changed & NMEA_COURSE ) {
+        gps_data.course = nmea->course;
+        gps_data.changed |= GPS_DATA_COURSE;
+        GPSCTL_DEBUG_LOG("new course: %f", gps_data.course );
+    }
+    if ( changed & NMEA_SATELLITE ) {
+        gps_data.satellites = nmea->satellites;
+        gps_data.changed |= GPS_DATA_SATELLITE;
+        GPSCTL_DEBUG_LOG("new satellites: %d", gps_data.satellites );
+    }
+    if ( changed & NMEA_SATELLITE_TYPE ) {
+        gps_data.satellite_types.gps_satellites = nmea->gps_satellites;
+        gps_data.satellite_types.glonass_satellites = nmea->glonass_satellites;
+        gps_data.satellite_types.baidou_satellites = nmea->baidou_satellites;
+        gps_data.changed |= GPS_DATA_SATELLITE_TYPE;
+        GPSCTL_DEBUG_LOG("gps/glonass/baidou satellites: %d/%d/%d", gps_data.satellite_types.gps_satellites, gps_data.satellite_types.glonass_satellites, gps_data.satellite_types.baidou_satellites );
+    }
+    if ( gps_data.changed && gps_data.gps_source != GPS_SOURCE_GPS ) {
+        gps_data.gps_source = GPS_SOURCE_GPS;
+        gps_data.changed |= GPS_DATA_SOURCE;
+    }
+    /*
+     * send FIX and SET_APP_LOCATION or NOFIX
+     */
+    if ( gps_data.valid_location != gps_data.gpsfix ) {
+        gps_data.gpsfix = gps_data.valid_location;
+        if ( gps_data.gpsfix ) {
+            gpsctl_send_cb( GPSCTL_FIX, NULL );
+            gps_data.changed |= GPS_DATA_SOURCE;
+            if ( gpsctl_get_app_use_gps() ) {
+                gpsctl_send_cb( GPSCTL_SET_APP_LOCATION, (void*)&gps_data );
             }
-        #endif // NATIVE_64BIT
+        }
+        else {
+            gpsctl_send_cb( GPSCTL_NOFIX, NULL );
+        }
+    }
+    /*
+     * send all updates of this interval with one event
+     */
+    if ( gps_data.changed ) {
+        gpsctl_send_cb( GPSCTL_UPDATE_DATA, (void*)&gps_data );
+        gps_data.changed = 0;
     }
-    return( true );
+}
+
+static void gpsctl_reset_data( void ) {
+    gps_data.changed = 0;
+    gps_data.gpsfix = false;
+    gps_data.valid_location = false;
+    gps_data.valid_speed = false;
+    gps_data.valid_altitude = false;
+    gps_data.valid_satellite = false;
+    gps_data.valid_course = false;
+    gps_data.satellites = 0;
+    gps_data.satellite_types.gps_satellites = 0;
+    gps_data.satellite_types.glonass_satellites = 0;
+    gps_data.satellite_types.baidou_satellites = 0;
+    nmea_init( &gpsctl_nmea );
+    #ifdef NATIVE_64BIT
+        gpsctl_replay_start = micros();
+        gpsctl_replay_bytes = 0;
+    #endif
 }
 
 bool gpsctl_powermgm_event_cb( EventBits_t event, void *arg ) {
@@ -376,14 +441,7 @@ void gpsctl_on( void ) {
         /**
          * force gps data update
          */
-        gps_data.gpsfix = false;
-        gps_data.valid_location = false;
-        gps_data.valid_speed = false;
-        gps_data.valid_altitude = false;
-        gps_data.valid_satellite = false;
-        gps_data.satellite_types.gps_satellites = 0;
-        gps_data.satellite_types.glonass_satellites = 0;
-        gps_data.satellite_types.baidou_satellites = 0;
+        gpsctl_reset_data();
         gpsctl_config.autoon = true;
         gpsctl_config.save();
         gpsctl_enable = true;
@@ -415,14 +473,7 @@ void gpsctl_off( void ) {
         /**
          * force gps data update
          */
-        gps_data.gpsfix = false;
-        gps_data.valid_location = false;
-        gps_data.valid_speed = false;
-        gps_data.valid_altitude = false;
-        gps_data.valid_satellite = false;
-        gps_data.satellite_types.gps_satellites = 0;
-        gps_data.satellite_types.glonass_satellites = 0;
-        gps_data.satellite_types.baidou_satellites = 0;
+        gpsctl_reset_data();
         gpsctl_config.autoon = false;
         gpsctl_config.save();
         gpsctl_enable = false;
@@ -433,14 +484,7 @@ void gpsctl_off( void ) {
 }
 
 void gpsctl_autoon_on( void ) {
-    gps_data.gpsfix = false;
-    gps_data.valid_location = false;
-    gps_data.valid_speed = false;
-    gps_data.valid_altitude = false;
-    gps_data.valid_satellite = false;
-    gps_data.satellite_types.gps_satellites = 0;
-    gps_data.satellite_types.glonass_satellites = 0;
-    gps_data.satellite_types.baidou_satellites = 0;
+    gpsctl_reset_data();
 
     if ( gpsctl_config.autoon ) {
         if ( !gpsctl_enable ) {
@@ -486,14 +530,7 @@ void gpsctl_autoon_off( void ) {
         #endif
     #endif
     gpsctl_enable = false;
-    gps_data.gpsfix = false;
-    gps_data.valid_location = false;
-    gps_data.valid_speed = false;
-    gps_data.valid_altitude = false;
-    gps_data.valid_satellite = false;
-    gps_data.satellite_types.gps_satellites = 0;
-    gps_data.satellite_types.glonass_satellites = 0;
-    gps_data.satellite_types.baidou_satellites = 0;
+    gpsctl_reset_data();
     gpsctl_send_cb( GPSCTL_NOFIX, NULL );
     gpsctl_send_cb( GPSCTL_DISABLE, NULL );
     powermgm_set_lightsleep( true );
@@ -561,7 +598,7 @@ void gpsctl_set_location( double lat, double lon, double altitude, double speed,
     }
     if ( gps_data.gps_source != gps_source ) {
         gps_data.gps_source = gps_source;
-        gpsctl_send_cb( GPSCTL_UPDATE_SOURCE, (void*)&gps_data );        
+        gps_data.changed |= GPS_DATA_SOURCE;
     }
     gps_data.valid_location = true;
     gps_data.valid_speed = true;
@@ -572,10 +609,11 @@ void gpsctl_set_location( double lat, double lon, double altitude, double speed,
     gps_data.altitude_meters = altitude;
     gps_data.speed_kmh = speed;
     /*
-     * send FIX, UPDATE_SOURCE and UPDATE_LOCATION
+     * send location, altitude, speed and source with one UPDATE_DATA
      */
-    gpsctl_send_cb( GPSCTL_UPDATE_LOCATION, (void*)&gps_data );
-    gpsctl_send_cb( GPSCTL_UPDATE_ALTITUDE, (void*)&gps_data );
+    gps_data.changed |= GPS_DATA_LOCATION | GPS_DATA_ALTITUDE | GPS_DATA_SPEED;
+    gpsctl_send_cb( GPSCTL_UPDATE_DATA, (void*)&gps_data );
+    gps_data.changed = 0;
     /*
      * send SET_APP_LOCATION if enabled
      */
@@ -31,6 +31,9 @@
     #define GPSCTL_ERROR_LOG                log_e
 
     #define GPSCTL_INTERVAL                 1000           /** @brief gps data intervall in milliseconds */
+    #define GPSCTL_RX_BUFFER                1024           /** @brief uart rx buffer size, about one second of nmea data at 9600 baud */
+    #define GPSCTL_RX_BLOCK                 256            /** @brief read and parse the uart rx buffer when this many bytes are pending */
+    #define GPSCTL_REPLAY_FILE              "/spiffs/gps.nmea"  /** @brief nmea log replayed as gps receiver on the emulator */
 
     #define EARTH_RADIUS_KM                 6367
     #define EARTH_RADIUS_MIL                3956
@@ -40,16 +43,16 @@
     #define GPSCTL_FIX                      _BV(2)         /** @brief event mask for GPS has an fix */
     #define GPSCTL_NOFIX                    _BV(3)         /** @brief event mask for GPS has no fix */
     #define GPSCTL_SET_APP_LOCATION         _BV(4)         /** @brief event mask for GPS set location for user application like weather-app */
-    #define GPSCTL_UPDATE_LOCATION          _BV(5)         /** @brief event mask for GPS location update */
-    #define GPSCTL_UPDATE_DATE              _BV(6)         /** @brief event mask for GPS date update */
-    #define GPSCTL_UPDATE_TIME              _BV(7)         /** @brief event mask for GPS time update*/
-    #define GPSCTL_UPDATE_SPEED             _BV(8)         /** @brief event mask for GPS speed update*/
-    #define GPSCTL_UPDATE_ALTITUDE          _BV(9)         /** @brief event mask for GPS altitude update*/
-    #define GPSCTL_UPDATE_COURSE            _BV(10)        /** @brief event mask for GPS course update*/
-    #define GPSCTL_UPDATE_SATELLITE         _BV(11)        /** @brief event mask for GPS satellite update*/
-    #define GPSCTL_UPDATE_SATELLITE_TYPE    _BV(12)        /** @brief event mask for GPS satellite type update*/
-    #define GPSCTL_UPDATE_SOURCE            _BV(13)        /** @brief event mask for GPS source update*/
-    #define GPSCTL_UPDATE_CONFIG            _BV(14)        /** @brief event mask for GPS configuration*/
+    #define GPSCTL_UPDATE_DATA              _BV(5)         /** @brief event mask for GPS data update, gps_data_t.changed holds the GPS_DATA_* mask */
+    #define GPSCTL_UPDATE_CONFIG            _BV(6)         /** @brief event mask for GPS configuration*/
+
+    #define GPS_DATA_LOCATION               _BV(0)         /** @brief gps_data_t.changed mask for location update */
+    #define GPS_DATA_SPEED                  _BV(1)         /** @brief gps_data_t.changed mask for speed update */
+    #define GPS_DATA_ALTITUDE               _BV(2)         /** @brief gps_data_t.changed mask for altitude update */
+    #define GPS_DATA_COURSE                 _BV(3)         /** @brief gps_data_t.changed mask for course update */
+    #define GPS_DATA_SATELLITE              _BV(4)         /** @brief gps_data_t.changed mask for satellite update */
+    #define GPS_DATA_SATELLITE_TYPE         _BV(5)         /** @brief gps_data_t.changed mask for satellite type update */
+    #define GPS_DATA_SOURCE                 _BV(6)         /** @brief gps_data_t.changed mask for source update */
     /**
      * @brief gps source types
      */
@@ -65,6 +68,7 @@
      * @brief gps data structure
      */
     typedef struct {
+        uint32_t changed = 0;                           /** @brief GPS_DATA_* mask of fields updated with this GPSCTL_UPDATE_DATA event */
         gps_source_t gps_source = GPS_SOURCE_UNKNOWN;   /** @brief gps source */
         bool gpsfix = false;                            /** @brief gps fix flag for internal use */
         bool valid_location = false;                    /** @brief true if location valid */
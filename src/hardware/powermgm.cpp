@@ -337,6 +337,10 @@ void powermgm_reset( void ) {
     powermgm_send_event_cb( POWERMGM_RESET );
 }
 
+void powermgm_save_config( void ) {
+    powermgm_send_event_cb( POWERMGM_SAVE_CONFIG );
+}
+
 void powermgm_suspend( void ) {
     #ifdef NATIVE_64BIT
     #else
@@ -154,6 +154,18 @@
      * @return false 
      */
     bool powermgm_get_lightsleep( void );
+    /**
+     * @brief send a shutdown event
+     */
+    void powermgm_shutdown( void );
+    /**
+     * @brief send a reset event
+     */
+    void powermgm_reset( void );
+    /**
+     * @brief send a save config event, pending config writes are flushed
+     */
+    void powermgm_save_config( void );
     /**
      * @brief suspend alls Tasks
      */
@@ -4,6 +4,8 @@
 
 #include "hardware/hardware.h"
 #include "hardware/powermgm.h"
+#include "utils/frametime.h"
+#include "utils/basejsonconfig.h"
 
 #if defined( NATIVE_64BIT )
     /**
@@ -20,6 +22,10 @@
 #endif // NATIVE_64BIT
 
 void setup() {
+    /**
+     * boot start for the autocall timeline and time to first frame
+     */
+    frametime_mark_boot();
     /**
      * hardware setup
      */
@@ -36,6 +42,10 @@ void setup() {
      * post hardware setup
      */
     hardware_post_setup();
+    /**
+     * write the config snapshot for the next boot
+     */
+    BaseJsonConfig::commitSnapshot();
 }
 
 void loop(){
@@ -10,6 +10,7 @@
     #include <string.h>
     #include <unistd.h>
     #include <sys/types.h>
+    #include <sys/stat.h>
     #include <pwd.h>
 #else
     #include <SPIFFS.h>
@@ -21,6 +22,373 @@
 #include "json_psram_allocator.h"
 #include "alloc.h"
 
+#include "hardware/powermgm.h"
+
+#ifdef NATIVE_64BIT
+    #include "utils/millis.h"
+    #define basejsonconfig_millis()     ( micros() / 1000 )
+#else
+    #define basejsonconfig_millis()     millis()
+
+    static portMUX_TYPE basejsonconfig_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+/**
+ * config load statistics since boot
+ */
+static struct {
+    uint32_t loads = 0;                     /** @brief number of load() calls */
+    uint32_t snapshot_loads = 0;            /** @brief loads served from the snapshot */
+    uint64_t load_us = 0;                   /** @brief total time spent in load() */
+    uint32_t peak_doc = 0;                  /** @brief largest json document allocated by load() */
+} basejsonconfig_stats;
+
+/**
+ * write-behind state
+ */
+static BaseJsonConfig *basejsonconfig_dirty = NULL;                     /** @brief list of configs with a pending save */
+static uint32_t basejsonconfig_save_delay = BASEJSONCONFIG_SAVE_DELAY;  /** @brief write-behind window in ms */
+static uint64_t basejsonconfig_save_deadline = 0;                       /** @brief time of the next flush */
+static bool basejsonconfig_registered = false;                          /** @brief true if powermgm callbacks are registered */
+static uint32_t basejsonconfig_saves = 0;                               /** @brief save() calls */
+static uint32_t basejsonconfig_writes = 0;                              /** @brief config files written */
+
+static bool basejsonconfig_powermgm_event_cb( EventBits_t event, void *arg );
+static bool basejsonconfig_powermgm_loop_cb( EventBits_t event, void *arg );
+
+static inline void basejsonconfig_lock( void ) {
+#ifndef NATIVE_64BIT
+    portENTER_CRITICAL( &basejsonconfig_mux );
+#endif
+}
+
+static inline void basejsonconfig_unlock( void ) {
+#ifndef NATIVE_64BIT
+    portEXIT_CRITICAL( &basejsonconfig_mux );
+#endif
+}
+
+#ifdef BASEJSONCONFIG_SNAPSHOT
+/**
+ * snapshot file layout: header, then count entries of
+ * uint8_t name length, name, uint16_t data length, messagepack data
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                         /** @brief BASEJSONCONFIG_SNAPSHOT_MAGIC */
+    uint16_t version;                       /** @brief BASEJSONCONFIG_SNAPSHOT_VERSION */
+    uint16_t count;                         /** @brief number of entries */
+    uint32_t size;                          /** @brief size of all entries */
+    uint32_t crc;                           /** @brief crc32 over all entries */
+} snapshot_header_t;
+/**
+ * snapshot entry in memory
+ */
+typedef struct {
+    char *name;                             /** @brief config file name */
+    uint8_t *data;                          /** @brief messagepack serialized config */
+    uint16_t size;                          /** @brief size of data */
+} snapshot_entry_t;
+
+static snapshot_entry_t *snapshot_entry = NULL;     /** @brief snapshot entries */
+static uint16_t snapshot_count = 0;                 /** @brief number of snapshot entries */
+static bool snapshot_loaded = false;                /** @brief true if the snapshot file was read */
+static bool snapshot_dirty = false;                 /** @brief true if the snapshot changed since the last write */
+static bool snapshot_booting = true;                /** @brief true until commitSnapshot(), saves only mark the snapshot dirty */
+static bool snapshot_hold = false;                  /** @brief true while flush() writes configs, the snapshot is written once after */
+static volatile bool snapshot_invalid = false;      /** @brief set by invalidateSnapshot() from any task, the main task drops the snapshot */
+
+static uint32_t snapshot_crc32( uint32_t crc, const uint8_t *data, size_t len ) {
+    crc = ~crc;
+    while ( len-- ) {
+        crc ^= *data++;
+        for ( int i = 0 ; i < 8 ; i++ )
+            crc = ( crc >> 1 ) ^ ( 0xedb88320 & -( crc & 1 ) );
+    }
+    return( ~crc );
+}
+
+static void snapshot_clear( void ) {
+    for ( int i = 0 ; i < snapshot_count ; i++ ) {
+        free( snapshot_entry[ i ].name );
+        free( snapshot_entry[ i ].data );
+    }
+    free( snapshot_entry );
+    snapshot_entry = NULL;
+    snapshot_count = 0;
+}
+
+/**
+ * @brief drop the snapshot in memory and on flash if invalidateSnapshot() was called,
+ * only call it from the main task, it owns the snapshot entries
+ * 
+ * @return  true if the snapshot was dropped
+ */
+static bool snapshot_drop_invalid( void ) {
+    char filename[ MAX_CONFIG_FILE_NAME_LENGTH ] = "";
+
+    basejsonconfig_lock();
+    bool invalid = snapshot_invalid;
+    snapshot_invalid = false;
+    basejsonconfig_unlock();
+
+    if ( !invalid ) {
+        return( false );
+    }
+    filepath_convert( filename, sizeof( filename ), BASEJSONCONFIG_SNAPSHOT_FILE );
+    remove( filename );
+    snapshot_clear();
+    snapshot_loaded = true;
+    snapshot_dirty = false;
+    log_d("config snapshot dropped");
+    return( true );
+}
+
+static snapshot_entry_t *snapshot_find( const char *name ) {
+    for ( int i = 0 ; i < snapshot_count ; i++ ) {
+        if ( !strcmp( snapshot_entry[ i ].name, name ) ) {
+            return( &snapshot_entry[ i ] );
+        }
+    }
+    return( NULL );
+}
+/**
+ * @brief read the snapshot file once, a missing file, a version or a checksum
+ * mismatch leaves the snapshot empty and all configs load from json
+ */
+static void snapshot_read( void ) {
+    char filename[ MAX_CONFIG_FILE_NAME_LENGTH ] = "";
+    snapshot_header_t header;
+    uint8_t *payload = NULL;
+
+    snapshot_drop_invalid();
+    if ( snapshot_loaded ) {
+        return;
+    }
+    snapshot_loaded = true;
+
+    filepath_convert( filename, sizeof( filename ), BASEJSONCONFIG_SNAPSHOT_FILE );
+    FILE *file = fopen( filename, "rb" );
+    if ( !file ) {
+        log_d("no config snapshot");
+        return;
+    }
+    if ( fread( &header, sizeof( header ), 1, file ) != 1 || header.magic != BASEJSONCONFIG_SNAPSHOT_MAGIC || header.version != BASEJSONCONFIG_SNAPSHOT_VERSION ) {
+        log_w("config snapshot version mismatch, load json");
+        fclose( file );
+        return;
+    }
+    payload = (uint8_t*)MALLOC( header.size );
+    if ( !payload || fread( payload, 1, header.size, file ) != header.size || snapshot_crc32( 0, payload, header.size ) != header.crc ) {
+        log_w("config snapshot checksum mismatch, load json");
+        free( payload );
+        fclose( file );
+        return;
+    }
+    fclose( file );
+    /**
+     * split payload into entries
+     */
+    snapshot_entry = (snapshot_entry_t*)CALLOC( header.count, sizeof( snapshot_entry_t ) );
+    uint32_t pos = 0;
+    for ( int i = 0 ; snapshot_entry && i < header.count ; i++ ) {
+        if ( pos + 1 > header.size ) break;
+        uint8_t name_len = payload[ pos++ ];
+        if ( pos + name_len + 2 > header.size ) break;
+        const uint8_t *name = &payload[ pos ];
+        pos += name_len;
+        uint16_t size = payload[ pos ] | ( payload[ pos + 1 ] << 8 );
+        pos += 2;
+        if ( pos + size > header.size ) break;
+
+        snapshot_entry_t *entry = &snapshot_entry[ snapshot_count ];
+        entry->name = (char*)MALLOC( name_len + 1 );
+        entry->data = (uint8_t*)MALLOC( size );
+        if ( !entry->name || !entry->data ) {
+            free( entry->name );
+            free( entry->data );
+            break;
+        }
+        memcpy( entry->name, name, name_len );
+        entry->name[ name_len ] = '\0';
+        memcpy( entry->data, &payload[ pos ], size );
+        entry->size = size;
+        pos += size;
+        snapshot_count++;
+    }
+    free( payload );
+    /**
+     * a truncated payload despite a valid crc means a broken writer, drop all
+     */
+    if ( snapshot_count != header.count ) {
+        log_e("config snapshot corrupt, load json");
+        snapshot_clear();
+        return;
+    }
+    log_d("config snapshot with %d entrys, %d bytes", snapshot_count, header.size );
+}
+
+static void snapshot_write( void ) {
+    char filename[ MAX_CONFIG_FILE_NAME_LENGTH ] = "";
+    snapshot_header_t header;
+    uint32_t crc = 0;
+
+    if ( snapshot_drop_invalid() ) {
+        return;
+    }
+    header.magic = BASEJSONCONFIG_SNAPSHOT_MAGIC;
+    header.version = BASEJSONCONFIG_SNAPSHOT_VERSION;
+    header.count = snapshot_count;
+    header.size = 0;
+    /**
+     * crc and size over all entries as they will be written
+     */
+    for ( int i = 0 ; i < snapshot_count ; i++ ) {
+        uint8_t name_len = strlen( snapshot_entry[ i ].name );
+        uint8_t size[2] = { (uint8_t)( snapshot_entry[ i ].size & 0xff ), (uint8_t)( snapshot_entry[ i ].size >> 8 ) };
+        crc = snapshot_crc32( crc, &name_len, 1 );
+        crc = snapshot_crc32( crc, (const uint8_t*)snapshot_entry[ i ].name, name_len );
+        crc = snapshot_crc32( crc, size, 2 );
+        crc = snapshot_crc32( crc, snapshot_entry[ i ].data, snapshot_entry[ i ].size );
+        header.size += 1 + name_len + 2 + snapshot_entry[ i ].size;
+    }
+    header.crc = crc;
+
+    filepath_convert( filename, sizeof( filename ), BASEJSONCONFIG_SNAPSHOT_FILE );
+    FILE *file = fopen( filename, "wb" );
+    if ( !file ) {
+        log_e("can't write config snapshot %s", filename );
+        return;
+    }
+    fwrite( &header, sizeof( header ), 1, file );
+    for ( int i = 0 ; i < snapshot_count ; i++ ) {
+        uint8_t name_len = strlen( snapshot_entry[ i ].name );
+        uint8_t size[2] = { (uint8_t)( snapshot_entry[ i ].size & 0xff ), (uint8_t)( snapshot_entry[ i ].size >> 8 ) };
+        fwrite( &name_len, 1, 1, file );
+        fwrite( snapshot_entry[ i ].name, 1, name_len, file );
+        fwrite( size, 1, 2, file );
+        fwrite( snapshot_entry[ i ].data, 1, snapshot_entry[ i ].size, file );
+    }
+    fclose( file );
+    snapshot_dirty = false;
+    log_d("config snapshot written, %d entrys, %d bytes", snapshot_count, header.size );
+    /**
+     * invalidated while writing, don't leave the old entries on flash
+     */
+    snapshot_drop_invalid();
+}
+/**
+ * @brief store a config document as messagepack in the snapshot
+ */
+static void snapshot_store( const char *name, JsonDocument &doc ) {
+    size_t size = measureMsgPack( doc );
+    size_t name_len = strlen( name );
+
+    snapshot_drop_invalid();
+    if ( size == 0 || size > 0xffff || name_len > 0xff ) {
+        return;
+    }
+
+    uint8_t *data = (uint8_t*)MALLOC( size );
+    if ( !data ) {
+        return;
+    }
+    serializeMsgPack( doc, data, size );
+    /**
+     * unchanged config, keep the snapshot as it is
+     */
+    snapshot_entry_t *entry = snapshot_find( name );
+    if ( entry && entry->size == size && !memcmp( entry->data, data, size ) ) {
+        free( data );
+        return;
+    }
+    /**
+     * add a new entry or replace the data
+     */
+    if ( !entry ) {
+        snapshot_entry_t *entrys = (snapshot_entry_t*)REALLOC( snapshot_entry, ( snapshot_count + 1 ) * sizeof( snapshot_entry_t ) );
+        char *entry_name = (char*)MALLOC( name_len + 1 );
+        if ( !entrys || !entry_name ) {
+            if ( entrys ) snapshot_entry = entrys;
+            free( entry_name );
+            free( data );
+            return;
+        }
+        snapshot_entry = entrys;
+        entry = &snapshot_entry[ snapshot_count++ ];
+        memcpy( entry_name, name, name_len + 1 );
+        entry->name = entry_name;
+        entry->data = NULL;
+    }
+    free( entry->data );
+    entry->data = data;
+    entry->size = size;
+    snapshot_dirty = true;
+
+    if ( !snapshot_booting && !snapshot_hold ) {
+        snapshot_write();
+    }
+}
+
+bool BaseJsonConfig::loadSnapshot( uint32_t size ) {
+    bool result = false;
+
+    snapshot_read();
+    snapshot_entry_t *entry = snapshot_find( fileName );
+    if ( !entry ) {
+        return( result );
+    }
+
+    if ( size == 0 ) {
+        size = entry->size * 4;
+    }
+    if ( size > basejsonconfig_stats.peak_doc ) {
+        basejsonconfig_stats.peak_doc = size;
+    }
+
+    SpiRamJsonDocument doc( size );
+    DeserializationError error = deserializeMsgPack( doc, (const uint8_t*)entry->data, entry->size );
+    if ( error ) {
+        log_w("config snapshot deserializeMsgPack() failed: %s, file: %s", error.c_str(), fileName );
+    }
+    else {
+        result = onLoad( doc );
+    }
+    doc.clear();
+    return( result );
+}
+#endif // BASEJSONCONFIG_SNAPSHOT
+
+void BaseJsonConfig::commitSnapshot() {
+#ifdef BASEJSONCONFIG_SNAPSHOT
+    snapshot_booting = false;
+    if ( snapshot_dirty ) {
+        snapshot_write();
+    }
+#endif // BASEJSONCONFIG_SNAPSHOT
+    log_i("config: %d loads, %d from snapshot, %llu us, peak json document %d bytes",
+            basejsonconfig_stats.loads,
+            basejsonconfig_stats.snapshot_loads,
+            (unsigned long long)basejsonconfig_stats.load_us,
+            basejsonconfig_stats.peak_doc );
+}
+
+void BaseJsonConfig::invalidateSnapshot() {
+#ifdef BASEJSONCONFIG_SNAPSHOT
+    char filename[ MAX_CONFIG_FILE_NAME_LENGTH ] = "";
+    /**
+     * called from the ftp or webserver task, the entries are only flagged
+     * here and dropped by the main task on the next snapshot access. the
+     * file is removed at once so a reboot before that doesn't use it
+     */
+    basejsonconfig_lock();
+    snapshot_invalid = true;
+    basejsonconfig_unlock();
+
+    filepath_convert( filename, sizeof( filename ), BASEJSONCONFIG_SNAPSHOT_FILE );
+    remove( filename );
+#endif // BASEJSONCONFIG_SNAPSHOT
+}
+
 BaseJsonConfig::BaseJsonConfig(const char* configFileName) {
 
 #ifdef NATIVE_64BIT
@@ -50,11 +418,123 @@ BaseJsonConfig::BaseJsonConfig(const char* configFileName) {
 #endif
 }
 
+/**
+ * @brief remember size and time of the config file as written or read by BaseJsonConfig
+ */
+void BaseJsonConfig::stampFile() {
+#ifdef NATIVE_64BIT
+    struct stat st;
+
+    fileStamped = ( stat( fileName, &st ) == 0 );
+    if ( fileStamped ) {
+        fileSize = st.st_size;
+        fileTime = st.st_mtime;
+    }
+#else
+    fs::File file = SPIFFS.open( fileName, FILE_READ );
+
+    fileStamped = (bool)file;
+    if ( fileStamped ) {
+        fileSize = file.size();
+        fileTime = file.getLastWrite();
+    }
+    file.close();
+#endif
+}
+/**
+ * @brief check if the config file was replaced outside of BaseJsonConfig like an
+ * installed theme, true if unknown
+ */
+bool BaseJsonConfig::fileReplaced() {
+    uint32_t size = fileSize;
+    uint32_t time = fileTime;
+
+    if ( !fileStamped ) {
+        return( true );
+    }
+    stampFile();
+    return( !fileStamped || size != fileSize || time != fileTime );
+}
+
+BaseJsonConfig::~BaseJsonConfig() {
+    /*
+     * the derived part is already gone, onSave() can't write the pending
+     * save anymore. unlink it so the next flush() doesn't touch freed memory
+     */
+    if ( removeDirty() ) {
+        log_w("config destroyed with a pending save, save dropped: %s", fileName );
+    }
+}
+
+bool BaseJsonConfig::removeDirty() {
+    bool removed = false;
+
+    basejsonconfig_lock();
+    if ( dirty ) {
+        BaseJsonConfig **config = &basejsonconfig_dirty;
+        while ( *config && *config != this ) {
+            config = &(*config)->nextDirty;
+        }
+        if ( *config ) {
+            *config = nextDirty;
+        }
+        nextDirty = NULL;
+        dirty = false;
+        removed = true;
+    }
+    basejsonconfig_unlock();
+
+    return( removed );
+}
+
 bool BaseJsonConfig::load( uint32_t size ) {
     bool result = false;
+    uint64_t start = micros();
+    /*
+     * write a pending save first, the file would override newer settings. but
+     * if the file was replaced outside of BaseJsonConfig the pending save is
+     * older than the file and dropped
+     */
+    if ( removeDirty() ) {
+        if ( fileReplaced() ) {
+            log_d("config file replaced, pending save dropped: %s", fileName );
+        }
+        else {
+            saveNow( dirtySize );
+        }
+    }
+
+    basejsonconfig_stats.loads++;
+#ifdef BASEJSONCONFIG_SNAPSHOT
+    /*
+     * try the snapshot first, but only while booting. later loads come from
+     * a json file that may be replaced outside of BaseJsonConfig like a theme
+     */
+    if ( snapshot_booting && loadSnapshot( size ) ) {
+        basejsonconfig_stats.snapshot_loads++;
+        basejsonconfig_stats.load_us += micros() - start;
+        return( true );
+    }
+#endif // BASEJSONCONFIG_SNAPSHOT
     /*
      * load config if exist
      */
+    /*
+     * recover an interrupted save, the config is only removed after the temp file is complete
+     */
+    char tmpName[ MAX_CONFIG_FILE_NAME_LENGTH + sizeof( BASEJSONCONFIG_TMP_SUFFIX ) ] = "";
+    snprintf( tmpName, sizeof( tmpName ), "%s" BASEJSONCONFIG_TMP_SUFFIX, fileName );
+#ifdef NATIVE_64BIT
+    if ( access( fileName, F_OK ) != 0 && access( tmpName, F_OK ) == 0 ) {
+        rename( tmpName, fileName );
+        log_w("recovered %s", fileName );
+    }
+#else
+    if ( !SPIFFS.exists( fileName ) && SPIFFS.exists( tmpName ) ) {
+        SPIFFS.rename( tmpName, fileName );
+        log_w("recovered %s", fileName );
+    }
+#endif
     /*
      * open file
      */
@@ -88,6 +568,9 @@ bool BaseJsonConfig::load( uint32_t size ) {
              */
             size = filesize*4;
         }
+        if ( size > basejsonconfig_stats.peak_doc ) {
+            basejsonconfig_stats.peak_doc = size;
+        }
         /*
         * create json structure
         */
@@ -102,10 +585,16 @@ bool BaseJsonConfig::load( uint32_t size ) {
         else {
             log_d("json config deserializeJson() success: %s, file: %s", error.c_str(), fileName );
             result = onLoad(doc);
+#ifdef BASEJSONCONFIG_SNAPSHOT
+            if ( result ) {
+                snapshot_store( fileName, doc );
+            }
+#endif // BASEJSONCONFIG_SNAPSHOT
         }
         doc.clear();
     }
     file.close();
+    stampFile();
     /*
      * check if read from json is failed
      */
@@ -113,20 +602,134 @@ bool BaseJsonConfig::load( uint32_t size ) {
         log_w("reading json failed, call defaults, file: %s", fileName );
         result = onDefault();
     }
+    basejsonconfig_stats.load_us += micros() - start;
     return result;
 }
 
 bool BaseJsonConfig::save( uint32_t size ) {
+    bool added = false;
+
+    if ( !basejsonconfig_registered ) {
+        basejsonconfig_registered = true;
+        powermgm_register_cb( POWERMGM_STANDBY | POWERMGM_SAVE_CONFIG | POWERMGM_SHUTDOWN | POWERMGM_RESET, basejsonconfig_powermgm_event_cb, "config save" );
+        powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, basejsonconfig_powermgm_loop_cb, "config save loop" );
+    }
+    basejsonconfig_saves++;
+
+    if ( basejsonconfig_save_delay == 0 ) {
+        return( saveNow( size ) );
+    }
+    /*
+     * loaded from the snapshot, remember the file as it was before the first change
+     */
+    if ( !dirty && !fileStamped ) {
+        stampFile();
+    }
+    /*
+     * add to dirty list, the deadline starts with the first save in the window
+     */
+    basejsonconfig_lock();
+    dirtySize = size;
+    if ( !dirty ) {
+        dirty = true;
+        nextDirty = basejsonconfig_dirty;
+        basejsonconfig_dirty = this;
+        added = true;
+    }
+    if ( basejsonconfig_save_deadline == 0 ) {
+        basejsonconfig_save_deadline = basejsonconfig_millis() + basejsonconfig_save_delay;
+    }
+    basejsonconfig_unlock();
+
+    if ( added ) {
+        log_d("config dirty: %s", fileName );
+    }
+    return( true );
+}
+
+void BaseJsonConfig::flush() {
+    uint32_t files = 0;
+    /*
+     * detach dirty list, configs saved while writing go into a new list
+     */
+    basejsonconfig_lock();
+    BaseJsonConfig *config = basejsonconfig_dirty;
+    basejsonconfig_dirty = NULL;
+    basejsonconfig_save_deadline = 0;
+    basejsonconfig_unlock();
+
+#ifdef BASEJSONCONFIG_SNAPSHOT
+    snapshot_hold = true;
+#endif // BASEJSONCONFIG_SNAPSHOT
+    while ( config ) {
+        basejsonconfig_lock();
+        BaseJsonConfig *next = config->nextDirty;
+        uint32_t size = config->dirtySize;
+        config->nextDirty = NULL;
+        config->dirty = false;
+        basejsonconfig_unlock();
+
+        config->saveNow( size );
+        config = next;
+        files++;
+    }
+#ifdef BASEJSONCONFIG_SNAPSHOT
+    snapshot_hold = false;
+    if ( snapshot_dirty && !snapshot_booting ) {
+        snapshot_write();
+    }
+#endif // BASEJSONCONFIG_SNAPSHOT
+
+    if ( files ) {
+        log_i("config flush: %d files, %d saves in %d writes, %d writes avoided", files, basejsonconfig_saves, basejsonconfig_writes, basejsonconfig_saves - basejsonconfig_writes );
+    }
+}
+
+void BaseJsonConfig::setSaveDelay( uint32_t delay ) {
+    basejsonconfig_save_delay = delay;
+    if ( delay == 0 ) {
+        flush();
+    }
+}
+
+static bool basejsonconfig_powermgm_event_cb( EventBits_t event, void *arg ) {
+    switch( event ) {
+        case POWERMGM_STANDBY:
+        case POWERMGM_SAVE_CONFIG:
+        case POWERMGM_SHUTDOWN:
+        case POWERMGM_RESET:
+            BaseJsonConfig::flush();
+            break;
+    }
+    return( true );
+}
+
+static bool basejsonconfig_powermgm_loop_cb( EventBits_t event, void *arg ) {
+#ifdef BASEJSONCONFIG_SNAPSHOT
+    snapshot_drop_invalid();
+#endif // BASEJSONCONFIG_SNAPSHOT
+    if ( basejsonconfig_save_deadline && basejsonconfig_millis() >= basejsonconfig_save_deadline ) {
+        BaseJsonConfig::flush();
+    }
+    return( true );
+}
+
+bool BaseJsonConfig::saveNow( uint32_t size ) {
     bool result = false;
+    char tmpName[ MAX_CONFIG_FILE_NAME_LENGTH + sizeof( BASEJSONCONFIG_TMP_SUFFIX ) ] = "";
+    /*
+     * write into a temp file and rename it over the config when complete
+     */
+    snprintf( tmpName, sizeof( tmpName ), "%s" BASEJSONCONFIG_TMP_SUFFIX, fileName );
 #ifdef NATIVE_64BIT
     std::fstream file;
 
-    file.open(fileName, std::fstream::out );
+    file.open(tmpName, std::fstream::out );
 #else
-    fs::File file = SPIFFS.open(fileName, FILE_WRITE );
+    fs::File file = SPIFFS.open(tmpName, FILE_WRITE );
 #endif
     if (!file) {
-        log_e("Can't open file: %s!", fileName);
+        log_e("Can't open file: %s!", tmpName);
     }
     else {
         if (size == 0) {
@@ -145,17 +748,39 @@ bool BaseJsonConfig::save( uint32_t size ) {
         else
             outSize = serializeJson(doc, file);
 
+        file.close();
+
         if (result == true && outSize == 0) {
             log_e("Failed to write config file %s", fileName);
             result = false;
         }
-        else {
+        else if ( result ) {
+            /*
+             * spiffs can't rename over an existing file, load() recovers
+             * the temp file if the config went missing in between
+             */
+#ifdef NATIVE_64BIT
+            result = ( rename( tmpName, fileName ) == 0 );
+#else
+            SPIFFS.remove( fileName );
+            result = SPIFFS.rename( tmpName, fileName );
+#endif
+            if ( !result ) {
+                log_e("Failed to rename %s", tmpName );
+            }
+        }
+
+        if ( result ) {
+            stampFile();
+            basejsonconfig_writes++;
             log_d("json config serializeJson() success: %s", fileName );
+#ifdef BASEJSONCONFIG_SNAPSHOT
+            snapshot_store( fileName, doc );
+#endif // BASEJSONCONFIG_SNAPSHOT
         }
         
         doc.clear();
     }
-    file.close();
     return result;
 }
 
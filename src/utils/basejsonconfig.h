@@ -10,6 +10,13 @@
 
 #define MAX_CONFIG_FILE_NAME_LENGTH 128
 
+#define BASEJSONCONFIG_SNAPSHOT                                         /** @brief keep a binary snapshot of all configs, comment out to always load json */
+#define BASEJSONCONFIG_SNAPSHOT_FILE    "/spiffs/config.snapshot"       /** @brief snapshot file */
+#define BASEJSONCONFIG_SNAPSHOT_MAGIC   0x53474643                      /** @brief snapshot magic "CFGS" */
+#define BASEJSONCONFIG_SNAPSHOT_VERSION 1                               /** @brief snapshot format version, a mismatch falls back to json */
+#define BASEJSONCONFIG_SAVE_DELAY       3000                            /** @brief default write-behind window in ms, saves within are coalesced into one write */
+#define BASEJSONCONFIG_TMP_SUFFIX       ".tmp"                          /** @brief suffix of the temp file renamed over the config file */
+
 #include "ArduinoJson.h"
 
 /**
@@ -19,17 +26,51 @@ class BaseJsonConfig {
 public:
   BaseJsonConfig(const char* configFileName);
   /**
-   * @brief Load settings from file with a custom json size, use 0 for automatic sizing
+   * @brief remove the config from the dirty list, a pending save is dropped.
+   * derived configs that must not lose it call saveNow() in their own destructor
+   */
+  virtual ~BaseJsonConfig();
+  /**
+   * @brief Load settings from file with a custom json size, use 0 for automatic sizing,
+   * until commitSnapshot() the settings come from the snapshot if there is one.
+   * a pending save() is written first, or dropped if the file was replaced meanwhile
    */
   bool load( uint32_t size = 0 );
   /**
-   * @brief Save settings to file with a custom json size, use 0 for automatic sizing
+   * @brief Mark settings dirty, they are written to file after the write-behind window
+   * or on flush(), with a custom json size, use 0 for automatic sizing
    */
   bool save( uint32_t size = 0 );
+  /**
+   * @brief Save settings to file now with a custom json size, use 0 for automatic sizing
+   */
+  bool saveNow( uint32_t size = 0 );
   /**
    * @brief print out json
    */
   void debugPrint();
+  /**
+   * @brief write the snapshot if configs changed and log the config load statistics,
+   * called once at the end of setup, later saves write the snapshot directly
+   */
+  static void commitSnapshot();
+  /**
+   * @brief drop the snapshot, call when json files may change outside of BaseJsonConfig
+   * like ftp or the web editor, the next boot loads json and rebuilds the snapshot.
+   * safe to call from any task, the main task drops the entries on the next access
+   */
+  static void invalidateSnapshot();
+  /**
+   * @brief write all dirty configs now, called on POWERMGM_STANDBY, POWERMGM_SAVE_CONFIG,
+   * POWERMGM_SHUTDOWN and POWERMGM_RESET
+   */
+  static void flush();
+  /**
+   * @brief set the write-behind window
+   *
+   * @param delay   window in ms, 0 writes on every save()
+   */
+  static void setSaveDelay( uint32_t delay );
   
 protected:
   ////////////// Available for overloading: //////////////
@@ -41,6 +82,19 @@ protected:
 protected:
   char fileName[MAX_CONFIG_FILE_NAME_LENGTH];
   bool prettyJson = true;
+
+private:
+  bool loadSnapshot( uint32_t size );
+  bool removeDirty();
+  void stampFile();
+  bool fileReplaced();
+
+  bool dirty = false;                       /** @brief true if in the dirty list */
+  uint32_t dirtySize = 0;                   /** @brief json size of the pending save */
+  BaseJsonConfig *nextDirty = nullptr;      /** @brief next config in the dirty list */
+  bool fileStamped = false;                 /** @brief true if fileSize and fileTime are valid */
+  uint32_t fileSize = 0;                    /** @brief file size after the last load or write */
+  uint32_t fileTime = 0;                    /** @brief file time after the last load or write */
 };
 
 #endif
\ No newline at end of file
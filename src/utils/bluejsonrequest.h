@@ -37,6 +37,31 @@ public:
         }
     }
 
+    /**
+     * Empty document to be filled with parse(), for reuse over many messages.
+     */
+    BluetoothJsonRequest(size_t jsonBufferSize) : SpiRamJsonDocument(jsonBufferSize) {
+        dsError = DeserializationError::EmptyInput;
+    }
+
+    /**
+     * Parse message in place: string values point into message, which is
+     * modified and has to outlive the document content. With a filter only
+     * the keys set in filter are kept.
+     */
+    bool parse(char* message, JsonDocument* filter = nullptr) {
+        clear();
+        if (filter)
+            dsError = deserializeJson(*this, message, DeserializationOption::Filter(*filter));
+        else
+            dsError = deserializeJson(*this, message);
+        if (dsError) {
+            log_e("deserializeJson() failed: %s", dsError.c_str());
+            clear();
+        }
+        return !dsError;
+    }
+
     bool isValid() { return !dsError; }
     DeserializationError getDeserializationError() { return dsError; }
 
@@ -29,7 +29,11 @@ char *filepath_convert( char * dst_str, int max_len, const char* local_path ) {
         /**
          * create config dir if not exist
          */
-        if ( !opendir( hedge_config_path ) ) {
+        DIR *hedge_config_dir = opendir( hedge_config_path );
+        if ( hedge_config_dir ) {
+            closedir( hedge_config_dir );
+        }
+        else {
             log_i("create config path and dir");
             mkdir( hedge_config_path, 0700 );
             snprintf( hedge_config_path, sizeof( hedge_config_path ), "%s/.hedge/spiffs", getpwuid(getuid())->pw_dir );
@@ -0,0 +1,147 @@
+/****************************************************************************
+ *   Oct 17 16:05:12 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include "config.h"
+#include <string.h>
+#include "lvgl.h"
+#include "frametime.h"
+
+#ifdef NATIVE_64BIT
+    #include "utils/logging.h"
+    #include "utils/millis.h"
+#else
+    #include <Arduino.h>
+#endif
+
+static frametime_entry_t frametime_entry[ FRAMETIME_ENTRYS ];      /** @brief frame ring buffer */
+static uint32_t frametime_first_entry = 0;                          /** @brief index of the oldest frame */
+static uint32_t frametime_entrys = 0;                               /** @brief frames in the ring buffer */
+static uint32_t frametime_frames = 0;                               /** @brief frames since boot */
+static uint32_t frametime_handler_start_us = 0;                     /** @brief micros() at the start of the lvgl task handler run */
+static frametime_entry_t *frametime_pending = NULL;                 /** @brief frame added in the current task handler run */
+static bool frametime_overlay = false;                              /** @brief statusbar overlay enabled */
+static uint32_t frametime_boot_us = 0;                              /** @brief micros() at the boot start mark */
+static uint32_t frametime_first_frame_ms = 0;                       /** @brief time from boot to the first frame */
+
+void frametime_mark_boot( void ) {
+    frametime_boot_us = micros();
+}
+
+uint32_t frametime_get_boot_us( void ) {
+    return( (uint32_t)micros() - frametime_boot_us );
+}
+
+void frametime_add_frame( uint32_t frame_ms, uint32_t flush_us, uint32_t px, uint32_t bands ) {
+    frametime_entry_t *frame;
+    /**
+     * overwrite the oldest frame when the ring buffer is full
+     */
+    if ( frametime_entrys < FRAMETIME_ENTRYS ) {
+        frame = &frametime_entry[ ( frametime_first_entry + frametime_entrys ) % FRAMETIME_ENTRYS ];
+        frametime_entrys++;
+    }
+    else {
+        frame = &frametime_entry[ frametime_first_entry ];
+        frametime_first_entry = ( frametime_first_entry + 1 ) % FRAMETIME_ENTRYS;
+    }
+
+    frame->timestamp = lv_tick_get();
+    frame->frame_ms = frame_ms;
+    frame->render_us = 0;
+    frame->flush_us = flush_us;
+    frame->px = px;
+    frame->bands = bands;
+    /**
+     * log the time to the first frame once
+     */
+    if ( !frametime_frames ) {
+        frametime_first_frame_ms = frametime_get_boot_us() / 1000;
+        log_i("first frame %ums after boot", frametime_first_frame_ms );
+    }
+    frametime_frames++;
+    frametime_pending = frame;
+}
+
+void frametime_handler_start( void ) {
+    frametime_handler_start_us = micros();
+    frametime_pending = NULL;
+}
+
+void frametime_handler_end( void ) {
+    if ( !frametime_pending )
+        return;
+    /**
+     * rendering is what is left of the handler run without flushing
+     */
+    uint32_t handler_us = (uint32_t)micros() - frametime_handler_start_us;
+    frametime_pending->render_us = handler_us > frametime_pending->flush_us ? handler_us - frametime_pending->flush_us : 0;
+    frametime_pending = NULL;
+}
+
+uint32_t frametime_get_entrys( void ) {
+    return( frametime_entrys );
+}
+
+bool frametime_get_entry( uint32_t entry, frametime_entry_t *frame ) {
+    if ( entry >= frametime_entrys )
+        return( false );
+
+    *frame = frametime_entry[ ( frametime_first_entry + entry ) % FRAMETIME_ENTRYS ];
+    return( true );
+}
+
+void frametime_get_summary( frametime_summary_t *summary ) {
+    uint64_t render_sum = 0;
+    uint64_t flush_sum = 0;
+    uint64_t px_sum = 0;
+    uint32_t now = lv_tick_get();
+
+    memset( summary, 0, sizeof( frametime_summary_t ) );
+    summary->frames = frametime_frames;
+    summary->entrys = frametime_entrys;
+    summary->first_frame_ms = frametime_first_frame_ms;
+
+    for( uint32_t entry = 0 ; entry < frametime_entrys ; entry++ ) {
+        const frametime_entry_t *frame = &frametime_entry[ ( frametime_first_entry + entry ) % FRAMETIME_ENTRYS ];
+
+        render_sum += frame->render_us;
+        flush_sum += frame->flush_us;
+        px_sum += frame->px;
+        summary->render_max_us = LV_MATH_MAX( summary->render_max_us, frame->render_us );
+        summary->flush_max_us = LV_MATH_MAX( summary->flush_max_us, frame->flush_us );
+        if ( now - frame->timestamp < FRAMETIME_FPS_WINDOW )
+            summary->fps++;
+    }
+
+    if ( frametime_entrys ) {
+        summary->render_mean_us = render_sum / frametime_entrys;
+        summary->flush_mean_us = flush_sum / frametime_entrys;
+        summary->px_mean = px_sum / frametime_entrys;
+    }
+}
+
+void frametime_set_overlay( bool overlay ) {
+    frametime_overlay = overlay;
+}
+
+bool frametime_get_overlay( void ) {
+    return( frametime_overlay );
+}
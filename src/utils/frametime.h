@@ -0,0 +1,115 @@
+/****************************************************************************
+ *   Oct 17 16:05:12 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _FRAMETIME_H
+    #define _FRAMETIME_H
+
+    #include <stdint.h>
+
+    #define FRAMETIME_ENTRYS            64              /** @brief number of frames kept in the ring buffer */
+    #define FRAMETIME_FPS_WINDOW        1000            /** @brief window in ms for the frames per second */
+    /**
+     * @brief frame time ring buffer entry
+     */
+    typedef struct {
+        uint32_t timestamp;                             /** @brief lvgl tick at the end of the frame */
+        uint32_t frame_ms;                              /** @brief lvgl refresh time */
+        uint32_t render_us;                             /** @brief rendering time, lvgl task handler time without flush time */
+        uint32_t flush_us;                              /** @brief time spent in flush or waiting for a transfer */
+        uint32_t px;                                    /** @brief refreshed pixel */
+        uint16_t bands;                                 /** @brief number of flushed bands */
+    } frametime_entry_t;
+    /**
+     * @brief frame time summary over the ring buffer
+     */
+    typedef struct {
+        uint32_t frames;                                /** @brief frames since boot */
+        uint32_t entrys;                                /** @brief frames in the ring buffer */
+        uint32_t fps;                                   /** @brief frames within the last FRAMETIME_FPS_WINDOW ms */
+        uint32_t render_mean_us;                        /** @brief mean rendering time */
+        uint32_t render_max_us;                         /** @brief max rendering time */
+        uint32_t flush_mean_us;                         /** @brief mean flush time */
+        uint32_t flush_max_us;                          /** @brief max flush time */
+        uint32_t px_mean;                               /** @brief mean refreshed pixel */
+        uint32_t first_frame_ms;                        /** @brief time from boot to the first frame */
+    } frametime_summary_t;
+    /**
+     * @brief mark the boot start, the time to the first frame is measured from here
+     */
+    void frametime_mark_boot( void );
+    /**
+     * @brief get the time since the boot start mark
+     * 
+     * @return  time in us
+     */
+    uint32_t frametime_get_boot_us( void );
+    /**
+     * @brief add a finished frame, called from the display driver monitor callback
+     * 
+     * @param   frame_ms    lvgl refresh time
+     * @param   flush_us    time spent in flush or waiting for a transfer
+     * @param   px          refreshed pixel
+     * @param   bands       number of flushed bands
+     */
+    void frametime_add_frame( uint32_t frame_ms, uint32_t flush_us, uint32_t px, uint32_t bands );
+    /**
+     * @brief mark the start of a lvgl task handler run
+     */
+    void frametime_handler_start( void );
+    /**
+     * @brief mark the end of a lvgl task handler run, completes the rendering time of a frame added in this run
+     */
+    void frametime_handler_end( void );
+    /**
+     * @brief get the number of frames in the ring buffer
+     * 
+     * @return  number of frames
+     */
+    uint32_t frametime_get_entrys( void );
+    /**
+     * @brief get a frame from the ring buffer
+     * 
+     * @param   entry       entry number, 0 is the oldest
+     * @param   frame       pointer to a frametime_entry_t structure
+     * 
+     * @return  true if successfull
+     */
+    bool frametime_get_entry( uint32_t entry, frametime_entry_t *frame );
+    /**
+     * @brief get a summary over the ring buffer
+     * 
+     * @param   summary     pointer to a frametime_summary_t structure
+     */
+    void frametime_get_summary( frametime_summary_t *summary );
+    /**
+     * @brief enable or disable the statusbar overlay
+     * 
+     * @param   overlay     true to show frame times in the statusbar
+     */
+    void frametime_set_overlay( bool overlay );
+    /**
+     * @brief get the statusbar overlay state
+     * 
+     * @return  true if the overlay is enabled
+     */
+    bool frametime_get_overlay( void );
+
+#endif // _FRAMETIME_H
@@ -20,6 +20,7 @@
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 #include "hardware/powermgm.h"
+#include "utils/basejsonconfig.h"
 
 #ifdef NATIVE_64BIT
 #else
@@ -48,6 +49,10 @@ void ftpserver_start( const char *user, const char *pass ) {
          * start ftp server
          */
         if ( ftpSrv ) {
+            /**
+             * config files may change over ftp, load them from json on the next boot
+             */
+            BaseJsonConfig::invalidateSnapshot();
             ftpSrv->begin( user, pass );
             log_i("use ftp user/password: %s/%s", user, pass );
             powermgm_register_loop_cb( POWERMGM_WAKEUP | POWERMGM_SILENCE_WAKEUP, ftpserver_powermgm_event_loop_cb, "handle ftp" );
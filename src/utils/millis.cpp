@@ -5,6 +5,7 @@
         #include <linux/unistd.h>       /* for _syscallX macros/related stuff */
         #include <linux/kernel.h>       /* for struct sysinfo */
         #include <sys/sysinfo.h>
+        #include <time.h>
         #include "millis.h"
 
         long millis( void ) {
@@ -15,4 +16,10 @@
             }
             return s_info.uptime;        
         }
+
+        unsigned long micros( void ) {
+            struct timespec ts;
+            clock_gettime( CLOCK_MONOTONIC, &ts );
+            return( ts.tv_sec * 1000000ul + ts.tv_nsec / 1000 );
+        }
 #endif
\ No newline at end of file
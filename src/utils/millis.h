@@ -3,6 +3,7 @@
 
     #ifdef NATIVE_64BIT
         long millis( void );
+        unsigned long micros( void );
     #endif
 
 #endif /// _MILLIS_H
\ No newline at end of file
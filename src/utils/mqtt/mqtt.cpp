@@ -26,6 +26,7 @@
 #include "utils/mqtt/mqtt.h"
 #include "hardware/pmu.h"
 #include "hardware/powermgm.h"
+#include "utils/frametime.h"
 
 bool mqtt_setup = false;
 bool mqtt_run = false;
@@ -99,6 +100,7 @@ void mqtt_loop( lv_task_t * task ) {
         mqtt_publish_sketch();
         mqtt_publish_heap();
         mqtt_publish_psram();
+        mqtt_publish_frametime();
     }
   }
 }
@@ -252,6 +254,19 @@ void mqtt_publish_sketch() {
   mqtt_client.publish(topic, payload, false);
 }
 
+void mqtt_publish_frametime() {
+  char topic[64];
+  snprintf(topic, sizeof(topic), "%s/frametime", clientId);
+
+  frametime_summary_t summary;
+  frametime_get_summary( &summary );
+
+  char payload[48];
+  snprintf(payload, sizeof(payload), "%u/%u/%u/%u", summary.fps, summary.render_mean_us, summary.flush_mean_us, summary.px_mean);
+
+  mqtt_client.publish(topic, payload, false);
+}
+
 bool mqtt_get_connected() {
   return mqtt_client.connected();
 }
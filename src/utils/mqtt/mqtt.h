@@ -116,6 +116,11 @@
      */
     void mqtt_publish_sketch();
 
+    /**
+     *  @brief publish frame time state as fps/render_mean_us/flush_mean_us/px_mean.
+     */
+    void mqtt_publish_frametime();
+
     /**
      *  @brief get connection state.
      */
@@ -22,316 +22,242 @@
 #include "config.h"
 #include "alloc.h"
 #include "msg_chain.h"
+#include <string.h>
 
 #ifdef NATIVE_64BIT
     #include <time.h>
     #include "utils/logging.h"
+    #include "utils/millis.h"
 #else
     #include <Arduino.h>
 #endif
 
-msg_chain_t * msg_chain_add_msg( msg_chain_t *msg_chain, const char *msg ) {
-    /*
-     * add msg_chain_t head structure if not exsist
-     */
-    if ( msg_chain == NULL ) {
-        msg_chain = (msg_chain_t *)CALLOC( sizeof( msg_chain_t ), 1 );
-        if ( msg_chain == NULL ) {
-            log_e("msg_chain_t alloc failed");
-            while( true );
-        }
+/**
+ * @brief get a pointer to the msg chain entry by their number, 0 is the oldest
+ * 
+ * @param   msg_chain   pointer to the msg_chain
+ * @param   entry       entry number
+ * 
+ * @return  pointer to the msg chain entry
+ */
+static msg_chain_entry_t *msg_chain_get_entry( msg_chain_t *msg_chain, int32_t entry ) {
+    return( &msg_chain->entry[ ( msg_chain->first_entry + entry ) % msg_chain->max_entrys ] );
+}
 
-        msg_chain->entrys = 0;
-        msg_chain->current_entry = 0;
-        msg_chain->current_msg_chain_entry = NULL;
-        msg_chain->first_msg_chain_entry = NULL;
-    }
- 
-    /*
-     * add new msg_chain_entry_t structure and add msg
-     */
-    msg_chain_entry_t *msg_chain_entry = (msg_chain_entry_t *)CALLOC( sizeof( msg_chain_entry_t ), 1 );
-    if ( msg_chain_entry == NULL ) {
-        log_e("msg_chain_entry_t alloc failed");
-        while( true );
-    }
-    else {
-        msg_chain_entry->msg = (const char *)CALLOC( strlen( msg ) + 1, 1 );
-        if ( msg_chain_entry->msg == NULL ) {
-            log_e("msg calloc failed");
-            while( true );
-        }
-        msg_chain_entry->prev_msg = NULL;
-        msg_chain_entry->next_msg = NULL;
-        time( &msg_chain_entry->timestamp );
-        strcpy( (char*)msg_chain_entry->msg, msg );
-    }
-    
+/**
+ * @brief evict the oldest msg from the msg_chain and release their arena space
+ * 
+ * @param   msg_chain   pointer to the msg_chain
+ */
+static void msg_chain_evict_oldest( msg_chain_t *msg_chain ) {
+    msg_chain->bytes -= msg_chain_get_entry( msg_chain, 0 )->size;
+    msg_chain->first_entry = ( msg_chain->first_entry + 1 ) % msg_chain->max_entrys;
+    msg_chain->entrys--;
+    msg_chain->evicted++;
     /*
-     * add msg_chain_entry to the chain
+     * the arena tail follows the oldest msg, an empty arena starts from the beginning
      */
-    if ( msg_chain->first_msg_chain_entry == NULL ) {
-        msg_chain->first_msg_chain_entry = msg_chain_entry;
-        msg_chain->entrys++;
+    if ( msg_chain->entrys == 0 ) {
+        msg_chain->arena_head = 0;
+        msg_chain->arena_tail = 0;
     }
     else {
-        msg_chain_entry_t *current_msg_chain_entry = msg_chain->first_msg_chain_entry;
-
-        /*
-         * find the last entry in the chain
-         */
-        while( current_msg_chain_entry->next_msg != NULL ) {
-            current_msg_chain_entry = current_msg_chain_entry->next_msg;
-        }
-        /*
-         * add a new msg_chain_entry
-         */
-        current_msg_chain_entry->next_msg = msg_chain_entry;
-        msg_chain_entry->prev_msg = current_msg_chain_entry;
-        msg_chain->entrys++;
+        msg_chain->arena_tail = msg_chain_get_entry( msg_chain, 0 )->msg - msg_chain->arena;
     }
-    return( msg_chain );
 }
 
-bool msg_chain_delete_msg_entry( msg_chain_t *msg_chain, int32_t entry ) {
-    int32_t msg_counter = 0;
-    bool retval = false;
-
-    /*
-     * check if msg chain exist
-     */
-    if ( msg_chain == NULL ) {
-        return( retval );
-    }
-    /*
-     * check if msg has an entry
-     */
-    if ( msg_chain->first_msg_chain_entry == NULL ) {
-        return( retval );
-    }
-    /*
-     * check if entry exist
-     */
-    if ( entry > msg_chain->entrys ) {
-        return( retval );
-    }
-
-    msg_chain_entry_t *msg_chain_entry = msg_chain->first_msg_chain_entry;
-    msg_chain_entry_t *prev_msg_chain_entry = NULL;
-    msg_chain_entry_t *next_msg_chain_entry = NULL;
+/**
+ * @brief get arena space for a msg, evict the oldest msg until the space is free
+ * 
+ * @param   msg_chain   pointer to the msg_chain
+ * @param   size        size in bytes
+ * 
+ * @return  pointer to the arena space
+ */
+static char *msg_chain_arena_alloc( msg_chain_t *msg_chain, size_t size ) {
+    char *retval = NULL;
 
-    /*
-     * find the entry in the chain
-     */
-    do {
-        if ( entry == msg_counter ) {
-            /*
-             * get the prev and next msg chain entry if exsist
-             */
-            if ( msg_chain_entry->prev_msg != NULL ) {
-                prev_msg_chain_entry = msg_chain_entry->prev_msg;
-            }
-            if ( msg_chain_entry->next_msg != NULL ) {
-                next_msg_chain_entry = msg_chain_entry->next_msg;
-            }
+    while( retval == NULL ) {
+        bool wrapped = msg_chain->arena_head < msg_chain->arena_tail || ( msg_chain->arena_head == msg_chain->arena_tail && msg_chain->entrys > 0 );
 
+        if ( !wrapped && msg_chain->max_bytes - msg_chain->arena_head >= size ) {
             /*
-             * free allocated msg
+             * free space behind the arena head
              */
-            free( (void *)msg_chain_entry->msg );
-
+            retval = &msg_chain->arena[ msg_chain->arena_head ];
+            msg_chain->arena_head += size;
+        }
+        else if ( !wrapped && msg_chain->arena_tail > size ) {
             /*
-             * delete chain entry in all conditions
+             * free space at the arena beginning, wrap around
              */
-            if ( prev_msg_chain_entry && next_msg_chain_entry ) {
-                prev_msg_chain_entry->next_msg = next_msg_chain_entry;
-                next_msg_chain_entry->prev_msg = prev_msg_chain_entry;
-            }
-            else if( !prev_msg_chain_entry && next_msg_chain_entry ) {
-                next_msg_chain_entry->prev_msg = NULL;
-                msg_chain->first_msg_chain_entry = next_msg_chain_entry;
-            }
-            else if( prev_msg_chain_entry && !next_msg_chain_entry ) {
-                prev_msg_chain_entry->next_msg = NULL;
-            }
-            else {
-                msg_chain->first_msg_chain_entry = NULL;
-            }
-
+            retval = msg_chain->arena;
+            msg_chain->arena_head = size;
+        }
+        else if ( wrapped && msg_chain->arena_tail - msg_chain->arena_head >= size ) {
             /*
-             * free allocated msg chain entry
+             * free space between arena head and tail
              */
-            free( msg_chain_entry );
-            msg_chain->entrys--;
-            retval = true;
-            break;
-        }
-
-        /*
-         * get next chain entry
-         */
-        if ( msg_chain_entry->next_msg != NULL ) {
-            msg_counter++;
-            msg_chain_entry = msg_chain_entry->next_msg;
+            retval = &msg_chain->arena[ msg_chain->arena_head ];
+            msg_chain->arena_head += size;
         }
         else {
-            retval = false;
-            break;
+            msg_chain_evict_oldest( msg_chain );
         }
-
-    } while ( true );
-
+    }
     return( retval );
 }
 
-time_t* msg_chain_get_msg_timestamp_entry( msg_chain_t *msg_chain, int32_t entry ) {
-    time_t* retval = NULL;
-    int32_t msg_counter = 0;
-
+msg_chain_t *msg_chain_create( int32_t max_entrys, size_t max_bytes ) {
     /*
-     * check if msg chain exist
+     * alloc head, entry ring and text arena in one block
      */
+    msg_chain_t *msg_chain = (msg_chain_t *)CALLOC( sizeof( msg_chain_t ) + sizeof( msg_chain_entry_t ) * max_entrys + max_bytes, 1 );
     if ( msg_chain == NULL ) {
-        return( retval );
+        log_e("msg_chain_t alloc failed");
+        return( NULL );
+    }
+
+    msg_chain->entrys = 0;
+    msg_chain->max_entrys = max_entrys;
+    msg_chain->first_entry = 0;
+    msg_chain->entry = (msg_chain_entry_t *)&msg_chain[ 1 ];
+    msg_chain->max_bytes = max_bytes;
+    msg_chain->bytes = 0;
+    msg_chain->arena_head = 0;
+    msg_chain->arena_tail = 0;
+    msg_chain->arena = (char *)&msg_chain->entry[ max_entrys ];
+    msg_chain->evicted = 0;
+
+    return( msg_chain );
+}
+
+msg_chain_t * msg_chain_add_msg( msg_chain_t *msg_chain, const char *msg ) {
+    return( msg_chain_add_msg( msg_chain, msg, NULL ) );
+}
+
+msg_chain_t * msg_chain_add_msg( msg_chain_t *msg_chain, const char *msg, bool *added ) {
+    if ( added ) {
+        *added = false;
     }
     /*
-     * check if msg has an entry
+     * add msg_chain_t head structure if not exsist
      */
-    if ( msg_chain->first_msg_chain_entry == NULL ) {
-        return( retval );
+    if ( msg_chain == NULL ) {
+        msg_chain = msg_chain_create( MSG_CHAIN_DEFAULT_ENTRYS, MSG_CHAIN_DEFAULT_BYTES );
+        if ( msg_chain == NULL ) {
+            while( true );
+        }
     }
     /*
-     * check if entry exist
+     * check if msg fit into the arena
      */
-    if ( entry > msg_chain->entrys ) {
-        return( retval );
+    size_t size = strlen( msg ) + 1;
+    if ( size > msg_chain->max_bytes ) {
+        log_e("msg to large for msg_chain ( %u > %u bytes )", (unsigned int)size, (unsigned int)msg_chain->max_bytes );
+        return( msg_chain );
     }
-
     /*
-     * get the first entry in the chain
+     * evict the oldest msg if the entry ring is full
      */
-    msg_chain_entry_t *msg_chain_entry = msg_chain->first_msg_chain_entry;
+    if ( msg_chain->entrys == msg_chain->max_entrys ) {
+        msg_chain_evict_oldest( msg_chain );
+    }
     /*
-     * find the entry in the chain
+     * add msg at the end of the ring
      */
-    do {
-        if ( entry == msg_counter ) {
-            retval = &msg_chain_entry->timestamp;
-            break;
-        }
-        if ( msg_chain_entry->next_msg != NULL ) {
-            msg_counter++;
-            msg_chain_entry = msg_chain_entry->next_msg;
-        }
-        else {
-            break;
-        }
-    } while ( true );
+    msg_chain_entry_t *msg_chain_entry = msg_chain_get_entry( msg_chain, msg_chain->entrys );
+    msg_chain_entry->msg = msg_chain_arena_alloc( msg_chain, size );
+    msg_chain_entry->size = size;
+    time( &msg_chain_entry->timestamp );
+    memcpy( (char*)msg_chain_entry->msg, msg, size );
+    msg_chain->bytes += size;
+    msg_chain->entrys++;
+    if ( added ) {
+        *added = true;
+    }
 
-    return( retval );
+    return( msg_chain );
 }
 
-const char* msg_chain_get_msg_entry( msg_chain_t *msg_chain, int32_t entry ) {
-    const char* retval = NULL;
-    int32_t msg_counter = 0;
-
+bool msg_chain_delete_msg_entry( msg_chain_t *msg_chain, int32_t entry ) {
     /*
      * check if msg chain exist
      */
     if ( msg_chain == NULL ) {
-        return( retval );
+        return( false );
     }
     /*
-     * check if msg has an entry
+     * check if entry exist
      */
-    if ( msg_chain->first_msg_chain_entry == NULL ) {
-        return( retval );
+    if ( entry < 0 || entry >= msg_chain->entrys ) {
+        return( false );
     }
     /*
-     * check if entry exist
+     * the oldest msg release their arena space directly
      */
-    if ( entry > msg_chain->entrys ) {
-        return( retval );
+    if ( entry == 0 ) {
+        msg_chain_evict_oldest( msg_chain );
+        msg_chain->evicted--;
+        return( true );
     }
     /*
-     * get the first entry in the chain
+     * close the gap in the entry ring, the arena space is released
+     * when all older msg are gone
      */
-    msg_chain_entry_t *msg_chain_entry = msg_chain->first_msg_chain_entry;
+    msg_chain->bytes -= msg_chain_get_entry( msg_chain, entry )->size;
+    for( int32_t i = entry ; i < msg_chain->entrys - 1 ; i++ ) {
+        *msg_chain_get_entry( msg_chain, i ) = *msg_chain_get_entry( msg_chain, i + 1 );
+    }
+    msg_chain->entrys--;
     /*
-     * find the entry in the chain
+     * if the newest msg was deleted, the arena head goes back
      */
-    do {
-        if ( entry == msg_counter ) {
-            retval = msg_chain_entry->msg;
-            break;
-        }
-        if ( msg_chain_entry->next_msg != NULL ) {
-            msg_counter++;
-            msg_chain_entry = msg_chain_entry->next_msg;
-        }
-        else {
-            break;
-        }
-    } while ( true );
+    if ( entry == msg_chain->entrys ) {
+        msg_chain_entry_t *msg_chain_entry = msg_chain_get_entry( msg_chain, msg_chain->entrys - 1 );
+        msg_chain->arena_head = msg_chain_entry->msg - msg_chain->arena + msg_chain_entry->size;
+    }
 
-    return( retval );
+    return( true );
 }
 
-int32_t msg_chain_get_entrys( msg_chain_t *msg_chain ) {
-    int32_t msg_counter = 0;
-    /*
-     * check if msg chain exist
-     */
-    if ( msg_chain == NULL ) {
-        return( msg_counter );
-    }
+time_t* msg_chain_get_msg_timestamp_entry( msg_chain_t *msg_chain, int32_t entry ) {
     /*
-     * check if msg has an entry
+     * check if msg chain and entry exist
      */
-    if ( msg_chain->first_msg_chain_entry == NULL ) {
-        return( msg_counter );
+    if ( msg_chain == NULL || entry < 0 || entry >= msg_chain->entrys ) {
+        return( NULL );
     }
+    return( &msg_chain_get_entry( msg_chain, entry )->timestamp );
+}
 
-    msg_counter++;
-    
-    msg_chain_entry_t *msg_chain_entry = msg_chain->first_msg_chain_entry;
-
+const char* msg_chain_get_msg_entry( msg_chain_t *msg_chain, int32_t entry ) {
     /*
-     * count the entry in the chain
+     * check if msg chain and entry exist
      */
-    while( msg_chain_entry->next_msg != NULL ) {
-        msg_counter++;
-        msg_chain_entry = msg_chain_entry->next_msg;
+    if ( msg_chain == NULL || entry < 0 || entry >= msg_chain->entrys ) {
+        return( NULL );
     }
-    return( msg_counter );
+    return( msg_chain_get_entry( msg_chain, entry )->msg );
 }
 
-msg_chain_t *msg_chain_delete( msg_chain_t *msg_chain ) {
-    int32_t entrys = 0;
-
+int32_t msg_chain_get_entrys( msg_chain_t *msg_chain ) {
     /*
      * check if msg chain exist
      */
     if ( msg_chain == NULL ) {
-        return( NULL );
+        return( 0 );
     }
-    /*
-     * get number of entrys
-     */
-    entrys = msg_chain_get_entrys( msg_chain );
+    return( msg_chain->entrys );
+}
 
+msg_chain_t *msg_chain_delete( msg_chain_t *msg_chain ) {
     /*
-     * delete all msg_chain entrys
+     * head, entry ring and arena are one block
      */
-    for ( int32_t i = 0 ; i < entrys ; i++ ) {
-        if ( !msg_chain_delete_msg_entry( msg_chain, 0 ) ) {
-            log_e("delete msg from msg_chain failed");
-            return( msg_chain );
-        }
+    if ( msg_chain != NULL ) {
+        free( msg_chain );
     }
-
-    free( msg_chain );
-
     return( NULL );
 }
 
@@ -342,25 +268,56 @@ void msg_chain_printf_msg_chain( msg_chain_t *msg_chain ) {
     if ( msg_chain == NULL ) {
         return;
     }
+
+    log_i("msg_chain: %d/%d entrys, %u/%u bytes, %u evicted", msg_chain->entrys, msg_chain->max_entrys, (unsigned int)msg_chain->bytes, (unsigned int)msg_chain->max_bytes, msg_chain->evicted );
+    for( int32_t i = 0 ; i < msg_chain->entrys ; i++ ) {
+        msg_chain_entry_t *msg_chain_entry = msg_chain_get_entry( msg_chain, i );
+        log_i("msg %d: %u < \"%s\" >", i, (unsigned int)( msg_chain_entry->msg - msg_chain->arena ), msg_chain_entry->msg );
+    }
+}
+
+#if defined( NATIVE_64BIT ) && defined( MSG_CHAIN_BENCHMARK )
+void msg_chain_benchmark( void ) {
+    char msg[ 512 ];
+    uint64_t start;
+    uint32_t bytes = 0;
+    msg_chain_t *msg_chain = msg_chain_create( MSG_CHAIN_DEFAULT_ENTRYS, MSG_CHAIN_DEFAULT_BYTES );
+
+    if ( msg_chain == NULL ) {
+        return;
+    }
     /*
-     * check if msg has an entry
+     * append msgs from 64 to 447 bytes, the budget evicts the oldest ones
      */
-    if ( msg_chain->first_msg_chain_entry == NULL ) {
-        return;
+    start = micros();
+    for( int i = 0 ; i < MSG_CHAIN_BENCHMARK_MSGS ; i++ ) {
+        size_t len = 64 + ( i * 37 ) % 384;
+        memset( msg, 'a' + i % 26, len );
+        msg[ len ] = '\0';
+        msg_chain = msg_chain_add_msg( msg_chain, msg );
     }
-    
-    int32_t msg_counter = 0;
-    msg_chain_entry_t *msg_chain_entry = msg_chain->first_msg_chain_entry;
-
+    log_i("msg_chain benchmark: %d appends, %lu ns per append, %d entrys, %u evicted",
+            MSG_CHAIN_BENCHMARK_MSGS, (unsigned long)( ( micros() - start ) * 1000 / MSG_CHAIN_BENCHMARK_MSGS ), msg_chain->entrys, msg_chain->evicted );
     /*
-     * count and printf entry in the chain
+     * indexed access over all entrys
      */
-    while( true ) {
-        log_i("msg %d: %p < \"%s\" > %p", msg_counter, msg_chain_entry->prev_msg, msg_chain_entry->msg, msg_chain_entry->next_msg );
-        if ( msg_chain_entry->next_msg == NULL ) {
-            break;
-        }
-        msg_counter++;
-        msg_chain_entry = msg_chain_entry->next_msg;
-    };
-}
\ No newline at end of file
+    start = micros();
+    for( int i = 0 ; i < MSG_CHAIN_BENCHMARK_MSGS ; i++ ) {
+        bytes += strlen( msg_chain_get_msg_entry( msg_chain, i % msg_chain->entrys ) );
+    }
+    log_i("msg_chain benchmark: %d indexed reads, %lu ns per read, %u bytes",
+            MSG_CHAIN_BENCHMARK_MSGS, (unsigned long)( ( micros() - start ) * 1000 / MSG_CHAIN_BENCHMARK_MSGS ), bytes );
+    /*
+     * delete from the middle and the oldest end until the chain is empty
+     */
+    int32_t deletes = msg_chain->entrys;
+    start = micros();
+    for( int i = 0 ; msg_chain->entrys > 0 ; i++ ) {
+        msg_chain_delete_msg_entry( msg_chain, i & 1 ? 0 : msg_chain->entrys / 2 );
+    }
+    log_i("msg_chain benchmark: %d deletes, %lu ns per delete",
+            deletes, (unsigned long)( ( micros() - start ) * 1000 / deletes ) );
+
+    msg_chain_delete( msg_chain );
+}
+#endif
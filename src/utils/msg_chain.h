@@ -23,34 +23,72 @@
     #define _MSG_CHAIN_H
 
     #include <stdint.h>
+    #include <stddef.h>
     #include <sys/time.h>
+
+    #define MSG_CHAIN_DEFAULT_ENTRYS        64          /** @brief default max number of messages before the oldest is evicted */
+    #define MSG_CHAIN_DEFAULT_BYTES         16384       /** @brief default max bytes for message text before the oldest is evicted */
+    /**
+     * Uncomment to run msg_chain_benchmark() at bluetooth message setup
+     * and log the time per append, indexed access and delete, emulator only.
+     */
+    // #define MSG_CHAIN_BENCHMARK
+    #define MSG_CHAIN_BENCHMARK_MSGS        10000       /** @brief messages appended by the benchmark */
     /**
      * @brief msg chain entry structure
      */
     struct msg_chain_entry_t {
-        msg_chain_entry_t *prev_msg;                    /** @brief pointer to the preview msg chain entry, if NULL no preview entry available */
         time_t timestamp;                               /** @brief timestamp, set when created */
-        const char *msg;                                /** @brief pointer to the msg itself, terminated with \0 */
-        msg_chain_entry_t *next_msg;                    /** @brief pointer to the next msg chain entry, if NULL no next entry available */
+        const char *msg;                                /** @brief pointer to the msg itself in the text arena, terminated with \0 */
+        size_t size;                                    /** @brief size of the msg in the text arena including \0 */
     };
     /**
      * @brief msg chain head structure
+     * 
+     * the msg chain is one allocation with the head, a ring of max_entrys
+     * msg_chain_entry_t and a text arena of max_bytes. messages are append
+     * at the arena head and evicted from the arena tail, oldest first.
      */
     struct msg_chain_t {
         int32_t entrys;                                 /** @brief number of entry, count by it self */
-        msg_chain_entry_t *first_msg_chain_entry;       /** @brief pointer to the first msg_chain_entry */
-        int32_t current_entry;                          /** @brief number of the current entry */
-        msg_chain_entry_t *current_msg_chain_entry;     /** @brief pointer to the current entry */
+        int32_t max_entrys;                             /** @brief size of the entry ring */
+        int32_t first_entry;                            /** @brief ring position of the oldest entry */
+        msg_chain_entry_t *entry;                       /** @brief pointer to the entry ring */
+        size_t max_bytes;                               /** @brief size of the text arena */
+        size_t bytes;                                   /** @brief bytes used by stored messages */
+        size_t arena_head;                              /** @brief arena offset for the next message */
+        size_t arena_tail;                              /** @brief arena offset of the oldest message */
+        char *arena;                                    /** @brief pointer to the text arena */
+        uint32_t evicted;                               /** @brief number of messages evicted by the entry or byte budget */
     };
     /**
-     * @brief add a message to the msg_chain
+     * @brief create a new empty msg_chain
+     * 
+     * @param   max_entrys  max number of messages before the oldest is evicted
+     * @param   max_bytes   max bytes of message text before the oldest is evicted
+     * 
+     * @return  pointer     to the msg_chain structure, NULL if failed
+     */
+    msg_chain_t *msg_chain_create( int32_t max_entrys, size_t max_bytes );
+    /**
+     * @brief add a message to the msg_chain, evict the oldest messages if the entry or byte budget is exhausted
      * 
-     * @param   msg_chain   pointer to the msg_chain, if NULL a new msg_chain is make. don't forget to save the return pointer
+     * @param   msg_chain   pointer to the msg_chain, if NULL a new msg_chain with default budget is make. don't forget to save the return pointer
      * @param   msg         the message to store
      * 
      * @return  pointer     to the msg_chain structure, NULL if failed
      */
     msg_chain_t *msg_chain_add_msg( msg_chain_t *msg_chain, const char *msg );
+    /**
+     * @brief add a message to the msg_chain, evict the oldest messages if the entry or byte budget is exhausted
+     * 
+     * @param   msg_chain   pointer to the msg_chain, if NULL a new msg_chain with default budget is make. don't forget to save the return pointer
+     * @param   msg         the message to store
+     * @param   added       pointer to a bool, set to true if the message was stored, false if it was dropped because it is larger than the byte budget. can be NULL
+     * 
+     * @return  pointer     to the msg_chain structure, NULL if failed
+     */
+    msg_chain_t *msg_chain_add_msg( msg_chain_t *msg_chain, const char *msg, bool *added );
     /**
      * @brief delete an msg from the msg_chain
      * 
@@ -96,5 +134,12 @@
      * @param   msg_chain   pointer to the msg_chain
      */
     void msg_chain_printf_msg_chain( msg_chain_t *msg_chain );
+#if defined( NATIVE_64BIT ) && defined( MSG_CHAIN_BENCHMARK )
+    /**
+     * @brief append MSG_CHAIN_BENCHMARK_MSGS messages to a msg_chain with default budget
+     * and log the time per append, indexed access and delete
+     */
+    void msg_chain_benchmark( void );
+#endif
 
 #endif // _MSG_CHAIN_H
\ No newline at end of file
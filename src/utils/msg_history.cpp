@@ -0,0 +1,482 @@
+/****************************************************************************
+ *   Oct 17 10:12:43 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+#include "alloc.h"
+#include "msg_history.h"
+#include "filepath_convert.h"
+#include "utils/sqlite3/shox96_0_2.h"
+#include "hardware/powermgm.h"
+
+#ifdef NATIVE_64BIT
+    #include <time.h>
+    #include "utils/logging.h"
+#else
+    #include <Arduino.h>
+#endif
+
+static msg_history_index_t *msg_history_index = NULL;     /** @brief in memory copy of the index file */
+static int32_t msg_history_entrys = 0;                      /** @brief number of valid index entrys */
+static uint32_t msg_history_log_size = 0;                   /** @brief size of the log file */
+static bool msg_history_compact_pending = false;            /** @brief over budget, compact from the powermgm loop */
+
+static bool msg_history_recover( const char *log_file, const char *index_file );
+static bool msg_history_write_entry( FILE *log, FILE *index, msg_history_index_t *entry, const char *data );
+static bool msg_history_powermgm_loop_cb( EventBits_t event, void *arg );
+
+/**
+ * @brief fletcher16 checksum
+ * 
+ * @param   data        pointer to the data
+ * @param   size        size of the data
+ * 
+ * @return  checksum
+ */
+static uint16_t msg_history_checksum( const char *data, size_t size ) {
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    for( size_t i = 0 ; i < size ; i++ ) {
+        sum1 = ( sum1 + (uint8_t)data[ i ] ) % 255;
+        sum2 = ( sum2 + sum1 ) % 255;
+    }
+    return( ( sum2 << 8 ) | sum1 );
+}
+
+/**
+ * @brief get the file size of an open file
+ * 
+ * @param   file        pointer to an open file
+ * 
+ * @return  file size
+ */
+static uint32_t msg_history_file_size( FILE *file ) {
+    fseek( file, 0, SEEK_END );
+    return( ftell( file ) );
+}
+
+/**
+ * @brief read the index and the log size from the history files
+ * 
+ * @param   log_file    path to the log file
+ * @param   index_file  path to the index file
+ * 
+ * @return  true if an index file was found
+ */
+static bool msg_history_load( const char *log_file, const char *index_file ) {
+    msg_history_entrys = 0;
+    msg_history_log_size = 0;
+    /**
+     * get log size, the log itself is not read
+     */
+    FILE *log = fopen( log_file, "rb" );
+    if ( log ) {
+        msg_history_log_size = msg_history_file_size( log );
+        fclose( log );
+    }
+    /**
+     * read only whole index records, a torn last record is overwritten by the next add
+     */
+    bool index_found = false;
+    int32_t records = 0;
+    FILE *index = fopen( index_file, "rb" );
+    if ( index ) {
+        uint32_t index_size = msg_history_file_size( index );
+        records = index_size / sizeof( msg_history_index_t );
+        if ( records > MSG_HISTORY_MAX_ENTRYS + 1 )
+            records = MSG_HISTORY_MAX_ENTRYS + 1;
+        fseek( index, 0, SEEK_SET );
+        records = fread( msg_history_index, sizeof( msg_history_index_t ), records, index );
+        index_found = true;
+        fclose( index );
+    }
+    /**
+     * keep only entrys thats lie inside the log and behind the previous entry,
+     * the stored data itself is checked against the checksum on read
+     */
+    uint32_t end = 0;
+    for( int32_t i = 0 ; i < records ; i++ ) {
+        msg_history_index_t *entry = &msg_history_index[ i ];
+        if (    entry->size > MSG_HISTORY_MAX_MSG_SIZE
+             || entry->offset < end
+             || entry->offset + entry->stored > msg_history_log_size ) {
+            log_w("msg history index entry %d damaged, dropped", i );
+            continue;
+        }
+        end = entry->offset + entry->stored;
+        msg_history_index[ msg_history_entrys++ ] = *entry;
+    }
+    log_d("msg history: %d entrys, %d bytes log", msg_history_entrys, msg_history_log_size );
+
+    return( index_found );
+}
+
+bool msg_history_setup( void ) {
+    char log_file[ 256 ] = "";
+    char index_file[ 256 ] = "";
+
+    filepath_convert( log_file, sizeof( log_file ), MSG_HISTORY_LOG_FILE );
+    filepath_convert( index_file, sizeof( index_file ), MSG_HISTORY_INDEX_FILE );
+    /**
+     * finish an interrupted compacting
+     */
+    msg_history_recover( log_file, index_file );
+    /**
+     * alloc index
+     */
+    if ( msg_history_index == NULL ) {
+        msg_history_index = (msg_history_index_t *)CALLOC_ASSERT( sizeof( msg_history_index_t ) * ( MSG_HISTORY_MAX_ENTRYS + 1 ), 1, "msg history index alloc failed" );
+        powermgm_register_loop_cb( POWERMGM_SILENCE_WAKEUP | POWERMGM_STANDBY | POWERMGM_WAKEUP, msg_history_powermgm_loop_cb, "msg history loop" );
+    }
+    bool index_found = msg_history_load( log_file, index_file );
+    /**
+     * compact if over budget or if the index was damaged
+     */
+    if ( msg_history_entrys > MSG_HISTORY_MAX_ENTRYS || msg_history_log_size > MSG_HISTORY_MAX_BYTES || ( index_found && msg_history_entrys == 0 && msg_history_log_size ) ) {
+        return( msg_history_compact() );
+    }
+    return( true );
+}
+
+bool msg_history_add( const char *msg, time_t timestamp ) {
+    char log_file[ 256 ] = "";
+    char index_file[ 256 ] = "";
+    bool retval = false;
+
+    if ( msg_history_index == NULL ) {
+        return( false );
+    }
+    /**
+     * the index is still full after a failed or not yet done compacting, try it now or drop the msg
+     */
+    if ( msg_history_entrys > MSG_HISTORY_MAX_ENTRYS && !msg_history_compact() ) {
+        log_w("msg history full, msg dropped");
+        return( false );
+    }
+    size_t size = strlen( msg );
+    if ( size > MSG_HISTORY_MAX_MSG_SIZE ) {
+        log_w("msg to large for msg history");
+        return( false );
+    }
+    /**
+     * compress msg and check the round trip, shox96 only knows printable ascii,
+     * so all other messages are stored as they are
+     */
+    msg_history_index_t entry;
+    char *compressed = (char *)CALLOC_ASSERT( size * 3 + 8, 1, "msg history compress buffer alloc failed" );
+    char *decompressed = (char *)CALLOC_ASSERT( size + 8, 1, "msg history decompress buffer alloc failed" );
+    const char *data = msg;
+    int stored = shox96_0_2_compress( msg, size, compressed, NULL );
+
+    entry.flags = 0;
+    entry.stored = size;
+    if ( stored > 0 && (size_t)stored < size ) {
+        int len = shox96_0_2_decompress( compressed, stored, decompressed, NULL );
+        if ( (size_t)len == size && !memcmp( decompressed, msg, size ) ) {
+            data = compressed;
+            entry.flags = MSG_HISTORY_FLAG_COMPRESSED;
+            entry.stored = stored;
+        }
+    }
+    entry.timestamp = timestamp;
+    entry.size = size;
+    entry.checksum = msg_history_checksum( data, entry.stored );
+    /**
+     * append to log and index
+     */
+    FILE *log = fopen( filepath_convert( log_file, sizeof( log_file ), MSG_HISTORY_LOG_FILE ), "ab" );
+    FILE *index = fopen( filepath_convert( index_file, sizeof( index_file ), MSG_HISTORY_INDEX_FILE ), "r+b" );
+    if ( !index )
+        index = fopen( index_file, "wb" );
+    if ( log && index ) {
+        /**
+         * take the offset from the log itself, so bytes left by a failed write
+         * don't shift the following entrys, and write over a torn index record
+         */
+        entry.offset = msg_history_file_size( log );
+        uint32_t index_size = msg_history_file_size( index );
+        fseek( index, index_size - index_size % sizeof( msg_history_index_t ), SEEK_SET );
+        retval = msg_history_write_entry( log, index, &entry, data );
+        msg_history_log_size = msg_history_file_size( log );
+    }
+    else {
+        log_e("can't open msg history files");
+    }
+    if ( log )
+        fclose( log );
+    if ( index )
+        fclose( index );
+    free( compressed );
+    free( decompressed );
+    /**
+     * update in memory index
+     */
+    if ( retval ) {
+        msg_history_index[ msg_history_entrys++ ] = entry;
+        log_d("msg history: add %d bytes as %d bytes", entry.size, entry.stored );
+        /**
+         * compact from the powermgm loop, not in the path that shows the msg
+         */
+        if ( msg_history_entrys > MSG_HISTORY_MAX_ENTRYS || msg_history_log_size > MSG_HISTORY_MAX_BYTES ) {
+            msg_history_compact_pending = true;
+        }
+    }
+    return( retval );
+}
+
+int32_t msg_history_get_entrys( void ) {
+    return( msg_history_entrys );
+}
+
+size_t msg_history_get_msg_size( int32_t entry ) {
+    if ( entry < 0 || entry >= msg_history_entrys ) {
+        return( 0 );
+    }
+    return( msg_history_index[ entry ].size + 1 );
+}
+
+bool msg_history_get_msg( int32_t entry, char *msg, size_t size, time_t *timestamp ) {
+    char log_file[ 256 ] = "";
+    bool retval = false;
+
+    if ( entry < 0 || entry >= msg_history_entrys || size < msg_history_get_msg_size( entry ) ) {
+        return( false );
+    }
+    msg_history_index_t *index = &msg_history_index[ entry ];
+    /**
+     * read the stored data
+     */
+    FILE *log = fopen( filepath_convert( log_file, sizeof( log_file ), MSG_HISTORY_LOG_FILE ), "rb" );
+    if ( !log ) {
+        return( false );
+    }
+    char *data = (char *)MALLOC_ASSERT( index->stored, "msg history read buffer alloc failed" );
+    if ( !fseek( log, index->offset, SEEK_SET ) && fread( data, 1, index->stored, log ) == index->stored ) {
+        if ( msg_history_checksum( data, index->stored ) != index->checksum ) {
+            log_e("msg history entry %d checksum failed", entry );
+        }
+        else if ( index->flags & MSG_HISTORY_FLAG_COMPRESSED ) {
+            /**
+             * the decoder can write a few bytes more than the message
+             */
+            char *decompressed = (char *)CALLOC_ASSERT( index->size + 8, 1, "msg history decompress buffer alloc failed" );
+            int len = shox96_0_2_decompress( data, index->stored, decompressed, NULL );
+            if ( len == index->size ) {
+                memcpy( msg, decompressed, index->size );
+                msg[ index->size ] = '\0';
+                retval = true;
+            }
+            free( decompressed );
+        }
+        else {
+            memcpy( msg, data, index->size );
+            msg[ index->size ] = '\0';
+            retval = true;
+        }
+    }
+    fclose( log );
+    free( data );
+
+    if ( retval && timestamp ) {
+        *timestamp = index->timestamp;
+    }
+    return( retval );
+}
+
+bool msg_history_compact( void ) {
+    char log_file[ 256 ] = "";
+    char index_file[ 256 ] = "";
+    char tmp_log_file[ 256 ] = "";
+    char tmp_index_file[ 256 ] = "";
+    bool retval = true;
+
+    if ( msg_history_index == NULL ) {
+        return( false );
+    }
+    msg_history_compact_pending = false;
+
+    filepath_convert( log_file, sizeof( log_file ), MSG_HISTORY_LOG_FILE );
+    filepath_convert( index_file, sizeof( index_file ), MSG_HISTORY_INDEX_FILE );
+    filepath_convert( tmp_log_file, sizeof( tmp_log_file ), MSG_HISTORY_LOG_FILE MSG_HISTORY_TMP_EXT );
+    filepath_convert( tmp_index_file, sizeof( tmp_index_file ), MSG_HISTORY_INDEX_FILE MSG_HISTORY_TMP_EXT );
+    /**
+     * find the oldest entry to keep, the newest entrys must fit into half of the budget
+     */
+    int32_t first = msg_history_entrys;
+    uint32_t bytes = 0;
+    while( first > 0 && msg_history_entrys - first < MSG_HISTORY_MAX_ENTRYS / 2 && bytes + msg_history_index[ first - 1 ].stored <= MSG_HISTORY_MAX_BYTES / 2 ) {
+        first--;
+        bytes += msg_history_index[ first ].stored;
+    }
+    /**
+     * copy the kept entrys into new files
+     */
+    FILE *log = fopen( log_file, "rb" );
+    FILE *tmp_log = fopen( tmp_log_file, "wb" );
+    FILE *tmp_index = fopen( tmp_index_file, "wb" );
+    int32_t kept = 0;
+    uint32_t offset = 0;
+
+    if ( tmp_log && tmp_index ) {
+        char *data = (char *)MALLOC_ASSERT( MSG_HISTORY_MAX_MSG_SIZE * 3 + 8, "msg history compact buffer alloc failed" );
+        for( int32_t i = first ; i < msg_history_entrys && log ; i++ ) {
+            msg_history_index_t entry = msg_history_index[ i ];
+
+            if ( fseek( log, entry.offset, SEEK_SET ) || fread( data, 1, entry.stored, log ) != entry.stored || msg_history_checksum( data, entry.stored ) != entry.checksum ) {
+                log_w("msg history entry %d damaged, dropped", i );
+                continue;
+            }
+            entry.offset = offset;
+            if ( !msg_history_write_entry( tmp_log, tmp_index, &entry, data ) ) {
+                retval = false;
+                break;
+            }
+            msg_history_index[ kept++ ] = entry;
+            offset += entry.stored;
+        }
+        free( data );
+    }
+    else {
+        retval = false;
+    }
+    if ( log )
+        fclose( log );
+    if ( tmp_log )
+        fclose( tmp_log );
+    if ( tmp_index )
+        fclose( tmp_index );
+    /**
+     * swap files, msg_history_recover() finish it after a reset in between
+     */
+    if ( retval ) {
+        remove( log_file );
+        retval = msg_history_recover( log_file, index_file );
+    }
+    else {
+        remove( tmp_log_file );
+        remove( tmp_index_file );
+        log_e("msg history compacting failed");
+        /**
+         * the original files are untouched, reread the index overwritten by the copy
+         */
+        msg_history_load( log_file, index_file );
+        return( false );
+    }
+    msg_history_entrys = kept;
+    msg_history_log_size = offset;
+    log_d("msg history compacted: %d entrys, %d bytes log", msg_history_entrys, msg_history_log_size );
+
+    return( retval );
+}
+
+void msg_history_clear( void ) {
+    char filename[ 256 ] = "";
+
+    remove( filepath_convert( filename, sizeof( filename ), MSG_HISTORY_LOG_FILE ) );
+    remove( filepath_convert( filename, sizeof( filename ), MSG_HISTORY_INDEX_FILE ) );
+    msg_history_entrys = 0;
+    msg_history_log_size = 0;
+}
+
+/**
+ * @brief write a msg history entry into a log and index file
+ * 
+ * @param   log         pointer to the open log file
+ * @param   index       pointer to the open index file
+ * @param   entry       pointer to the index entry
+ * @param   data        pointer to the stored data
+ * 
+ * @return  true if success, false if failed
+ */
+/**
+ * @brief run a compacting requested by msg_history_add()
+ */
+static bool msg_history_powermgm_loop_cb( EventBits_t event, void *arg ) {
+    if ( msg_history_compact_pending ) {
+        msg_history_compact();
+    }
+    return( true );
+}
+
+static bool msg_history_write_entry( FILE *log, FILE *index, msg_history_index_t *entry, const char *data ) {
+    /**
+     * the log entry is written first, an index entry without log data
+     * is dropped at next setup
+     */
+    if ( fwrite( data, 1, entry->stored, log ) != entry->stored || fflush( log ) ) {
+        log_e("msg history log write failed");
+        return( false );
+    }
+    if ( fwrite( entry, sizeof( msg_history_index_t ), 1, index ) != 1 || fflush( index ) ) {
+        log_e("msg history index write failed");
+        return( false );
+    }
+    return( true );
+}
+
+/**
+ * @brief finish an interrupted compacting
+ * 
+ * compacting writes a complete new log and index as temp files, remove the old log
+ * and rename the temp files. a missing log with existing temp files means the temp
+ * files are complete, existing log and temp files means the compacting was
+ * interrupted while writing the temp files.
+ * 
+ * @param   log_file    log filename
+ * @param   index_file  index filename
+ * 
+ * @return  true if success, false if failed
+ */
+static bool msg_history_recover( const char *log_file, const char *index_file ) {
+    char tmp_log_file[ 256 ] = "";
+    char tmp_index_file[ 256 ] = "";
+    bool retval = true;
+
+    snprintf( tmp_log_file, sizeof( tmp_log_file ), "%s" MSG_HISTORY_TMP_EXT, log_file );
+    snprintf( tmp_index_file, sizeof( tmp_index_file ), "%s" MSG_HISTORY_TMP_EXT, index_file );
+
+    FILE *log = fopen( log_file, "rb" );
+    FILE *tmp_log = fopen( tmp_log_file, "rb" );
+    FILE *tmp_index = fopen( tmp_index_file, "rb" );
+    if ( log )
+        fclose( log );
+    if ( tmp_log )
+        fclose( tmp_log );
+    if ( tmp_index )
+        fclose( tmp_index );
+
+    if ( tmp_log && log ) {
+        remove( tmp_log_file );
+        remove( tmp_index_file );
+    }
+    else {
+        if ( tmp_log ) {
+            retval = !rename( tmp_log_file, log_file );
+        }
+        if ( tmp_index ) {
+            remove( index_file );
+            retval = !rename( tmp_index_file, index_file ) && retval;
+        }
+    }
+    return( retval );
+}
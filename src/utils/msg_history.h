@@ -0,0 +1,99 @@
+/****************************************************************************
+ *   Oct 17 10:12:43 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _MSG_HISTORY_H
+    #define _MSG_HISTORY_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+    #include <sys/time.h>
+
+    #define MSG_HISTORY_LOG_FILE            "/spiffs/msg_history.log"   /** @brief append only log with the stored messages */
+    #define MSG_HISTORY_INDEX_FILE          "/spiffs/msg_history.idx"   /** @brief append only index into the log */
+    #define MSG_HISTORY_TMP_EXT             ".tmp"                      /** @brief file extension while compacting */
+    #define MSG_HISTORY_MAX_ENTRYS          256                         /** @brief max entrys before compacting */
+    #define MSG_HISTORY_MAX_BYTES           65536                       /** @brief max log size before compacting */
+    #define MSG_HISTORY_MAX_MSG_SIZE        4096                        /** @brief max size of a single message */
+
+    #define MSG_HISTORY_FLAG_COMPRESSED     0x0001                      /** @brief entry is stored shox96 compressed */
+    /**
+     * @brief msg history index entry, stored as is in the index file
+     */
+    typedef struct {
+        uint32_t offset;                    /** @brief offset of the stored message in the log file */
+        uint32_t timestamp;                 /** @brief timestamp when the message was added */
+        uint16_t size;                      /** @brief message size without \0 */
+        uint16_t stored;                    /** @brief stored size in the log file */
+        uint16_t flags;                     /** @brief MSG_HISTORY_FLAG_* */
+        uint16_t checksum;                  /** @brief fletcher16 checksum over the stored data */
+    } msg_history_index_t;
+    /**
+     * @brief load the msg history index, the log is only read on demand
+     * 
+     * @return  true if success, false if failed
+     */
+    bool msg_history_setup( void );
+    /**
+     * @brief append a message to the msg history, the history is compacted from the powermgm loop if it grows over budget
+     * 
+     * @param   msg         the message to store
+     * @param   timestamp   timestamp of the message
+     * 
+     * @return  true if success, false if failed
+     */
+    bool msg_history_add( const char *msg, time_t timestamp );
+    /**
+     * @brief get the number of messages in the msg history
+     * 
+     * @return  number of entrys
+     */
+    int32_t msg_history_get_entrys( void );
+    /**
+     * @brief get the buffer size needed to read a message from the msg history
+     * 
+     * @param   entry       entry number, 0 is the oldest
+     * 
+     * @return  size including \0, 0 if failed
+     */
+    size_t msg_history_get_msg_size( int32_t entry );
+    /**
+     * @brief read and decompress a message from the msg history
+     * 
+     * @param   entry       entry number, 0 is the oldest
+     * @param   msg         pointer to a buffer for the message
+     * @param   size        size of the buffer, see msg_history_get_msg_size()
+     * @param   timestamp   pointer to a time_t for the timestamp, can be NULL
+     * 
+     * @return  true if success, false if failed
+     */
+    bool msg_history_get_msg( int32_t entry, char *msg, size_t size, time_t *timestamp );
+    /**
+     * @brief rewrite the msg history and keep only the newest messages thats fit into half of the budget
+     * 
+     * @return  true if success, false if failed
+     */
+    bool msg_history_compact( void );
+    /**
+     * @brief delete the complete msg history
+     */
+    void msg_history_clear( void );
+
+#endif // _MSG_HISTORY_H
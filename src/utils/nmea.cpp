@@ -0,0 +1,274 @@
+/****************************************************************************
+ *   Oct 17 16:05:12 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "nmea.h"
+
+#define NMEA_MAX_FIELDS         24                  /** @brief max fields per sentence, GSV has 20 */
+
+static uint32_t nmea_hex( char c );
+static bool nmea_checksum( char *sentence, size_t len );
+static size_t nmea_split( char *sentence, char **field, size_t max_fields );
+static double nmea_coord( const char *value, const char *hemisphere );
+static void nmea_set_fix( nmea_data_t *data, bool fix );
+static void nmea_set_satellites( nmea_data_t *data, uint32_t *satellites, const char *value, uint32_t changed );
+static void nmea_decode( nmea_parser_t *parser );
+
+void nmea_init( nmea_parser_t *parser ) {
+    memset( parser, 0, sizeof( nmea_parser_t ) );
+}
+
+uint32_t nmea_parse( nmea_parser_t *parser, const char *buf, size_t len ) {
+    const char *end = buf + len;
+    uint32_t sentences = parser->stats.sentences;
+
+    parser->stats.bytes += len;
+
+    while( buf < end ) {
+        /**
+         * resync on the next '$' if we are not inside a sentence
+         */
+        if ( !parser->in_sentence ) {
+            buf = (const char *)memchr( buf, '$', end - buf );
+            if ( !buf ) {
+                break;
+            }
+            buf++;
+            parser->in_sentence = true;
+            parser->len = 0;
+            continue;
+        }
+        /**
+         * copy up to the line end, a '$' inside the chunk starts a new sentence
+         * and drops the truncated one
+         */
+        const char *eol = (const char *)memchr( buf, '\n', end - buf );
+        const char *chunk_end = eol ? eol : end;
+        const char *restart = (const char *)memchr( buf, '$', chunk_end - buf );
+
+        if ( restart ) {
+            parser->stats.checksum_errors++;
+            parser->in_sentence = false;
+            buf = restart;
+            continue;
+        }
+
+        size_t chunk = chunk_end - buf;
+
+        if ( parser->len + chunk >= NMEA_SENTENCE_SIZE ) {
+            parser->stats.overflows++;
+            parser->in_sentence = false;
+            buf = chunk_end;
+            continue;
+        }
+        memcpy( &parser->sentence[ parser->len ], buf, chunk );
+        parser->len += chunk;
+        buf = chunk_end;
+        /**
+         * a complete line, verify and decode it
+         */
+        if ( eol ) {
+            buf++;
+            parser->in_sentence = false;
+            if ( parser->len && parser->sentence[ parser->len - 1 ] == '\r' ) {
+                parser->len--;
+            }
+            if ( nmea_checksum( parser->sentence, parser->len ) ) {
+                parser->stats.sentences++;
+                nmea_decode( parser );
+            }
+            else {
+                parser->stats.checksum_errors++;
+            }
+        }
+    }
+    return( parser->stats.sentences - sentences );
+}
+
+uint32_t nmea_clear_changed( nmea_parser_t *parser ) {
+    uint32_t changed = parser->data.changed;
+
+    parser->data.changed = 0;
+    return( changed );
+}
+
+static uint32_t nmea_hex( char c ) {
+    if ( c >= '0' && c <= '9' ) {
+        return( c - '0' );
+    }
+    if ( c >= 'A' && c <= 'F' ) {
+        return( c - 'A' + 10 );
+    }
+    if ( c >= 'a' && c <= 'f' ) {
+        return( c - 'a' + 10 );
+    }
+    return( 0x100 );
+}
+
+static bool nmea_checksum( char *sentence, size_t len ) {
+    uint8_t checksum = 0;
+    /**
+     * the checksum is the xor of all chars between '$' and '*'
+     */
+    if ( len < 3 || sentence[ len - 3 ] != '*' ) {
+        return( false );
+    }
+    for( size_t i = 0 ; i < len - 3 ; i++ ) {
+        checksum ^= sentence[ i ];
+    }
+    if ( ( nmea_hex( sentence[ len - 2 ] ) << 4 | nmea_hex( sentence[ len - 1 ] ) ) != checksum ) {
+        return( false );
+    }
+    /**
+     * cut off the checksum for the field split
+     */
+    sentence[ len - 3 ] = '\0';
+    return( true );
+}
+
+static size_t nmea_split( char *sentence, char **field, size_t max_fields ) {
+    size_t fields = 0;
+
+    field[ fields++ ] = sentence;
+    while( fields < max_fields && ( sentence = strchr( sentence, ',' ) ) ) {
+        *sentence++ = '\0';
+        field[ fields++ ] = sentence;
+    }
+    return( fields );
+}
+
+static double nmea_coord( const char *value, const char *hemisphere ) {
+    /**
+     * [d]ddmm.mmmm to degrees
+     */
+    double raw = strtod( value, NULL );
+    double degrees = (int)( raw / 100 );
+    double coord = degrees + ( raw - degrees * 100 ) / 60.0;
+
+    if ( *hemisphere == 'S' || *hemisphere == 'W' ) {
+        coord = -coord;
+    }
+    return( coord );
+}
+
+static void nmea_set_fix( nmea_data_t *data, bool fix ) {
+    if ( data->fix != fix ) {
+        data->fix = fix;
+        data->changed |= NMEA_FIX;
+    }
+    if ( !fix ) {
+        data->valid_location = false;
+    }
+}
+
+static void nmea_set_satellites( nmea_data_t *data, uint32_t *satellites, const char *value, uint32_t changed ) {
+    uint32_t count = strtoul( value, NULL, 10 );
+
+    if ( *satellites != count ) {
+        *satellites = count;
+        data->changed |= changed;
+    }
+}
+
+static void nmea_decode( nmea_parser_t *parser ) {
+    nmea_data_t *data = &parser->data;
+    char *field[ NMEA_MAX_FIELDS ];
+    size_t fields = nmea_split( parser->sentence, field, NMEA_MAX_FIELDS );
+    const char *talker = field[ 0 ];
+    const char *type;
+    /**
+     * skip the two char talker id, GP, GL, GN, BD, GB, ...
+     */
+    if ( strlen( talker ) != 5 ) {
+        return;
+    }
+    type = talker + 2;
+
+    if ( !strcmp( type, "RMC" ) && fields >= 10 ) {
+        /**
+         * time, status, lat, N/S, lon, E/W, speed, course, date
+         */
+        nmea_set_fix( data, *field[ 2 ] == 'A' );
+        if ( *field[ 1 ] && *field[ 9 ] ) {
+            data->time = strtoul( field[ 1 ], NULL, 10 );
+            data->date = strtoul( field[ 9 ], NULL, 10 );
+            data->changed |= NMEA_TIME;
+        }
+        if ( !data->fix ) {
+            return;
+        }
+        if ( *field[ 3 ] && *field[ 5 ] ) {
+            data->lat = nmea_coord( field[ 3 ], field[ 4 ] );
+            data->lon = nmea_coord( field[ 5 ], field[ 6 ] );
+            data->valid_location = true;
+            data->changed |= NMEA_LOCATION;
+        }
+        if ( *field[ 7 ] ) {
+            data->speed_knots = strtod( field[ 7 ], NULL );
+            data->valid_speed = true;
+            data->changed |= NMEA_SPEED;
+        }
+        if ( *field[ 8 ] ) {
+            data->course = strtod( field[ 8 ], NULL );
+            data->valid_course = true;
+            data->changed |= NMEA_COURSE;
+        }
+    }
+    else if ( !strcmp( type, "GGA" ) && fields >= 10 ) {
+        /**
+         * time, lat, N/S, lon, E/W, quality, satellites, hdop, altitude
+         */
+        if ( *field[ 7 ] ) {
+            data->valid_satellite = true;
+            nmea_set_satellites( data, &data->satellites, field[ 7 ], NMEA_SATELLITE );
+        }
+        nmea_set_fix( data, strtoul( field[ 6 ], NULL, 10 ) > 0 );
+        if ( !data->fix ) {
+            return;
+        }
+        if ( *field[ 2 ] && *field[ 4 ] ) {
+            data->lat = nmea_coord( field[ 2 ], field[ 3 ] );
+            data->lon = nmea_coord( field[ 4 ], field[ 5 ] );
+            data->valid_location = true;
+            data->changed |= NMEA_LOCATION;
+        }
+        if ( *field[ 9 ] ) {
+            data->altitude = strtod( field[ 9 ], NULL );
+            data->valid_altitude = true;
+            data->changed |= NMEA_ALTITUDE;
+        }
+    }
+    else if ( !strcmp( type, "GSV" ) && fields >= 4 ) {
+        /**
+         * field 3 is the number of satellites in view for this talker
+         */
+        if ( !strncmp( talker, "GP", 2 ) ) {
+            nmea_set_satellites( data, &data->gps_satellites, field[ 3 ], NMEA_SATELLITE_TYPE );
+        }
+        else if ( !strncmp( talker, "GL", 2 ) ) {
+            nmea_set_satellites( data, &data->glonass_satellites, field[ 3 ], NMEA_SATELLITE_TYPE );
+        }
+        else if ( !strncmp( talker, "BD", 2 ) || !strncmp( talker, "GB", 2 ) ) {
+            nmea_set_satellites( data, &data->baidou_satellites, field[ 3 ], NMEA_SATELLITE_TYPE );
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *   Oct 17 16:05:12 2026
+ *   Copyright  2026  Dirk Brosswick
+ *   Email: dirk.brosswick@googlemail.com
+ ****************************************************************************/
+ 
+/*
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _NMEA_H
+    #define _NMEA_H
+
+    #include <stdint.h>
+    #include <stddef.h>
+    #include "utils/io.h"
+
+    #define NMEA_SENTENCE_SIZE              96              /** @brief max sentence length, NMEA 0183 allows 82 chars */
+
+    #define NMEA_LOCATION                   _BV(0)          /** @brief lat/lon updated */
+    #define NMEA_SPEED                      _BV(1)          /** @brief speed updated */
+    #define NMEA_ALTITUDE                   _BV(2)          /** @brief altitude updated */
+    #define NMEA_COURSE                     _BV(3)          /** @brief course updated */
+    #define NMEA_SATELLITE                  _BV(4)          /** @brief number of used satellites changed */
+    #define NMEA_SATELLITE_TYPE             _BV(5)          /** @brief number of satellites in view per system changed */
+    #define NMEA_FIX                        _BV(6)          /** @brief fix state changed */
+    #define NMEA_TIME                       _BV(7)          /** @brief utc time and date updated */
+    /**
+     * @brief decoded nmea data
+     */
+    typedef struct {
+        uint32_t changed;                                   /** @brief NMEA_* mask of fields updated since the last nmea_clear_changed() */
+        bool fix;                                           /** @brief true if the last RMC/GGA sentence reported a fix */
+        bool valid_location;                                /** @brief true if lat/lon valid */
+        bool valid_speed;                                   /** @brief true if speed valid */
+        bool valid_altitude;                                /** @brief true if altitude valid */
+        bool valid_course;                                  /** @brief true if course valid */
+        bool valid_satellite;                               /** @brief true if satellites valid */
+        double lat;                                         /** @brief latitude in degrees */
+        double lon;                                         /** @brief longitude in degrees */
+        double speed_knots;                                 /** @brief speed over ground in knots */
+        double course;                                      /** @brief course over ground in degrees */
+        double altitude;                                    /** @brief altitude in meters */
+        uint32_t satellites;                                /** @brief number of satellites used for the fix */
+        uint32_t gps_satellites;                            /** @brief number of gps satellites in view */
+        uint32_t glonass_satellites;                        /** @brief number of glonass satellites in view */
+        uint32_t baidou_satellites;                         /** @brief number of baidou satellites in view */
+        uint32_t time;                                      /** @brief utc time as hhmmss */
+        uint32_t date;                                      /** @brief utc date as ddmmyy */
+    } nmea_data_t;
+    /**
+     * @brief nmea parser statistics
+     */
+    typedef struct {
+        uint32_t bytes;                                     /** @brief bytes fed into the parser */
+        uint32_t sentences;                                 /** @brief sentences with a valid checksum */
+        uint32_t checksum_errors;                           /** @brief sentences with a bad or missing checksum */
+        uint32_t overflows;                                 /** @brief sentences dropped because they exceed NMEA_SENTENCE_SIZE */
+    } nmea_stats_t;
+    /**
+     * @brief incremental nmea parser state, a sentence may be split over
+     * any number of nmea_parse() calls
+     */
+    typedef struct {
+        char sentence[ NMEA_SENTENCE_SIZE ];                /** @brief sentence collected so far, without '$' */
+        size_t len;                                         /** @brief chars in sentence */
+        bool in_sentence;                                   /** @brief true after a '$' until the line end */
+        nmea_data_t data;                                   /** @brief decoded data */
+        nmea_stats_t stats;                                 /** @brief parser statistics */
+    } nmea_parser_t;
+    /**
+     * @brief reset a parser and its decoded data
+     *
+     * @param   parser  pointer to the parser
+     */
+    void nmea_init( nmea_parser_t *parser );
+    /**
+     * @brief feed a block of raw receiver output into the parser
+     *
+     * @param   parser  pointer to the parser
+     * @param   buf     pointer to the received bytes
+     * @param   len     number of bytes
+     *
+     * @return  number of complete sentences decoded from this block
+     */
+    uint32_t nmea_parse( nmea_parser_t *parser, const char *buf, size_t len );
+    /**
+     * @brief get the NMEA_* mask of fields updated since the last call and clear it
+     *
+     * @param   parser  pointer to the parser
+     *
+     * @return  NMEA_* mask
+     */
+    uint32_t nmea_clear_changed( nmea_parser_t *parser );
+
+#endif // _NMEA_H
@@ -24,6 +24,7 @@
 #include "osm_map.h"
 #include "utils/alloc.h"
 #include "utils/uri_load/uri_load.h"
+#include "gui/png_decoder/lv_png.h"
 
 #ifdef NATIVE_64BIT
     #include "utils/logging.h"
@@ -40,10 +41,13 @@
     
     using namespace std;
     #define String string
+    #define osm_map_millis()            ( micros() / 1000 )
 #else
     #include <HTTPClient.h>
     #include <Update.h>
     #include <SPIFFS.h>
+
+    #define osm_map_millis()            millis()
 #endif
 
 /**
@@ -58,8 +62,10 @@ uint32_t osm_map_lat2tiley(double lat, uint32_t z);
 double osm_map_tilex2long(int x, uint32_t z);
 double osm_map_tiley2lat(int y, uint32_t z);
 osm_location_t *osm_map_update_tile_image( osm_location_t *osm_location );
-uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location );
+uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location, uint32_t zoom, uint32_t x, uint32_t y, bool show, bool prefetch );
 void osm_map_gen_url( osm_location_t *osm_location );
+static void osm_map_gen_tile_url( osm_location_t *osm_location, uint32_t zoom, uint32_t x, uint32_t y, char *url, size_t len );
+static void osm_map_cache_init( osm_location_t *osm_location );
 
 osm_location_t *osm_map_create_location_obj( void ) {
     /**
@@ -96,17 +102,18 @@ osm_location_t *osm_map_create_location_obj( void ) {
         osm_location->tile_server = NULL;
         osm_location->current_tile_url = NULL;
         osm_location->osm_map_data.header.always_zero = 0;
-        osm_location->osm_map_data.header.cf = LV_IMG_CF_RAW_ALPHA;
-        osm_location->osm_map_data.header.w = 256;
-        osm_location->osm_map_data.header.h = 256;
+        osm_location->osm_map_data.header.cf = LV_IMG_CF_TRUE_COLOR;
+        osm_location->osm_map_data.header.w = OSM_MAP_TILE_SIZE;
+        osm_location->osm_map_data.header.h = OSM_MAP_TILE_SIZE;
         osm_location->osm_map_data.data = NULL;
         osm_location->osm_map_data.data_size = 0;
+        osm_location->view_conn = NULL;
+        osm_location->prefetch_conn = NULL;
         osm_location->load_ahead = false;
         osm_location->cache_size = 0;
         osm_location->cached_fies = 0;
-        for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-            osm_location->uri_load_dsc[ i ] = NULL;
-        }
+        osm_location->cache_budget = DEFAULT_OSM_CACHE_BYTES;
+        osm_map_cache_init( osm_location );
 #ifndef NATIVE_64BIT
         osm_location->xSemaphoreMutex = xSemaphoreCreateMutex();;
 #endif
@@ -462,7 +469,7 @@ bool osm_map_update( osm_location_t *osm_location ) {
  * @return  updated lv_img_dsc structure
  */
 osm_location_t *osm_map_update_tile_image( osm_location_t *osm_location ) {
-    uri_load_dsc_t *uri_load_dsc = NULL;
+    uint32_t zoom, tilex, tiley;
     /**
      * check if osm_location set
      */
@@ -470,43 +477,120 @@ osm_location_t *osm_map_update_tile_image( osm_location_t *osm_location ) {
         return( NULL );
     }
     /**
-     * download file into RAM
+     * generate current tile url for display
      */
-    uri_load_dsc = osm_map_get_cache_tile_image( osm_location );
+    osm_map_gen_url( osm_location );
     /**
      * enter critical section
      */
     osm_map_take( osm_location );
+    zoom = osm_location->zoom;
+    tilex = osm_location->tilex;
+    tiley = osm_location->tiley;
     /**
-     * check if download was success
+     * leave critical section
      */
-    if ( uri_load_dsc ) {
-        /**
-         * set new image data
-         */
-        osm_location->osm_map_data.data = uri_load_dsc->data;
-        osm_location->osm_map_data.data_size = uri_load_dsc->size;
-        lv_img_cache_invalidate_src( &osm_location->osm_map_data );
+    osm_map_give( osm_location );
+    /**
+     * get the tile from cache or download it into RAM and show it
+     */
+    osm_map_get_cache_tile_image( osm_location, zoom, tilex, tiley, true, false );
+    return( osm_location );
+}
+
+/**
+ * @brief add a tile to the prefetch ring, tiles outside the map are skipped and tilex wraps around
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param zoom          osm zoom level
+ * @param x             osm tilex, may be out of range
+ * @param y             osm tiley, may be out of range
+ */
+static void osm_map_prefetch_add( osm_location_t *osm_location, uint32_t zoom, int32_t x, int32_t y ) {
+    if ( osm_location->prefetch_entrys >= OSM_MAP_PREFETCH_TILES )
+        return;
+    if ( y < 0 || y >= ( 1 << zoom ) )
+        return;
+
+    osm_map_tile_key_t *key = &osm_location->prefetch[ ( osm_location->prefetch_first + osm_location->prefetch_entrys ) % OSM_MAP_PREFETCH_TILES ];
+    key->server = 0;
+    key->zoom = zoom;
+    key->x = x & ( ( 1 << zoom ) - 1 );
+    key->y = y;
+    osm_location->prefetch_entrys++;
+}
+
+/**
+ * @brief plan the prefetch ring for the viewed tile
+ * 
+ * the neighbours are ordered by the direction of travel, or by the position in the
+ * tile if there is no travel yet. at high zoom levels, where one tile is passed
+ * quickly, the second tile ahead is loaded too and the parent tile is loaded last
+ * for a fast zoom out
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ */
+static void osm_map_prefetch_plan( osm_location_t *osm_location ) {
+    int32_t dx = 0, dy = 0;
+    int32_t offset[ 8 ][ 3 ];
+    int32_t offsets = 0;
+    /**
+     * direction of travel from the last viewed tile
+     */
+    if ( osm_location->prefetch_zoom == osm_location->zoom ) {
+        int32_t mx = (int32_t)osm_location->tilex - (int32_t)osm_location->prefetch_tilex;
+        int32_t my = (int32_t)osm_location->tiley - (int32_t)osm_location->prefetch_tiley;
+        if ( abs( mx ) <= 2 && abs( my ) <= 2 ) {
+            dx = ( mx > 0 ) - ( mx < 0 );
+            dy = ( my > 0 ) - ( my < 0 );
+        }
     }
-    else {
-        /**
-         * set default no data image
-         */
-        osm_location->osm_map_data.data = osm_no_data_256px.data;
-        osm_location->osm_map_data.data_size = osm_no_data_256px.data_size;
-        lv_img_cache_invalidate_src( &osm_location->osm_map_data );
+    /**
+     * no travel, use the nearest edge of the current position
+     */
+    if ( !dx && !dy && osm_location->tilexy_pos_valid ) {
+        double px = osm_location->tilex_pos / osm_location->tilex_dest_px_res;
+        double py = osm_location->tiley_pos / osm_location->tiley_dest_px_res;
+        dx = px < 0.25 ? -1 : px > 0.75 ? 1 : 0;
+        dy = py < 0.25 ? -1 : py > 0.75 ? 1 : 0;
     }
     /**
-     * leave critical section
+     * score all neighbours, ahead first and direct before diagonal neighbours
      */
-    osm_map_give( osm_location );
-    return( osm_location );
+    for( int32_t oy = -1 ; oy <= 1 ; oy++ ) {
+        for( int32_t ox = -1 ; ox <= 1 ; ox++ ) {
+            if ( !ox && !oy )
+                continue;
+            int32_t score = 4 * ( ox * dx + oy * dy ) - abs( ox ) - abs( oy );
+            int32_t i = offsets++;
+            while( i > 0 && offset[ i - 1 ][ 2 ] < score ) {
+                memcpy( offset[ i ], offset[ i - 1 ], sizeof( offset[ i ] ) );
+                i--;
+            }
+            offset[ i ][ 0 ] = ox;
+            offset[ i ][ 1 ] = oy;
+            offset[ i ][ 2 ] = score;
+        }
+    }
+
+    osm_location->prefetch_first = 0;
+    osm_location->prefetch_entrys = 0;
+    for( int32_t i = 0 ; i < offsets ; i++ ) {
+        osm_map_prefetch_add( osm_location, osm_location->zoom, osm_location->tilex + offset[ i ][ 0 ], osm_location->tiley + offset[ i ][ 1 ] );
+        if ( i == 0 && ( dx || dy ) && osm_location->zoom >= OSM_MAP_PREFETCH_FAR_ZOOM )
+            osm_map_prefetch_add( osm_location, osm_location->zoom, osm_location->tilex + 2 * dx, osm_location->tiley + 2 * dy );
+    }
+    if ( osm_location->zoom > 2 )
+        osm_map_prefetch_add( osm_location, osm_location->zoom - 1, osm_location->tilex / 2, osm_location->tiley / 2 );
+
+    osm_location->prefetch_zoom = osm_location->zoom;
+    osm_location->prefetch_tilex = osm_location->tilex;
+    osm_location->prefetch_tiley = osm_location->tiley;
+    OSM_MAP_LOG("planned %d tiles ahead, direction %d/%d", osm_location->prefetch_entrys, dx, dy );
 }
 
 bool osm_map_load_tiles_ahead( osm_location_t *osm_location ) {
-    static uint32_t tilex = 0, tiley = 0;
-    static uint32_t load_ahead_progress = 0;
-    static bool load_ahead_in_progress = false;
+    osm_map_tile_key_t key;
     /**
      * check if osm_location set
      */
@@ -517,62 +601,33 @@ bool osm_map_load_tiles_ahead( osm_location_t *osm_location ) {
      * enter critical section
      */
     osm_map_take( osm_location );
-    if ( osm_location->load_ahead ) {
-        /**
-         * check if viewed tile has change
-         */
-        if ( tilex != osm_location->tilex || tiley != osm_location->tiley ) {
-            tilex = osm_location->tilex;
-            tiley = osm_location->tiley;
-            load_ahead_in_progress = true;
-            load_ahead_progress = 0;
-            OSM_MAP_LOG("start load 4 tiles ahead");
-        }
-        /**
-         * if a load ahead need?
-         */
-        if ( load_ahead_in_progress ) {
-            switch( load_ahead_progress ) {
-                case 0:
-                    osm_location->tiley = tiley;
-                    osm_location->tilex = tilex - 1;
-                    break;
-                case 1:
-                    osm_location->tiley = tiley;
-                    osm_location->tilex = tilex + 1;
-                    break;
-                case 2:
-                    osm_location->tilex = tilex;
-                    osm_location->tiley = tiley - 1;
-                    break;
-                case 3:
-                    osm_location->tilex = tilex;
-                    osm_location->tiley = tiley + 1;
-                    break;
-                default:
-                    load_ahead_in_progress = false;
-            }
-            if ( load_ahead_in_progress ) {
-                load_ahead_progress++;
-                    /**
-                     * leave critical section
-                     */
-                    osm_map_give( osm_location );
-                    osm_map_get_cache_tile_image( osm_location );
-                    /**
-                     * enter critical section
-                     */
-                    osm_map_take( osm_location );
-            }
-            osm_location->tilex = tilex;
-            osm_location->tiley = tiley;
-        }
+    if ( !osm_location->load_ahead ) {
+        osm_location->prefetch_entrys = 0;
+        osm_map_give( osm_location );
+        return( false );
     }
+    /**
+     * check if viewed tile has change
+     */
+    if ( osm_location->prefetch_zoom != osm_location->zoom || osm_location->prefetch_tilex != osm_location->tilex || osm_location->prefetch_tiley != osm_location->tiley )
+        osm_map_prefetch_plan( osm_location );
+    /**
+     * take the next tile from the prefetch ring
+     */
+    if ( !osm_location->prefetch_entrys ) {
+        osm_map_give( osm_location );
+        return( false );
+    }
+    key = osm_location->prefetch[ osm_location->prefetch_first ];
+    osm_location->prefetch_first = ( osm_location->prefetch_first + 1 ) % OSM_MAP_PREFETCH_TILES;
+    osm_location->prefetch_entrys--;
     /**
      * leave critical section
      */
     osm_map_give( osm_location );
-    return( load_ahead_in_progress );
+    osm_map_get_cache_tile_image( osm_location, key.zoom, key.x, key.y, false, true );
+
+    return( true );
 }
 
 uint32_t osm_map_get_used_cache_size( osm_location_t *osm_location ) {
@@ -591,6 +646,18 @@ uint32_t osm_map_get_cache_files( osm_location_t *osm_location ) {
     return( cached_file );
 }
 
+void osm_map_get_cache_stats( osm_location_t *osm_location, osm_map_cache_stats_t *stats ) {
+    if ( osm_location )
+        *stats = osm_location->cache_stats;
+    else
+        memset( stats, 0, sizeof( osm_map_cache_stats_t ) );
+}
+
+void osm_map_set_cache_budget( osm_location_t *osm_location, uint32_t budget ) {
+    if ( osm_location )
+        osm_location->cache_budget = budget;
+}
+
 bool osm_map_get_load_ahead( osm_location_t *osm_location ) {
     bool load_ahead = false;
     
@@ -623,9 +690,254 @@ char *osm_map_get_current_tile_uri( osm_location_t *osm_location ) {
     return( uri );
 }
 
+/**
+ * @brief hash a tile server uri, FNV-1a
+ * 
+ * @param tile_server   pointer to the tile server uri
+ * 
+ * @return  hash
+ */
+static uint32_t osm_map_server_hash( const char *tile_server ) {
+    uint32_t hash = 2166136261u;
+
+    while( tile_server && *tile_server ) {
+        hash ^= (uint8_t)*tile_server++;
+        hash *= 16777619u;
+    }
+    return( hash );
+}
+
+/**
+ * @brief get the hash bucket of a tile key
+ * 
+ * @param key   pointer to the tile key
+ * 
+ * @return  hash bucket
+ */
+static uint32_t osm_map_cache_bucket( const osm_map_tile_key_t *key ) {
+    uint32_t hash = key->server;
+
+    hash = ( hash ^ key->zoom ) * 16777619u;
+    hash = ( hash ^ key->x ) * 16777619u;
+    hash = ( hash ^ key->y ) * 16777619u;
+    return( ( hash ^ ( hash >> 16 ) ) & ( OSM_MAP_CACHE_HASH_SIZE - 1 ) );
+}
+
+/**
+ * @brief set all cache entrys free, the cache must be empty
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ */
+static void osm_map_cache_init( osm_location_t *osm_location ) {
+    for( int i = 0 ; i < OSM_MAP_CACHE_HASH_SIZE ; i++ )
+        osm_location->cache_hash[ i ] = OSM_MAP_CACHE_NONE;
+
+    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
+        osm_location->cache_entry[ i ].uri_load_dsc = NULL;
+        osm_location->cache_entry[ i ].prefetched = false;
+        osm_location->cache_entry[ i ].hash_next = i + 1 < DEFAULT_OSM_CACHE_SIZE ? i + 1 : OSM_MAP_CACHE_NONE;
+        osm_location->cache_entry[ i ].lru_prev = OSM_MAP_CACHE_NONE;
+        osm_location->cache_entry[ i ].lru_next = OSM_MAP_CACHE_NONE;
+    }
+    osm_location->cache_free = 0;
+    osm_location->cache_lru_head = OSM_MAP_CACHE_NONE;
+    osm_location->cache_lru_tail = OSM_MAP_CACHE_NONE;
+    memset( &osm_location->cache_stats, 0, sizeof( osm_map_cache_stats_t ) );
+    osm_location->prefetch_first = 0;
+    osm_location->prefetch_entrys = 0;
+    osm_location->prefetch_zoom = 0;
+    osm_location->prefetch_tilex = 0;
+    osm_location->prefetch_tiley = 0;
+}
+
+/**
+ * @brief find a tile in the cache
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param key           pointer to the tile key
+ * 
+ * @return  cache entry or OSM_MAP_CACHE_NONE
+ */
+static int16_t osm_map_cache_find( osm_location_t *osm_location, const osm_map_tile_key_t *key ) {
+    int16_t entry = osm_location->cache_hash[ osm_map_cache_bucket( key ) ];
+
+    while( entry != OSM_MAP_CACHE_NONE ) {
+        if ( !memcmp( &osm_location->cache_entry[ entry ].key, key, sizeof( osm_map_tile_key_t ) ) )
+            break;
+        entry = osm_location->cache_entry[ entry ].hash_next;
+    }
+    return( entry );
+}
+
+/**
+ * @brief remove a cache entry from the lru list
+ */
+static void osm_map_cache_lru_unlink( osm_location_t *osm_location, int16_t entry ) {
+    osm_map_cache_entry_t *cache_entry = &osm_location->cache_entry[ entry ];
+
+    if ( cache_entry->lru_prev != OSM_MAP_CACHE_NONE )
+        osm_location->cache_entry[ cache_entry->lru_prev ].lru_next = cache_entry->lru_next;
+    else
+        osm_location->cache_lru_head = cache_entry->lru_next;
+
+    if ( cache_entry->lru_next != OSM_MAP_CACHE_NONE )
+        osm_location->cache_entry[ cache_entry->lru_next ].lru_prev = cache_entry->lru_prev;
+    else
+        osm_location->cache_lru_tail = cache_entry->lru_prev;
+
+    cache_entry->lru_prev = OSM_MAP_CACHE_NONE;
+    cache_entry->lru_next = OSM_MAP_CACHE_NONE;
+}
+
+/**
+ * @brief put a cache entry at the head of the lru list
+ */
+static void osm_map_cache_lru_push( osm_location_t *osm_location, int16_t entry ) {
+    osm_map_cache_entry_t *cache_entry = &osm_location->cache_entry[ entry ];
+
+    cache_entry->lru_prev = OSM_MAP_CACHE_NONE;
+    cache_entry->lru_next = osm_location->cache_lru_head;
+    if ( osm_location->cache_lru_head != OSM_MAP_CACHE_NONE )
+        osm_location->cache_entry[ osm_location->cache_lru_head ].lru_prev = entry;
+    else
+        osm_location->cache_lru_tail = entry;
+    osm_location->cache_lru_head = entry;
+}
+
+/**
+ * @brief remove a cache entry, free the tile image and put the entry into the free list
+ */
+static void osm_map_cache_remove( osm_location_t *osm_location, int16_t entry ) {
+    osm_map_cache_entry_t *cache_entry = &osm_location->cache_entry[ entry ];
+    int16_t *link = &osm_location->cache_hash[ osm_map_cache_bucket( &cache_entry->key ) ];
+    /**
+     * unlink from hash bucket
+     */
+    while( *link != entry )
+        link = &osm_location->cache_entry[ *link ].hash_next;
+    *link = cache_entry->hash_next;
+    osm_map_cache_lru_unlink( osm_location, entry );
+
+    osm_location->cache_size -= cache_entry->uri_load_dsc->size;
+    osm_location->cached_fies--;
+    uri_load_free_all( cache_entry->uri_load_dsc );
+    cache_entry->uri_load_dsc = NULL;
+    cache_entry->hash_next = osm_location->cache_free;
+    osm_location->cache_free = entry;
+}
+
+/**
+ * @brief insert a tile image, the least recently used tiles are dropped until
+ * it fits into the byte budget. the viewed tile image is never dropped
+ * 
+ * @return  cache entry or OSM_MAP_CACHE_NONE if no entry is free
+ */
+static int16_t osm_map_cache_insert( osm_location_t *osm_location, const osm_map_tile_key_t *key, uri_load_dsc_t *uri_load_dsc, bool prefetch ) {
+    int16_t entry = osm_location->cache_lru_tail;
+
+    while( entry != OSM_MAP_CACHE_NONE && ( osm_location->cache_free == OSM_MAP_CACHE_NONE || osm_location->cache_size + uri_load_dsc->size > osm_location->cache_budget ) ) {
+        int16_t prev = osm_location->cache_entry[ entry ].lru_prev;
+        if ( osm_location->cache_entry[ entry ].uri_load_dsc->data != osm_location->osm_map_data.data ) {
+            OSM_MAP_LOG("cache full, delete the oldest: %s", osm_location->cache_entry[ entry ].uri_load_dsc->uri );
+            osm_map_cache_remove( osm_location, entry );
+            osm_location->cache_stats.evictions++;
+        }
+        entry = prev;
+    }
+
+    entry = osm_location->cache_free;
+    if ( entry == OSM_MAP_CACHE_NONE )
+        return( entry );
+
+    osm_map_cache_entry_t *cache_entry = &osm_location->cache_entry[ entry ];
+    uint32_t bucket = osm_map_cache_bucket( key );
+    osm_location->cache_free = cache_entry->hash_next;
+    cache_entry->key = *key;
+    cache_entry->uri_load_dsc = uri_load_dsc;
+    cache_entry->prefetched = prefetch;
+    cache_entry->hash_next = osm_location->cache_hash[ bucket ];
+    osm_location->cache_hash[ bucket ] = entry;
+    osm_map_cache_lru_push( osm_location, entry );
+
+    osm_location->cache_size += uri_load_dsc->size;
+    osm_location->cached_fies++;
+    return( entry );
+}
+
+/**
+ * @brief set a tile image as the viewed one, must be called in the critical section
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param uri_load_dsc  pointer to the tile image or NULL for the no data image
+ */
+static void osm_map_show_tile_image( osm_location_t *osm_location, uri_load_dsc_t *uri_load_dsc ) {
+    if ( uri_load_dsc ) {
+        osm_location->osm_map_data.header.cf = LV_IMG_CF_TRUE_COLOR;
+        osm_location->osm_map_data.data = uri_load_dsc->data;
+        osm_location->osm_map_data.data_size = uri_load_dsc->size;
+    }
+    else {
+        osm_location->osm_map_data.header.cf = osm_no_data_256px.header.cf;
+        osm_location->osm_map_data.data = osm_no_data_256px.data;
+        osm_location->osm_map_data.data_size = osm_no_data_256px.data_size;
+    }
+    lv_img_cache_invalidate_src( &osm_location->osm_map_data );
+}
+
+/**
+ * @brief replace the png data of a downloaded tile with the decoded pixels in display color format,
+ * so lvgl can draw the cached tile without decoding it again on every refresh
+ * 
+ * @param uri_load_dsc  pointer to the downloaded tile image
+ * 
+ * @return  true if success
+ */
+static bool osm_map_decode_tile_image( uri_load_dsc_t *uri_load_dsc ) {
+    uint32_t w = 0, h = 0;
+    uint8_t *img = lv_png_decode_true_color( uri_load_dsc->data, uri_load_dsc->size, &w, &h );
+    /**
+     * check if decode was success
+     */
+    if ( !img ) {
+        OSM_MAP_ERROR_LOG("tile image decode failed: %s", uri_load_dsc->uri );
+        return( false );
+    }
+    if ( w != OSM_MAP_TILE_SIZE || h != OSM_MAP_TILE_SIZE ) {
+        OSM_MAP_ERROR_LOG("tile image size %dx%d not supported: %s", w, h, uri_load_dsc->uri );
+        free( img );
+        return( false );
+    }
+    uri_load_free_data( uri_load_dsc );
+    uri_load_dsc->data = img;
+    uri_load_dsc->size = OSM_MAP_TILE_BYTES;
+    return( true );
+}
+
+void osm_map_close_connection( osm_location_t *osm_location, bool prefetch ) {
+    uri_load_conn_t *uri_load_conn = NULL;
+    /**
+     * check if osm_location set
+     */
+    if ( !osm_location ) {
+        return;
+    }
+    /**
+     * detach the connection under the lock and close it outside
+     */
+    osm_map_take( osm_location );
+    if ( prefetch ) {
+        uri_load_conn = osm_location->prefetch_conn;
+        osm_location->prefetch_conn = NULL;
+    }
+    else {
+        uri_load_conn = osm_location->view_conn;
+        osm_location->view_conn = NULL;
+    }
+    osm_map_give( osm_location );
+    uri_load_conn_free( uri_load_conn );
+}
+
 void osm_map_clear_cache( osm_location_t *osm_location ) {
-    uint32_t cache_size = 0;
-    uint32_t cache_files = 0;
     /**
      * check if osm_location set
      */
@@ -640,37 +952,35 @@ void osm_map_clear_cache( osm_location_t *osm_location ) {
      * clear cache
      * leave the current used tile image in memory
      */
-    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-        if ( osm_location->uri_load_dsc[ i ] ) {
-            if ( osm_location->uri_load_dsc[ i ]->data != osm_location->osm_map_data.data ) {
-                uri_load_free_all( osm_location->uri_load_dsc[ i ] );
-                osm_location->uri_load_dsc[ i ] = NULL;
-            }
-        }
+    int16_t entry = osm_location->cache_lru_head;
+    while( entry != OSM_MAP_CACHE_NONE ) {
+        int16_t next = osm_location->cache_entry[ entry ].lru_next;
+        if ( osm_location->cache_entry[ entry ].uri_load_dsc->data != osm_location->osm_map_data.data )
+            osm_map_cache_remove( osm_location, entry );
+        entry = next;
     }
-    /**
-     * get cache size
-     */
-    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-        if ( osm_location->uri_load_dsc[ i ] ) {
-            cache_size += osm_location->uri_load_dsc[ i ]->size;
-            cache_files++;
-        }
-    }
-    osm_location->cache_size = cache_size;
-    osm_location->cached_fies = cache_files;
     /**
      * leave critical section
      */
     osm_map_give( osm_location );
 }
 
-uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location ) {
-    size_t tile = -1;
-    size_t cache_size = 0;
-    size_t cache_file = 0;
-    uint64_t timestamp = millis();
+/**
+ * @brief get a tile image from the cache or download it into the cache
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param zoom          osm zoom level
+ * @param x             osm tilex
+ * @param y             osm tiley
+ * @param show          true to set the tile image as the viewed one
+ * @param prefetch      true if the tile is loaded ahead, it does not count as hit or miss
+ * 
+ * @return  pointer to the tile image or NULL if download failed
+ */
+uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location, uint32_t zoom, uint32_t x, uint32_t y, bool show, bool prefetch ) {
     uri_load_dsc_t *uri_load_dsc = NULL;
+    osm_map_tile_key_t key;
+    int16_t entry;
     /**
      * check if osm_location set
      */
@@ -678,102 +988,92 @@ uri_load_dsc_t *osm_map_get_cache_tile_image( osm_location_t *osm_location ) {
         return( NULL );
     }
     /**
-     * generate tile image utl/uri
+     * make sure a tile server is set
      */
-    osm_map_gen_url( osm_location );
+    if ( !osm_location->tile_server )
+        osm_map_gen_url( osm_location );
     /**
      * enter critical section
      */
     osm_map_take( osm_location );
+    key.server = osm_map_server_hash( osm_location->tile_server );
+    key.zoom = zoom;
+    key.x = x;
+    key.y = y;
     /**
-     * check if tile image exist
+     * check for a cache hit
      */
-    for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-        if ( osm_location->uri_load_dsc[ i ] ) {
-            if ( !strcmp( osm_location->current_tile_url, osm_location->uri_load_dsc[ i ]->uri ) ) {
-                tile = i;
-                break;
-            }
+    entry = osm_map_cache_find( osm_location, &key );
+    if ( entry != OSM_MAP_CACHE_NONE ) {
+        osm_map_cache_entry_t *cache_entry = &osm_location->cache_entry[ entry ];
+        uri_load_dsc = cache_entry->uri_load_dsc;
+        if ( !prefetch ) {
+            OSM_MAP_LOG("url cache hit: %s", uri_load_dsc->uri );
+            osm_location->cache_stats.hits++;
+            if ( cache_entry->prefetched )
+                osm_location->cache_stats.prefetch_hits++;
+            cache_entry->prefetched = false;
+            osm_map_cache_lru_unlink( osm_location, entry );
+            osm_map_cache_lru_push( osm_location, entry );
         }
+        if ( show )
+            osm_map_show_tile_image( osm_location, uri_load_dsc );
+        osm_map_give( osm_location );
+        return( uri_load_dsc );
     }
     /**
-     * check for a cache hit
+     * cache miss, download the tile image
+     * and give semaphore away in the time to download
+     * and take it back after that
+     */
+    if ( prefetch )
+        osm_location->cache_stats.prefetched++;
+    else
+        osm_location->cache_stats.misses++;
+
+    char *uri = (char*)MALLOC_ASSERT( MAX_CURRENT_TILE_URL_LEN, "error while uri alloc failed" );
+    osm_map_gen_tile_url( osm_location, zoom, x, y, uri, MAX_CURRENT_TILE_URL_LEN );
+    /**
+     * open the keep-alive connection on first use, it is closed
+     * again with osm_map_close_connection()
      */
-    if ( tile != -1 ) {
-        OSM_MAP_LOG("url cache hit: %s", osm_location->uri_load_dsc[ tile ]->uri );
-        uri_load_dsc = osm_location->uri_load_dsc[ tile ];
-        uri_load_dsc->timestamp = millis();
+    uri_load_conn_t **conn = prefetch ? &osm_location->prefetch_conn : &osm_location->view_conn;
+    if ( !*conn )
+        *conn = uri_load_conn_create();
+    uri_load_conn_t *uri_load_conn = *conn;
+    osm_map_give( osm_location );
+    uint64_t load_start = osm_map_millis();
+    uri_load_dsc = uri_load_conn_to_ram( uri_load_conn, (const char*)uri );
+    uint64_t decode_start = osm_map_millis();
+    if ( uri_load_dsc && !osm_map_decode_tile_image( uri_load_dsc ) ) {
+        uri_load_free_all( uri_load_dsc );
+        uri_load_dsc = NULL;
     }
-    else {
-        /**
-         * multi threading optimizing
-         * -
-         * 1st stage
-         * load file into ram ahead
-         * and give semaphore away in the time to download
-         * and take it back after that
-         */
-        char *uri = (char*)MALLOC_ASSERT( strlen( osm_location->current_tile_url ) + 1, "error while uri alloc failed" );
-        strncpy( uri, osm_location->current_tile_url, strlen( osm_location->current_tile_url ) + 1 );
-        osm_map_give( osm_location );
-        uri_load_dsc = uri_load_to_ram( (const char*)uri );
-        osm_map_take( osm_location );
-        free( uri );
+    uint64_t decode_end = osm_map_millis();
+    osm_map_take( osm_location );
+    free( uri );
+    osm_location->cache_stats.load_time += decode_start - load_start;
+    osm_location->cache_stats.decode_time += decode_end - decode_start;
+    OSM_MAP_LOG("tile %d/%d/%d: load %d ms, decode %d ms", zoom, x, y, (int)( decode_start - load_start ), (int)( decode_end - decode_start ) );
+
+    if ( uri_load_dsc ) {
         /**
-         * 2nd stage
-         * seek for a free tile cache
+         * the other task may have loaded the same tile meanwhile
          */
-        tile = -1;
-        for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-            if ( !osm_location->uri_load_dsc[ i ] ) {
-                tile = i;
-                break;
-            }
+        entry = osm_map_cache_find( osm_location, &key );
+        if ( entry != OSM_MAP_CACHE_NONE ) {
+            uri_load_free_all( uri_load_dsc );
+            uri_load_dsc = osm_location->cache_entry[ entry ].uri_load_dsc;
         }
-        /**
-         * 3rd stage
-         * if ne free tile, search for the oldest tile
-         */
-        if ( tile == -1 ) {
-            /**
-             * search the oldest one
-             */
-            for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-                if ( osm_location->uri_load_dsc[ i ]->timestamp <= timestamp && osm_location->uri_load_dsc[ i ] ) {
-                    timestamp = osm_location->uri_load_dsc[ i ]->timestamp;
-                    tile = i;
-                }
-            }
-            /**
-             * delete the oldest one
-             */
-            OSM_MAP_LOG("cache full, delete the oldest: %s", osm_location->uri_load_dsc[ tile ]->uri );
-            uri_load_free_all( osm_location->uri_load_dsc[ tile ] );
-            osm_location->uri_load_dsc[ tile ] = NULL;
+        else if ( osm_map_cache_insert( osm_location, &key, uri_load_dsc, prefetch ) == OSM_MAP_CACHE_NONE ) {
+            OSM_MAP_ERROR_LOG("no free tile cache entry");
+            uri_load_free_all( uri_load_dsc );
+            uri_load_dsc = NULL;
         }
-        osm_location->uri_load_dsc[ tile ] = uri_load_dsc;
-#ifdef NATIVE_64BIT
-        OSM_MAP_LOG("use tile cache %ld", tile );
-#else
-        OSM_MAP_LOG("use tile cache %d", tile );
-#endif
-        /**
-         * get cache size
-         */
-        for( int i = 0 ; i < DEFAULT_OSM_CACHE_SIZE ; i++ ) {
-            if ( osm_location->uri_load_dsc[ i ] ) {
-                cache_size += osm_location->uri_load_dsc[ i ]->size;
-                cache_file++;
-            }
-        }
-        osm_location->cache_size = cache_size;
-        osm_location->cached_fies = cache_file;
-#ifdef NATIVE_64BIT
-        OSM_MAP_LOG("cached files: %ld, cachesize = %ld bytes", cache_file, cache_size );
-#else
-        OSM_MAP_LOG("cached files: %d, cachesize = %d bytes", cache_file, cache_size );
-#endif
     }
+    OSM_MAP_LOG("cached files: %d, cachesize = %d bytes, hits/misses = %d/%d", osm_location->cached_fies, osm_location->cache_size, osm_location->cache_stats.hits, osm_location->cache_stats.misses );
+    if ( show )
+        osm_map_show_tile_image( osm_location, uri_load_dsc );
     /**
      * leave critical section
      */
@@ -813,10 +1113,6 @@ void osm_map_set_tile_server( osm_location_t *osm_location, const char* tile_ser
 }
 
 void osm_map_gen_url( osm_location_t *osm_location ) {
-    char *tile_server_p = NULL;
-    char *current_tile_url_p = NULL;
-    char temp_str[32] = "";
-    char *temp_str_p = NULL;
     /**
      * check if osm_location set
      */
@@ -851,49 +1147,69 @@ void osm_map_gen_url( osm_location_t *osm_location ) {
     /**
      * generate current tile url from tile server
      */
-    tile_server_p = osm_location->tile_server;
-    current_tile_url_p = osm_location->current_tile_url;
+    osm_map_gen_tile_url( osm_location, osm_location->zoom, osm_location->tilex, osm_location->tiley, osm_location->current_tile_url, MAX_CURRENT_TILE_URL_LEN );
+    OSM_MAP_LOG("tile server: %s -> %s", osm_location->tile_server, osm_location->current_tile_url );
+    /**
+     * leave critical section
+     */
+    osm_map_give( osm_location );
+}
 
+/**
+ * @brief generate the tile image url for a tile from the tile server uri, must be called in the critical section
+ * 
+ * @param osm_location  pointer to the osm_location structure
+ * @param zoom          osm zoom level
+ * @param x             osm tilex
+ * @param y             osm tiley
+ * @param url           pointer to the url buffer
+ * @param len           size of the url buffer
+ */
+static void osm_map_gen_tile_url( osm_location_t *osm_location, uint32_t zoom, uint32_t x, uint32_t y, char *url, size_t len ) {
+    const char *tile_server_p = osm_location->tile_server;
+    char *url_p = url;
+    char temp_str[32] = "";
+    char *temp_str_p = NULL;
+
+    *url_p = '\0';
     while( *tile_server_p ) {
         if ( *tile_server_p == '$' ) {
             tile_server_p++;
             switch ( *tile_server_p ) {
                 case 'z':
-                    snprintf( temp_str, sizeof( temp_str ), "%d", osm_location->zoom );
+                    snprintf( temp_str, sizeof( temp_str ), "%d", zoom );
                     break;
                 case 'x':
-                    snprintf( temp_str, sizeof( temp_str ), "%d", osm_location->tilex );
+                    snprintf( temp_str, sizeof( temp_str ), "%d", x );
                     break;
                 case 'y':
-                    snprintf( temp_str, sizeof( temp_str ), "%d", osm_location->tiley );
+                    snprintf( temp_str, sizeof( temp_str ), "%d", y );
                     break;
                 default:
                     snprintf( temp_str, sizeof( temp_str ), "$%c", *tile_server_p );
                     break;
             }
             temp_str_p = temp_str;
-            while( *temp_str_p ) {
-                *current_tile_url_p = *temp_str_p;
-                current_tile_url_p++;
+            while( *temp_str_p && url_p < url + len - 1 ) {
+                *url_p = *temp_str_p;
+                url_p++;
                 temp_str_p++;
             }
         }
-        else {
-            *current_tile_url_p = *tile_server_p;
-            current_tile_url_p++;
+        else if ( url_p < url + len - 1 ) {
+            *url_p = *tile_server_p;
+            url_p++;
         }
-        tile_server_p++;
-        *current_tile_url_p = '\0';
-        if ( strlen( osm_location->current_tile_url ) >= MAX_CURRENT_TILE_URL_LEN ) {
-            OSM_MAP_ERROR_LOG("osm_location->current_tile_url: MAX_CURRENT_TILE_URL_LEN reached");
-            *osm_location->current_tile_url = '\0';
+        /**
+         * a '$' at the end has nothing to replace
+         */
+        if ( *tile_server_p )
+            tile_server_p++;
+        *url_p = '\0';
+        if ( url_p >= url + len - 1 ) {
+            OSM_MAP_ERROR_LOG("tile url: MAX_CURRENT_TILE_URL_LEN reached");
+            *url = '\0';
             break;
         }
-        log_d("current url: %s", osm_location->current_tile_url );
     }
-    OSM_MAP_LOG("tile server: %s -> %s", osm_location->tile_server, osm_location->current_tile_url );
-    /**
-     * leave critical section
-     */
-    osm_map_give( osm_location );
-}
\ No newline at end of file
+}
@@ -12,9 +12,49 @@
     #define OSM_MAP_ERROR_LOG           log_e
 
     #define MAX_CURRENT_TILE_URL_LEN    256
-    #define DEFAULT_OSM_CACHE_SIZE      32
+    #define DEFAULT_OSM_CACHE_SIZE      64                  /** @brief max number of cached tile images */
+    #define OSM_MAP_TILE_SIZE           256                 /** @brief tile image width and height in px */
+    #define OSM_MAP_TILE_BYTES          ( OSM_MAP_TILE_SIZE * OSM_MAP_TILE_SIZE * sizeof( lv_color_t ) )   /** @brief size of a decoded tile image */
+    #define DEFAULT_OSM_CACHE_BYTES     ( 12 * OSM_MAP_TILE_BYTES ) /** @brief byte budget for cached tile images, viewed tile and a full prefetch ring */
+    #define OSM_MAP_CACHE_HASH_SIZE     64                  /** @brief number of hash buckets, must be a power of two */
+    #define OSM_MAP_CACHE_NONE          -1                  /** @brief no cache entry */
+    #define OSM_MAP_PREFETCH_TILES      10                  /** @brief size of the prefetch ring */
+    #define OSM_MAP_PREFETCH_FAR_ZOOM   15                  /** @brief from this zoom level on the second tile in direction of travel is prefetched */
     #define DEFAULT_OSM_TILE_SERVER     "http://a.tile.openstreetmap.org/$z/$x/$y.png"   /** @brief osm tile map server */
 
+    /**
+     * @brief tile cache key
+     */
+    typedef struct {
+        uint32_t server;                                /** @brief hash of the tile server uri */
+        uint32_t zoom;                                  /** @brief osm zoom level */
+        uint32_t x;                                     /** @brief osm tilex */
+        uint32_t y;                                     /** @brief osm tiley */
+    } osm_map_tile_key_t;
+    /**
+     * @brief tile cache entry
+     */
+    typedef struct {
+        osm_map_tile_key_t key;                         /** @brief tile key */
+        uri_load_dsc_t *uri_load_dsc;                   /** @brief cached tile image in display color format, NULL if the entry is free */
+        bool prefetched;                                /** @brief loaded ahead and not viewed yet */
+        int16_t hash_next;                              /** @brief next entry in the hash bucket or in the free list */
+        int16_t lru_prev;                               /** @brief more recently used entry */
+        int16_t lru_next;                               /** @brief less recently used entry */
+    } osm_map_cache_entry_t;
+    /**
+     * @brief tile cache statistics
+     */
+    typedef struct {
+        uint32_t hits;                                  /** @brief viewed tiles found in the cache */
+        uint32_t misses;                                /** @brief viewed tiles that had to be loaded */
+        uint32_t prefetched;                            /** @brief tiles loaded ahead */
+        uint32_t prefetch_hits;                         /** @brief viewed tiles that were loaded ahead */
+        uint32_t evictions;                             /** @brief tiles dropped to stay within the budget */
+        uint32_t load_time;                             /** @brief total download time of all loaded tiles in ms */
+        uint32_t decode_time;                           /** @brief total png decode time of all loaded tiles in ms */
+    } osm_map_cache_stats_t;
+
     /**
      * @brief osm tile calculation structure
      */
@@ -45,10 +85,24 @@
         char *tile_server = NULL;                       /** @brief the current tile server uri */
         char *current_tile_url = NULL;                  /** @brief the current tile image uri */
         bool load_ahead = false;                        /** @brief enable load ahead feature */
-        uint32_t cache_size = 0;
-        uint32_t cached_fies = 0;
+        uint32_t cache_size = 0;                        /** @brief bytes in the cache */
+        uint32_t cached_fies = 0;                       /** @brief tiles in the cache */
+        uint32_t cache_budget = DEFAULT_OSM_CACHE_BYTES;    /** @brief byte budget of the cache */
         lv_img_dsc_t osm_map_data;                      /** @brief pointer to an lv_img_dsc for lvgl use */
-        uri_load_dsc_t *uri_load_dsc[ DEFAULT_OSM_CACHE_SIZE ];
+        uri_load_conn_t *view_conn;                     /** @brief keep-alive connection to the tile server for viewed tiles */
+        uri_load_conn_t *prefetch_conn;                 /** @brief keep-alive connection to the tile server for tiles loaded ahead */
+        osm_map_cache_entry_t cache_entry[ DEFAULT_OSM_CACHE_SIZE ];  /** @brief tile cache entrys */
+        int16_t cache_hash[ OSM_MAP_CACHE_HASH_SIZE ];  /** @brief first entry of each hash bucket */
+        int16_t cache_free;                             /** @brief first free entry */
+        int16_t cache_lru_head;                         /** @brief most recently used entry */
+        int16_t cache_lru_tail;                         /** @brief least recently used entry */
+        osm_map_cache_stats_t cache_stats;              /** @brief tile cache statistics */
+        osm_map_tile_key_t prefetch[ OSM_MAP_PREFETCH_TILES ];  /** @brief prefetch ring */
+        uint32_t prefetch_first;                        /** @brief first pending tile in the prefetch ring */
+        uint32_t prefetch_entrys;                       /** @brief pending tiles in the prefetch ring */
+        uint32_t prefetch_zoom;                         /** @brief zoom level the prefetch ring was planned for */
+        uint32_t prefetch_tilex;                        /** @brief tilex the prefetch ring was planned for */
+        uint32_t prefetch_tiley;                        /** @brief tiley the prefetch ring was planned for */
 #ifndef NATIVE_64BIT
         SemaphoreHandle_t xSemaphoreMutex;
 #endif
@@ -150,6 +204,14 @@
      * @param osm_location  pointer to the osm_location structure
      */
     void osm_map_center_location( osm_location_t *osm_location );
+    /**
+     * @brief load the next tile from the prefetch ring, the ring is planned from the
+     * direction of travel and the zoom level each time the viewed tile changes
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * 
+     * @return true if more tiles are pending
+     */
     bool osm_map_load_tiles_ahead( osm_location_t *osm_location );
     /**
      * @brief get the numbers of bytes in the cache
@@ -167,6 +229,20 @@
      * @return number of cached tile images
      */
     uint32_t osm_map_get_cache_files( osm_location_t *osm_location );
+    /**
+     * @brief get the tile cache statistics
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param stats         pointer to a osm_map_cache_stats_t structure
+     */
+    void osm_map_get_cache_stats( osm_location_t *osm_location, osm_map_cache_stats_t *stats );
+    /**
+     * @brief set the byte budget of the tile cache
+     * 
+     * @param osm_location  pointer to the osm_location structure
+     * @param budget        budget in bytes
+     */
+    void osm_map_set_cache_budget( osm_location_t *osm_location, uint32_t budget );
     /**
      * @brief get the load ahead config flag
      * 
@@ -196,5 +272,14 @@
      */
     char *osm_map_get_current_tile_uri( osm_location_t *osm_location );
     void osm_map_clear_cache( osm_location_t *osm_location );
+    /**
+     * @brief close the keep-alive connection for viewed or loaded ahead tiles and free it,
+     * it is opened again on the next download, only call it from the task that loads
+     * over this connection
+     * 
+     * @param osm_location  pointer to the osm_location_t structure
+     * @param prefetch      true for the load ahead connection, false for the view connection
+     */
+    void osm_map_close_connection( osm_location_t *osm_location, bool prefetch );
 
 #endif // _OSM_HELPER_H
\ No newline at end of file
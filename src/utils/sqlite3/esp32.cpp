@@ -22,9 +22,10 @@
 #include <errno.h>
 #include <fcntl.h>
 #include "shox96_0_2.h"
+#include "esp32.h"
 
 #ifdef NATIVE_64BIT
-
+    #include "utils/millis.h"
 #else
     #include <Arduino.h>
     #include <esp_spi_flash.h>
@@ -74,6 +75,35 @@ uint64_t decode_unsigned_varint(const uint8_t *data, int &decoded_bytes) {
 # define SQLITE_ESP32VFS_BUFFERSZ 8192
 #endif
 
+/*
+** Size of a cache sector in bytes. Reads and writes of the main database
+** file go through a small cache of sector aligned blocks, flushed in file
+** order on sync. 4096 matches the flash erase sector and the default page
+** size from config_ext.h.
+*/
+#ifndef SQLITE_ESP32VFS_SECTORSZ
+# define SQLITE_ESP32VFS_SECTORSZ 4096
+#endif
+
+/*
+** Number of cached sectors per main database file, 0 disables the cache.
+** On the ESP32 the cache is only allocated in PSRAM.
+*/
+#ifndef SQLITE_ESP32VFS_CACHESZ
+# define SQLITE_ESP32VFS_CACHESZ 16
+#endif
+
+/*
+** Device characteristics reported to SQLite. Files only grow after their
+** data is written, so SQLite can skip the sync between journal records
+** and the journal header. Write order is not claimed, the sector cache
+** and the filesystem may reorder writes, and neither are atomic sector
+** writes, SPIFFS nor FAT guarantee that on power loss.
+*/
+#ifndef SQLITE_ESP32VFS_IOCAP
+# define SQLITE_ESP32VFS_IOCAP SQLITE_IOCAP_SAFE_APPEND
+#endif
+
 /*
 ** The maximum pathname length supported by this VFS.
 */
@@ -83,6 +113,13 @@ uint64_t decode_unsigned_varint(const uint8_t *data, int &decoded_bytes) {
 ** When using this VFS, the sqlite3_file* handles that SQLite uses are
 ** actually pointers to instances of type ESP32File.
 */
+typedef struct ESP32Sector ESP32Sector;
+struct ESP32Sector {
+  sqlite3_int64 iOfst;            /* Sector aligned file offset, -1 if unused */
+  uint32_t iUsed;                 /* LRU stamp of the last access */
+  int bDirty;                     /* True if not yet written to the file */
+};
+
 typedef struct ESP32File ESP32File;
 struct ESP32File {
   sqlite3_file base;              /* Base class. Must be first. */
@@ -91,8 +128,19 @@ struct ESP32File {
   char *aBuffer;                  /* Pointer to malloc'd buffer */
   int nBuffer;                    /* Valid bytes of data in zBuffer */
   sqlite3_int64 iBufferOfst;      /* Offset in file of zBuffer[0] */
+
+  ESP32Sector *aSector;           /* Sector cache slots, NULL if not cached */
+  char *aCache;                   /* Sector cache data, nSector * SECTORSZ bytes */
+  int nSector;                    /* Number of cache slots */
+  uint32_t iClock;                /* LRU clock */
+  sqlite3_int64 iSize;            /* File size including dirty sectors */
 };
 
+/*
+** Global cache counters, see sqlite3_ESP32vfs_stats().
+*/
+static esp32vfs_stats_t ESP32Stats;
+
 /*
 ** Write directly to the file passed as the first argument. Even if the
 ** file has a write-buffer (ESP32File.aBuffer), ignore it.
@@ -141,6 +189,188 @@ static int ESP32FlushBuffer(ESP32File *p){
   return rc;
 }
 
+/*
+** Allocate and free sector cache memory, from PSRAM on the ESP32.
+*/
+static void *ESP32CacheAlloc(size_t n){
+#ifdef NATIVE_64BIT
+  return malloc(n);
+#else
+  if( !psramFound() ){
+    return 0;
+  }
+  return ps_malloc(n);
+#endif
+}
+
+/*
+** Write cache slot i to the file. Only the part below the logical file
+** size is written so the file never grows by a padded sector.
+*/
+static int ESP32CacheWriteSector(ESP32File *p, int i){
+  ESP32Sector *pSector = &p->aSector[i];
+  sqlite3_int64 nWrite = p->iSize - pSector->iOfst;
+
+  if( nWrite>SQLITE_ESP32VFS_SECTORSZ ){
+    nWrite = SQLITE_ESP32VFS_SECTORSZ;
+  }
+  if( nWrite>0 ){
+    int rc = ESP32DirectWrite(p, &p->aCache[i*SQLITE_ESP32VFS_SECTORSZ], (int)nWrite, pSector->iOfst);
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+    ESP32Stats.nWrite++;
+  }
+  pSector->bDirty = 0;
+  return SQLITE_OK;
+}
+
+/*
+** Write all dirty sectors in file order. Adjacent sectors end up as one
+** sequential run in the stdio buffer instead of seeking back and forth.
+*/
+static int ESP32CacheFlush(ESP32File *p){
+  sqlite3_int64 iLast = -1;
+
+  for(;;){
+    int iNext = -1;
+    /* Find the dirty sector with the lowest offset above the last one. */
+    for(int i=0; i<p->nSector; i++){
+      ESP32Sector *pSector = &p->aSector[i];
+      if( pSector->bDirty && pSector->iOfst>iLast
+       && (iNext<0 || pSector->iOfst<p->aSector[iNext].iOfst) ){
+        iNext = i;
+      }
+    }
+    if( iNext<0 ){
+      break;
+    }
+    int rc = ESP32CacheWriteSector(p, iNext);
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+    iLast = p->aSector[iNext].iOfst;
+  }
+  return SQLITE_OK;
+}
+
+/*
+** Return the cache slot holding the sector at iOfst. On a miss the least
+** recently used slot is written back if dirty and reused. If bLoad is
+** false the caller overwrites the whole sector and the read is skipped.
+*/
+static int ESP32CacheGet(ESP32File *p, sqlite3_int64 iOfst, int bLoad, int *piSlot){
+  int iSlot = 0;
+
+  for(int i=0; i<p->nSector; i++){
+    if( p->aSector[i].iOfst==iOfst ){
+      p->aSector[i].iUsed = ++p->iClock;
+      ESP32Stats.nHit++;
+      *piSlot = i;
+      return SQLITE_OK;
+    }
+    if( p->aSector[i].iUsed<p->aSector[iSlot].iUsed ){
+      iSlot = i;
+    }
+  }
+  ESP32Stats.nMiss++;
+
+  ESP32Sector *pSector = &p->aSector[iSlot];
+  char *aData = &p->aCache[iSlot*SQLITE_ESP32VFS_SECTORSZ];
+  if( pSector->bDirty ){
+    int rc = ESP32CacheWriteSector(p, iSlot);
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+  }
+  pSector->iOfst = -1;
+
+  size_t nRead = 0;
+  if( bLoad && iOfst<p->iSize ){
+    if( fseek(p->fp, iOfst, SEEK_SET)!=0 ){
+      return SQLITE_IOERR_READ;
+    }
+    nRead = fread(aData, 1, SQLITE_ESP32VFS_SECTORSZ, p->fp);
+    ESP32Stats.nRead++;
+  }
+  memset(&aData[nRead], 0, SQLITE_ESP32VFS_SECTORSZ - nRead);
+
+  pSector->iOfst = iOfst;
+  pSector->iUsed = ++p->iClock;
+  pSector->bDirty = 0;
+  *piSlot = iSlot;
+  return SQLITE_OK;
+}
+
+/*
+** Read from the sector cache. Bytes beyond the end of the file are
+** zero-filled and reported as a short read, as SQLite expects.
+*/
+static int ESP32CacheRead(ESP32File *p, void *zBuf, int iAmt, sqlite3_int64 iOfst){
+  char *z = (char *)zBuf;
+  int n = iAmt;
+  sqlite3_int64 i = iOfst;
+
+  if( iOfst+iAmt>p->iSize ){
+    n = iOfst<p->iSize ? (int)(p->iSize - iOfst) : 0;
+    memset(&z[n], 0, iAmt - n);
+  }
+  while( n>0 ){
+    sqlite3_int64 iSector = i - (i % SQLITE_ESP32VFS_SECTORSZ);
+    int iSkip = (int)(i - iSector);
+    int nCopy = SQLITE_ESP32VFS_SECTORSZ - iSkip;
+    int iSlot;
+
+    if( nCopy>n ){
+      nCopy = n;
+    }
+    int rc = ESP32CacheGet(p, iSector, 1, &iSlot);
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+    memcpy(z, &p->aCache[iSlot*SQLITE_ESP32VFS_SECTORSZ + iSkip], nCopy);
+    n -= nCopy;
+    i += nCopy;
+    z += nCopy;
+  }
+  return iOfst+iAmt>p->iSize ? SQLITE_IOERR_SHORT_READ : SQLITE_OK;
+}
+
+/*
+** Write into the sector cache, the file is written on sync, close or
+** when a dirty sector is evicted.
+*/
+static int ESP32CacheWrite(ESP32File *p, const void *zBuf, int iAmt, sqlite3_int64 iOfst){
+  const char *z = (const char *)zBuf;
+  int n = iAmt;
+  sqlite3_int64 i = iOfst;
+
+  /* Grow first, a dirty sector evicted during this write is written in full. */
+  if( iOfst+iAmt>p->iSize ){
+    p->iSize = iOfst+iAmt;
+  }
+  while( n>0 ){
+    sqlite3_int64 iSector = i - (i % SQLITE_ESP32VFS_SECTORSZ);
+    int iSkip = (int)(i - iSector);
+    int nCopy = SQLITE_ESP32VFS_SECTORSZ - iSkip;
+    int iSlot;
+
+    if( nCopy>n ){
+      nCopy = n;
+    }
+    int rc = ESP32CacheGet(p, iSector, nCopy!=SQLITE_ESP32VFS_SECTORSZ, &iSlot);
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+    memcpy(&p->aCache[iSlot*SQLITE_ESP32VFS_SECTORSZ + iSkip], z, nCopy);
+    p->aSector[iSlot].bDirty = 1;
+    n -= nCopy;
+    i += nCopy;
+    z += nCopy;
+  }
+  return SQLITE_OK;
+}
+
 /*
 ** Close a file.
 */
@@ -149,6 +379,12 @@ static int ESP32Close(sqlite3_file *pFile){
   //Serial.println("fn: Close");
   ESP32File *p = (ESP32File*)pFile;
   rc = ESP32FlushBuffer(p);
+  if( p->aSector ){
+    int rc2 = ESP32CacheFlush(p);
+    if( rc==SQLITE_OK ) rc = rc2;
+    sqlite3_free(p->aSector);
+    free(p->aCache);
+  }
   sqlite3_free(p->aBuffer);
   fclose(p->fp);
   //Serial.println("fn:Close:Success");
@@ -170,6 +406,10 @@ static int ESP32Read(
   int nRead;                      /* Return value from read() */
   int rc;                         /* Return code from ESP32FlushBuffer() */
 
+  if( p->aSector ){
+    return ESP32CacheRead(p, zBuf, iAmt, iOfst);
+  }
+
   /* Flush any data in the write buffer to disk in case this operation
   ** is trying to read data the file-region currently cached in the buffer.
   ** It would be possible to detect this case and possibly save an 
@@ -211,7 +451,9 @@ static int ESP32Write(
       //Serial.println("fn: Write");
   ESP32File *p = (ESP32File*)pFile;
   
-  if( p->aBuffer ){
+  if( p->aSector ){
+    return ESP32CacheWrite(p, zBuf, iAmt, iOfst);
+  }else if( p->aBuffer ){
     char *z = (char *)zBuf;       /* Pointer to remaining data to write */
     int n = iAmt;                 /* Number of bytes at z */
     sqlite3_int64 i = iOfst;      /* File offset to write to */
@@ -277,6 +519,12 @@ static int ESP32Sync(sqlite3_file *pFile, int flags){
   if( rc!=SQLITE_OK ){
     return rc;
   }
+  if( p->aSector ){
+    rc = ESP32CacheFlush(p);
+    if( rc!=SQLITE_OK ){
+      return rc;
+    }
+  }
   rc = fflush(p->fp);
   if (rc != 0)
     return SQLITE_IOERR_FSYNC;
@@ -295,6 +543,12 @@ static int ESP32FileSize(sqlite3_file *pFile, sqlite_int64 *pSize){
   int rc;                         /* Return code from fstat() call */
 //  struct stat sStat;              /* Output of fstat() call */
 
+  /* The cache tracks the size including sectors not written yet. */
+  if( p->aSector ){
+    *pSize = p->iSize;
+    return SQLITE_OK;
+  }
+
   /* Flush the contents of the buffer to disk. As with the flush in the
   ** ESP32Read() method, it would be possible to avoid this and save a write
   ** here and there. But in practice this comes up so infrequently it is
@@ -305,6 +559,11 @@ static int ESP32FileSize(sqlite3_file *pFile, sqlite_int64 *pSize){
     return rc;
   }
 
+  /* fstat() only sees what stdio has passed to the file system. */
+  if( fflush(p->fp)!=0 ){
+    return SQLITE_IOERR_FSTAT;
+  }
+
 	struct stat st;
 	int fno = fileno(p->fp);
 	if (fno == -1)
@@ -334,10 +593,12 @@ static int ESP32CheckReservedLock(sqlite3_file *pFile, int *pResOut){
 }
 
 /*
-** No xFileControl() verbs are implemented by this VFS.
+** No xFileControl() verbs are implemented by this VFS. SQLITE_NOTFOUND
+** lets SQLite handle them, SQLITE_OK would swallow every PRAGMA as
+** SQLITE_FCNTL_PRAGMA answered by the VFS.
 */
 static int ESP32FileControl(sqlite3_file *pFile, int op, void *pArg){
-  return SQLITE_OK;
+  return SQLITE_NOTFOUND;
 }
 
 /*
@@ -346,10 +607,10 @@ static int ESP32FileControl(sqlite3_file *pFile, int op, void *pArg){
 ** access to some extent. But it is also safe to simply return 0.
 */
 static int ESP32SectorSize(sqlite3_file *pFile){
-  return 0;
+  return SQLITE_ESP32VFS_SECTORSZ;
 }
 static int ESP32DeviceCharacteristics(sqlite3_file *pFile){
-  return 0;
+  return SQLITE_ESP32VFS_IOCAP;
 }
 
 #ifndef F_OK
@@ -463,6 +724,27 @@ static int ESP32Open(
   }
   p->aBuffer = aBuf;
 
+  /* Main database files get a sector cache if memory is available. */
+  if( (flags&SQLITE_OPEN_MAIN_DB) && SQLITE_ESP32VFS_CACHESZ>0 ){
+    p->aCache = (char *)ESP32CacheAlloc(SQLITE_ESP32VFS_CACHESZ*SQLITE_ESP32VFS_SECTORSZ);
+    p->aSector = (ESP32Sector *)sqlite3_malloc(SQLITE_ESP32VFS_CACHESZ*sizeof(ESP32Sector));
+    if( p->aCache && p->aSector ){
+      struct stat st;
+      p->nSector = SQLITE_ESP32VFS_CACHESZ;
+      for(int i=0; i<p->nSector; i++){
+        p->aSector[i].iOfst = -1;
+        p->aSector[i].iUsed = 0;
+        p->aSector[i].bDirty = 0;
+      }
+      p->iSize = fstat(fileno(p->fp), &st)==0 ? st.st_size : 0;
+    }else{
+      free(p->aCache);
+      sqlite3_free(p->aSector);
+      p->aCache = 0;
+      p->aSector = 0;
+    }
+  }
+
   if( pOutFlags ){
     *pOutFlags = flags;
   }
@@ -635,6 +917,84 @@ sqlite3_vfs *sqlite3_ESP32vfs(void){
   return &ESP32vfs;
 }
 
+void sqlite3_ESP32vfs_stats(esp32vfs_stats_t *pStats){
+  *pStats = ESP32Stats;
+}
+
+#ifdef SQLITE_ESP32VFS_BENCHMARK
+#ifndef SQLITE_DEFAULT_PAGE_SIZE
+# define SQLITE_DEFAULT_PAGE_SIZE 4096
+#endif
+
+int sqlite3_ESP32vfs_benchmark(const char *zName, int nPage, int bCache, esp32vfs_benchmark_t *pResult){
+  sqlite3_vfs *pVfs = sqlite3_ESP32vfs();
+  sqlite3_file *pFile;
+  char *aPage;
+  int flags = SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE | (bCache ? SQLITE_OPEN_MAIN_DB : SQLITE_OPEN_TEMP_DB);
+  int rc;
+  uint64_t iStart;
+  uint32_t iRand = 1;
+  esp32vfs_stats_t start = ESP32Stats;
+
+  memset(pResult, 0, sizeof(*pResult));
+  pFile = (sqlite3_file *)sqlite3_malloc(pVfs->szOsFile);
+  aPage = (char *)sqlite3_malloc(SQLITE_DEFAULT_PAGE_SIZE);
+  if( !pFile || !aPage ){
+    sqlite3_free(pFile);
+    sqlite3_free(aPage);
+    return SQLITE_NOMEM;
+  }
+  pVfs->xDelete(pVfs, zName, 0);
+  rc = pVfs->xOpen(pVfs, zName, pFile, flags, 0);
+  if( rc!=SQLITE_OK ){
+    sqlite3_free(pFile);
+    sqlite3_free(aPage);
+    return rc;
+  }
+  pResult->bCache = ((ESP32File *)pFile)->aSector!=0;
+  /* Sequential page writes, like a transaction growing the database. */
+  iStart = micros();
+  for(int i=0; i<nPage && rc==SQLITE_OK; i++){
+    memset(aPage, i, SQLITE_DEFAULT_PAGE_SIZE);
+    rc = pFile->pMethods->xWrite(pFile, aPage, SQLITE_DEFAULT_PAGE_SIZE, (sqlite3_int64)i*SQLITE_DEFAULT_PAGE_SIZE);
+  }
+  pResult->iWrite = micros() - iStart;
+  iStart = micros();
+  if( rc==SQLITE_OK ){
+    rc = pFile->pMethods->xSync(pFile, SQLITE_SYNC_NORMAL);
+  }
+  pResult->iSync = micros() - iStart;
+  /* Sequential page reads, like a table scan. */
+  iStart = micros();
+  for(int i=0; i<nPage && rc==SQLITE_OK; i++){
+    rc = pFile->pMethods->xRead(pFile, aPage, SQLITE_DEFAULT_PAGE_SIZE, (sqlite3_int64)i*SQLITE_DEFAULT_PAGE_SIZE);
+    if( rc==SQLITE_OK && aPage[SQLITE_DEFAULT_PAGE_SIZE-1]!=(char)i ){
+      rc = SQLITE_CORRUPT;
+    }
+  }
+  pResult->iRead = micros() - iStart;
+  /* Small reads clustered on a few pages, like index lookups and header checks. */
+  iStart = micros();
+  for(int i=0; i<nPage*16 && rc==SQLITE_OK; i++){
+    iRand = iRand * 1103515245 + 12345;
+    int iPage = (iRand >> 16) % (nPage < 8 ? nPage : 8);
+    rc = pFile->pMethods->xRead(pFile, aPage, 100, (sqlite3_int64)iPage*SQLITE_DEFAULT_PAGE_SIZE + ((iRand >> 8) & 0xff));
+  }
+  pResult->iRandom = micros() - iStart;
+
+  pFile->pMethods->xClose(pFile);
+  pVfs->xDelete(pVfs, zName, 0);
+  sqlite3_free(pFile);
+  sqlite3_free(aPage);
+
+  pResult->stats.nHit = ESP32Stats.nHit - start.nHit;
+  pResult->stats.nMiss = ESP32Stats.nMiss - start.nMiss;
+  pResult->stats.nRead = ESP32Stats.nRead - start.nRead;
+  pResult->stats.nWrite = ESP32Stats.nWrite - start.nWrite;
+  return rc;
+}
+#endif /* SQLITE_ESP32VFS_BENCHMARK */
+
 static void shox96_0_2c(sqlite3_context *context, int argc, sqlite3_value **argv) {
   int nIn, nOut;
   long int nOut2;
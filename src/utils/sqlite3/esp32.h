@@ -0,0 +1,63 @@
+/*
+** ESP32 VFS for SQLite, see esp32.cpp.
+**
+** Main database files are read and written through a small LRU cache of
+** sector aligned blocks, allocated in PSRAM on the ESP32 and from the heap
+** on the native build.
+*/
+#ifndef _SQLITE3_ESP32_H
+#define _SQLITE3_ESP32_H
+
+#include <stdint.h>
+#include "sqlite3.h"
+
+/*
+** Uncomment to build sqlite3_ESP32vfs_benchmark().
+*/
+// #define SQLITE_ESP32VFS_BENCHMARK
+
+/*
+** Sector cache counters, summed over all open files.
+*/
+typedef struct {
+  uint32_t nHit;                  /* Cache hits */
+  uint32_t nMiss;                 /* Cache misses */
+  uint32_t nRead;                 /* Sectors read from the file */
+  uint32_t nWrite;                /* Sectors written to the file */
+} esp32vfs_stats_t;
+
+/*
+** Result of sqlite3_ESP32vfs_benchmark(), times in microseconds.
+*/
+typedef struct {
+  int bCache;                     /* True if the file was opened with the sector cache */
+  uint64_t iWrite;                /* Sequential write of all pages */
+  uint64_t iSync;                 /* Sync after the sequential write */
+  uint64_t iRead;                 /* Sequential read of all pages */
+  uint64_t iRandom;               /* Random small reads */
+  esp32vfs_stats_t stats;         /* Cache counters during the run */
+} esp32vfs_benchmark_t;
+
+/*
+** Return the ESP32 VFS, registered as default VFS in sqlite3_os_init().
+*/
+sqlite3_vfs *sqlite3_ESP32vfs(void);
+
+/*
+** Copy the sector cache counters to pStats.
+*/
+void sqlite3_ESP32vfs_stats(esp32vfs_stats_t *pStats);
+
+#ifdef SQLITE_ESP32VFS_BENCHMARK
+/*
+** Write nPage pages of SQLITE_DEFAULT_PAGE_SIZE to zName, sync, read them
+** back sequentially and then at random. With bCache the file is opened as
+** main database file and goes through the sector cache, without as a temp
+** database with direct I/O. The file is deleted afterwards.
+**
+** Returns SQLITE_OK on success.
+*/
+int sqlite3_ESP32vfs_benchmark(const char *zName, int nPage, int bCache, esp32vfs_benchmark_t *pResult);
+#endif
+
+#endif /* _SQLITE3_ESP32_H */
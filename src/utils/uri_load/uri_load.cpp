@@ -72,6 +72,7 @@
 #else
     #include <HTTPClient.h>
     #include <SPIFFS.h>
+    #include <lwip/sockets.h>
 #endif
 
 uri_load_dsc_t *uri_load_create_dsc( void );
@@ -950,4 +951,254 @@ void uri_load_set_url_from_uri( uri_load_dsc_t *uri_load_dsc, const char *uri )
             URI_LOAD_ERROR_LOG("uri_load->uri: alloc failed");
         }
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief keep-alive connection structure
+ */
+struct uri_load_conn_s {
+#ifdef NATIVE_64BIT
+    CURL *curl;                                 /** @brief curl easy handle, holds the open connection */
+#else
+    HTTPClient *client;                         /** @brief http client with connection reuse */
+    SemaphoreHandle_t xSemaphoreMutex;          /** @brief one request at a time over the connection */
+#endif
+    char server[ 128 ];                         /** @brief scheme, host and port of the connected server */
+    uint32_t requests;                          /** @brief requests sent over this connection */
+    uint32_t connects;                          /** @brief connections opened */
+};
+
+/**
+ * @brief copy scheme, host and port of an uri into the server buffer
+ */
+static void uri_load_conn_get_server( const char *uri, char *server, size_t len ) {
+    const char *host = strstr( uri, "://" );
+    const char *path = host ? strchr( host + 3, '/' ) : NULL;
+    size_t server_len = path ? path - uri : strlen( uri );
+
+    if ( server_len >= len )
+        server_len = len - 1;
+    memcpy( server, uri, server_len );
+    server[ server_len ] = '\0';
+}
+
+uri_load_conn_t *uri_load_conn_create( void ) {
+    uri_load_conn_t *uri_load_conn = (uri_load_conn_t*)CALLOC( 1, sizeof( uri_load_conn_t ) );
+    /**
+     * check if alloc was failed
+     */
+    if ( !uri_load_conn ) {
+        URI_LOAD_ERROR_LOG("uri_load_conn: alloc failed");
+        return( NULL );
+    }
+#ifdef NATIVE_64BIT
+    /**
+     * curl_global_init is reference counted, keep one reference for the
+     * lifetime of the program so the per request cleanup in uri_load_http_to_ram
+     * does not tear down the connection cache
+     */
+    static bool curl_global = false;
+    if ( !curl_global ) {
+        curl_global_init( CURL_GLOBAL_ALL );
+        curl_global = true;
+    }
+    /**
+     * the easy handle keep its connection open between two transfers
+     */
+    uri_load_conn->curl = curl_easy_init();
+    if ( !uri_load_conn->curl ) {
+        URI_LOAD_ERROR_LOG("curl_easy_init() failed");
+        free( uri_load_conn );
+        return( NULL );
+    }
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback );
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_USERAGENT, HARDWARE_NAME "-" __FIRMWARE__ );
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_FOLLOWLOCATION, 1L );
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_TCP_KEEPALIVE, 1L );
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_CONNECTTIMEOUT_MS, (long)URI_LOAD_CONN_TIMEOUT );
+#else
+    const char * headerKeys[] = {"location", "redirect" };
+    const size_t numberOfHeaders = 2;
+
+    uri_load_conn->client = new HTTPClient();
+    uri_load_conn->client->setReuse( true );
+    uri_load_conn->client->setTimeout( URI_LOAD_CONN_TIMEOUT );
+    uri_load_conn->client->setUserAgent( HARDWARE_NAME "-" __FIRMWARE__ );
+    uri_load_conn->client->collectHeaders( headerKeys, numberOfHeaders );
+    uri_load_conn->xSemaphoreMutex = xSemaphoreCreateMutex();
+#endif
+    return( uri_load_conn );
+}
+
+void uri_load_conn_free( uri_load_conn_t *uri_load_conn ) {
+    if ( !uri_load_conn ) {
+        return;
+    }
+    URI_LOAD_LOG("close connection to %s after %d requests over %d connections", uri_load_conn->server, uri_load_conn->requests, uri_load_conn->connects );
+#ifdef NATIVE_64BIT
+    curl_easy_cleanup( uri_load_conn->curl );
+#else
+    uri_load_conn->client->setReuse( false );
+    uri_load_conn->client->end();
+    delete uri_load_conn->client;
+    vSemaphoreDelete( uri_load_conn->xSemaphoreMutex );
+#endif
+    free( uri_load_conn );
+}
+
+#ifndef NATIVE_64BIT
+/**
+ * @brief read the response body with known size from the stream, wait in select() for
+ * new data instead of polling available()
+ * 
+ * @return  true if all bytes received
+ */
+static bool uri_load_conn_read( uri_load_dsc_t *uri_load_dsc, WiFiClient *stream ) {
+    uint32_t bytes_left = uri_load_dsc->size;
+    uint8_t *data_write_p = uri_load_dsc->data;
+
+    while( bytes_left > 0 ) {
+        /**
+         * first take what is buffered or already arrived
+         */
+        int c = stream->read( data_write_p, bytes_left );
+        if ( c > 0 ) {
+            bytes_left -= c;
+            data_write_p += c;
+            continue;
+        }
+        if ( !stream->connected() ) {
+            break;
+        }
+        /**
+         * block until the socket becomes readable or timeout
+         */
+        fd_set readset;
+        struct timeval timeout;
+        FD_ZERO( &readset );
+        FD_SET( stream->fd(), &readset );
+        timeout.tv_sec = URI_LOAD_CONN_TIMEOUT / 1000;
+        timeout.tv_usec = ( URI_LOAD_CONN_TIMEOUT % 1000 ) * 1000;
+        if ( select( stream->fd() + 1, &readset, NULL, NULL, &timeout ) <= 0 ) {
+            URI_LOAD_ERROR_LOG("receive timeout, %d bytes left", bytes_left );
+            break;
+        }
+    }
+    return( bytes_left == 0 );
+}
+#endif
+
+uri_load_dsc_t *uri_load_conn_to_ram( uri_load_conn_t *uri_load_conn, const char *uri ) {
+    char server[ sizeof( uri_load_conn->server ) ];
+    /**
+     * only plain http is kept alive
+     */
+    if ( !uri_load_conn || !strstr( uri, "http://" ) ) {
+        return( uri_load_to_ram( uri ) );
+    }
+    /**
+     * alloc uri_load_dsc structure
+     */
+    uri_load_dsc_t *uri_load_dsc = uri_load_create_dsc();
+    if ( !uri_load_dsc ) {
+        URI_LOAD_ERROR_LOG("uri_load_dsc: alloc failed");
+        return( NULL );
+    }
+    uri_load_set_filename_from_uri( uri_load_dsc, uri );
+    uri_load_set_url_from_uri( uri_load_dsc, uri );
+    uri_load_conn_get_server( uri, server, sizeof( server ) );
+#ifdef NATIVE_64BIT
+    struct MemoryStruct chunk;
+    long connects = 0;
+    long httpCode = 0;
+
+    chunk.memory = (char*)MALLOC( 1 );
+    chunk.size = 0;
+    /**
+     * send the request over the open connection, curl reconnects by itself
+     * if the server has closed it or the server has changed
+     */
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_URL, uri );
+    curl_easy_setopt( uri_load_conn->curl, CURLOPT_WRITEDATA, (void *)&chunk );
+    CURLcode res = curl_easy_perform( uri_load_conn->curl );
+    curl_easy_getinfo( uri_load_conn->curl, CURLINFO_RESPONSE_CODE, &httpCode );
+    curl_easy_getinfo( uri_load_conn->curl, CURLINFO_NUM_CONNECTS, &connects );
+    uri_load_conn->requests++;
+    uri_load_conn->connects += connects;
+    strncpy( uri_load_conn->server, server, sizeof( uri_load_conn->server ) );
+
+    if ( res != CURLE_OK || httpCode != 200 ) {
+        URI_LOAD_ERROR_LOG("%s failed: %s, code: %ld", uri, curl_easy_strerror( res ), httpCode );
+        free( chunk.memory );
+        uri_load_free_all( uri_load_dsc );
+        return( NULL );
+    }
+    uri_load_dsc->data = (uint8_t *)chunk.memory;
+    uri_load_dsc->size = chunk.size;
+#else
+    HTTPClient *client = uri_load_conn->client;
+    String location = "";
+    bool success = false;
+
+    xSemaphoreTake( uri_load_conn->xSemaphoreMutex, portMAX_DELAY );
+    /**
+     * close the connection when the server has changed
+     */
+    if ( strcmp( uri_load_conn->server, server ) ) {
+        client->setReuse( false );
+        client->end();
+        client->setReuse( true );
+        strncpy( uri_load_conn->server, server, sizeof( uri_load_conn->server ) );
+    }
+    client->begin( uri );
+    if ( !client->connected() )
+        uri_load_conn->connects++;
+    uri_load_conn->requests++;
+    int httpCode = client->GET();
+
+    if ( httpCode == HTTP_CODE_OK ) {
+        int size = client->getSize();
+        if ( size > 0 ) {
+            uri_load_dsc->size = size;
+            uri_load_dsc->data = (uint8_t*)CALLOC( 1, uri_load_dsc->size + 1 );
+            if ( uri_load_dsc->data )
+                success = uri_load_conn_read( uri_load_dsc, client->getStreamPtr() );
+            else
+                URI_LOAD_ERROR_LOG("data alloc failed, %d bytes", uri_load_dsc->size );
+        }
+        else {
+            /**
+             * chunked or without content length, let the client collect it
+             */
+            String payload = client->getString();
+            uri_load_dsc->size = payload.length();
+            uri_load_dsc->data = (uint8_t*)CALLOC( 1, uri_load_dsc->size + 1 );
+            if ( uri_load_dsc->data ) {
+                memcpy( uri_load_dsc->data, payload.c_str(), uri_load_dsc->size );
+                success = uri_load_dsc->size > 0;
+            }
+        }
+    }
+    else if ( httpCode == 301 || httpCode == 302 ) {
+        location = client->header("location") != "" ? client->header("location") : client->header("redirect");
+        URI_LOAD_INFO_LOG("301/302 redirect to: %s", location.c_str() );
+    }
+    else {
+        URI_LOAD_ERROR_LOG("http connection abort, code: %d", httpCode );
+    }
+    /**
+     * the connection stay open if the response was read completely
+     */
+    if ( !success )
+        client->setReuse( false );
+    client->end();
+    client->setReuse( true );
+    xSemaphoreGive( uri_load_conn->xSemaphoreMutex );
+
+    if ( !success ) {
+        uri_load_free_all( uri_load_dsc );
+        return( location.isEmpty() ? NULL : uri_load_to_ram( location.c_str() ) );
+    }
+#endif
+    uri_load_dsc->timestamp = millis();
+    return( uri_load_dsc );
+}
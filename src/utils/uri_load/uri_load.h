@@ -29,6 +29,7 @@
     #define URI_LOAD_ERROR_LOG  log_e
 
     #define URI_BLOCK_SIZE      4096
+    #define URI_LOAD_CONN_TIMEOUT   1500        /** @brief keep-alive connection receive timeout in ms */
 
     /**
      * @brief typedef for the callback function call
@@ -47,6 +48,10 @@
         uint8_t *data;              /** @brief pointer to the downloaded data */
         progress_cb_t *progresscb;  /** @brief progress call back */
     } uri_load_dsc_t;
+    /**
+     * @brief typedef for a keep-alive connection, one connection serve one server at a time
+     */
+    typedef struct uri_load_conn_s uri_load_conn_t;
     /**
      * @brief doenload a file from a webserver into ram
      * 
@@ -129,5 +134,27 @@
      * @param uri_load_dsc pointer to a uri_load_dsc structure
      */
     void uri_load_free_dsc( uri_load_dsc_t *uri_load_dsc );
+    /**
+     * @brief create a keep-alive connection for repeated downloads from the same server
+     * 
+     * @return  pointer to a uri_load_conn structure or NULL if alloc failed
+     */
+    uri_load_conn_t *uri_load_conn_create( void );
+    /**
+     * @brief close a keep-alive connection and free all allocated memory
+     * 
+     * @param uri_load_conn pointer to a uri_load_conn structure
+     */
+    void uri_load_conn_free( uri_load_conn_t *uri_load_conn );
+    /**
+     * @brief download a file from a webserver into ram over a keep-alive connection,
+     * http uri reuse the open connection, all other uri are loaded with uri_load_to_ram()
+     * 
+     * @param   uri_load_conn   pointer to a uri_load_conn structure, NULL means no keep-alive
+     * @param   uri             requested url to get a file from
+     * 
+     * @return  uri_load_dsc structure or NULL if failed
+     */
+    uri_load_dsc_t *uri_load_conn_to_ram( uri_load_conn_t *uri_load_conn, const char *uri );
 
 #endif // _URI_LOAD__H
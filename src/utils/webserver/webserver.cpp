@@ -21,6 +21,12 @@
  */
 #include "webserver.h"
 #include "config.h"
+#include "hardware/callback.h"
+#include "utils/frametime.h"
+#include "utils/alloc.h"
+#include "utils/filepath_convert.h"
+#include "utils/basejsonconfig.h"
+#include "app/tracker/tracker_recorder.h"
 
 #if defined( ENABLE_WEBSERVER )
     #ifdef NATIVE_64BIT
@@ -36,6 +42,7 @@
         #include <ESPAsyncWebServer.h>
         #include <SPIFFSEditor.h>
         #include <ESP32SSDP.h>
+        #include <memory>
 
         AsyncWebServer asyncserver( WEBSERVERPORT );
         TaskHandle_t _WEBSERVER_Task;
@@ -133,6 +140,7 @@
         } else {
         Serial.println("Update complete");
         Serial.flush();
+        BaseJsonConfig::flush();
         ESP.restart();
         }
     }
@@ -168,6 +176,8 @@
         "<li><a target=\"cont\" href=\"/battery\">/battery</a> - Display battery charging information"
         "<li><a target=\"cont\" href=\"/touch\">/touch</a> - Display touch screen information"
         "<li><a target=\"cont\" href=\"/network\">/network</a> - Display network information"
+        "<li><a target=\"cont\" href=\"/callback\">/callback</a> - Callback call time statistics as json"
+        "<li><a target=\"cont\" href=\"/frametime\">/frametime</a> - Frame time statistics as json, ?overlay=on|off for the statusbar overlay"
         "<li><a target=\"cont\" href=\"/shot\">/shot</a> - Capture a screen shot"
         "<li><a target=\"cont\" href=\"/screen.png\">/screen.png</a> - Retrieve the image in png format, open it with gimp"
         "<li><a target=\"_blank\" href=\"/edit\">/edit</a> - View, edit, upload, and delete files"
@@ -236,6 +246,89 @@
         request->send(200, "text/html", html);
     });
 
+    asyncserver.on("/callback", HTTP_GET, [](AsyncWebServerRequest *request) {
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        callback_t *callback = callback_get_head();
+
+        response->print("{\"uptime\":");
+        response->print( millis() / 1000 );
+        response->print(",\"callback\":[");
+        while( callback ) {
+            response->printf("{\"name\":\"%s\",\"entrys\":[", callback->name );
+            for( uint32_t entry = 0 ; entry < callback->entrys ; entry++ ) {
+                callback_stats_t stats;
+                const char *id = NULL;
+                if( !callback_get_entry_snapshot( callback, entry, &id, &stats ) )
+                    break;
+                response->printf("%s{\"id\":\"%s\",\"calls\":%u,\"min\":%u,\"max\":%u,\"mean\":%u,\"histogram\":[", entry ? "," : "", id, stats.calls, stats.time_min, stats.time_max, callback_get_stats_mean( &stats ) );
+                for( int slot = 0 ; slot < CALLBACK_HISTOGRAM_SIZE ; slot++ )
+                    response->printf("%s%u", slot ? "," : "", stats.histogram[ slot ] );
+                response->print("]}");
+            }
+            callback = callback->next_callback_t;
+            response->print( callback ? "]}," : "]}" );
+        }
+        response->print("]}");
+        request->send( response );
+    });
+
+    asyncserver.on("/frametime", HTTP_GET, [](AsyncWebServerRequest *request) {
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        frametime_summary_t summary;
+
+        if ( request->hasParam("overlay") )
+            frametime_set_overlay( request->getParam("overlay")->value() == "on" );
+
+        frametime_get_summary( &summary );
+        response->printf("{\"frames\":%u,\"fps\":%u,\"render_mean\":%u,\"render_max\":%u,\"flush_mean\":%u,\"flush_max\":%u,\"px_mean\":%u,\"first_frame\":%u,\"overlay\":%s,\"frame\":[", summary.frames, summary.fps, summary.render_mean_us, summary.render_max_us, summary.flush_mean_us, summary.flush_max_us, summary.px_mean, summary.first_frame_ms, frametime_get_overlay() ? "true" : "false" );
+        for( uint32_t entry = 0 ; entry < frametime_get_entrys() ; entry++ ) {
+            frametime_entry_t frame;
+            if( !frametime_get_entry( entry, &frame ) )
+                break;
+            response->printf("%s{\"timestamp\":%u,\"frame_ms\":%u,\"render\":%u,\"flush\":%u,\"px\":%u,\"bands\":%u}", entry ? "," : "", frame.timestamp, frame.frame_ms, frame.render_us, frame.flush_us, frame.px, frame.bands );
+        }
+        response->print("]}");
+        request->send( response );
+    });
+
+    asyncserver.on("/tracker", HTTP_GET, [](AsyncWebServerRequest *request) {
+        char filename[ 256 ] = "";
+        tracker_export_format_t format = TRACKER_EXPORT_GPX;
+        double simplify = 0;
+        /**
+         * stream the given or the last recorded track as gpx or kml
+         */
+        if ( request->hasParam("file") )
+            filepath_convert( filename, sizeof( filename ), request->getParam("file")->value().c_str() );
+        else
+            strncpy( filename, tracker_recorder_get_filename(), sizeof( filename ) - 1 );
+
+        if ( request->hasParam("format") && request->getParam("format")->value() == "kml" )
+            format = TRACKER_EXPORT_KML;
+
+        if ( request->hasParam("simplify") )
+            simplify = request->getParam("simplify")->value().toFloat();
+
+        tracker_export_t *exporter = (tracker_export_t *)MALLOC( sizeof( tracker_export_t ) );
+        if ( !exporter || !tracker_recorder_export_open( exporter, filename, format, simplify ) ) {
+            free( exporter );
+            request->send( 404, "text/plain", "track not found" );
+            return;
+        }
+        /**
+         * the export state lives as long as the chunked response
+         */
+        std::shared_ptr<tracker_export_t> state( exporter, []( tracker_export_t *exporter ) {
+            tracker_recorder_export_close( exporter );
+            free( exporter );
+        });
+        AsyncWebServerResponse *response = request->beginChunkedResponse( format == TRACKER_EXPORT_KML ? "application/vnd.google-earth.kml+xml" : "application/gpx+xml", [ state ]( uint8_t *buffer, size_t maxLen, size_t index ) -> size_t {
+            return( tracker_recorder_export_read( state.get(), (char *)buffer, maxLen ) );
+        });
+        response->addHeader("Content-Disposition", format == TRACKER_EXPORT_KML ? "attachment; filename=track.kml" : "attachment; filename=track.gpx" );
+        request->send( response );
+    });
+
     /*
     asyncserver.on("/battery", HTTP_GET, [](AsyncWebServerRequest *request) {
         TTGOClass * ttgo = TTGOClass::getWatch();
@@ -387,6 +480,7 @@
 
     asyncserver.on("/reset", HTTP_GET, []( AsyncWebServerRequest * request ) {
         request->send(200, "text/plain", "Reset\r\n" );
+        BaseJsonConfig::flush();
         delay(3000);
         ESP.restart();    
     });
@@ -465,6 +559,15 @@
         if(mSPIFFSEditor!=nullptr)
             delete mSPIFFSEditor;  
         mSPIFFSEditor = new SPIFFSEditor(fs);
+        /**
+         * config files may change in the editor, load them from json on the next boot
+         */
+        mSPIFFSEditor->setFilter( []( AsyncWebServerRequest *request ) {
+            if ( request->url() == "/edit" && request->method() != HTTP_GET ) {
+                BaseJsonConfig::invalidateSnapshot();
+            }
+            return( true );
+        });
         log_d("asyncserver.addHandler");
         mHandler_SPIFFSEditor = asyncserver.addHandler(mSPIFFSEditor);
     }